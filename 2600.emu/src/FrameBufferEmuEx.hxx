@@ -43,7 +43,11 @@ public:
 	};
 	uInt16 tiaColorMap16[256]{};
 	uInt32 tiaColorMap32[256]{};
-	uInt8 myPhosphorPalette[256][256]{};
+	uInt32 tiaColorMapRGBA8888[256]{};
+	// decayed value of each previous frame channel value, and a 16-bit fixed point
+	// multiplier giving the same result for the SIMD path or 0 if none does
+	uInt8 myPhosphorDecay[256]{};
+	uInt16 myPhosphorMul{};
 	std::array<uInt8, 160 * TIAConstants::frameBufferHeight> prevFramebuffer{};
 	Common::Rect myImageRect{};
 	float myPhosphorPercent = 0.80f;
@@ -80,8 +84,6 @@ public:
 
 	uInt8 getPhosphor(const uInt8 c1, uInt8 c2) const;
 
-	uInt32 getRGBPhosphor(const uInt32 c, const uInt32 p) const;
-
 	void clear() {}
 
 	void updateSurfaceSettings() {}
@@ -20,6 +20,12 @@
 #include <emuframework/EmuApp.hh>
 #undef Debugger
 #include <imagine/logger/logger.h>
+#include <algorithm>
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
 
 void FrameBuffer::showMessage(const string& message, int position, bool force, uInt32 color)
 {
@@ -35,11 +41,26 @@ void FrameBuffer::enablePhosphor(bool enable, int blend)
   	logMsg("phosphor blend:%d (%.2f%%)", blend, myPhosphorPercent);
 	}
 	if(enable)
-  {
-    for(Int16 c = 255; c >= 0; c--)
-      for(Int16 p = 255; p >= 0; p--)
-        myPhosphorPalette[c][p] = getPhosphor(c, p);
-  }
+	{
+		iterateTimes(256, p)
+		{
+			myPhosphorDecay[p] = getPhosphor(0, p);
+		}
+		// the float decay rounds differently than any multiplier for a few blend values,
+		// those use the scalar path so the output is the same either way
+		myPhosphorMul = 0;
+		int mulGuess = myPhosphorPercent * 65536.f;
+		for(int mul = std::max(mulGuess - 4, 1); mul <= std::min(mulGuess + 4, 0xFFFF); mul++)
+		{
+			if(std::all_of(std::begin(myPhosphorDecay), std::end(myPhosphorDecay),
+				[&, p = 0](uInt8 decay) mutable { return ((p++ * mul) >> 16) == decay; }))
+			{
+				myPhosphorMul = mul;
+				break;
+			}
+		}
+		logMsg("phosphor blend multiplier:%d", myPhosphorMul);
+	}
 	prevFramebuffer = {};
 }
 
@@ -61,41 +82,173 @@ void FrameBuffer::setTIAPalette(const PaletteArray& palette)
 		uint8_t b = palette[i] & 0xff;
 		tiaColorMap16[i] = IG::PIXEL_DESC_RGB565.build(r >> 3, g >> 2, b >> 3, 0);
 		tiaColorMap32[i] = IG::PIXEL_DESC_ARGB8888.build((int)r, (int)g, (int)b, 0);
+		// in memory byte order, phosphor blending treats every byte the same so it can work on these directly
+		const uint8_t rgba[4]{r, g, b, 0xff};
+		memcpy(&tiaColorMapRGBA8888[i], rgba, sizeof(rgba));
 	}
 }
 
-uInt32 FrameBuffer::getRGBPhosphor(const uInt32 c, const uInt32 p) const
+#if defined __SSE2__
+using PhosphorVec = __m128i;
+using PhosphorMulVec = __m128i;
+
+// max(c, (p * mul) >> 16) on each byte of 4 pixels
+static PhosphorVec blendPhosphor(PhosphorVec c, PhosphorVec p, PhosphorMulVec mul)
+{
+	auto zero = _mm_setzero_si128();
+	auto lo = _mm_mulhi_epu16(_mm_unpacklo_epi8(p, zero), mul);
+	auto hi = _mm_mulhi_epu16(_mm_unpackhi_epi8(p, zero), mul);
+	return _mm_max_epu8(c, _mm_packus_epi16(lo, hi));
+}
+
+static PhosphorMulVec makePhosphorMul(uint16_t mul) { return _mm_set1_epi16(mul); }
+
+static PhosphorVec loadColors(const uInt32 *colorMap, const uint8_t *idx)
+{
+	return _mm_setr_epi32(colorMap[idx[0]], colorMap[idx[1]], colorMap[idx[2]], colorMap[idx[3]]);
+}
+
+static void storeRGBA8888(uint32_t *dest, PhosphorVec v)
+{
+	_mm_storeu_si128((__m128i*)dest, v);
+}
+
+// 0x00RRGGBB colors to 8 RGB565 pixels
+static void storeRGB565(uint16_t *dest, PhosphorVec v1, PhosphorVec v2)
+{
+	auto to565 = [](__m128i v)
+	{
+		auto r = _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xf800));
+		auto g = _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x07e0));
+		auto b = _mm_and_si128(_mm_srli_epi32(v, 3), _mm_set1_epi32(0x001f));
+		// sign extend so the signed saturating pack keeps values above 0x7fff
+		return _mm_srai_epi32(_mm_slli_epi32(_mm_or_si128(_mm_or_si128(r, g), b), 16), 16);
+	};
+	_mm_storeu_si128((__m128i*)dest, _mm_packs_epi32(to565(v1), to565(v2)));
+}
+#elif defined __ARM_NEON
+using PhosphorVec = uint8x16_t;
+using PhosphorMulVec = uint16x4_t;
+
+static PhosphorVec blendPhosphor(PhosphorVec c, PhosphorVec p, PhosphorMulVec mul)
+{
+	auto decay = [=](uint8x8_t p)
+	{
+		auto p16 = vmovl_u8(p);
+		auto lo = vshrn_n_u32(vmull_u16(vget_low_u16(p16), mul), 16);
+		auto hi = vshrn_n_u32(vmull_u16(vget_high_u16(p16), mul), 16);
+		return vmovn_u16(vcombine_u16(lo, hi));
+	};
+	return vmaxq_u8(c, vcombine_u8(decay(vget_low_u8(p)), decay(vget_high_u8(p))));
+}
+
+static PhosphorMulVec makePhosphorMul(uint16_t mul) { return vdup_n_u16(mul); }
+
+static PhosphorVec loadColors(const uInt32 *colorMap, const uint8_t *idx)
 {
-  #define TO_RGB(color, red, green, blue) \
-    const uInt8 red = color >> 16; const uInt8 green = color >> 8; const uInt8 blue = color;
+	const uint32_t colors[4]{colorMap[idx[0]], colorMap[idx[1]], colorMap[idx[2]], colorMap[idx[3]]};
+	return vreinterpretq_u8_u32(vld1q_u32(colors));
+}
 
-  TO_RGB(c, rc, gc, bc);
-  TO_RGB(p, rp, gp, bp);
+static void storeRGBA8888(uint32_t *dest, PhosphorVec v)
+{
+	vst1q_u32(dest, vreinterpretq_u32_u8(v));
+}
 
-  // Mix current calculated frame with previous displayed frame
-  const uInt8 rn = myPhosphorPalette[rc][rp];
-  const uInt8 gn = myPhosphorPalette[gc][gp];
-  const uInt8 bn = myPhosphorPalette[bc][bp];
+static void storeRGB565(uint16_t *dest, PhosphorVec v1, PhosphorVec v2)
+{
+	auto to565 = [](uint8x16_t v)
+	{
+		auto v32 = vreinterpretq_u32_u8(v);
+		auto r = vandq_u32(vshrq_n_u32(v32, 8), vdupq_n_u32(0xf800));
+		auto g = vandq_u32(vshrq_n_u32(v32, 5), vdupq_n_u32(0x07e0));
+		auto b = vandq_u32(vshrq_n_u32(v32, 3), vdupq_n_u32(0x001f));
+		return vmovn_u32(vorrq_u32(vorrq_u32(r, g), b));
+	};
+	vst1q_u16(dest, vcombine_u16(to565(v1), to565(v2)));
+}
+#endif
 
-  return IG::PIXEL_DESC_RGB565.build(rn >> 3, gn >> 2, bn >> 3, 0);
+static uint32_t blendPhosphorBytes(uint32_t c, uint32_t p, const uInt8 *decay)
+{
+	uint32_t blended = 0;
+	for(unsigned shift = 0; shift < 32; shift += 8)
+	{
+		blended |= (uint32_t)std::max<uInt8>(c >> shift, decay[(p >> shift) & 0xff]) << shift;
+	}
+	return blended;
+}
+
+// Pixel is uint16_t for RGB565 from 0x00RRGGBB colors or uint32_t for RGBA8888 from colors
+// already in that format
+template <class Pixel>
+static void renderPhosphorLine(Pixel *dest, const uint8_t *src, const uint8_t *prevSrc, unsigned width,
+	const uInt32 *colorMap, const uInt8 *decay, [[maybe_unused]] uint16_t mul)
+{
+	unsigned x = 0;
+	#if defined __SSE2__ || defined __ARM_NEON
+	if(mul)
+	{
+		auto mulVec = makePhosphorMul(mul);
+		for(; x + 8 <= width; x += 8)
+		{
+			auto v1 = blendPhosphor(loadColors(colorMap, src + x), loadColors(colorMap, prevSrc + x), mulVec);
+			auto v2 = blendPhosphor(loadColors(colorMap, src + x + 4), loadColors(colorMap, prevSrc + x + 4), mulVec);
+			if constexpr(sizeof(Pixel) == 2)
+			{
+				storeRGB565(dest + x, v1, v2);
+			}
+			else
+			{
+				storeRGBA8888(dest + x, v1);
+				storeRGBA8888(dest + x + 4, v2);
+			}
+		}
+	}
+	#endif
+	for(; x < width; x++)
+	{
+		auto v = blendPhosphorBytes(colorMap[src[x]], colorMap[prevSrc[x]], decay);
+		if constexpr(sizeof(Pixel) == 2)
+			dest[x] = IG::PIXEL_DESC_RGB565.build(v >> 19 & 0x1f, v >> 10 & 0x3f, v >> 3 & 0x1f, 0u);
+		else
+			dest[x] = v;
+	}
 }
 
 void FrameBuffer::render(IG::Pixmap pix, TIA &tia)
 {
 	assumeExpr(pix.w() == tia.width());
 	assumeExpr(pix.h() == tia.height());
-	IG::Pixmap framePix{{{(int)tia.width(), (int)tia.height()}, IG::PIXEL_I8}, tia.frameBuffer()};
+	bool isRGBA8888 = pix.format() == IG::PIXEL_RGBA8888;
 	if(myUsePhosphor)
 	{
-		uint8_t* prevFrame = prevFramebuffer.data();
-		pix.writeTransformed([this, &prevFrame](uint8_t p)
+		auto width = tia.width();
+		const uint8_t *src = tia.frameBuffer();
+		const uint8_t *prevSrc = prevFramebuffer.data();
+		iterateTimes(tia.height(), y)
+		{
+			if(isRGBA8888)
+			{
+				renderPhosphorLine((uint32_t*)pix.pixel({0, (int)y}), src, prevSrc, width,
+					tiaColorMapRGBA8888, myPhosphorDecay, myPhosphorMul);
+			}
+			else
 			{
-				return getRGBPhosphor(tiaColorMap32[p], tiaColorMap32[*prevFrame++]);
-			}, framePix);
+				renderPhosphorLine((uint16_t*)pix.pixel({0, (int)y}), src, prevSrc, width,
+					tiaColorMap32, myPhosphorDecay, myPhosphorMul);
+			}
+			src += width;
+			prevSrc += width;
+		}
 		memcpy(prevFramebuffer.data(), tia.frameBuffer(), sizeof(prevFramebuffer));
 	}
 	else
 	{
-		pix.writeTransformed([this](uint8_t p){ return tiaColorMap16[p]; }, framePix);
+		IG::Pixmap framePix{{{(int)tia.width(), (int)tia.height()}, IG::PIXEL_I8}, tia.frameBuffer()};
+		if(isRGBA8888)
+			pix.writeTransformed([this](uint8_t p){ return tiaColorMapRGBA8888[p]; }, framePix);
+		else
+			pix.writeTransformed([this](uint8_t p){ return tiaColorMap16[p]; }, framePix);
 	}
 }
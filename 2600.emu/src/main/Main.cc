@@ -45,6 +45,8 @@ std::unique_ptr<OSystem> osystem{};
 Properties defaultGameProps{};
 bool p1DiffB = true, p2DiffB = true, vcsColor = true;
 Controller::Type autoDetectedInput1{};
+// the phosphor blend works on RGBA8888 directly so use it when the renderer prefers it
+static IG::PixelFormat pixFmt = IG::PIXEL_FMT_RGB565;
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nStella Team\nstella-emu.github.io";
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
@@ -149,6 +151,12 @@ void EmuSystem::configAudioRate(IG::FloatSeconds frameTime, uint32_t rate)
 	osystem->setFrameTime(frameTime.count(), rate);
 }
 
+void EmuSystem::onPrepareVideo(EmuVideo &video)
+{
+	pixFmt = EmuApp::defaultRenderPixelFormat() == IG::PIXEL_RGBA8888 ? IG::PIXEL_FMT_RGBA8888 : IG::PIXEL_FMT_RGB565;
+	logMsg("rendering with format:%s", pixFmt.name());
+}
+
 void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 {
 	auto os = osystem.get();
@@ -162,7 +170,7 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	tia.renderToFrameBuffer();
 	if(video)
 	{
-		auto img = video->startFrameWithFormat(task, {{(int)tia.width(), (int)tia.height()}, IG::PIXEL_FMT_RGB565});
+		auto img = video->startFrameWithFormat(task, {{(int)tia.width(), (int)tia.height()}, pixFmt});
 		os->frameBuffer().render(img.pixmap(), tia);
 		img.endFrame();
 	}
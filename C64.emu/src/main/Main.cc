@@ -19,8 +19,6 @@
 #include <emuframework/EmuVideo.hh>
 #include <emuframework/EmuInput.hh>
 #include <emuframework/EmuAppInlines.hh>
-#include <imagine/thread/Thread.hh>
-#include <imagine/thread/Semaphore.hh>
 #include <imagine/gui/AlertView.hh>
 #include <imagine/base/Base.hh>
 #include "internal.hh"
@@ -66,9 +64,10 @@ extern "C"
 }
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2013-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nVice Team\nwww.viceteam.org";
-IG::Semaphore execSem{0}, execDoneSem{0};
+std::optional<IG::Coroutine> viceMainLoop{};
 EmuAudio *audioPtr{};
 static bool c64IsInit = false, c64FailedInit = false;
+static bool autostartWasInProgress = false;
 FS::PathString firmwareBasePath{};
 FS::PathString sysFilePath[Config::envIsLinux ? 5 : 3]{};
 VicePlugin plugin{};
@@ -77,6 +76,7 @@ ViceSystem currSystem = VICE_SYSTEM_C64;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 bool EmuSystem::handlesGenericIO = false;
+bool EmuSystem::hasBootSnapshots = true;
 
 const char *EmuSystem::shortSystemName()
 {
@@ -556,6 +556,22 @@ static FS::FileString vic20ExtraCartName(const char *baseCartName, const char *s
 	return {};
 }
 
+static uint64_t bootConfigHash()
+{
+	// settings that change what autostarting leaves in memory
+	std::array<int, 7> config
+	{
+		currSystem, sysModel(), optionDriveTrueEmulation, optionVirtualDeviceTraps,
+		optionAutostartTDE, optionAutostartBasicLoad, optionVic20RamExpansions
+	};
+	uint64_t hash = 0;
+	for(auto val : config)
+	{
+		hash = hash * 31 + val;
+	}
+	return hash;
+}
+
 EmuSystem::Error EmuSystem::loadGame(IO &, EmuSystemCreateParams params, OnLoadProgressDelegate)
 {
 	if(!initC64())
@@ -564,7 +580,10 @@ EmuSystem::Error EmuSystem::loadGame(IO &, EmuSystemCreateParams params, OnLoadP
 	}
 	applyInitialOptionResources();
 	bool shouldAutostart = !(params.systemFlags & SYSTEM_FLAG_NO_AUTOSTART) && optionAutostartOnLaunch;
-	if(shouldAutostart && plugin.autostart_autodetect_)
+	autostartWasInProgress = false;
+	// with a boot snapshot only the media is attached, the snapshot holds the autostarted machine
+	bool useSnapshot = shouldAutostart && plugin.autostart_autodetect_ && useBootSnapshot(bootConfigHash());
+	if(shouldAutostart && plugin.autostart_autodetect_ && !useSnapshot)
 	{
 		logMsg("loading & autostarting:%s", fullGamePath());
 		if(string_hasDotExtension(fullGamePath(), "prg"))
@@ -616,18 +635,27 @@ EmuSystem::Error EmuSystem::loadGame(IO &, EmuSystemCreateParams params, OnLoadP
 				}
 			}
 		}
-		optionAutostartOnLaunch = false;
-		sessionOptionSet();
+		if(!useSnapshot)
+		{
+			optionAutostartOnLaunch = false;
+			sessionOptionSet();
+		}
 	}
 	return {};
 }
 
+void EmuSystem::onBootSnapshotLoadFailed()
+{
+	reset(RESET_HARD);
+	plugin.autostart_autodetect(fullGamePath(), nullptr, 0, AUTOSTART_MODE_RUN);
+}
+
 static void execC64Frame()
 {
 	startCanvasRunningFrame();
-	// signal C64 thread to execute one frame and wait for it to finish
-	execSem.notify();
-	execDoneSem.wait();
+	// run VICE's main loop until it yields at the next vsync, always on the
+	// emulation thread since its suspended frames may hold that thread's TLS
+	EmuApp::runOnEmulationThread([](){ viceMainLoop->resume(); });
 }
 
 void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
@@ -635,6 +663,14 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	audioPtr = audio;
 	setCanvasSkipFrame(!video);
 	execC64Frame();
+	if(bool inProgress = plugin.autostart_in_progress();
+		inProgress != autostartWasInProgress)
+	{
+		// the program is running once autostart finishes typing RUN
+		if(!inProgress)
+			markBootReady(task);
+		autostartWasInProgress = inProgress;
+	}
 	if(video)
 	{
 		video->startFrameWithFormat(task, canvasSrcPix);
@@ -688,10 +724,9 @@ void EmuSystem::onPrepareAudio(EmuAudio &audio)
 
 EmuSystem::Error EmuSystem::onInit()
 {
-	IG::makeDetachedThread(
+	viceMainLoop.emplace(
 		[]()
 		{
-			execSem.wait();
 			logMsg("starting maincpu_mainloop()");
 			plugin.maincpu_mainloop();
 		});
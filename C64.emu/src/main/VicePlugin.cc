@@ -208,6 +208,13 @@ int VicePlugin::autostart_autodetect(const char *file_name, const char *program_
 	return -1;
 }
 
+bool VicePlugin::autostart_in_progress()
+{
+	if(autostart_in_progress_)
+		return autostart_in_progress_();
+	return false;
+}
+
 int VicePlugin::cart_getid_slotmain()
 {
 	if(cart_getid_slotmain_)
@@ -381,11 +388,13 @@ VicePlugin commonVicePlugin(void *lib, ViceSystem system)
 	if(system == VICE_SYSTEM_PET)
 	{
 		loadSymbolCheck(plugin.autostart_autodetect_, lib, "autostart_autodetect");
+		loadSymbolCheck(plugin.autostart_in_progress_, lib, "autostart_in_progress");
 		// no cart system
 	}
 	else if(system == VICE_SYSTEM_PLUS4)
 	{
 		loadSymbolCheck(plugin.autostart_autodetect_, lib, "autostart_autodetect");
+		loadSymbolCheck(plugin.autostart_in_progress_, lib, "autostart_in_progress");
 		plugin.cart_getid_slotmain_ =
 			[]()
 			{
@@ -412,6 +421,7 @@ VicePlugin commonVicePlugin(void *lib, ViceSystem system)
 	else if(system == VICE_SYSTEM_VIC20)
 	{
 		loadSymbolCheck(plugin.autostart_autodetect_, lib, "autostart_autodetect");
+		loadSymbolCheck(plugin.autostart_in_progress_, lib, "autostart_in_progress");
 		plugin.cart_getid_slotmain_ =
 			[]()
 			{
@@ -424,6 +434,7 @@ VicePlugin commonVicePlugin(void *lib, ViceSystem system)
 	else
 	{
 		loadSymbolCheck(plugin.autostart_autodetect_, lib, "autostart_autodetect");
+		loadSymbolCheck(plugin.autostart_in_progress_, lib, "autostart_in_progress");
 		if(system != VICE_SYSTEM_C64DTV)
 			loadSymbolCheck(plugin.cart_getid_slotmain_, lib, "cart_getid_slotmain");
 		loadSymbolCheck(plugin.cartridge_get_file_name_, lib, "cartridge_get_file_name");
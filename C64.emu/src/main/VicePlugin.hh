@@ -70,6 +70,7 @@ struct VicePlugin
 	void (*maincpu_mainloop_)(){};
 	int (*autostart_autodetect_)(const char *file_name, const char *program_name,
 		unsigned int program_number, unsigned int runmode){};
+	int (*autostart_in_progress_)(){};
 	int (*cart_getid_slotmain_)(){};
 	const char *(*cartridge_get_file_name_)(int type){};
 	int (*cartridge_attach_image_)(int type, const char *filename){};
@@ -111,6 +112,7 @@ struct VicePlugin
 	void maincpu_mainloop();
 	int autostart_autodetect(const char *file_name, const char *program_name,
 		unsigned int program_number, unsigned int runmode);
+	bool autostart_in_progress();
 	int cart_getid_slotmain();
 	const char *cartridge_get_file_name(int type);
 	int cartridge_attach_image(int type, const char *filename);
@@ -1,10 +1,11 @@
 #pragma once
 
 #include "VicePlugin.hh"
-#include <imagine/thread/Semaphore.hh>
+#include <imagine/thread/Coroutine.hh>
 #include <imagine/pixmap/Pixmap.hh>
 #include <emuframework/Option.hh>
 #include <emuframework/EmuSystem.hh>
+#include <optional>
 
 class EmuAudio;
 
@@ -24,7 +25,7 @@ extern ViceSystem currSystem;
 extern FS::PathString sysFilePath[Config::envIsLinux ? 5 : 3];
 extern EmuAudio *audioPtr;
 static constexpr auto pixFmt = IG::PIXEL_FMT_RGB565;
-extern IG::Semaphore execSem, execDoneSem;
+extern std::optional<IG::Coroutine> viceMainLoop;
 extern double systemFrameRate;
 extern struct video_canvas_s *activeCanvas;
 extern IG::Pixmap canvasSrcPix;
@@ -32,7 +32,7 @@ extern "C"
 struct video_canvas_s *activeCanvas{};
 IG::Pixmap canvasSrcPix{};
 double systemFrameRate = 60.0;
-static std::atomic_bool runningFrame{};
+static bool runningFrame{};
 
 void setCanvasSkipFrame(bool on)
 {
@@ -49,10 +49,9 @@ int vsync_do_vsync2(struct video_canvas_s *c, int been_skipped)
 {
 	if(likely(runningFrame))
 	{
-		//logMsg("vsync_do_vsync signaling main thread");
+		//logMsg("vsync_do_vsync returning to emulation thread");
 		runningFrame = false;
-		execDoneSem.notify();
-		execSem.wait();
+		viceMainLoop->yield();
 	}
 	else
 	{
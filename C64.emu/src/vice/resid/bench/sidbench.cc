@@ -0,0 +1,169 @@
+//  ---------------------------------------------------------------------------
+//  This file is part of reSID, a MOS6581 SID emulator engine.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//  ---------------------------------------------------------------------------
+
+// Clocks the SID with each chip model and resampling method, playing a
+// register script that keeps changing pitch, waveform, envelope and filter
+// settings once per PAL frame, the way VICE calls SID::clock(). Prints the
+// speed relative to realtime and a checksum of the output samples.
+//
+// "make run" builds sid.cc twice, writes reference checksums with the
+// RESID_NO_SIMD build and checks the default build's output against them.
+// Give CXXFLAGS="-O2 -mavx2" to check the AVX2 version.
+
+#include "sid.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace reSID;
+
+static const double palClock = 985248.;
+static const cycle_count frameCycles = 19656;
+
+static void writeFrameRegs(SID &sid, unsigned frame)
+{
+  static const reg8 waveforms[] { 0x10, 0x20, 0x40, 0x80, 0x30, 0x50, 0x60, 0x70 };
+  for (unsigned v = 0; v < 3; v++) {
+    reg8 base = v * 7;
+    unsigned note = (frame / (4 + v) + v * 5) % 48;
+    unsigned freq = (unsigned)(268 * (1 << (note / 12)) * (1. + (note % 12) / 12.));
+    sid.write(base + 0, freq & 0xff);
+    sid.write(base + 1, (freq >> 8) & 0xff);
+    sid.write(base + 2, (frame * 37 + v * 91) & 0xff);
+    sid.write(base + 3, (frame >> 3) & 0x0f);
+    sid.write(base + 5, 0x09 + v * 0x20);
+    sid.write(base + 6, 0xa4 - v * 0x30);
+    // retrigger every few frames so the envelopes keep moving
+    reg8 wave = waveforms[(frame / 16 + v) % 8];
+    bool gate = (frame + v * 3) % 12 < 8;
+    sid.write(base + 4, wave | gate);
+  }
+  // sweep the cutoff and switch filter modes
+  unsigned cutoff = (frame * 13) % 2048;
+  sid.write(0x15, cutoff & 0x07);
+  sid.write(0x16, cutoff >> 3);
+  sid.write(0x17, ((frame / 50) % 16) << 4 | 0x07);
+  sid.write(0x18, ((frame / 100) % 7 + 1) << 4 | 0x0f);
+}
+
+struct Result
+{
+  double speed;
+  unsigned checksum;
+};
+
+static Result run(chip_model model, sampling_method method, double rate, unsigned seconds)
+{
+  SID sid;
+  sid.set_chip_model(model);
+  if (!sid.set_sampling_parameters(palClock, method, rate)) {
+    fprintf(stderr, "error setting sampling parameters\n");
+    exit(EXIT_FAILURE);
+  }
+  std::vector<short> buf(rate / 25);
+  unsigned checksum = 2166136261u;
+  unsigned frames = seconds * 50;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned frame = 0; frame < frames; frame++) {
+    writeFrameRegs(sid, frame);
+    cycle_count delta_t = frameCycles;
+    while (delta_t) {
+      int samples = sid.clock(delta_t, buf.data(), buf.size());
+      for (int i = 0; i < samples; i++)
+        checksum = (checksum ^ (unsigned short)buf[i]) * 16777619u;
+    }
+  }
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+  return {frames * frameCycles / palClock / time.count(), checksum};
+}
+
+int main(int argc, char **argv)
+{
+  unsigned seconds = 10;
+  const char *writePath{};
+  const char *checkPath{};
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc)
+      seconds = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+      writePath = argv[++i];
+    else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+      checkPath = argv[++i];
+    else {
+      fprintf(stderr, "usage: %s [-n seconds] [-w reference] [-c reference]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  static const struct { chip_model model; const char *name; } models[] {
+    {MOS6581, "6581"}, {MOS8580, "8580"} };
+  static const struct { sampling_method method; const char *name; } methods[] {
+    {SAMPLE_RESAMPLE, "resample"}, {SAMPLE_RESAMPLE_FASTMEM, "resample fastmem"} };
+  static const double rates[] { 44100., 48000. };
+#if defined(RESID_NO_SIMD)
+  printf("convolve: scalar\n");
+#elif defined(__AVX2__)
+  printf("convolve: AVX2\n");
+#elif defined(__SSE2__)
+  printf("convolve: SSE2\n");
+#elif defined(__ARM_NEON)
+  printf("convolve: NEON\n");
+#else
+  printf("convolve: scalar\n");
+#endif
+  std::string checksums;
+  for (auto &model : models) {
+    for (auto &method : methods) {
+      for (auto rate : rates) {
+        auto r = run(model.model, method.method, rate, seconds);
+        char line[128];
+        snprintf(line, sizeof(line), "%s %s %.0fHz: %08x\n", model.name, method.name, rate, r.checksum);
+        printf("%s %s %.0fHz: %.1fx realtime, checksum %08x\n", model.name, method.name, rate, r.speed, r.checksum);
+        checksums += line;
+      }
+    }
+  }
+  if (writePath) {
+    FILE *f = fopen(writePath, "w");
+    if (!f || fputs(checksums.c_str(), f) < 0) {
+      fprintf(stderr, "error writing %s\n", writePath);
+      return EXIT_FAILURE;
+    }
+    fclose(f);
+  }
+  if (checkPath) {
+    FILE *f = fopen(checkPath, "r");
+    if (!f) {
+      fprintf(stderr, "error reading %s\n", checkPath);
+      return EXIT_FAILURE;
+    }
+    std::string ref;
+    char line[128];
+    while (fgets(line, sizeof(line), f))
+      ref += line;
+    fclose(f);
+    if (ref != checksums) {
+      printf("output differs from %s\n", checkPath);
+      return EXIT_FAILURE;
+    }
+    printf("output matches %s\n", checkPath);
+  }
+  return EXIT_SUCCESS;
+}
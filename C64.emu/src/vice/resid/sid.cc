@@ -27,6 +27,16 @@
 #include "sid.h"
 #include <math.h>
 
+#if defined(RESID_NO_SIMD)
+// scalar convolve() only, bench/ checks the SIMD versions against it
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #ifndef round
 #define round(x) (x>=0.0?floor(x+0.5):ceil(x-0.5))
 #endif
@@ -896,6 +906,83 @@ int SID::clock_interpolate(cycle_count& delta_t, short* buf, int n, int interlea
 // NB! the result of right shifting negative numbers is really
 // implementation dependent in the C++ standard.
 // ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// Convolution of the sample ring with a FIR table.
+// The SIMD versions add up the same 32 bit products as the scalar loop, only
+// in a different order, so the result is identical (modulo 2^32 wraparound,
+// just like the scalar sum).
+// ----------------------------------------------------------------------------
+static RESID_INLINE int convolve(const short* a, const short* b, int n)
+{
+  int v = 0;
+  int i = 0;
+
+#if defined(RESID_NO_SIMD)
+#elif defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 16 <= n; i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(x, y));
+  }
+  __m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                                 _mm256_extracti128_si256(acc, 1));
+  if (i + 8 <= n) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+    acc128 = _mm_add_epi32(acc128, _mm_madd_epi16(x, y));
+    i += 8;
+  }
+  acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, 0x4e));
+  acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, 0xb1));
+  v = _mm_cvtsi128_si32(acc128);
+#elif defined(__SSE2__)
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    __m128i x0 = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i y0 = _mm_loadu_si128((const __m128i*)(b + i));
+    __m128i x1 = _mm_loadu_si128((const __m128i*)(a + i + 8));
+    __m128i y1 = _mm_loadu_si128((const __m128i*)(b + i + 8));
+    acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(x0, y0));
+    acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(x1, y1));
+  }
+  if (i + 8 <= n) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+    acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(x, y));
+    i += 8;
+  }
+  acc0 = _mm_add_epi32(acc0, acc1);
+  acc0 = _mm_add_epi32(acc0, _mm_shuffle_epi32(acc0, 0x4e));
+  acc0 = _mm_add_epi32(acc0, _mm_shuffle_epi32(acc0, 0xb1));
+  v = _mm_cvtsi128_si32(acc0);
+#elif defined(__ARM_NEON)
+  int32x4_t acc0 = vdupq_n_s32(0);
+  int32x4_t acc1 = vdupq_n_s32(0);
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t x = vld1q_s16(a + i);
+    int16x8_t y = vld1q_s16(b + i);
+    acc0 = vmlal_s16(acc0, vget_low_s16(x), vget_low_s16(y));
+    acc1 = vmlal_s16(acc1, vget_high_s16(x), vget_high_s16(y));
+  }
+  acc0 = vaddq_s32(acc0, acc1);
+#if defined(__aarch64__)
+  v = vaddvq_s32(acc0);
+#else
+  int32x2_t acc64 = vadd_s32(vget_low_s32(acc0), vget_high_s32(acc0));
+  v = vget_lane_s32(vpadd_s32(acc64, acc64), 0);
+#endif
+#endif
+
+  for (; i < n; i++) {
+    v += a[i]*b[i];
+  }
+
+  return v;
+}
+
 int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
 {
   int s;
@@ -927,10 +1014,7 @@ int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
     short* sample_start = sample + sample_index - fir_N - 1 + RINGSIZE;
 
     // Convolution with filter impulse response.
-    int v1 = 0;
-    for (int j = 0; j < fir_N; j++) {
-      v1 += sample_start[j]*fir_start[j];
-    }
+    int v1 = convolve(sample_start, fir_start, fir_N);
 
     // Use next FIR table, wrap around to first FIR table using
     // next sample.
@@ -941,10 +1025,7 @@ int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
     fir_start = fir + fir_offset*fir_N;
 
     // Convolution with filter impulse response.
-    int v2 = 0;
-    for (int k = 0; k < fir_N; k++) {
-      v2 += sample_start[k]*fir_start[k];
-    }
+    int v2 = convolve(sample_start, fir_start, fir_N);
 
     // Linear interpolation.
     // fir_offset_rmd is equal for all samples, it can thus be factorized out:
@@ -1002,10 +1083,7 @@ int SID::clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int int
     short* sample_start = sample + sample_index - fir_N + RINGSIZE;
 
     // Convolution with filter impulse response.
-    int v = 0;
-    for (int j = 0; j < fir_N; j++) {
-      v += sample_start[j]*fir_start[j];
-    }
+    int v = convolve(sample_start, fir_start, fir_N);
 
     v >>= FIR_SHIFT;
 
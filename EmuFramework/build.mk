@@ -5,6 +5,7 @@ ifneq ($(filter linux ios android,$(ENV)),)
 endif
 
 SRC += AudioOptionView.cc \
+BootSnapshot.cc \
 BundledGamesView.cc \
 ButtonConfigView.cc \
 Cheats.cc \
@@ -27,13 +28,17 @@ EmuView.cc \
 EmuViewController.cc \
 FilePicker.cc \
 FileUtils.cc \
+FrameTrace.cc \
 GUIOptionView.cc \
 InputManagerView.cc \
+RamSearch.cc \
+RamSearchView.cc \
 Recent.cc \
 RecentGameView.cc \
 Screenshot.cc \
 StateSlotView.cc \
 SystemOptionView.cc \
+VideoImageCPUEffect.cc \
 VideoImageEffect.cc \
 VideoImageOverlay.cc \
 VideoOptionView.cc
@@ -29,6 +29,7 @@ class EmuApp
 public:
 	using OnMainMenuOptionChanged = DelegateFunc<void()>;
 	using CreateSystemCompleteDelegate = DelegateFunc<void (Input::Event e)>;
+	using CreateSystemErrorDelegate = DelegateFunc<void (const char *errorStr)>;
 	using NavView = BasicNavView;
 
 	enum class ViewID
@@ -48,7 +49,8 @@ public:
 
 	static bool willCreateSystem(ViewAttachParams attach, Input::Event e);
 	static void createSystemWithMedia(GenericIO io, const char *path, const char *name,
-		Input::Event e, EmuSystemCreateParams, CreateSystemCompleteDelegate onComplete);
+		Input::Event e, EmuSystemCreateParams, CreateSystemCompleteDelegate onComplete,
+		CreateSystemErrorDelegate onError = {});
 	static void exitGame(bool allowAutosaveState = true);
 	static void reloadGame(EmuSystemCreateParams params = {});
 	static void promptSystemReloadDueToSetOption(ViewAttachParams attach, Input::Event e, EmuSystemCreateParams params = {});
@@ -103,6 +105,9 @@ public:
 	static bool hasSavedSessionOptions();
 	static void deleteSessionOptions();
 	static void syncEmulationThread();
+	// runs func on the thread that runs frames during emulation and waits for it,
+	// for systems that have state tied to that thread
+	static void runOnEmulationThread(DelegateFunc<void()> func);
 	static IG::PixelFormat defaultRenderPixelFormat();
 	static void resetVideo();
 
@@ -23,7 +23,8 @@ class EmuLoadProgressView : public View
 public:
 	using MessagePortType = Base::MessagePort<EmuSystem::LoadProgressMessage>;
 
-	EmuLoadProgressView(ViewAttachParams attach, Input::Event e, EmuApp::CreateSystemCompleteDelegate onComplete);
+	EmuLoadProgressView(ViewAttachParams attach, Input::Event e, EmuApp::CreateSystemCompleteDelegate onComplete,
+		EmuApp::CreateSystemErrorDelegate onError = {});
 	void setMax(int val);
 	void setPos(int val);
 	void setLabel(const char *str);
@@ -35,6 +36,7 @@ public:
 private:
 	MessagePortType msgPort{"EmuLoadProgressView"};
 	EmuApp::CreateSystemCompleteDelegate onComplete{};
+	EmuApp::CreateSystemErrorDelegate onError{};
 	Gfx::Text text{"Loading...", &View::defaultFace};
 	Input::Event originalEvent{};
 	int pos = 0, max = 0;
@@ -25,6 +25,7 @@
 #include <imagine/util/string.h>
 #include <emuframework/config.hh>
 #include <optional>
+#include <vector>
 #include <stdexcept>
 
 class EmuInputView;
@@ -49,6 +50,15 @@ struct BundledGameInfo
 	const char *assetName;
 };
 
+// Memory a system lets the RAM search scan, data points at the live memory
+struct RamSearchRegion
+{
+	const char *name;
+	uint8_t *data;
+	uint32_t size;
+	uint32_t address; // address of data[0] on the emulated system
+};
+
 struct EmuSystemCreateParams
 {
 	uint8_t systemFlags;
@@ -118,7 +128,9 @@ public:
 	static bool inputHasShortBtnTexture;
 	static bool hasBundledGames;
 	static bool hasPALVideoSystem;
+	static bool hasBootSnapshots;
 	enum VideoSystem { VIDSYS_NATIVE_NTSC, VIDSYS_PAL };
+	static constexpr uint8_t MAX_SUBSYSTEMS = 4;
 	static IG::FloatSeconds frameTimeNative;
 	static IG::FloatSeconds frameTimePAL;
 	static double audioFramesPerVideoFrameFloat;
@@ -129,6 +141,7 @@ public:
 	static bool handlesArchiveFiles;
 	static bool handlesGenericIO;
 	static bool hasCheats;
+	static bool hasRamSearch;
 	static bool hasSound;
 	static int forcedSoundRate;
 	static IG::Audio::SampleFormat audioSampleFormat;
@@ -187,6 +200,9 @@ public:
 	static FS::PathString willLoadGameFromPath(FS::PathString path);
 	static Error loadGameFromPath(const char *path, EmuSystemCreateParams params, OnLoadProgressDelegate onLoadProgress);
 	static Error loadGameFromFile(GenericIO io, const char *name, EmuSystemCreateParams params, OnLoadProgressDelegate onLoadProgress);
+	// A null video or audio means that output isn't needed for this frame,
+	// cores should skip rendering/palette conversion and sample mixing/resampling
+	// but still advance any chip state the emulated software can observe
 	[[gnu::hot]] static void runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
 	static void skipFrames(EmuSystemTask *task, uint32_t frames, EmuAudio *audio);
 	static bool skipForwardFrames(EmuSystemTask *task, uint32_t frames);
@@ -194,6 +210,9 @@ public:
 	static void onPrepareAudio(EmuAudio &audio);
 	static void onPrepareVideo(EmuVideo &video);
 	static bool vidSysIsPAL();
+	// which of the systems the app emulates the loaded game runs on, used to keep
+	// some options per system, 0 in apps with only one
+	static uint8_t subsystem();
 	static uint32_t updateAudioFramesPerVideoFrame();
 	static double frameRate();
 	static double frameRate(VideoSystem system);
@@ -225,7 +244,22 @@ public:
 	static void setupGameSavePath();
 	static void clearGamePaths();
 	static FS::PathString baseDefaultGameSavePath();
-	static IG::Time benchmark(EmuVideo &video);
+	static IG::Time benchmark(EmuVideo &video, uint32_t frames = 180);
+	// Systems with slow boots call useBootSnapshot() from loadGame() with a hash
+	// of the settings that affect booting. If it returns true, a snapshot from an
+	// earlier boot of the same media gets loaded once the system is created and
+	// the system can skip its own boot steps. Otherwise the system calls
+	// markBootReady() from runFrame() once the game is playable to save one.
+	static bool useBootSnapshot(uint64_t configHash);
+	static void markBootReady(EmuSystemTask *task);
+	static void onBootSnapshotLoadFailed();
+	// Systems with a state format that's quicker to save and load than their
+	// state files set hasMemoryStates, boot snapshots then use it instead
+	static bool hasMemoryStates;
+	static std::vector<uint8_t> saveStateToMemory();
+	static Error loadStateFromMemory(const uint8_t *data, size_t size);
+	// Regions of the running game's RAM to search when hasRamSearch is set
+	static std::vector<RamSearchRegion> ramSearchRegions();
 	static bool gameIsRunning()
 	{
 		return !string_equal(gameName_.data(), "");
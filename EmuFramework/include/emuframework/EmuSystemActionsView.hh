@@ -30,11 +30,12 @@ public:
 	void onShow() override;
 	void loadStandardItems();
 
-	static const uint STANDARD_ITEMS = 9;
+	static const uint STANDARD_ITEMS = 10;
 	static const uint MAX_SYSTEM_ITEMS = 6;
 
 protected:
 	TextMenuItem cheats;
+	TextMenuItem ramSearch;
 	TextMenuItem reset;
 	TextMenuItem loadState;
 	TextMenuItem saveState;
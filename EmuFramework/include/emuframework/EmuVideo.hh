@@ -17,15 +17,29 @@
 
 #include <imagine/gfx/PixmapBufferTexture.hh>
 #include <imagine/gfx/SyncFence.hh>
+#include <imagine/pixmap/MemPixmap.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/container/ArrayList.hh>
+#include <emuframework/VideoImageCPUEffect.hh>
+#include <mutex>
 
 class EmuVideo;
 class EmuSystemTask;
 
+// run of consecutive frame lines sharing the same width
+struct EmuVideoLineSpan
+{
+	uint16_t y{};
+	uint16_t lines{};
+	uint16_t width{};
+};
+
 class EmuVideoImage
 {
 public:
 	EmuVideoImage();
 	EmuVideoImage(EmuSystemTask *task, EmuVideo &vid, Gfx::LockedTextureBuffer texBuff);
+	EmuVideoImage(EmuSystemTask *task, EmuVideo &vid, IG::Pixmap effectSrcPix);
 	IG::Pixmap pixmap() const;
 	explicit operator bool() const;
 	void endFrame();
@@ -34,6 +48,8 @@ private:
 	EmuSystemTask *task{};
 	EmuVideo *emuVideo{};
 	Gfx::LockedTextureBuffer texBuff{};
+	IG::Pixmap effectSrcPix{};
+	IG::Time convertStart{}; // when the core started writing the frame, for FrameTrace
 };
 
 class EmuVideo
@@ -41,8 +57,10 @@ class EmuVideo
 public:
 	using FrameFinishedDelegate = DelegateFunc<void (EmuVideo &)>;
 	using FormatChangedDelegate = DelegateFunc<void (EmuVideo &)>;
+	static constexpr unsigned MAX_LINE_SPANS = 32;
+	using LineSpans = StaticArrayList<EmuVideoLineSpan, MAX_LINE_SPANS>;
 
-	constexpr EmuVideo() {}
+	EmuVideo() {}
 	void setRendererTask(Gfx::RendererTask &rTask);
 	void setFormat(IG::PixmapDesc desc);
 	void resetImage();
@@ -51,6 +69,10 @@ public:
 	void startFrame(EmuSystemTask *task, IG::Pixmap pix);
 	EmuVideoImage startFrameWithFormat(EmuSystemTask *task, IG::PixmapDesc desc);
 	void startFrameWithFormat(EmuSystemTask *task, IG::Pixmap pix);
+	// Line y of pix holds lineWidth[y] pixels starting at its left edge and is
+	// stretched to pix's full width when drawn, so mixed-resolution frames
+	// don't need to be expanded to a common width on the CPU
+	void startFrameWithLineWidths(EmuSystemTask *task, IG::Pixmap pix, const int32_t *lineWidth);
 	void startUnchangedFrame(EmuSystemTask *task);
 	void finishFrame(EmuSystemTask *task, Gfx::LockedTextureBuffer texBuff);
 	void finishFrame(EmuSystemTask *task, IG::Pixmap pix);
@@ -61,6 +83,7 @@ public:
 	Gfx::PixmapBufferTexture &image();
 	Gfx::Renderer &renderer() const;
 	IG::WP size() const;
+	IG::WP imageSize() const;
 	bool formatIsEqual(IG::PixmapDesc desc) const;
 	void setOnFrameFinished(FrameFinishedDelegate del);
 	void setOnFormatChanged(FormatChangedDelegate del);
@@ -68,12 +91,26 @@ public:
 	bool setImageBuffers(unsigned num);
 	unsigned imageBuffers() const;
 	void setCompatTextureSampler(const Gfx::TextureSampler &);
+	void setCPUEffect(uint8_t effect);
+	uint8_t cpuEffect() const;
+	// line widths of the last finished frame, empty if all lines use the full width,
+	// safe to call from the main thread while the next frame is being emulated
+	LineSpans lineSpans() const;
+	// draw the image into pos with each line span stretched to the full width,
+	// uv may be vertically flipped when drawing into a render target
+	void drawLineSpans(Gfx::RendererCommands &cmds, const LineSpans &spans, Gfx::GCRect pos, Gfx::GTexCRect uv) const;
 
 protected:
 	Gfx::RendererTask *rTask{};
 	const Gfx::TextureSampler *texSampler{};
 	Gfx::SyncFence fence{};
 	Gfx::PixmapBufferTexture vidImg{};
+	IG::PixmapDesc srcDesc{};
+	VideoImageCPUEffect cpuEffect_{};
+	LineSpans frameLineSpans{}; // spans of the frame in progress, only used by the emulation thread
+	LineSpans lineSpans_{}; // copied from frameLineSpans when the frame finishes
+	mutable std::mutex lineSpansLock{};
+	IG::MemPixmap lineExpandPix{};
 	FrameFinishedDelegate onFrameFinished{};
 	FormatChangedDelegate onFormatChanged{};
 	Gfx::TextureBufferMode bufferMode{};
@@ -82,6 +119,8 @@ protected:
 	bool needsFence = false;
 
 	void doScreenshot(EmuSystemTask *task, IG::Pixmap pix);
+	void renderCPUEffect(IG::Pixmap pix);
+	IG::Pixmap expandLines(IG::Pixmap pix, const int32_t *lineWidth);
 	void dispatchFinishFrame(EmuSystemTask *task);
 	void postSetFormat(EmuSystemTask &task, IG::PixmapDesc desc);
 	void syncImageAccess();
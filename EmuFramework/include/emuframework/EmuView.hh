@@ -16,7 +16,8 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/gui/View.hh>
-#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+#include <emuframework/FrameTrace.hh>
+#if defined CONFIG_EMUFRAMEWORK_AUDIO_STATS || defined CONFIG_EMUFRAMEWORK_FRAME_TRACE
 #include <imagine/gfx/GfxText.hh>
 #endif
 
@@ -36,6 +37,8 @@ public:
 	void setLayoutInputView(EmuInputView *view);
 	void updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames);
 	void clearAudioStats();
+	void updateFrameTraceStats(const FrameTrace::Stats &stats);
+	void clearFrameTraceStats();
 	EmuVideoLayer *videoLayer() const { return layer; }
 
 private:
@@ -45,4 +48,8 @@ private:
 	Gfx::Text audioStatsText{};
 	Gfx::GCRect audioStatsRect{};
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	Gfx::Text frameTraceText{};
+	Gfx::GCRect frameTraceRect{};
+	#endif
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/time/Time.hh>
+#include <array>
+
+// Per-frame phase timing, enabled by defining CONFIG_EMUFRAMEWORK_FRAME_TRACE.
+// Each thread records into its own fixed-size ring so recording never locks,
+// the rings are read back for the on-screen overlay and Chrome trace dumps.
+
+namespace FrameTrace
+{
+
+enum class Phase : uint8_t
+{
+	INPUT,
+	RUN_FRAME,
+	VIDEO_CONVERT,
+	VIDEO_UPLOAD,
+	SYNC_IMAGE,
+	PRESENT,
+	AUDIO_CALLBACK,
+};
+
+static constexpr unsigned PHASES = 7;
+
+struct PhaseStats
+{
+	IG::Time total{};
+	IG::Time max{};
+	uint32_t count{};
+
+	IG::Time average() const { return count ? total / count : IG::Time{}; }
+};
+
+using Stats = std::array<PhaseStats, PHASES>;
+
+const char *phaseName(Phase phase);
+
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+static constexpr bool ENABLED = true;
+
+void record(Phase phase, IG::Time start, IG::Time end);
+// label the calling thread in trace dumps
+void setThreadName(const char *name);
+// timings of events that ended after the given time
+Stats stats(IG::Time since);
+// write all buffered events in Chrome's trace event JSON format
+bool writeChromeTrace(const char *path);
+
+class Scope
+{
+public:
+	Scope(Phase phase): start{IG::steadyClockTimestamp()}, phase{phase} {}
+	~Scope() { record(phase, start, IG::steadyClockTimestamp()); }
+	Scope(const Scope &) = delete;
+	Scope &operator=(const Scope &) = delete;
+
+private:
+	IG::Time start;
+	Phase phase;
+};
+#else
+static constexpr bool ENABLED = false;
+
+static inline void record(Phase phase, IG::Time start, IG::Time end) {}
+static inline void setThreadName(const char *name) {}
+static inline Stats stats(IG::Time since) { return {}; }
+static inline bool writeChromeTrace(const char *path) { return false; }
+
+class Scope
+{
+public:
+	constexpr Scope(Phase phase) {}
+};
+#endif
+
+}
@@ -52,6 +52,7 @@ protected:
 	MultiChoiceMenuItem frameInterval;
 	#endif
 	BoolMenuItem dropLateFrames;
+	BoolMenuItem frameDelay;
 	TextMenuItem frameRate;
 	TextMenuItem frameRatePAL;
 	StaticArrayList<TextMenuItem, MAX_ASPECT_RATIO_ITEMS> aspectRatioItem;
@@ -65,6 +66,8 @@ protected:
 	TextMenuItem imgEffectItem[4];
 	MultiChoiceMenuItem imgEffect;
 	#endif
+	TextMenuItem imgCPUEffectItem[4];
+	MultiChoiceMenuItem imgCPUEffect;
 	TextMenuItem overlayEffectItem[6];
 	MultiChoiceMenuItem overlayEffect;
 	TextMenuItem overlayEffectLevelItem[5];
@@ -89,7 +92,7 @@ protected:
 	TextHeadingMenuItem screenShapeHeading;
 	TextHeadingMenuItem advancedHeading;
 	TextHeadingMenuItem systemSpecificHeading;
-	StaticArrayList<MenuItem*, 28> item{};
+	StaticArrayList<MenuItem*, 30> item{};
 
 	void pushAndShowFrameRateSelectMenu(EmuSystem::VideoSystem vidSys, Input::Event e);
 	bool onFrameTimeChange(EmuSystem::VideoSystem vidSys, IG::FloatSeconds time);
@@ -144,10 +147,11 @@ protected:
 	MultiChoiceMenuItem autoSaveState;
 	BoolMenuItem confirmAutoLoadState;
 	BoolMenuItem confirmOverwriteState;
+	BoolMenuItem bootSnapshots;
 	TextMenuItem savePath;
 	BoolMenuItem checkSavePathWriteAccess;
 	static constexpr uint MIN_FAST_FORWARD_SPEED = 2;
-	TextMenuItem fastForwardSpeedItem[6];
+	TextMenuItem fastForwardSpeedItem[7];
 	MultiChoiceMenuItem fastForwardSpeed;
 	#if defined __ANDROID__
 	BoolMenuItem performanceMode;
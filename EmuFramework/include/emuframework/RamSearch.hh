@@ -0,0 +1,80 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/EmuSystem.hh>
+#include <cstdint>
+#include <vector>
+
+// Finds where a game keeps a value by narrowing down a set of candidate
+// addresses in the regions from EmuSystem::ramSearchRegions(). Values are
+// aligned to their size and each region keeps a bitmap with one bit per value
+// plus its contents as of the last step, which comparisons against the
+// previous value use. A step reads the live memory once, updating the
+// candidates and the copy of the last contents in the same pass.
+
+class RamSearch
+{
+public:
+	enum class ValueType : uint8_t
+	{
+		U8, U16LE, U16BE, U32LE, U32BE
+	};
+
+	enum class Compare : uint8_t
+	{
+		// against the given value
+		EQUAL, NOT_EQUAL, LESS, GREATER,
+		// against the value at the last step
+		UNCHANGED, CHANGED, DECREASED, INCREASED, CHANGED_BY
+	};
+
+	struct Result
+	{
+		const char *regionName;
+		uint32_t address;
+		uint32_t value;
+	};
+
+	// snapshot the regions with every value as a candidate, returns false
+	// if the system has nothing to search
+	bool start(ValueType type);
+	// returns false without searching if the regions changed since start(),
+	// like after loading another game
+	bool search(Compare op, uint32_t value = 0);
+	void clear();
+	bool isActive() const { return regions.size(); }
+	size_t count() const;
+	std::vector<Result> results(size_t maxResults) const;
+	ValueType valueType() const { return type; }
+	// whether less/greater comparisons treat values as signed
+	void setSigned(bool on) { isSigned = on; }
+	static unsigned valueSize(ValueType type);
+	static bool comparesToValue(Compare op) { return op <= Compare::GREATER || op == Compare::CHANGED_BY; }
+
+	struct Region
+	{
+		RamSearchRegion mem;
+		std::vector<uint8_t> last;
+		std::vector<uint64_t> candidates;
+		uint32_t values;
+	};
+
+protected:
+	std::vector<Region> regions{};
+	ValueType type{};
+	bool isSigned{};
+};
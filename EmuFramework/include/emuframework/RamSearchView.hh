@@ -0,0 +1,47 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/gui/TableView.hh>
+#include <imagine/gui/MenuItem.hh>
+#include <emuframework/RamSearch.hh>
+#include <vector>
+
+class RamSearchView : public TableView
+{
+public:
+	RamSearchView(ViewAttachParams attach);
+
+protected:
+	static constexpr unsigned MAX_RESULTS = 100;
+	TextMenuItem valueTypeItem[5];
+	MultiChoiceMenuItem valueType;
+	BoolMenuItem signedValues;
+	TextMenuItem newSearch;
+	TextHeadingMenuItem valueHeading{"Compare To Value"};
+	TextMenuItem equal, notEqual, less, greater;
+	TextHeadingMenuItem lastHeading{"Compare To Last Search"};
+	TextMenuItem unchanged, changed, decreased, increased, changedBy;
+	TextHeadingMenuItem resultsHeading{};
+	std::vector<TextMenuItem> result{};
+	std::vector<MenuItem*> item{};
+
+	void search(RamSearch::Compare op, Input::Event e);
+	void runSearch(RamSearch::Compare op, uint32_t value);
+	void setValueType(RamSearch::ValueType type);
+	void loadItems();
+	void refreshItems();
+};
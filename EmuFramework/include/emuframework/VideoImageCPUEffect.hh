@@ -0,0 +1,61 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/pixmap/MemPixmap.hh>
+#include <vector>
+
+// CPU versions of the VideoImageEffect shaders, applied to the emulated frame
+// before texture upload for devices without the GPU throughput to run them
+
+class VideoImageCPUEffect
+{
+public:
+	enum
+	{
+		NO_EFFECT = 0,
+		HQ2X = 1,
+		SCALE2X = 2,
+		PRESCALE2X = 3,
+
+		LAST_EFFECT_VAL
+	};
+
+	VideoImageCPUEffect() {}
+	VideoImageCPUEffect(const VideoImageCPUEffect &) = delete;
+	VideoImageCPUEffect &operator=(const VideoImageCPUEffect &) = delete;
+	void setEffect(uint8_t effect);
+	uint8_t effect() const { return effect_; }
+	bool isActive(IG::PixmapDesc srcDesc) const;
+	IG::WP scale() const;
+	IG::PixmapDesc outputDesc(IG::PixmapDesc srcDesc) const;
+	IG::Pixmap inputBuffer(IG::PixmapDesc srcDesc);
+	void render(IG::Pixmap dest, IG::Pixmap src);
+	static bool formatIsSupported(IG::PixelFormat format);
+
+private:
+	IG::MemPixmap srcBuffer{};
+	IG::Pixmap destPix{}, srcPix{};
+	// hq2x working lines and patterns, a set per band since bands render in parallel
+	std::vector<uint32_t> hq2xColor{};
+	std::vector<int16_t> hq2xYUV{};
+	std::vector<uint16_t> hq2xPattern{};
+	uint8_t effect_ = NO_EFFECT;
+
+	void renderBand(unsigned band, int srcY, int srcY2);
+	void allocHq2xBuffers(int w, unsigned bands);
+};
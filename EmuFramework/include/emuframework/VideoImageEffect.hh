@@ -20,6 +20,8 @@
 #include <system_error>
 #include <optional>
 
+class EmuVideo;
+
 class VideoImageEffect
 {
 public:
@@ -54,7 +56,7 @@ public:
 	void setCompatTextureSampler(const Gfx::TextureSampler &);
 	Gfx::Program &program();
 	Gfx::Texture &renderTarget();
-	void drawRenderTarget(Gfx::RendererCommands &cmds, const Gfx::Texture &img);
+	void drawRenderTarget(Gfx::RendererCommands &cmds, EmuVideo &video);
 	void deinit(Gfx::Renderer &r);
 
 private:
@@ -0,0 +1,215 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "BootSnapshot"
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuApp.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
+#include "EmuOptions.hh"
+#include "EmuSystemTask.hh"
+#include "private.hh"
+
+// Boot snapshots are regular save states, or memory states on systems with
+// hasMemoryStates, named after a key made from the media's contents and the
+// system's boot settings, so changing either one misses the old snapshot and
+// the system boots normally, saving a new one.
+
+enum class BootSnapshotState : uint8_t
+{
+	OFF, LOAD, CAPTURE
+};
+
+static BootSnapshotState bootSnapshotState{};
+static bool bootReadySent{};
+static uint64_t bootSnapshotKey{};
+static constexpr char bootSnapshotExt[] = ".boot.";
+
+[[gnu::weak]] bool EmuSystem::hasBootSnapshots = false;
+
+[[gnu::weak]] void EmuSystem::onBootSnapshotLoadFailed()
+{
+	reset(RESET_HARD);
+}
+
+[[gnu::weak]] bool EmuSystem::hasMemoryStates = false;
+
+[[gnu::weak]] std::vector<uint8_t> EmuSystem::saveStateToMemory()
+{
+	return {};
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::loadStateFromMemory(const uint8_t *, size_t)
+{
+	return makeError("Memory states aren't supported");
+}
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+	auto bytes = (const uint8_t*)data;
+	iterateTimes(size, i)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+static uint64_t mediaHash()
+{
+	// the size plus the start of the file tells disk images apart without
+	// taking long on CD images
+	static constexpr size_t MAX_HASH_BYTES = 16 * 1024 * 1024;
+	FileIO io{};
+	if(io.open(EmuSystem::fullGamePath(), IO::AccessHint::SEQUENTIAL))
+	{
+		logErr("can't open media to hash:%s", EmuSystem::fullGamePath());
+		return 0;
+	}
+	uint64_t hash = 14695981039346656037ull;
+	uint64_t size = io.size();
+	hash = fnv1a(hash, &size, sizeof(size));
+	char buff[4096];
+	for(size_t hashed = 0; hashed < MAX_HASH_BYTES;)
+	{
+		auto bytesRead = io.read(buff, sizeof(buff));
+		if(bytesRead <= 0)
+			break;
+		hash = fnv1a(hash, buff, bytesRead);
+		hashed += bytesRead;
+	}
+	return hash;
+}
+
+static FS::PathString bootSnapshotPath()
+{
+	return FS::makePathStringPrintf("%s/%s%s%016llx", EmuSystem::savePath(), EmuSystem::gameName().data(),
+		bootSnapshotExt, (unsigned long long)bootSnapshotKey);
+}
+
+static void removeBootSnapshots()
+{
+	auto prefix = FS::makeFileStringPrintf("%s%s", EmuSystem::gameName().data(), bootSnapshotExt);
+	std::error_code ec{};
+	for(auto &entry : FS::directory_iterator{EmuSystem::savePath(), ec})
+	{
+		if(!strncmp(entry.name(), prefix.data(), strlen(prefix.data())))
+		{
+			logMsg("removing old boot snapshot:%s", entry.name());
+			FS::remove(entry.path());
+		}
+	}
+}
+
+bool EmuSystem::useBootSnapshot(uint64_t configHash)
+{
+	bootSnapshotState = BootSnapshotState::OFF;
+	bootReadySent = false;
+	if(!optionBootSnapshots)
+		return false;
+	auto hash = mediaHash();
+	if(!hash)
+		return false;
+	bootSnapshotKey = fnv1a(hash, &configHash, sizeof(configHash));
+	if(FS::exists(bootSnapshotPath()))
+	{
+		logMsg("using boot snapshot:%016llx", (unsigned long long)bootSnapshotKey);
+		bootSnapshotState = BootSnapshotState::LOAD;
+		return true;
+	}
+	logMsg("no boot snapshot:%016llx, saving one when ready", (unsigned long long)bootSnapshotKey);
+	bootSnapshotState = BootSnapshotState::CAPTURE;
+	return false;
+}
+
+void EmuSystem::markBootReady(EmuSystemTask *task)
+{
+	// frames run without a task are from state loads or benchmarks
+	if(bootSnapshotState != BootSnapshotState::CAPTURE || !task || bootReadySent)
+		return;
+	bootReadySent = true;
+	task->sendBootReadyReply();
+}
+
+static EmuSystem::Error loadMemoryState(const char *path)
+{
+	FileIO io{};
+	if(io.open(path, IO::AccessHint::ALL))
+		return EmuSystem::makeFileReadError();
+	std::vector<uint8_t> state(io.size());
+	if(io.read(state.data(), state.size()) != (ssize_t)state.size())
+		return EmuSystem::makeFileReadError();
+	return EmuSystem::loadStateFromMemory(state.data(), state.size());
+}
+
+static EmuSystem::Error saveMemoryState(const char *path)
+{
+	EmuApp::syncEmulationThread();
+	auto state = EmuSystem::saveStateToMemory();
+	if(state.empty())
+		return EmuSystem::makeError("No state data");
+	FileIO io{};
+	if(io.create(path))
+		return EmuSystem::makeFileWriteError();
+	if(io.write(state.data(), state.size()) != (ssize_t)state.size())
+	{
+		io.close();
+		FS::remove(path);
+		return EmuSystem::makeFileWriteError();
+	}
+	return {};
+}
+
+void loadBootSnapshot()
+{
+	if(bootSnapshotState != BootSnapshotState::LOAD)
+		return;
+	bootSnapshotState = BootSnapshotState::OFF;
+	auto path = bootSnapshotPath();
+	if(auto err = EmuSystem::hasMemoryStates ? loadMemoryState(path.data()) : EmuSystem::loadState(path.data());
+		err)
+	{
+		logErr("error loading boot snapshot:%s, booting normally", err->what());
+		FS::remove(path);
+		EmuSystem::onBootSnapshotLoadFailed();
+		return;
+	}
+	logMsg("loaded boot snapshot:%s", path.data());
+}
+
+void saveBootSnapshot()
+{
+	if(bootSnapshotState != BootSnapshotState::CAPTURE || !EmuSystem::gameIsRunning())
+		return;
+	bootSnapshotState = BootSnapshotState::OFF;
+	removeBootSnapshots();
+	auto path = bootSnapshotPath();
+	if(auto err = EmuSystem::hasMemoryStates ? saveMemoryState(path.data()) : EmuApp::saveState(path.data());
+		err)
+	{
+		logErr("error saving boot snapshot:%s", err->what());
+		return;
+	}
+	logMsg("saved boot snapshot:%s", path.data());
+}
+
+void cancelBootSnapshot()
+{
+	if(bootSnapshotState == BootSnapshotState::CAPTURE)
+	{
+		logMsg("state loaded before boot finished, not saving boot snapshot");
+		bootSnapshotState = BootSnapshotState::OFF;
+	}
+}
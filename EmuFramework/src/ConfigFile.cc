@@ -135,6 +135,7 @@ static OptionBase *cfgFileOption[] =
 	&optionImgEffect,
 	&optionImageEffectPixelFormat,
 	#endif
+	&optionImgCPUEffect,
 	&optionVideoImageBuffers,
 	&optionOverlayEffect,
 	&optionOverlayEffectLevel,
@@ -166,6 +167,7 @@ static OptionBase *cfgFileOption[] =
 	&optionVControllerLayoutPos,
 	&optionSwappedGamepadConfirm,
 	&optionConfirmOverwriteState,
+	&optionBootSnapshots,
 	&optionFastForwardSpeed,
 	#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 	&optionNotifyInputDeviceChange,
@@ -177,6 +179,7 @@ static OptionBase *cfgFileOption[] =
 	&optionFrameInterval,
 	#endif
 	&optionSkipLateFrames,
+	&optionFrameDelay,
 	&optionFrameRate,
 	&optionFrameRatePAL,
 	&optionVibrateOnPush,
@@ -452,6 +455,7 @@ void loadConfigFile()
 				bcase CFGKEY_FRAME_INTERVAL: optionFrameInterval.readFromIO(io, size);
 				#endif
 				bcase CFGKEY_SKIP_LATE_FRAMES: optionSkipLateFrames.readFromIO(io, size);
+				bcase CFGKEY_FRAME_DELAY: optionFrameDelay.readFromIO(io, size);
 				bcase CFGKEY_FRAME_RATE: optionFrameRate.readFromIO(io, size);
 				bcase CFGKEY_FRAME_RATE_PAL: optionFrameRatePAL.readFromIO(io, size);
 				bcase CFGKEY_LAST_DIR: optionLastLoadPath.readFromIO(io, size);
@@ -469,6 +473,7 @@ void loadConfigFile()
 				bcase CFGKEY_IMAGE_EFFECT: optionImgEffect.readFromIO(io, size);
 				bcase CFGKEY_IMAGE_EFFECT_PIXEL_FORMAT: optionImageEffectPixelFormat.readFromIO(io, size);
 				#endif
+				bcase CFGKEY_IMAGE_CPU_EFFECT: optionImgCPUEffect.readFromIO(io, size);
 				bcase CFGKEY_VIDEO_IMAGE_BUFFERS: optionVideoImageBuffers.readFromIO(io, size);
 				bcase CFGKEY_OVERLAY_EFFECT: optionOverlayEffect.readFromIO(io, size);
 				bcase CFGKEY_OVERLAY_EFFECT_LEVEL: optionOverlayEffectLevel.readFromIO(io, size);
@@ -483,6 +488,7 @@ void loadConfigFile()
 				bcase CFGKEY_IDLE_DISPLAY_POWER_SAVE: optionIdleDisplayPowerSave.readFromIO(io, size);
 				bcase CFGKEY_HIDE_STATUS_BAR: optionHideStatusBar.readFromIO(io, size);
 				bcase CFGKEY_CONFIRM_OVERWRITE_STATE: optionConfirmOverwriteState.readFromIO(io, size);
+				bcase CFGKEY_BOOT_SNAPSHOTS: optionBootSnapshots.readFromIO(io, size);
 				bcase CFGKEY_FAST_FORWARD_SPEED: optionFastForwardSpeed.readFromIO(io, size);
 				#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 				bcase CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE: optionNotifyInputDeviceChange.readFromIO(io, size);
@@ -186,15 +186,38 @@ void EmuApp::showExitAlert(ViewAttachParams attach, Input::Event e)
 	emuViewController().pushAndShowModal(std::make_unique<ExitConfirmAlertView>(attach), e, false);
 }
 
-static const char *parseCmdLineArgs(int argc, char** argv)
+struct CmdLineArgs
 {
-	if(argc < 2)
+	const char *launchGame{};
+	const char *benchmarkState{};
+	uint32_t benchmarkFrames{};
+};
+
+// [-benchmark=frames [-benchmark-state=path]] game
+static CmdLineArgs parseCmdLineArgs(int argc, char** argv)
+{
+	static constexpr char benchmarkArg[] = "-benchmark=";
+	static constexpr char benchmarkStateArg[] = "-benchmark-state=";
+	CmdLineArgs args{};
+	for(int i = 1; i < argc; i++)
 	{
-		return nullptr;
+		auto arg = argv[i];
+		if(!strncmp(arg, benchmarkArg, string_len(benchmarkArg)))
+		{
+			args.benchmarkFrames = std::max(atoi(arg + string_len(benchmarkArg)), 1);
+		}
+		else if(!strncmp(arg, benchmarkStateArg, string_len(benchmarkStateArg)))
+		{
+			args.benchmarkState = arg + string_len(benchmarkStateArg);
+		}
+		else
+		{
+			args.launchGame = arg;
+		}
 	}
-	auto launchGame = argv[1];
-	logMsg("starting game from command line: %s", launchGame);
-	return launchGame;
+	if(args.launchGame)
+		logMsg("starting game from command line: %s", args.launchGame);
+	return args;
 }
 
 IG::PixelFormat windowPixelFormat()
@@ -239,7 +262,7 @@ void mainInitCommon(int argc, char** argv)
 		});
 	optionVControllerLayoutPos.setVController(vController);
 	initOptions();
-	auto launchGame = parseCmdLineArgs(argc, argv);
+	auto cmdArgs = parseCmdLineArgs(argc, argv);
 	loadConfigFile();
 	if(auto err = EmuSystem::onOptionsLoaded();
 		err)
@@ -279,6 +302,7 @@ void mainInitCommon(int argc, char** argv)
 	emuVideo.setRendererTask(renderer.task());
 	emuVideo.setTextureBufferMode((Gfx::TextureBufferMode)optionTextureBufferMode.val);
 	emuVideo.setImageBuffers(optionVideoImageBuffers);
+	emuVideo.setCPUEffect(optionImgCPUEffect);
 	emuVideoLayerPtr = std::make_unique<EmuVideoLayer>(emuVideo, optionImgFilter);
 	auto &emuVideoLayer = *emuVideoLayerPtr;
 	emuVideoLayer.setOverlayIntensity(optionOverlayEffectLevel/100.);
@@ -437,9 +461,13 @@ void mainInitCommon(int argc, char** argv)
 	win.show();
 	win.postDraw();
 	EmuApp::onMainWindowCreated(viewAttach, Input::defaultEvent());
-	if(launchGame)
+	if(cmdArgs.launchGame && cmdArgs.benchmarkFrames)
+	{
+		runCmdLineBenchmark(cmdArgs.launchGame, cmdArgs.benchmarkState, cmdArgs.benchmarkFrames);
+	}
+	else if(cmdArgs.launchGame)
 	{
-		emuViewController().handleOpenFileCommand(launchGame);
+		emuViewController().handleOpenFileCommand(cmdArgs.launchGame);
 	}
 }
 
@@ -510,6 +538,38 @@ void runBenchmarkOneShot()
 	EmuApp::printfMessage(2, 0, "%.2f fps", double(180.)/time.count());
 }
 
+// Runs frames as fast as possible and prints the time to stdout, then exits.
+// Used by scripts like imagine/make/pgoBuild.sh that need a repeatable workload.
+void runCmdLineBenchmark(const char *path, const char *statePath, uint32_t frames)
+{
+	static const char *benchmarkState;
+	static uint32_t benchmarkFrames;
+	benchmarkState = statePath;
+	benchmarkFrames = frames;
+	EmuApp::createSystemWithMedia({}, path, "", Input::defaultEvent(), {},
+		[](Input::Event e)
+		{
+			if(benchmarkState)
+			{
+				if(auto err = EmuSystem::loadState(benchmarkState);
+					err)
+				{
+					Base::exitWithErrorMessagePrintf(-1, "error loading benchmark state: %s", err->what());
+					return;
+				}
+			}
+			IG::FloatSeconds time = EmuSystem::benchmark(emuVideo, benchmarkFrames);
+			printf("benchmark: %s: %u frames in %.3fs, %.2f fps\n", EmuSystem::fullGameName().data(),
+				benchmarkFrames, time.count(), benchmarkFrames / time.count());
+			fflush(stdout);
+			Base::exit();
+		},
+		[](const char *errorStr)
+		{
+			Base::exitWithErrorMessagePrintf(-1, "error loading benchmark game: %s", errorStr);
+		});
+}
+
 void EmuApp::showEmuation()
 {
 	if(EmuSystem::gameIsRunning())
@@ -656,14 +716,15 @@ static ViewAttachParams emuViewAttachParams()
 
 [[gnu::weak]] bool EmuApp::willCreateSystem(ViewAttachParams attach, Input::Event) { return true; }
 
-void EmuApp::createSystemWithMedia(GenericIO io, const char *path, const char *name, Input::Event e, EmuSystemCreateParams params, CreateSystemCompleteDelegate onComplete)
+void EmuApp::createSystemWithMedia(GenericIO io, const char *path, const char *name, Input::Event e, EmuSystemCreateParams params,
+	CreateSystemCompleteDelegate onComplete, CreateSystemErrorDelegate onError)
 {
 	if(!EmuApp::willCreateSystem(emuViewAttachParams(), e))
 	{
 		return;
 	}
 	emuViewController().closeSystem();
-	auto loadProgressView = std::make_unique<EmuLoadProgressView>(emuViewAttachParams(), e, onComplete);
+	auto loadProgressView = std::make_unique<EmuLoadProgressView>(emuViewAttachParams(), e, onComplete, onError);
 	auto &msgPort = loadProgressView->messagePort();
 	pushAndShowModalView(std::move(loadProgressView), e);
 	IG::makeDetachedThread(
@@ -759,6 +820,8 @@ EmuSystem::Error EmuApp::loadState(const char *path)
 	}
 	fixFilePermissions(path);
 	syncEmulationThread();
+	// the loaded state is past boot, don't snapshot it
+	cancelBootSnapshot();
 	logMsg("loading state %s", path);
 	return EmuSystem::loadState(path);
 }
@@ -926,6 +989,11 @@ void EmuApp::syncEmulationThread()
 	emuSystemTask.pause();
 }
 
+void EmuApp::runOnEmulationThread(DelegateFunc<void()> func)
+{
+	emuSystemTask.runOnThread(func);
+}
+
 WindowData &windowData(const Base::Window &win)
 {
 	auto data = win.customData<WindowData>();
@@ -16,6 +16,7 @@
 #define LOGTAG "EmuAudio"
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuSystem.hh>
+#include <emuframework/FrameTrace.hh>
 #include "private.hh"
 #include <imagine/audio/AudioManager.hh>
 #include <imagine/logger/logger.h>
@@ -165,6 +166,7 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 			outputFormat,
 			[this, outputSampleFormat = outputFormat.sample](void *samples, unsigned bytes)
 			{
+				FrameTrace::Scope traceScope{FrameTrace::Phase::AUDIO_CALLBACK};
 				#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 				audioStats.callbacks++;
 				audioStats.callbackBytes += bytes;
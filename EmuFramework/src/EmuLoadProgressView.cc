@@ -19,8 +19,9 @@
 #include <imagine/logger/logger.h>
 #include "private.hh"
 
-EmuLoadProgressView::EmuLoadProgressView(ViewAttachParams attach, Input::Event e, EmuApp::CreateSystemCompleteDelegate onComplete):
-	View{attach}, onComplete{onComplete}, originalEvent{e}
+EmuLoadProgressView::EmuLoadProgressView(ViewAttachParams attach, Input::Event e, EmuApp::CreateSystemCompleteDelegate onComplete,
+	EmuApp::CreateSystemErrorDelegate onError):
+	View{attach}, onComplete{onComplete}, onError{onError}, originalEvent{e}
 {
 	msgPort.attach(
 		[this](auto msgs)
@@ -37,8 +38,12 @@ EmuLoadProgressView::EmuLoadProgressView(ViewAttachParams attach, Input::Event e
 						msgs.getExtraData(errorStr, len);
 						errorStr[len] = 0;
 						msgPort.detach();
+						auto onError = this->onError;
 						EmuApp::popModalViews();
-						EmuApp::postErrorMessage(4, errorStr);
+						if(onError)
+							onError(errorStr);
+						else
+							EmuApp::postErrorMessage(4, errorStr);
 						return;
 					}
 					bcase EmuSystem::LoadProgress::OK:
@@ -17,6 +17,7 @@
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/EmuApp.hh>
 #include <emuframework/VideoImageEffect.hh>
+#include <emuframework/VideoImageCPUEffect.hh>
 #include <emuframework/VideoImageOverlay.hh>
 #include <emuframework/VController.hh>
 #include "private.hh"
@@ -25,6 +26,7 @@
 #include <imagine/base/platformExtras.hh>
 #include <imagine/gfx/Renderer.hh>
 #include <imagine/util/bits.h>
+#include <algorithm>
 
 template<class T>
 bool optionFrameTimeIsValid(T val)
@@ -102,7 +104,8 @@ Byte1Option optionIdleDisplayPowerSave(CFGKEY_IDLE_DISPLAY_POWER_SAVE, 0, !Confi
 Byte1Option optionHideStatusBar(CFGKEY_HIDE_STATUS_BAR, 1, !Config::envIsAndroid && !Config::envIsIOS);
 OptionSwappedGamepadConfirm optionSwappedGamepadConfirm(CFGKEY_SWAPPED_GAMEPAD_CONFIM, Input::SWAPPED_GAMEPAD_CONFIRM_DEFAULT);
 Byte1Option optionConfirmOverwriteState(CFGKEY_CONFIRM_OVERWRITE_STATE, 1, 0);
-Byte1Option optionFastForwardSpeed(CFGKEY_FAST_FORWARD_SPEED, 4, 0, optionIsValidWithMinMax<2, 7>);
+Byte1Option optionBootSnapshots(CFGKEY_BOOT_SNAPSHOTS, 1, 0);
+Byte1Option optionFastForwardSpeed(CFGKEY_FAST_FORWARD_SPEED, 4, 0, optionIsValidWithMinMax<2, MAX_SPEED_FAST_FORWARD>);
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 Byte1Option optionNotifyInputDeviceChange(CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE, Config::Input::DEVICE_HOTSWAP, !Config::Input::DEVICE_HOTSWAP);
 #endif
@@ -124,6 +127,7 @@ Byte1Option optionImgFilter(CFGKEY_GAME_IMG_FILTER, 1, 0);
 #ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
 Byte1Option optionImgEffect(CFGKEY_IMAGE_EFFECT, 0, 0, optionIsValidWithMax<VideoImageEffect::LAST_EFFECT_VAL-1>);
 #endif
+OptionImageCPUEffect optionImgCPUEffect{};
 Byte1Option optionOverlayEffect(CFGKEY_OVERLAY_EFFECT, 0, 0, optionIsValidWithMax<VideoImageOverlay::MAX_EFFECT_VAL>);
 Byte1Option optionOverlayEffectLevel(CFGKEY_OVERLAY_EFFECT_LEVEL, 25, 0, optionIsValidWithMax<100>);
 
@@ -220,6 +224,7 @@ Byte1Option optionFrameInterval
 	{CFGKEY_FRAME_INTERVAL,	1, !Config::envIsIOS, optionIsValidWithMinMax<1, 4>};
 #endif
 Byte1Option optionSkipLateFrames{CFGKEY_SKIP_LATE_FRAMES, 1, 0};
+Byte1Option optionFrameDelay{CFGKEY_FRAME_DELAY, 0, 0};
 DoubleOption optionFrameRate{CFGKEY_FRAME_RATE, 0, 0, optionFrameTimeIsValid};
 DoubleOption optionFrameRatePAL{CFGKEY_FRAME_RATE_PAL, 1./50., !EmuSystem::hasPALVideoSystem, optionFrameTimePALIsValid};
 
@@ -497,6 +502,64 @@ void setupFont(Gfx::Renderer &r, Base::Window &win)
 	View::defaultBoldFace.setFontSettings(r, IG::FontSettings(win.heightSMMInPixels(size)));
 }
 
+static uint8_t currentSubsystem()
+{
+	return std::min(EmuSystem::subsystem(), (uint8_t)(EmuSystem::MAX_SUBSYSTEMS - 1));
+}
+
+OptionImageCPUEffect &OptionImageCPUEffect::operator=(uint8_t v)
+{
+	val[currentSubsystem()] = v;
+	return *this;
+}
+
+OptionImageCPUEffect::operator uint8_t() const
+{
+	return val[currentSubsystem()];
+}
+
+void OptionImageCPUEffect::initDefault(uint8_t v)
+{
+	defaultVal = v;
+	val.fill(v);
+}
+
+bool OptionImageCPUEffect::isDefault() const
+{
+	return std::all_of(val.begin(), val.end(), [this](uint8_t v){ return v == defaultVal; });
+}
+
+bool OptionImageCPUEffect::writeToIO(IO &io)
+{
+	logMsg("writing CPU image effects");
+	io.write(key);
+	io.write(val.data(), val.size());
+	return true;
+}
+
+bool OptionImageCPUEffect::readFromIO(IO &io, uint readSize)
+{
+	if(readSize != val.size())
+	{
+		logMsg("skipping %u byte option value, expected %zu", readSize, val.size());
+		return false;
+	}
+	for(auto &v : val)
+	{
+		auto effect = io.get<uint8_t>();
+		if(effect < VideoImageCPUEffect::LAST_EFFECT_VAL)
+			v = effect;
+		else
+			logMsg("skipped invalid CPU image effect");
+	}
+	return true;
+}
+
+uint OptionImageCPUEffect::ioSize() const
+{
+	return sizeof(key) + val.size();
+}
+
 bool OptionRecentGames::isDefault() const
 {
 	return recentGameList.size() == 0;
@@ -78,7 +78,9 @@ enum { CFGKEY_SOUND = 0, CFGKEY_TOUCH_CONTROL_DISPLAY = 1,
 	CFGKEY_FRAME_RATE_PAL = 78, CFGKEY_TIME_FRAMES_WITH_SCREEN_REFRESH = 79,
 	CFGKEY_SUSTAINED_PERFORMANCE_MODE = 80, CFGKEY_SHOW_BLUETOOTH_SCAN = 81,
 	CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN = 82, CFGKEY_VIDEO_IMAGE_BUFFERS = 83,
-	CFGKEY_AUDIO_API = 84, CFGKEY_SOUND_VOLUME = 85
+	CFGKEY_AUDIO_API = 84, CFGKEY_SOUND_VOLUME = 85,
+	CFGKEY_IMAGE_CPU_EFFECT = 86, CFGKEY_FRAME_DELAY = 87,
+	CFGKEY_BOOT_SNAPSHOTS = 88
 	// 256+ is reserved
 };
 
@@ -92,6 +94,23 @@ struct OptionRecentGames : public OptionBase
 	uint ioSize() const override;
 };
 
+// CPU image effect kept for each of the systems an app emulates, reads and
+// writes go to the one for EmuSystem::subsystem()
+struct OptionImageCPUEffect : public OptionBase
+{
+	const uint16_t key = CFGKEY_IMAGE_CPU_EFFECT;
+	std::array<uint8_t, EmuSystem::MAX_SUBSYSTEMS> val{};
+	uint8_t defaultVal{};
+
+	OptionImageCPUEffect &operator=(uint8_t v);
+	operator uint8_t() const;
+	void initDefault(uint8_t v);
+	bool isDefault() const override;
+	bool writeToIO(IO &io) override;
+	bool readFromIO(IO &io, uint readSize);
+	uint ioSize() const override;
+};
+
 struct OptionVControllerLayoutPosition : public OptionBase
 {
 	const uint16_t key = CFGKEY_VCONTROLLER_LAYOUT_POS;
@@ -132,7 +151,10 @@ extern Byte1Option optionIdleDisplayPowerSave;
 extern Byte1Option optionHideStatusBar;
 extern OptionSwappedGamepadConfirm optionSwappedGamepadConfirm;
 extern Byte1Option optionConfirmOverwriteState;
+extern Byte1Option optionBootSnapshots;
 extern Byte1Option optionFastForwardSpeed;
+// optionFastForwardSpeed value that runs as many frames as fit in each screen refresh
+static constexpr uint8_t MAX_SPEED_FAST_FORWARD = 8;
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 extern Byte1Option optionNotifyInputDeviceChange;
 #endif
@@ -154,6 +176,7 @@ extern DoubleOption optionAspectRatio;
 extern Byte1Option optionImgEffect;
 extern Byte1Option optionImageEffectPixelFormat;
 #endif
+extern OptionImageCPUEffect optionImgCPUEffect;
 extern Byte1Option optionOverlayEffect;
 extern Byte1Option optionOverlayEffectLevel;
 
@@ -189,6 +212,7 @@ extern OptionVControllerLayoutPosition optionVControllerLayoutPos;
 extern Byte1Option optionFrameInterval;
 #endif
 extern Byte1Option optionSkipLateFrames;
+extern Byte1Option optionFrameDelay;
 extern DoubleOption optionFrameRate;
 extern DoubleOption optionFrameRatePAL;
 extern DoubleOption optionRefreshRateOverride;
@@ -19,6 +19,7 @@
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/FileUtils.hh>
 #include <emuframework/FilePicker.hh>
+#include <emuframework/FrameTrace.hh>
 #include <imagine/base/Base.hh>
 #include <imagine/base/platformExtras.hh>
 #include <imagine/fs/ArchiveFS.hh>
@@ -304,12 +305,42 @@ void EmuSystem::resetFrameTime()
 	emuTiming.reset();
 }
 
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+static Base::Timer frameTraceTimer
+{
+	"frameTraceTimer",
+	[]()
+	{
+		emuViewController().updateEmuFrameTraceStats(FrameTrace::stats(IG::steadyClockTimestamp() - IG::Seconds(1)));
+		return true;
+	}
+};
+#endif
+
+static void startFrameTraceStats()
+{
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	frameTraceTimer.run(IG::Seconds(1), IG::Seconds(1));
+	#endif
+}
+
+static void stopFrameTraceStats()
+{
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	frameTraceTimer.cancel();
+	emuViewController().clearEmuFrameTraceStats();
+	// keep a trace of the most recent frames, viewable in chrome://tracing
+	FrameTrace::writeChromeTrace(FS::makePathStringPrintf("%s/frameTrace.json", EmuApp::supportPath().data()).data());
+	#endif
+}
+
 void EmuSystem::pause()
 {
 	if(isActive())
 		state = State::PAUSED;
 	emuAudio.stop();
 	cancelAutoSaveStateTimer();
+	stopFrameTraceStats();
 }
 
 void EmuSystem::start()
@@ -319,12 +350,13 @@ void EmuSystem::start()
 	resetFrameTime();
 	emuAudio.start(makeWantedAudioLatencyUSecs(optionSoundBuffers), makeWantedAudioLatencyUSecs(1));
 	startAutoSaveStateTimer();
+	startFrameTraceStats();
 }
 
-IG::Time EmuSystem::benchmark(EmuVideo &video)
+IG::Time EmuSystem::benchmark(EmuVideo &video, uint32_t frames)
 {
 	auto now = IG::steadyClockTimestamp();
-	iterateTimes(180, i)
+	iterateTimes(frames, i)
 	{
 		runFrame(nullptr, &video, nullptr);
 	}
@@ -338,6 +370,7 @@ void EmuSystem::skipFrames(EmuSystemTask *task, uint32_t frames, EmuAudio *audio
 	iterateTimes(frames, i)
 	{
 		turboActions.update();
+		FrameTrace::Scope traceScope{FrameTrace::Phase::RUN_FRAME};
 		runFrame(task, nullptr, audio);
 	}
 }
@@ -458,6 +491,7 @@ void EmuSystem::prepareAudioVideo(EmuAudio &audio, EmuVideo &video)
 
 void EmuSystem::prepareVideo(EmuVideo &video)
 {
+	video.setCPUEffect(optionImgCPUEffect);
 	onPrepareVideo(video);
 	video.clear();
 }
@@ -632,6 +666,8 @@ void EmuSystem::sessionOptionSet()
 
 [[gnu::weak]] bool EmuSystem::vidSysIsPAL() { return false; }
 
+[[gnu::weak]] uint8_t EmuSystem::subsystem() { return 0; }
+
 [[gnu::weak]] bool EmuSystem::touchControlsApplicable() { return true; }
 
 [[gnu::weak]] bool EmuSystem::handlePointerInputEvent(Input::Event e, IG::WindowRect gameRect) { return false; }
@@ -26,6 +26,7 @@
 #include <emuframework/OptionView.hh>
 #include <emuframework/InputManagerView.hh>
 #include <emuframework/BundledGamesView.hh>
+#include <emuframework/RamSearchView.hh>
 #include "private.hh"
 
 class ResetAlertView : public BaseAlertView
@@ -86,6 +87,7 @@ void EmuSystemActionsView::onShow()
 	TableView::onShow();
 	logMsg("refreshing action menu state");
 	cheats.setActive(EmuSystem::gameIsRunning());
+	ramSearch.setActive(EmuSystem::gameIsRunning());
 	reset.setActive(EmuSystem::gameIsRunning());
 	saveState.setActive(EmuSystem::gameIsRunning());
 	loadState.setActive(EmuSystem::gameIsRunning() && EmuSystem::stateExists(EmuSystem::saveStateSlot));
@@ -104,6 +106,10 @@ void EmuSystemActionsView::loadStandardItems()
 	{
 		item.emplace_back(&cheats);
 	}
+	if(EmuSystem::hasRamSearch)
+	{
+		item.emplace_back(&ramSearch);
+	}
 	item.emplace_back(&reset);
 	item.emplace_back(&loadState);
 	item.emplace_back(&saveState);
@@ -130,6 +136,17 @@ EmuSystemActionsView::EmuSystemActionsView(ViewAttachParams attach, bool customM
 			}
 		}
 	},
+	ramSearch
+	{
+		"RAM Search",
+		[this](Input::Event e)
+		{
+			if(EmuSystem::gameIsRunning())
+			{
+				pushAndShow(makeView<RamSearchView>(), e);
+			}
+		}
+	},
 	reset
 	{
 		"Reset",
@@ -18,8 +18,11 @@
 #include <imagine/logger/logger.h>
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuVideo.hh>
+#include <emuframework/FrameTrace.hh>
 #include "EmuSystemTask.hh"
+#include "private.hh"
 #include "privateInput.hh"
+#include <algorithm>
 
 void EmuSystemTask::start()
 {
@@ -45,6 +48,10 @@ void EmuSystemTask::start()
 					{
 						EmuApp::printScreenshotResult(msg.args.screenshot.num, msg.args.screenshot.success);
 					}
+					bcase Reply::BOOT_READY:
+					{
+						saveBootSnapshot();
+					}
 					bdefault:
 					{
 						logErr("unknown reply message:%d", (int)msg.reply);
@@ -53,10 +60,22 @@ void EmuSystemTask::start()
 			}
 			return true;
 		});
+	startThread();
+	started = true;
+}
+
+void EmuSystemTask::startThread()
+{
+	// the thread stays for the app's lifetime so code that must always run on
+	// the same thread, like a system's coroutines, can use runOnThread()
+	if(threadStarted)
+		return;
 	IG::makeDetachedThreadSync(
 		[this](auto &sem)
 		{
+			threadId = std::this_thread::get_id();
 			auto eventLoop = Base::EventLoop::makeForThread();
+			FrameTrace::setThreadName("EmuSystemTask");
 			commandPort.attach(eventLoop,
 				[this](auto msgs)
 				{
@@ -66,6 +85,7 @@ void EmuSystemTask::start()
 						{
 							bcase Command::RUN_FRAME:
 							{
+								auto startTime = IG::steadyClockTimestamp();
 								auto frames = msg.args.run.frames;
 								assumeExpr(frames);
 								auto *video = msg.args.run.video;
@@ -84,27 +104,33 @@ void EmuSystemTask::start()
 										EmuSystem::setSpeedMultiplier(1);
 									}
 								}
-								else
+								else if(frames > 1)
+								{
+									auto skipTime = IG::timeFunc([&](){ EmuSystem::skipFrames(this, frames - 1, audio); });
+									if(!audio)
+										updateSkippedFrameTime(skipTime, frames - 1);
+								}
 								{
-									EmuSystem::skipFrames(this, frames - 1, audio);
+									FrameTrace::Scope traceScope{FrameTrace::Phase::INPUT};
+									turboActions.update();
 								}
-								turboActions.update();
-								EmuSystem::runFrame(this, video, audio);
+								{
+									FrameTrace::Scope traceScope{FrameTrace::Phase::RUN_FRAME};
+									EmuSystem::runFrame(this, video, audio);
+								}
+								updateFrameRunTime(IG::steadyClockTimestamp() - startTime);
 							}
-							bcase Command::PAUSE:
+							bcase Command::RUN_FUNC:
 							{
-								//logMsg("got pause command");
 								assumeExpr(msg.semPtr);
+								(*msg.args.func)();
 								msg.semPtr->notify();
 							}
-							bcase Command::EXIT:
+							bcase Command::PAUSE:
 							{
-								//logMsg("got exit command");
-								started = false;
-								Base::EventLoop::forThread().stop();
+								//logMsg("got pause command");
 								assumeExpr(msg.semPtr);
 								msg.semPtr->notify();
-								return false;
 							}
 							bdefault:
 							{
@@ -114,12 +140,10 @@ void EmuSystemTask::start()
 					}
 					return true;
 				});
-			started = true;
+			threadStarted = true;
 			sem.notify();
 			logMsg("starting thread event loop");
-			eventLoop.run(started);
-			logMsg("exiting thread");
-			commandPort.detach();
+			eventLoop.run(threadStarted);
 		});
 }
 
@@ -134,7 +158,8 @@ void EmuSystemTask::stop()
 {
 	if(!started)
 		return;
-	commandPort.send({Command::EXIT}, true);
+	commandPort.send({Command::PAUSE}, true);
+	started = false;
 	replyPort.clear();
 	replyPort.detach();
 }
@@ -147,6 +172,40 @@ void EmuSystemTask::runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, b
 	commandPort.send({Command::RUN_FRAME, video, audio, frames, skipForward});
 }
 
+void EmuSystemTask::runOnThread(DelegateFunc<void()> func)
+{
+	startThread();
+	if(std::this_thread::get_id() == threadId)
+	{
+		func();
+		return;
+	}
+	commandPort.send({Command::RUN_FUNC, func}, true);
+}
+
+void EmuSystemTask::updateSkippedFrameTime(IG::Time time, uint32_t frames)
+{
+	auto frameTime = time / frames;
+	auto avgTime = skippedFrameTime();
+	// weight new samples at 1/4 to smooth out scheduling noise
+	avgTime = avgTime.count() ? (avgTime * 3 + frameTime) / 4 : frameTime;
+	skippedFrameTime_.store(avgTime, std::memory_order_relaxed);
+}
+
+void EmuSystemTask::updateFrameRunTime(IG::Time time)
+{
+	auto prevTime = frameRunTime();
+	frameRunTime_.store(std::max(time, prevTime - prevTime / 16), std::memory_order_relaxed);
+}
+
+uint8_t EmuSystemTask::framesForTime(IG::Time time, uint8_t maxFrames) const
+{
+	auto frameTime = skippedFrameTime();
+	if(!frameTime.count())
+		return std::min((uint8_t)2, maxFrames); // no measurement yet
+	return std::clamp(time / frameTime, (IG::Time::rep)1, (IG::Time::rep)maxFrames);
+}
+
 void EmuSystemTask::sendVideoFormatChangedReply(EmuVideo &video, IG::PixmapDesc desc)
 {
 	replyPort.send({Reply::VIDEO_FORMAT_CHANGED, video, desc}, true);
@@ -156,3 +215,8 @@ void EmuSystemTask::sendScreenshotReply(int num, bool success)
 {
 	replyPort.send({Reply::TOOK_SCREENSHOT, num, success});
 }
+
+void EmuSystemTask::sendBootReadyReply()
+{
+	replyPort.send({Reply::BOOT_READY});
+}
@@ -19,6 +19,10 @@
 #include <imagine/base/CustomEvent.hh>
 #include <imagine/thread/Semaphore.hh>
 #include <imagine/pixmap/PixmapDesc.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <atomic>
+#include <thread>
 
 class EmuVideo;
 class EmuAudio;
@@ -28,7 +32,7 @@ class EmuSystemTask
 public:
 	enum class Command: uint8_t
 	{
-		UNSET, RUN_FRAME, PAUSE, EXIT
+		UNSET, RUN_FRAME, RUN_FUNC, PAUSE
 	};
 
 	struct CommandMessage
@@ -43,6 +47,7 @@ public:
 				uint8_t frames;
 				bool skipForward;
 			} run;
+			DelegateFunc<void()> *func;
 		} args{};
 		Command command{Command::UNSET};
 
@@ -51,13 +56,18 @@ public:
 			semPtr{semPtr}, command{command} {}
 		constexpr CommandMessage(Command command, EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward = false):
 			args{video, audio, frames, skipForward}, command{command} {}
+		constexpr CommandMessage(Command command, DelegateFunc<void()> &func):
+			command{command}
+		{
+			args.func = &func;
+		}
 		explicit operator bool() const { return command != Command::UNSET; }
 		void setReplySemaphore(IG::Semaphore *semPtr_) { assert(!semPtr); semPtr = semPtr_; };
 	};
 
 	enum class Reply: uint8_t
 	{
-		UNSET, VIDEO_FORMAT_CHANGED, TOOK_SCREENSHOT
+		UNSET, VIDEO_FORMAT_CHANGED, TOOK_SCREENSHOT, BOOT_READY
 	};
 
 	struct ReplyMessage
@@ -79,6 +89,8 @@ public:
 		Reply reply{Reply::UNSET};
 
 		constexpr ReplyMessage() {}
+		constexpr ReplyMessage(Reply reply):
+			reply{reply} {}
 		constexpr ReplyMessage(Reply reply, EmuVideo &video, IG::PixmapDesc desc):
 			args{desc, &video}, reply{reply} {}
 		constexpr ReplyMessage(Reply reply, int num, bool success):
@@ -94,11 +106,29 @@ public:
 	void pause();
 	void stop();
 	void runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward = false);
+	// runs func on the task's thread and waits for it to return, call it while
+	// the task is paused since frames may be waiting on the main thread
+	void runOnThread(DelegateFunc<void()> func);
 	void sendVideoFormatChangedReply(EmuVideo &video, IG::PixmapDesc desc);
 	void sendScreenshotReply(int num, bool success);
+	void sendBootReadyReply();
+	// running average of the time to emulate one frame without audio or video output
+	IG::Time skippedFrameTime() const { return skippedFrameTime_.load(std::memory_order_relaxed); }
+	// number of skipped frames that fit into the given time, for maximum-speed fast-forward
+	uint8_t framesForTime(IG::Time time, uint8_t maxFrames) const;
+	// recent peak time to run a frame request, decaying slowly so a single fast frame doesn't hide slower ones
+	IG::Time frameRunTime() const { return frameRunTime_.load(std::memory_order_relaxed); }
 
 private:
 	Base::MessagePort<CommandMessage> commandPort{"EmuSystemTask Command"};
 	Base::MessagePort<ReplyMessage> replyPort{"EmuSystemTask Reply"};
+	std::atomic<IG::Time> skippedFrameTime_{};
+	std::atomic<IG::Time> frameRunTime_{};
+	std::thread::id threadId{};
 	bool started = false;
+	bool threadStarted = false;
+
+	void startThread();
+	void updateSkippedFrameTime(IG::Time time, uint32_t frames);
+	void updateFrameRunTime(IG::Time time);
 };
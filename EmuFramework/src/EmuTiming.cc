@@ -17,6 +17,7 @@
 #include <imagine/util/utility.h>
 #include <imagine/logger/logger.h>
 #include <cmath>
+#include <algorithm>
 
 EmuFrameTimeInfo EmuTiming::advanceFramesWithTime(IG::FrameTime time)
 {
@@ -66,3 +67,34 @@ void EmuTiming::updateScaledFrameTime()
 	else
 		timePerVideoFrameScaled = timePerVideoFrame;
 }
+
+IG::Time EmuFrameDelay::delay(IG::FloatSeconds refreshTime, IG::Time runTime) const
+{
+	auto refresh = std::chrono::duration_cast<IG::Time>(refreshTime);
+	auto delay = refresh - runTime - margin_;
+	if(delay.count() <= 0)
+		return {};
+	// always leave at least half a refresh for emulation
+	return std::min(delay, refresh / 2);
+}
+
+void EmuFrameDelay::onDeadlineMissed()
+{
+	metDeadlines = 0;
+	margin_ = std::min(margin_ * 2, MAX_MARGIN);
+	logMsg("missed frame deadline, delay margin now:%.2fms",
+		std::chrono::duration<double, std::milli>(margin_).count());
+}
+
+void EmuFrameDelay::onDeadlineMet()
+{
+	if(++metDeadlines < MET_DEADLINES_TO_SHRINK)
+		return;
+	metDeadlines = 0;
+	margin_ = std::max(margin_ - MARGIN_STEP, MIN_MARGIN);
+}
+
+void EmuFrameDelay::reset()
+{
+	*this = {};
+}
@@ -40,3 +40,25 @@ protected:
 
 	void updateScaledFrameTime();
 };
+
+// Delays the start of emulation after a screen refresh so the frame completes
+// a safety margin before the next one, reducing input latency. The margin
+// grows when a frame misses its refresh and slowly shrinks while they don't.
+class EmuFrameDelay
+{
+public:
+	IG::Time delay(IG::FloatSeconds refreshTime, IG::Time runTime) const;
+	void onDeadlineMissed();
+	void onDeadlineMet();
+	void reset();
+	IG::Time margin() const { return margin_; }
+
+protected:
+	static constexpr IG::Time MIN_MARGIN = IG::Microseconds(1500);
+	static constexpr IG::Time MAX_MARGIN = IG::Milliseconds(16);
+	static constexpr IG::Time MARGIN_STEP = IG::Microseconds(250);
+	static constexpr uint16_t MET_DEADLINES_TO_SHRINK = 120;
+
+	IG::Time margin_{IG::Milliseconds(4)};
+	uint16_t metDeadlines{};
+};
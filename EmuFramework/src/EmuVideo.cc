@@ -17,9 +17,11 @@
 #include <emuframework/EmuVideo.hh>
 #include <emuframework/EmuApp.hh>
 #include <emuframework/Screenshot.hh>
+#include <emuframework/FrameTrace.hh>
 #include <imagine/gfx/Renderer.hh>
 #include <imagine/gfx/RendererTask.hh>
 #include <imagine/gfx/RendererCommands.hh>
+#include <imagine/gfx/GfxSprite.hh>
 #include <imagine/logger/logger.h>
 #include "EmuSystemTask.hh"
 
@@ -30,8 +32,9 @@ void EmuVideo::resetImage()
 
 IG::PixmapDesc EmuVideo::deleteImage()
 {
-	auto desc = vidImg.usedPixmapDesc();
+	auto desc = srcDesc;
 	vidImg = {};
+	srcDesc = {};
 	return desc;
 }
 
@@ -46,17 +49,22 @@ void EmuVideo::setFormat(IG::PixmapDesc desc)
 	{
 		return; // no change to format
 	}
+	srcDesc = desc;
+	auto texDesc = cpuEffect_.outputDesc(desc);
 	if(!vidImg)
 	{
-		Gfx::TextureConfig conf{desc, texSampler};
+		Gfx::TextureConfig conf{texDesc, texSampler};
 		vidImg = renderer().makePixmapBufferTexture(conf, bufferMode, singleBuffer);
 		vidImg.clear();
 	}
 	else
 	{
-		vidImg.setFormat(desc, texSampler);
+		vidImg.setFormat(texDesc, texSampler);
 	}
-	logMsg("resized to:%dx%d", desc.w(), desc.h());
+	if(texDesc != desc)
+		logMsg("resized to:%dx%d (CPU effect output:%dx%d)", desc.w(), desc.h(), texDesc.w(), texDesc.h());
+	else
+		logMsg("resized to:%dx%d", desc.w(), desc.h());
 	onFormatChanged(*this);
 }
 
@@ -72,11 +80,18 @@ void EmuVideo::postSetFormat(EmuSystemTask &task, IG::PixmapDesc desc)
 
 void EmuVideo::syncImageAccess()
 {
+	FrameTrace::Scope traceScope{FrameTrace::Phase::SYNC_IMAGE};
 	rTask->clientWaitSync(std::exchange(fence, {}));
 }
 
 EmuVideoImage EmuVideo::startFrame(EmuSystemTask *task)
 {
+	frameLineSpans.clear();
+	if(cpuEffect_.isActive(srcDesc))
+	{
+		// core renders into the effect's input buffer, texture is written in finishFrame()
+		return {task, *this, cpuEffect_.inputBuffer(srcDesc)};
+	}
 	auto lockedTex = vidImg.lock();
 	syncImageAccess();
 	return {task, *this, lockedTex};
@@ -84,6 +99,7 @@ EmuVideoImage EmuVideo::startFrame(EmuSystemTask *task)
 
 void EmuVideo::startFrame(EmuSystemTask *task, IG::Pixmap pix)
 {
+	frameLineSpans.clear();
 	finishFrame(task, pix);
 }
 
@@ -113,6 +129,90 @@ void EmuVideo::startFrameWithFormat(EmuSystemTask *task, IG::Pixmap pix)
 	startFrame(task, pix);
 }
 
+void EmuVideo::startFrameWithLineWidths(EmuSystemTask *task, IG::Pixmap pix, const int32_t *lineWidth)
+{
+	LineSpans spans{};
+	bool tooManySpans = false;
+	iterateTimes(pix.h(), y)
+	{
+		int w = lineWidth[y];
+		assumeExpr(w > 0 && w <= (int)pix.w());
+		if(spans.size() && spans.back().width == w)
+		{
+			spans.back().lines++;
+			continue;
+		}
+		if(spans.isFull())
+		{
+			tooManySpans = true;
+			break;
+		}
+		spans.push_back({(uint16_t)y, 1, (uint16_t)w});
+	}
+	if(spans.size() == 1)
+	{
+		startFrameWithFormat(task, pix.subView({}, {spans[0].width, (int)pix.h()}));
+		return;
+	}
+	if(unlikely(tooManySpans || screenshotNextFrame || cpuEffect_.isActive(pix)))
+	{
+		// fall back to scaling lines to the full width before uploading
+		startFrameWithFormat(task, expandLines(pix, lineWidth));
+		return;
+	}
+	if(task)
+	{
+		postSetFormat(*task, pix);
+	}
+	else
+	{
+		setFormat(pix);
+	}
+	frameLineSpans = spans;
+	finishFrame(task, pix);
+}
+
+template <class Pixel>
+static void expandLinesToWidth(IG::Pixmap dest, IG::Pixmap src, const int32_t *lineWidth)
+{
+	unsigned destWidth = dest.w();
+	iterateTimes(dest.h(), y)
+	{
+		auto srcLine = (const Pixel*)src.pixel({0, (int)y});
+		auto destLine = (Pixel*)dest.pixel({0, (int)y});
+		unsigned width = lineWidth[y];
+		if(width == destWidth)
+		{
+			std::copy_n(srcLine, width, destLine);
+			continue;
+		}
+		// nearest neighbor with a 16.16 fixed point step
+		uint32_t step = (width << 16) / destWidth;
+		uint32_t pos = 0;
+		iterateTimes(destWidth, x)
+		{
+			destLine[x] = srcLine[pos >> 16];
+			pos += step;
+		}
+	}
+}
+
+IG::Pixmap EmuVideo::expandLines(IG::Pixmap pix, const int32_t *lineWidth)
+{
+	if(!lineExpandPix || (IG::PixmapDesc)lineExpandPix != (IG::PixmapDesc)pix)
+	{
+		lineExpandPix = IG::MemPixmap{pix};
+	}
+	auto dest = lineExpandPix.view();
+	switch(pix.format().bytesPerPixel())
+	{
+		bcase 2: expandLinesToWidth<uint16_t>(dest, pix, lineWidth);
+		bcase 4: expandLinesToWidth<uint32_t>(dest, pix, lineWidth);
+		bdefault: bug_unreachable("unsupported bytes per pixel:%d", pix.format().bytesPerPixel());
+	}
+	return dest;
+}
+
 void EmuVideo::startUnchangedFrame(EmuSystemTask *task)
 {
 	dispatchFinishFrame(task);
@@ -121,6 +221,10 @@ void EmuVideo::startUnchangedFrame(EmuSystemTask *task)
 void EmuVideo::dispatchFinishFrame(EmuSystemTask *task)
 {
 	//logDMsg("frame finished");
+	{
+		std::scoped_lock lock{lineSpansLock};
+		lineSpans_ = frameLineSpans;
+	}
 	onFrameFinished(*this);
 }
 
@@ -140,11 +244,57 @@ void EmuVideo::finishFrame(EmuSystemTask *task, IG::Pixmap pix)
 	{
 		doScreenshot(task, pix);
 	}
-	syncImageAccess();
-	vidImg.write(pix, vidImg.WRITE_FLAG_ASYNC);
+	{
+		FrameTrace::Scope traceScope{FrameTrace::Phase::VIDEO_UPLOAD};
+		if(cpuEffect_.isActive(pix))
+		{
+			renderCPUEffect(pix);
+		}
+		else
+		{
+			syncImageAccess();
+			vidImg.write(pix, vidImg.WRITE_FLAG_ASYNC);
+		}
+	}
 	dispatchFinishFrame(task);
 }
 
+void EmuVideo::renderCPUEffect(IG::Pixmap pix)
+{
+	auto lockedTex = vidImg.lock();
+	syncImageAccess();
+	cpuEffect_.render(lockedTex.pixmap(), pix);
+	vidImg.unlock(lockedTex);
+}
+
+EmuVideo::LineSpans EmuVideo::lineSpans() const
+{
+	std::scoped_lock lock{lineSpansLock};
+	return lineSpans_;
+}
+
+void EmuVideo::drawLineSpans(Gfx::RendererCommands &cmds, const LineSpans &spans, Gfx::GCRect pos, Gfx::GTexCRect uv) const
+{
+	const Gfx::Texture &tex = vidImg;
+	float vMin = std::min(uv.y, uv.y2), vMax = std::max(uv.y, uv.y2);
+	auto lineV = [&](int line){ return vMin + (vMax - vMin) * line / (float)srcDesc.h(); };
+	// uv.y is sampled at the top edge (pos.y2) and uv.y2 at the bottom
+	auto vToY = [&](float v){ return pos.y2 + (pos.y - pos.y2) * (v - uv.y) / (uv.y2 - uv.y); };
+	for(auto span : spans)
+	{
+		float v = lineV(span.y), v2 = lineV(span.y + span.lines);
+		float y = vToY(v), y2 = vToY(v2);
+		if(y < y2)
+		{
+			std::swap(y, y2);
+			std::swap(v, v2);
+		}
+		float u2 = uv.x + (uv.x2 - uv.x) * span.width / (float)srcDesc.w();
+		Gfx::Sprite spr{{pos.x, y2, pos.x2, y}, {&tex, {uv.x, v, u2, v2}}};
+		spr.draw(cmds);
+	}
+}
+
 bool EmuVideo::addFence(Gfx::RendererCommands &cmds)
 {
 	if(!needsFence)
@@ -217,25 +367,54 @@ Gfx::Renderer &EmuVideo::renderer() const
 EmuVideoImage::EmuVideoImage() {}
 
 EmuVideoImage::EmuVideoImage(EmuSystemTask *task, EmuVideo &vid, Gfx::LockedTextureBuffer texBuff):
-	task{task}, emuVideo{&vid}, texBuff{texBuff} {}
+	task{task}, emuVideo{&vid}, texBuff{texBuff}
+{
+	if constexpr(FrameTrace::ENABLED)
+		convertStart = IG::steadyClockTimestamp();
+}
+
+EmuVideoImage::EmuVideoImage(EmuSystemTask *task, EmuVideo &vid, IG::Pixmap effectSrcPix):
+	task{task}, emuVideo{&vid}, effectSrcPix{effectSrcPix}
+{
+	if constexpr(FrameTrace::ENABLED)
+		convertStart = IG::steadyClockTimestamp();
+}
 
 IG::Pixmap EmuVideoImage::pixmap() const
 {
+	if(effectSrcPix)
+		return effectSrcPix;
 	return texBuff.pixmap();
 }
 
 EmuVideoImage::operator bool() const
 {
-	return (bool)texBuff;
+	return (bool)texBuff || effectSrcPix;
 }
 
 void EmuVideoImage::endFrame()
 {
+	// cores convert their palette or framebuffer into the image between startFrame() and here
+	if constexpr(FrameTrace::ENABLED)
+		FrameTrace::record(FrameTrace::Phase::VIDEO_CONVERT, convertStart, IG::steadyClockTimestamp());
+	if(effectSrcPix)
+	{
+		emuVideo->finishFrame(task, effectSrcPix);
+		return;
+	}
 	assumeExpr(texBuff);
 	emuVideo->finishFrame(task, texBuff);
 }
 
 IG::WP EmuVideo::size() const
+{
+	if(!vidImg)
+		return {};
+	else
+		return srcDesc.size();
+}
+
+IG::WP EmuVideo::imageSize() const
 {
 	if(!vidImg)
 		return {};
@@ -245,7 +424,7 @@ IG::WP EmuVideo::size() const
 
 bool EmuVideo::formatIsEqual(IG::PixmapDesc desc) const
 {
-	return vidImg && desc == vidImg.usedPixmapDesc();
+	return vidImg && desc == srcDesc;
 }
 
 void EmuVideo::setOnFrameFinished(FrameFinishedDelegate del)
@@ -300,3 +479,19 @@ void EmuVideo::setCompatTextureSampler(const Gfx::TextureSampler &compatTexSampl
 		return;
 	vidImg.setCompatTextureSampler(compatTexSampler);
 }
+
+void EmuVideo::setCPUEffect(uint8_t effect)
+{
+	if(effect == cpuEffect_.effect())
+		return;
+	cpuEffect_.setEffect(effect);
+	if(!vidImg)
+		return;
+	// re-create the texture with the new output size
+	setFormat(std::exchange(srcDesc, {}));
+}
+
+uint8_t EmuVideo::cpuEffect() const
+{
+	return cpuEffect_.effect();
+}
@@ -39,7 +39,7 @@ void EmuVideoLayer::resetImage()
 	{
 		logMsg("drawing video via render target");
 		disp.setImg(&vidImgEffect.renderTarget());
-		vidImgEffect.setImageSize(video.renderer(), video.size(), *texSampler);
+		vidImgEffect.setImageSize(video.renderer(), video.imageSize(), *texSampler);
 		video.setCompatTextureSampler(video.renderer().make(Gfx::CommonTextureSampler::NO_LINEAR_NO_MIP_CLAMP));
 	}
 	else
@@ -243,7 +243,7 @@ void EmuVideoLayer::draw(Gfx::RendererCommands &cmds, const Gfx::ProjectionPlane
 		cmds.setRenderTarget(vidImgEffect.renderTarget());
 		cmds.setDither(false);
 		cmds.clear();
-		vidImgEffect.drawRenderTarget(cmds, video.image());
+		vidImgEffect.drawRenderTarget(cmds, video);
 		cmds.setDefaultRenderTarget();
 		cmds.setDither(true);
 		cmds.setViewport(prevViewport);
@@ -255,7 +255,20 @@ void EmuVideoLayer::draw(Gfx::RendererCommands &cmds, const Gfx::ProjectionPlane
 		disp.setCommonProgram(cmds, replaceMode ? IMG_MODE_REPLACE : IMG_MODE_MODULATE, projP.makeTranslate());
 	}
 	cmds.setTextureSampler(*texSampler);
-	disp.draw(cmds);
+	#ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
+	bool spansInRenderTarget = (bool)vidImgEffect.program();
+	#else
+	bool spansInRenderTarget = false;
+	#endif
+	auto lineSpans = spansInRenderTarget ? EmuVideo::LineSpans{} : video.lineSpans();
+	if(lineSpans.size())
+	{
+		video.drawLineSpans(cmds, lineSpans, gameRectG, ((Gfx::TextureSpan)video.image()).uvBounds());
+	}
+	else
+	{
+		disp.draw(cmds);
+	}
 	video.addFence(cmds);
 	vidImgOverlay.draw(cmds);
 }
@@ -293,7 +306,7 @@ void EmuVideoLayer::setEffectFormat(IG::PixelFormatID fmt)
 void EmuVideoLayer::placeEffect()
 {
 	#ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
-	vidImgEffect.setImageSize(video.renderer(), video.size(), *texSampler);
+	vidImgEffect.setImageSize(video.renderer(), video.imageSize(), *texSampler);
 	#endif
 }
 
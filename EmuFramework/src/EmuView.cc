@@ -15,7 +15,13 @@
 
 #include <emuframework/EmuView.hh>
 #include <emuframework/EmuVideoLayer.hh>
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+#include <imagine/gfx/RendererCommands.hh>
+#include <imagine/gui/TableView.hh>
+#endif
+#include <imagine/util/algorithm.h>
 #include <algorithm>
+#include <cstdio>
 
 EmuView::EmuView() {}
 
@@ -29,6 +35,9 @@ void EmuView::prepareDraw()
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	audioStatsText.makeGlyphs(renderer());
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	frameTraceText.makeGlyphs(renderer());
+	#endif
 }
 
 void EmuView::draw(Gfx::RendererCommands &cmds)
@@ -51,6 +60,19 @@ void EmuView::draw(Gfx::RendererCommands &cmds)
 			projP.alignYToPixel(audioStatsRect.yCenter()), LC2DO, projP);
 	}
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	if(frameTraceText.isVisible())
+	{
+		cmds.setCommonProgram(CommonProgram::NO_TEX);
+		cmds.setBlendMode(BLEND_MODE_ALPHA);
+		cmds.setColor(0., 0., 0., .7);
+		GeomRect::draw(cmds, frameTraceRect);
+		cmds.setColor(1., 1., 1., 1.);
+		cmds.setCommonProgram(CommonProgram::TEX_ALPHA);
+		frameTraceText.draw(cmds, projP.alignXToPixel(frameTraceRect.x + TableView::globalXIndent),
+			projP.alignYToPixel(frameTraceRect.yCenter()), LC2DO, projP);
+	}
+	#endif
 }
 
 void EmuView::place()
@@ -67,6 +89,15 @@ void EmuView::place()
 			+ audioStatsText.nominalHeight * .5f; // adjust to bottom
 	}
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	if(frameTraceText.compile(renderer(), projP))
+	{
+		// anchored to the bottom so it doesn't overlap the audio stats
+		frameTraceRect = projP.bounds();
+		frameTraceRect.y = (frameTraceRect.y2 - frameTraceText.nominalHeight() * frameTraceText.currentLines())
+			- frameTraceText.nominalHeight() * .5f;
+	}
+	#endif
 }
 
 bool EmuView::inputEvent(Input::Event e)
@@ -94,3 +125,30 @@ void EmuView::clearAudioStats()
 	audioStatsText.setString(nullptr);
 	#endif
 }
+
+void EmuView::updateFrameTraceStats(const FrameTrace::Stats &stats)
+{
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	std::array<char, 512> str{};
+	size_t len = 0;
+	iterateTimes(FrameTrace::PHASES, i)
+	{
+		auto &phaseStats = stats[i];
+		auto toMSecs = [](IG::Time t){ return std::chrono::duration<double, std::milli>(t).count(); };
+		len += snprintf(&str[len], str.size() - len, "%s%s: %.2fms avg %.2fms max (%u)", i ? "\n" : "",
+			FrameTrace::phaseName((FrameTrace::Phase)i), toMSecs(phaseStats.average()), toMSecs(phaseStats.max), phaseStats.count);
+		if(len >= str.size())
+			break;
+	}
+	frameTraceText.setFace(&View::defaultFace);
+	frameTraceText.setString(str.data());
+	place();
+	#endif
+}
+
+void EmuView::clearFrameTraceStats()
+{
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+	frameTraceText.setString(nullptr);
+	#endif
+}
@@ -20,6 +20,7 @@
 #include <emuframework/EmuVideoLayer.hh>
 #include <emuframework/EmuMainMenuView.hh>
 #include <emuframework/FilePicker.hh>
+#include <emuframework/FrameTrace.hh>
 #include <imagine/base/Base.hh>
 #include <imagine/gfx/Renderer.hh>
 #include <imagine/gfx/RendererTask.hh>
@@ -67,6 +68,13 @@ EmuViewController::EmuViewController(Base::Window &win, Gfx::Renderer &renderer,
 	rendererTask_{&rTask},
 	systemTask{&systemTask}
 {
+	FrameTrace::setThreadName("Main");
+	frameDelayTimer.setCallback(
+		[this]()
+		{
+			this->systemTask->runFrame(&this->videoLayer().emuVideo(), delayedRunFrame.audio,
+				delayedRunFrame.frames, delayedRunFrame.skipForward);
+		});
 	emuInputView.setController(this, Input::defaultEvent());
 }
 
@@ -149,6 +157,10 @@ void EmuViewController::initViews(ViewAttachParams viewAttach)
 		{
 			if(emuVideoInProgress)
 			{
+				if(std::exchange(frameDelayActive, false))
+				{
+					frameDelay.onDeadlineMissed();
+				}
 				// frame not ready yet, retry on next vblank
 				if(useRendererTime())
 					postDrawToEmuWindows();
@@ -156,37 +168,75 @@ void EmuViewController::initViews(ViewAttachParams viewAttach)
 			}
 			bool skipForward = false;
 			bool fastForwarding = false;
-			if(unlikely(EmuSystem::shouldFastForward()))
-			{
-				// for skipping loading on disk-based computers
-				fastForwarding = true;
-				skipForward = true;
-				EmuSystem::setSpeedMultiplier(8);
-			}
-			else if(unlikely(targetFastForwardSpeed > 1))
+			EmuAudio *audioPtr = emuAudio ? &emuAudio : nullptr;
+			uint32_t framesToEmulate{};
+			if(unlikely(targetFastForwardSpeed == MAX_SPEED_FAST_FORWARD && !EmuSystem::shouldFastForward()))
 			{
+				// run as many frames as the measured emulation speed allows
+				// in most of a screen refresh, without audio output
+				constexpr uint8_t maxSpeedFrameSkip = 64;
 				fastForwarding = true;
-				EmuSystem::setSpeedMultiplier(targetFastForwardSpeed);
+				EmuSystem::setSpeedMultiplier(1);
+				EmuSystem::resetFrameTime();
+				auto timeBudget = std::chrono::duration_cast<IG::Time>(params.frameTime() * .75);
+				framesToEmulate = systemTask->framesForTime(timeBudget, maxSpeedFrameSkip);
+				audioPtr = nullptr;
 			}
 			else
 			{
-				EmuSystem::setSpeedMultiplier(1);
+				if(unlikely(EmuSystem::shouldFastForward()))
+				{
+					// for skipping loading on disk-based computers
+					fastForwarding = true;
+					skipForward = true;
+					EmuSystem::setSpeedMultiplier(8);
+				}
+				else if(unlikely(targetFastForwardSpeed > 1))
+				{
+					fastForwarding = true;
+					EmuSystem::setSpeedMultiplier(targetFastForwardSpeed);
+					if(!soundDuringFastForwardIsEnabled())
+					{
+						// core can skip audio synthesis entirely
+						audioPtr = nullptr;
+					}
+				}
+				else
+				{
+					EmuSystem::setSpeedMultiplier(1);
+				}
+				auto frameInfo = EmuSystem::advanceFramesWithTime(params.timestamp());
+				if(!frameInfo.advanced)
+				{
+					if(useRendererTime())
+						postDrawToEmuWindows();
+					return true;
+				}
+				if(!optionSkipLateFrames && !fastForwarding)
+				{
+					frameInfo.advanced = currentFrameInterval();
+				}
+				constexpr uint maxFrameSkip = 8;
+				framesToEmulate = std::min(frameInfo.advanced, maxFrameSkip);
 			}
-			auto frameInfo = EmuSystem::advanceFramesWithTime(params.timestamp());
-			if(!frameInfo.advanced)
+			emuVideoInProgress = true;
+			if(std::exchange(frameDelayActive, false))
 			{
-				if(useRendererTime())
-					postDrawToEmuWindows();
-				return true;
+				frameDelay.onDeadlineMet();
 			}
-			if(!optionSkipLateFrames && !fastForwarding)
+			if(optionFrameDelay && !fastForwarding)
 			{
-				frameInfo.advanced = currentFrameInterval();
+				// start emulation late enough in the refresh to finish just before the next one
+				if(auto delay = frameDelay.delay(params.frameTime(), systemTask->frameRunTime());
+					delay.count())
+				{
+					frameDelayActive = true;
+					delayedRunFrame = {audioPtr, (uint8_t)framesToEmulate, skipForward};
+					frameDelayTimer.runIn(delay);
+					r.setPresentationTime(emuWindowData().drawableHolder, params.presentTime());
+					return true;
+				}
 			}
-			constexpr uint maxFrameSkip = 8;
-			uint32_t framesToEmulate = std::min(frameInfo.advanced, maxFrameSkip);
-			emuVideoInProgress = true;
-			EmuAudio *audioPtr = emuAudio ? &emuAudio : nullptr;
 			systemTask->runFrame(&videoLayer().emuVideo(), audioPtr, framesToEmulate, skipForward);
 			r.setPresentationTime(emuWindowData().drawableHolder, params.presentTime());
 			/*logMsg("frame present time:%.4f next display frame:%.4f",
@@ -639,6 +689,16 @@ void EmuViewController::clearEmuAudioStats()
 	emuView.clearAudioStats();
 }
 
+void EmuViewController::updateEmuFrameTraceStats(const FrameTrace::Stats &stats)
+{
+	emuView.updateFrameTraceStats(stats);
+}
+
+void EmuViewController::clearEmuFrameTraceStats()
+{
+	emuView.clearFrameTraceStats();
+}
+
 bool EmuViewController::allWindowsAreFocused() const
 {
 	return mainWindowData().focused && (!extraWin || windowData(*extraWin).focused);
@@ -741,6 +801,9 @@ void EmuViewController::pauseEmulation()
 	EmuSystem::pause();
 	videoLayer().setBrightness(showingEmulation ? .75f : .25f);
 	setFastForwardActive(false);
+	frameDelayTimer.cancel();
+	frameDelayActive = false;
+	frameDelay.reset();
 	emuVideoInProgress = false;
 	removeOnFrame();
 }
@@ -813,6 +876,7 @@ void EmuViewController::prepareDraw()
 
 void EmuViewController::drawMainWindow(Base::Window &win, Gfx::RendererCommands &cmds, bool hasEmuView, bool hasPopup)
 {
+	FrameTrace::Scope traceScope{FrameTrace::Phase::PRESENT};
 	if(showingEmulation)
 	{
 		if(hasEmuView)
@@ -869,6 +933,7 @@ void EmuViewController::onInputDevicesChanged()
 
 void EmuViewController::onSystemCreated()
 {
+	loadBootSnapshot();
 	viewStack.navView()->showRightBtn(true);
 }
 
@@ -0,0 +1,210 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "FrameTrace"
+#include <emuframework/FrameTrace.hh>
+#include <imagine/logger/logger.h>
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+#include <imagine/io/FileIO.hh>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#endif
+
+namespace FrameTrace
+{
+
+const char *phaseName(Phase phase)
+{
+	switch(phase)
+	{
+		case Phase::INPUT: return "Input";
+		case Phase::RUN_FRAME: return "Run Frame";
+		case Phase::VIDEO_CONVERT: return "Video Convert";
+		case Phase::VIDEO_UPLOAD: return "Video Upload";
+		case Phase::SYNC_IMAGE: return "Sync Image";
+		case Phase::PRESENT: return "Present";
+		case Phase::AUDIO_CALLBACK: return "Audio Callback";
+	}
+	return "Unknown";
+}
+
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_TRACE
+
+struct Event
+{
+	IG::Time start;
+	IG::Time end;
+	Phase phase;
+};
+
+// Single-writer ring, readers copy the events behind the write count and
+// skip a margin at the old end that the writer may be overwriting
+struct EventRing
+{
+	static constexpr uint32_t SIZE = 2048;
+	static constexpr uint32_t READ_MARGIN = 64;
+
+	std::array<Event, SIZE> event{};
+	std::atomic_uint32_t writeCount{};
+	const char *name{};
+	std::atomic_bool inUse{};
+
+	void push(Event e)
+	{
+		auto count = writeCount.load(std::memory_order_relaxed);
+		event[count % SIZE] = e;
+		writeCount.store(count + 1, std::memory_order_release);
+	}
+
+	template <class Func>
+	void forEach(Func &&func) const
+	{
+		auto count = writeCount.load(std::memory_order_acquire);
+		uint32_t first = count > SIZE - READ_MARGIN ? count - (SIZE - READ_MARGIN) : 0;
+		for(auto i = first; i < count; i++)
+		{
+			func(event[i % SIZE]);
+		}
+	}
+};
+
+static constexpr unsigned MAX_THREADS = 8;
+static std::array<EventRing, MAX_THREADS> ring{};
+static std::atomic_uint rings{}; // rings ever used, readers scan this many
+static IG::Time traceStartTime = IG::steadyClockTimestamp();
+
+// Frees the thread's ring when it exits so threads that come and go
+// reuse rings, the old events stay readable until they're overwritten
+struct ThreadRing
+{
+	EventRing *ring{};
+	bool noRing{};
+
+	~ThreadRing()
+	{
+		if(ring)
+			ring->inUse.store(false, std::memory_order_release);
+	}
+};
+
+static thread_local ThreadRing threadRing{};
+
+static EventRing *ringForThread()
+{
+	if(likely(threadRing.ring))
+		return threadRing.ring;
+	if(threadRing.noRing)
+		return nullptr;
+	for(unsigned idx = 0; idx < MAX_THREADS; idx++)
+	{
+		bool inUse = false;
+		if(!ring[idx].inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+			continue;
+		ring[idx].name = nullptr;
+		auto used = rings.load(std::memory_order_relaxed);
+		while(used < idx + 1 && !rings.compare_exchange_weak(used, idx + 1, std::memory_order_release));
+		threadRing.ring = &ring[idx];
+		return threadRing.ring;
+	}
+	// warn once, later events from this thread get dropped silently
+	logWarn("too many threads, dropping events");
+	threadRing.noRing = true;
+	return nullptr;
+}
+
+void record(Phase phase, IG::Time start, IG::Time end)
+{
+	auto r = ringForThread();
+	if(unlikely(!r))
+		return;
+	r->push({start, end, phase});
+}
+
+void setThreadName(const char *name)
+{
+	auto r = ringForThread();
+	if(!r)
+		return;
+	r->name = name;
+}
+
+Stats stats(IG::Time since)
+{
+	Stats s{};
+	auto ringCount = std::min(rings.load(std::memory_order_acquire), MAX_THREADS);
+	for(unsigned i = 0; i < ringCount; i++)
+	{
+		ring[i].forEach(
+			[&](const Event &e)
+			{
+				if(e.end < since)
+					return;
+				auto &phaseStats = s[(unsigned)e.phase];
+				auto duration = e.end - e.start;
+				phaseStats.total += duration;
+				phaseStats.max = std::max(phaseStats.max, duration);
+				phaseStats.count++;
+			});
+	}
+	return s;
+}
+
+bool writeChromeTrace(const char *path)
+{
+	FileIO file;
+	if(file.create(path))
+	{
+		logErr("error creating trace file:%s", path);
+		return false;
+	}
+	auto ringCount = std::min(rings.load(std::memory_order_acquire), MAX_THREADS);
+	char str[256];
+	bool firstEvent = true;
+	auto writeEvent = [&](int len)
+		{
+			if(!firstEvent)
+				file.write(",\n", 2);
+			firstEvent = false;
+			file.write(str, std::min(len, (int)sizeof(str) - 1));
+		};
+	file.write("{\"traceEvents\":[\n", 17);
+	for(unsigned i = 0; i < ringCount; i++)
+	{
+		auto tid = i + 1;
+		char threadName[16];
+		if(!ring[i].name)
+			snprintf(threadName, sizeof(threadName), "Thread %u", tid);
+		writeEvent(snprintf(str, sizeof(str),
+			"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			tid, ring[i].name ? ring[i].name : threadName));
+		ring[i].forEach(
+			[&](const Event &e)
+			{
+				double ts = std::chrono::duration<double, std::micro>(e.start - traceStartTime).count();
+				double dur = std::chrono::duration<double, std::micro>(e.end - e.start).count();
+				writeEvent(snprintf(str, sizeof(str),
+					"{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					phaseName(e.phase), tid, ts, dur));
+			});
+	}
+	file.write("\n]}\n", 4);
+	logMsg("wrote frame trace:%s", path);
+	return true;
+}
+
+#endif
+
+}
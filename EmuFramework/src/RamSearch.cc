@@ -0,0 +1,531 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "RamSearch"
+#include <emuframework/RamSearch.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/time/Time.hh>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#if defined __AVX2__ || defined __SSE2__
+#include <immintrin.h>
+#define RAM_SEARCH_SIMD
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#define RAM_SEARCH_SIMD
+#endif
+
+using Compare = RamSearch::Compare;
+using ValueType = RamSearch::ValueType;
+
+// values are read in host order, which is little endian on every supported CPU
+static_assert(std::endian::native == std::endian::little);
+
+static constexpr unsigned CHUNK_VALUES = 64; // values per candidate bitmap word
+
+[[gnu::weak]] bool EmuSystem::hasRamSearch = false;
+
+[[gnu::weak]] std::vector<RamSearchRegion> EmuSystem::ramSearchRegions() { return {}; }
+
+#ifdef RAM_SEARCH_SIMD
+
+// Each SIMD backend provides the same operations on one vector of bytes,
+// comparisons are signed, unsigned ones flip the sign bits first
+
+#if defined __AVX2__
+
+struct SimdOps
+{
+	using V = __m256i;
+	static constexpr unsigned bytes = 32;
+
+	static V load(const uint8_t *p) { return _mm256_loadu_si256((const V*)p); }
+	static void store(uint8_t *p, V v) { _mm256_storeu_si256((V*)p, v); }
+	static V bitXor(V a, V b) { return _mm256_xor_si256(a, b); }
+	static uint32_t moveMask(V v) { return _mm256_movemask_epi8(v); }
+
+	template<unsigned SIZE>
+	static V set(uint32_t v)
+	{
+		if constexpr(SIZE == 1) return _mm256_set1_epi8(v);
+		else if constexpr(SIZE == 2) return _mm256_set1_epi16(v);
+		else return _mm256_set1_epi32(v);
+	}
+
+	template<unsigned SIZE>
+	static V cmpEq(V a, V b)
+	{
+		if constexpr(SIZE == 1) return _mm256_cmpeq_epi8(a, b);
+		else if constexpr(SIZE == 2) return _mm256_cmpeq_epi16(a, b);
+		else return _mm256_cmpeq_epi32(a, b);
+	}
+
+	template<unsigned SIZE>
+	static V cmpGt(V a, V b)
+	{
+		if constexpr(SIZE == 1) return _mm256_cmpgt_epi8(a, b);
+		else if constexpr(SIZE == 2) return _mm256_cmpgt_epi16(a, b);
+		else return _mm256_cmpgt_epi32(a, b);
+	}
+
+	template<unsigned SIZE>
+	static V sub(V a, V b)
+	{
+		if constexpr(SIZE == 1) return _mm256_sub_epi8(a, b);
+		else if constexpr(SIZE == 2) return _mm256_sub_epi16(a, b);
+		else return _mm256_sub_epi32(a, b);
+	}
+
+	template<unsigned SIZE>
+	static V byteSwap(V v)
+	{
+		if constexpr(SIZE == 2)
+			return _mm256_shuffle_epi8(v, _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+				1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+		else
+			return _mm256_shuffle_epi8(v, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+				3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+	}
+};
+
+#elif defined __SSE2__
+
+struct SimdOps
+{
+	using V = __m128i;
+	static constexpr unsigned bytes = 16;
+
+	static V load(const uint8_t *p) { return _mm_loadu_si128((const V*)p); }
+	static void store(uint8_t *p, V v) { _mm_storeu_si128((V*)p, v); }
+	static V bitXor(V a, V b) { return _mm_xor_si128(a, b); }
+	static uint32_t moveMask(V v) { return _mm_movemask_epi8(v); }
+
+	template<unsigned SIZE>
+	static V set(uint32_t v)
+	{
+		if constexpr(SIZE == 1) return _mm_set1_epi8(v);
+		else if constexpr(SIZE == 2) return _mm_set1_epi16(v);
+		else return _mm_set1_epi32(v);
+	}
+
+	template<unsigned SIZE>
+	static V cmpEq(V a, V b)
+	{
+		if constexpr(SIZE == 1) return _mm_cmpeq_epi8(a, b);
+		else if constexpr(SIZE == 2) return _mm_cmpeq_epi16(a, b);
+		else return _mm_cmpeq_epi32(a, b);
+	}
+
+	template<unsigned SIZE>
+	static V cmpGt(V a, V b)
+	{
+		if constexpr(SIZE == 1) return _mm_cmpgt_epi8(a, b);
+		else if constexpr(SIZE == 2) return _mm_cmpgt_epi16(a, b);
+		else return _mm_cmpgt_epi32(a, b);
+	}
+
+	template<unsigned SIZE>
+	static V sub(V a, V b)
+	{
+		if constexpr(SIZE == 1) return _mm_sub_epi8(a, b);
+		else if constexpr(SIZE == 2) return _mm_sub_epi16(a, b);
+		else return _mm_sub_epi32(a, b);
+	}
+
+	template<unsigned SIZE>
+	static V byteSwap(V v)
+	{
+		// no byte shuffle before SSSE3, swap the bytes of each word, then the words of each dword
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		if constexpr(SIZE == 4)
+			v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		return v;
+	}
+};
+
+#elif defined __ARM_NEON
+
+struct SimdOps
+{
+	using V = uint8x16_t;
+	static constexpr unsigned bytes = 16;
+
+	static V load(const uint8_t *p) { return vld1q_u8(p); }
+	static void store(uint8_t *p, V v) { vst1q_u8(p, v); }
+	static V bitXor(V a, V b) { return veorq_u8(a, b); }
+
+	static uint32_t moveMask(V v)
+	{
+		// weight each byte's bit then add the bytes of each half together
+		static const uint8_t weights[16]{1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+		auto m = vandq_u8(v, vld1q_u8(weights));
+		auto sum = vpadd_u8(vget_low_u8(m), vget_high_u8(m));
+		sum = vpadd_u8(sum, sum);
+		sum = vpadd_u8(sum, sum);
+		return vget_lane_u16(vreinterpret_u16_u8(sum), 0);
+	}
+
+	template<unsigned SIZE>
+	static V set(uint32_t v)
+	{
+		if constexpr(SIZE == 1) return vdupq_n_u8(v);
+		else if constexpr(SIZE == 2) return vreinterpretq_u8_u16(vdupq_n_u16(v));
+		else return vreinterpretq_u8_u32(vdupq_n_u32(v));
+	}
+
+	template<unsigned SIZE>
+	static V cmpEq(V a, V b)
+	{
+		if constexpr(SIZE == 1) return vceqq_u8(a, b);
+		else if constexpr(SIZE == 2) return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+		else return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+	}
+
+	template<unsigned SIZE>
+	static V cmpGt(V a, V b)
+	{
+		if constexpr(SIZE == 1) return vcgtq_s8(vreinterpretq_s8_u8(a), vreinterpretq_s8_u8(b));
+		else if constexpr(SIZE == 2) return vreinterpretq_u8_u16(vcgtq_s16(vreinterpretq_s16_u8(a), vreinterpretq_s16_u8(b)));
+		else return vreinterpretq_u8_u32(vcgtq_s32(vreinterpretq_s32_u8(a), vreinterpretq_s32_u8(b)));
+	}
+
+	template<unsigned SIZE>
+	static V sub(V a, V b)
+	{
+		if constexpr(SIZE == 1) return vsubq_u8(a, b);
+		else if constexpr(SIZE == 2) return vreinterpretq_u8_u16(vsubq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+		else return vreinterpretq_u8_u32(vsubq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+	}
+
+	template<unsigned SIZE>
+	static V byteSwap(V v)
+	{
+		if constexpr(SIZE == 2) return vrev16q_u8(v);
+		else return vrev32q_u8(v);
+	}
+};
+
+#endif
+
+// keep one bit per value from a byte mask where every byte of a value has the same bit
+template<unsigned SIZE>
+static uint32_t valueBits(uint32_t m)
+{
+	if constexpr(SIZE == 2)
+	{
+		m &= 0x55555555;
+		m = (m | (m >> 1)) & 0x33333333;
+		m = (m | (m >> 2)) & 0x0F0F0F0F;
+		m = (m | (m >> 4)) & 0x00FF00FF;
+		m = (m | (m >> 8)) & 0x0000FFFF;
+	}
+	else if constexpr(SIZE == 4)
+	{
+		m &= 0x11111111;
+		m = (m | (m >> 3)) & 0x03030303;
+		m = (m | (m >> 6)) & 0x000F000F;
+		m = (m | (m >> 12)) & 0x000000FF;
+	}
+	return m;
+}
+
+template<unsigned SIZE, bool IS_BE, Compare OP>
+static uint64_t chunkMatches(const uint8_t *mem, uint8_t *last, SimdOps::V value, SimdOps::V bias)
+{
+	using Ops = SimdOps;
+	constexpr unsigned vecs = CHUNK_VALUES * SIZE / Ops::bytes;
+	constexpr unsigned vecValues = Ops::bytes / SIZE;
+	constexpr bool usesLast = OP >= Compare::UNCHANGED;
+	// equality doesn't depend on byte order so the value gets swapped once instead
+	constexpr bool needsSwap = IS_BE && SIZE > 1 && OP != Compare::EQUAL && OP != Compare::NOT_EQUAL &&
+		OP != Compare::UNCHANGED && OP != Compare::CHANGED;
+	uint64_t matches = 0;
+	for(unsigned i = 0; i < vecs; i++)
+	{
+		auto cur = Ops::load(mem + i * Ops::bytes);
+		Ops::V prev;
+		if constexpr(usesLast)
+			prev = Ops::load(last + i * Ops::bytes);
+		Ops::store(last + i * Ops::bytes, cur);
+		if constexpr(needsSwap)
+		{
+			cur = Ops::byteSwap<SIZE>(cur);
+			if constexpr(usesLast)
+				prev = Ops::byteSwap<SIZE>(prev);
+		}
+		Ops::V m;
+		if constexpr(OP == Compare::EQUAL || OP == Compare::NOT_EQUAL)
+			m = Ops::cmpEq<SIZE>(cur, value);
+		else if constexpr(OP == Compare::LESS)
+			m = Ops::cmpGt<SIZE>(value, Ops::bitXor(cur, bias));
+		else if constexpr(OP == Compare::GREATER)
+			m = Ops::cmpGt<SIZE>(Ops::bitXor(cur, bias), value);
+		else if constexpr(OP == Compare::UNCHANGED || OP == Compare::CHANGED)
+			m = Ops::cmpEq<SIZE>(cur, prev);
+		else if constexpr(OP == Compare::DECREASED)
+			m = Ops::cmpGt<SIZE>(Ops::bitXor(prev, bias), Ops::bitXor(cur, bias));
+		else if constexpr(OP == Compare::INCREASED)
+			m = Ops::cmpGt<SIZE>(Ops::bitXor(cur, bias), Ops::bitXor(prev, bias));
+		else
+			m = Ops::cmpEq<SIZE>(Ops::sub<SIZE>(cur, prev), value);
+		matches |= (uint64_t)valueBits<SIZE>(Ops::moveMask(m)) << (i * vecValues);
+	}
+	if constexpr(OP == Compare::NOT_EQUAL || OP == Compare::CHANGED)
+		matches = ~matches;
+	return matches;
+}
+
+#endif
+
+template<unsigned SIZE, bool IS_BE>
+static uint32_t readValue(const uint8_t *p)
+{
+	if constexpr(SIZE == 1)
+		return *p;
+	else if constexpr(SIZE == 2)
+	{
+		uint16_t v;
+		memcpy(&v, p, 2);
+		return IS_BE ? __builtin_bswap16(v) : v;
+	}
+	else
+	{
+		uint32_t v;
+		memcpy(&v, p, 4);
+		return IS_BE ? __builtin_bswap32(v) : v;
+	}
+}
+
+template<unsigned SIZE>
+static int64_t ordered(uint32_t v, bool isSigned)
+{
+	constexpr unsigned shift = 32 - SIZE * 8;
+	return isSigned ? (int64_t)((int32_t)(v << shift) >> shift) : (int64_t)v;
+}
+
+template<unsigned SIZE, bool IS_BE, Compare OP>
+static bool valueMatches(const uint8_t *mem, const uint8_t *last, uint32_t value, bool isSigned)
+{
+	constexpr uint32_t valueMask = SIZE == 4 ? 0xFFFFFFFF : (1u << (SIZE * 8)) - 1;
+	auto cur = readValue<SIZE, IS_BE>(mem);
+	auto prev = readValue<SIZE, IS_BE>(last);
+	switch(OP)
+	{
+		case Compare::EQUAL: return cur == value;
+		case Compare::NOT_EQUAL: return cur != value;
+		case Compare::LESS: return ordered<SIZE>(cur, isSigned) < ordered<SIZE>(value, isSigned);
+		case Compare::GREATER: return ordered<SIZE>(cur, isSigned) > ordered<SIZE>(value, isSigned);
+		case Compare::UNCHANGED: return cur == prev;
+		case Compare::CHANGED: return cur != prev;
+		case Compare::DECREASED: return ordered<SIZE>(cur, isSigned) < ordered<SIZE>(prev, isSigned);
+		case Compare::INCREASED: return ordered<SIZE>(cur, isSigned) > ordered<SIZE>(prev, isSigned);
+		case Compare::CHANGED_BY: return ((cur - prev) & valueMask) == value;
+	}
+	return false;
+}
+
+template<unsigned SIZE, bool IS_BE, Compare OP>
+static void searchRegion(RamSearch::Region &r, uint32_t value, bool isSigned)
+{
+	auto mem = r.mem.data;
+	auto last = r.last.data();
+	auto &candidates = r.candidates;
+	unsigned fullChunks = 0;
+	#ifdef RAM_SEARCH_SIMD
+	fullChunks = r.values / CHUNK_VALUES;
+	auto valueVec = SimdOps::set<SIZE>(value);
+	auto bias = SimdOps::set<SIZE>(isSigned ? 0 : 1u << (SIZE * 8 - 1));
+	if constexpr(OP == Compare::LESS || OP == Compare::GREATER)
+		valueVec = SimdOps::bitXor(valueVec, bias);
+	else if constexpr(IS_BE && (OP == Compare::EQUAL || OP == Compare::NOT_EQUAL))
+		valueVec = SimdOps::set<SIZE>(SIZE == 2 ? __builtin_bswap16(value) : __builtin_bswap32(value));
+	for(unsigned c = 0; c < fullChunks; c++)
+	{
+		if(!candidates[c])
+			continue;
+		size_t offset = (size_t)c * CHUNK_VALUES * SIZE;
+		candidates[c] &= chunkMatches<SIZE, IS_BE, OP>(mem + offset, last + offset, valueVec, bias);
+	}
+	#endif
+	// the last partial chunk, or everything without SIMD
+	for(unsigned c = fullChunks; c < candidates.size(); c++)
+	{
+		if(!candidates[c])
+			continue;
+		uint64_t matches = 0;
+		unsigned values = std::min(CHUNK_VALUES, r.values - c * CHUNK_VALUES);
+		for(unsigned i = 0; i < values; i++)
+		{
+			size_t offset = ((size_t)c * CHUNK_VALUES + i) * SIZE;
+			if(valueMatches<SIZE, IS_BE, OP>(mem + offset, last + offset, value, isSigned))
+				matches |= (uint64_t)1 << i;
+		}
+		memcpy(last + (size_t)c * CHUNK_VALUES * SIZE, mem + (size_t)c * CHUNK_VALUES * SIZE, values * SIZE);
+		candidates[c] &= matches;
+	}
+}
+
+using SearchRegionFunc = void(*)(RamSearch::Region &, uint32_t value, bool isSigned);
+
+template<unsigned SIZE, bool IS_BE>
+static SearchRegionFunc searchRegionFunc(Compare op)
+{
+	switch(op)
+	{
+		case Compare::EQUAL: return searchRegion<SIZE, IS_BE, Compare::EQUAL>;
+		case Compare::NOT_EQUAL: return searchRegion<SIZE, IS_BE, Compare::NOT_EQUAL>;
+		case Compare::LESS: return searchRegion<SIZE, IS_BE, Compare::LESS>;
+		case Compare::GREATER: return searchRegion<SIZE, IS_BE, Compare::GREATER>;
+		case Compare::UNCHANGED: return searchRegion<SIZE, IS_BE, Compare::UNCHANGED>;
+		case Compare::CHANGED: return searchRegion<SIZE, IS_BE, Compare::CHANGED>;
+		case Compare::DECREASED: return searchRegion<SIZE, IS_BE, Compare::DECREASED>;
+		case Compare::INCREASED: return searchRegion<SIZE, IS_BE, Compare::INCREASED>;
+		case Compare::CHANGED_BY: return searchRegion<SIZE, IS_BE, Compare::CHANGED_BY>;
+	}
+	bug_unreachable("invalid compare op:%d", (int)op);
+	return {};
+}
+
+static SearchRegionFunc searchRegionFunc(ValueType type, Compare op)
+{
+	switch(type)
+	{
+		case ValueType::U8: return searchRegionFunc<1, false>(op);
+		case ValueType::U16LE: return searchRegionFunc<2, false>(op);
+		case ValueType::U16BE: return searchRegionFunc<2, true>(op);
+		case ValueType::U32LE: return searchRegionFunc<4, false>(op);
+		case ValueType::U32BE: return searchRegionFunc<4, true>(op);
+	}
+	bug_unreachable("invalid value type:%d", (int)type);
+	return {};
+}
+
+unsigned RamSearch::valueSize(ValueType type)
+{
+	switch(type)
+	{
+		case ValueType::U8: return 1;
+		case ValueType::U16LE:
+		case ValueType::U16BE: return 2;
+		case ValueType::U32LE:
+		case ValueType::U32BE: return 4;
+	}
+	return 1;
+}
+
+bool RamSearch::start(ValueType type_)
+{
+	clear();
+	type = type_;
+	auto size = valueSize(type);
+	for(auto &mem : EmuSystem::ramSearchRegions())
+	{
+		uint32_t values = mem.size / size;
+		if(!values)
+			continue;
+		auto &r = regions.emplace_back();
+		r.mem = mem;
+		r.values = values;
+		r.last.assign(mem.data, mem.data + values * size);
+		r.candidates.assign((values + CHUNK_VALUES - 1) / CHUNK_VALUES, ~(uint64_t)0);
+		if(auto tail = values % CHUNK_VALUES; tail)
+			r.candidates.back() = ((uint64_t)1 << tail) - 1;
+	}
+	logMsg("started search of %zu region(s) with %zu values", regions.size(), count());
+	return isActive();
+}
+
+bool RamSearch::search(Compare op, uint32_t value)
+{
+	if(!isActive())
+		return false;
+	auto currRegions = EmuSystem::ramSearchRegions();
+	if(currRegions.size() != regions.size() ||
+		!std::equal(regions.begin(), regions.end(), currRegions.begin(),
+			[](const Region &r, const RamSearchRegion &mem)
+			{
+				return r.mem.data == mem.data && r.mem.size == mem.size;
+			}))
+	{
+		logMsg("regions changed since search started");
+		clear();
+		return false;
+	}
+	auto size = valueSize(type);
+	if(size < 4)
+		value &= (1u << (size * 8)) - 1;
+	auto searchFunc = searchRegionFunc(type, op);
+	auto searchTime = IG::timeFuncDebug(
+		[&]()
+		{
+			for(auto &r : regions)
+			{
+				searchFunc(r, value, isSigned);
+			}
+		});
+	logMsg("search op:%d value:0x%X took %lldns, %zu values left", (int)op, value,
+		(long long)searchTime.count(), count());
+	return true;
+}
+
+void RamSearch::clear()
+{
+	regions.clear();
+	regions.shrink_to_fit();
+}
+
+size_t RamSearch::count() const
+{
+	size_t count = 0;
+	for(const auto &r : regions)
+	{
+		for(auto bits : r.candidates)
+		{
+			count += std::popcount(bits);
+		}
+	}
+	return count;
+}
+
+std::vector<RamSearch::Result> RamSearch::results(size_t maxResults) const
+{
+	std::vector<Result> results{};
+	auto size = valueSize(type);
+	for(const auto &r : regions)
+	{
+		for(size_t c = 0; c < r.candidates.size(); c++)
+		{
+			for(auto bits = r.candidates[c]; bits; bits &= bits - 1)
+			{
+				if(results.size() == maxResults)
+					return results;
+				size_t offset = (c * CHUNK_VALUES + std::countr_zero(bits)) * size;
+				auto p = r.mem.data + offset;
+				uint32_t value;
+				switch(type)
+				{
+					case ValueType::U8: value = readValue<1, false>(p); break;
+					case ValueType::U16LE: value = readValue<2, false>(p); break;
+					case ValueType::U16BE: value = readValue<2, true>(p); break;
+					case ValueType::U32LE: value = readValue<4, false>(p); break;
+					case ValueType::U32BE: value = readValue<4, true>(p); break;
+				}
+				results.emplace_back(Result{r.mem.name, r.mem.address + (uint32_t)offset, value});
+			}
+		}
+	}
+	return results;
+}
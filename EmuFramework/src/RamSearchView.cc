@@ -0,0 +1,173 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "RamSearchView"
+#include <emuframework/RamSearchView.hh>
+#include <emuframework/EmuApp.hh>
+#include <imagine/logger/logger.h>
+#include <cstdlib>
+#include "private.hh"
+
+// the search outlives the view so it can continue after going back to the game
+static RamSearch ramSearch{};
+static RamSearch::ValueType searchValueType{};
+static bool searchSigned{};
+
+RamSearchView::RamSearchView(ViewAttachParams attach):
+	TableView{"RAM Search", attach, item},
+	valueTypeItem
+	{
+		{"8-bit", [this]() { setValueType(RamSearch::ValueType::U8); }},
+		{"16-bit Little Endian", [this]() { setValueType(RamSearch::ValueType::U16LE); }},
+		{"16-bit Big Endian", [this]() { setValueType(RamSearch::ValueType::U16BE); }},
+		{"32-bit Little Endian", [this]() { setValueType(RamSearch::ValueType::U32LE); }},
+		{"32-bit Big Endian", [this]() { setValueType(RamSearch::ValueType::U32BE); }},
+	},
+	valueType
+	{
+		"Value Type",
+		(int)searchValueType,
+		valueTypeItem
+	},
+	signedValues
+	{
+		"Signed Values",
+		searchSigned,
+		[this]()
+		{
+			searchSigned = signedValues.flipBoolValue(*this);
+			ramSearch.setSigned(searchSigned);
+			refreshItems();
+		}
+	},
+	newSearch
+	{
+		"Start New Search",
+		[this]()
+		{
+			EmuApp::syncEmulationThread();
+			ramSearch.setSigned(searchSigned);
+			if(!ramSearch.start(searchValueType))
+			{
+				EmuApp::postErrorMessage("No RAM to search");
+				return;
+			}
+			refreshItems();
+		}
+	},
+	equal{"Equal To Value", [this](Input::Event e) { search(RamSearch::Compare::EQUAL, e); }},
+	notEqual{"Not Equal To Value", [this](Input::Event e) { search(RamSearch::Compare::NOT_EQUAL, e); }},
+	less{"Less Than Value", [this](Input::Event e) { search(RamSearch::Compare::LESS, e); }},
+	greater{"Greater Than Value", [this](Input::Event e) { search(RamSearch::Compare::GREATER, e); }},
+	unchanged{"Unchanged", [this](Input::Event e) { search(RamSearch::Compare::UNCHANGED, e); }},
+	changed{"Changed", [this](Input::Event e) { search(RamSearch::Compare::CHANGED, e); }},
+	decreased{"Decreased", [this](Input::Event e) { search(RamSearch::Compare::DECREASED, e); }},
+	increased{"Increased", [this](Input::Event e) { search(RamSearch::Compare::INCREASED, e); }},
+	changedBy{"Changed By Value", [this](Input::Event e) { search(RamSearch::Compare::CHANGED_BY, e); }}
+{
+	loadItems();
+}
+
+void RamSearchView::search(RamSearch::Compare op, Input::Event e)
+{
+	if(!ramSearch.isActive())
+		return;
+	if(!RamSearch::comparesToValue(op))
+	{
+		runSearch(op, 0);
+		return;
+	}
+	EmuApp::pushAndShowNewCollectValueInputView<const char*>(attachParams(), e,
+		"Input value (prefix hex with 0x)", "",
+		[this, op](auto str)
+		{
+			char *end;
+			auto value = strtoll(str, &end, 0);
+			if(end == str || *end)
+			{
+				EmuApp::postErrorMessage("Enter a number");
+				return false;
+			}
+			runSearch(op, value);
+			return true;
+		});
+}
+
+void RamSearchView::runSearch(RamSearch::Compare op, uint32_t value)
+{
+	EmuApp::syncEmulationThread();
+	if(!ramSearch.search(op, value))
+	{
+		EmuApp::postErrorMessage("Game changed, start a new search");
+	}
+	refreshItems();
+}
+
+void RamSearchView::setValueType(RamSearch::ValueType type)
+{
+	searchValueType = type;
+	if(ramSearch.isActive() && ramSearch.valueType() != type)
+	{
+		ramSearch.clear();
+		refreshItems();
+	}
+}
+
+void RamSearchView::loadItems()
+{
+	bool active = ramSearch.isActive();
+	for(auto i : {&equal, &notEqual, &less, &greater, &unchanged, &changed, &decreased, &increased, &changedBy})
+	{
+		i->setActive(active);
+	}
+	result.clear();
+	if(active)
+	{
+		auto count = ramSearch.count();
+		auto results = ramSearch.results(MAX_RESULTS);
+		resultsHeading.setName(count > results.size() ?
+			string_makePrintf<64>("%zu Results (showing %zu)", count, results.size()).data() :
+			string_makePrintf<64>("%zu Results", count).data());
+		auto size = RamSearch::valueSize(ramSearch.valueType());
+		result.reserve(results.size());
+		for(const auto &r : results)
+		{
+			long long value = searchSigned ? (int32_t)(r.value << (32 - size * 8)) >> (32 - size * 8) : r.value;
+			result.emplace_back(string_makePrintf<64>("%s %08X: %lld (0x%0*X)",
+				r.regionName, r.address, value, (int)size * 2, r.value).data(), nullptr);
+		}
+	}
+	else
+	{
+		resultsHeading.setName("Start a search to see results");
+	}
+	item.clear();
+	item.insert(item.end(), {&valueType, &signedValues, &newSearch,
+		&valueHeading, &equal, &notEqual, &less, &greater,
+		&lastHeading, &unchanged, &changed, &decreased, &increased, &changedBy,
+		&resultsHeading});
+	for(auto &r : result)
+	{
+		item.emplace_back(&r);
+	}
+}
+
+void RamSearchView::refreshItems()
+{
+	auto selectedCell = selected;
+	loadItems();
+	highlightCell(std::min(selectedCell, (int)item.size() - 1));
+	place();
+}
@@ -149,6 +149,15 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 			optionConfirmOverwriteState = item.flipBoolValue(*this);
 		}
 	},
+	bootSnapshots
+	{
+		"Fast Boot Snapshots",
+		(bool)optionBootSnapshots,
+		[this](BoolMenuItem &item, Input::Event e)
+		{
+			optionBootSnapshots = item.flipBoolValue(*this);
+		}
+	},
 	savePath
 	{
 		nullptr,
@@ -207,13 +216,14 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 		{"5x", [this]() { optionFastForwardSpeed = 5; }},
 		{"6x", [this]() { optionFastForwardSpeed = 6; }},
 		{"7x", [this]() { optionFastForwardSpeed = 7; }},
+		{"Max", [this]() { optionFastForwardSpeed = MAX_SPEED_FAST_FORWARD; }},
 	},
 	fastForwardSpeed
 	{
 		"Fast Forward Speed",
 		[]() -> int
 		{
-			if(optionFastForwardSpeed >= MIN_FAST_FORWARD_SPEED && optionFastForwardSpeed <= 7)
+			if(optionFastForwardSpeed >= MIN_FAST_FORWARD_SPEED && optionFastForwardSpeed <= MAX_SPEED_FAST_FORWARD)
 			{
 				return optionFastForwardSpeed - MIN_FAST_FORWARD_SPEED;
 			}
@@ -245,6 +255,8 @@ void SystemOptionView::loadStockItems()
 	item.emplace_back(&autoSaveState);
 	item.emplace_back(&confirmAutoLoadState);
 	item.emplace_back(&confirmOverwriteState);
+	if(EmuSystem::hasBootSnapshots)
+		item.emplace_back(&bootSnapshots);
 	savePath.setName(makePathMenuEntryStr(optionSavePath).data());
 	item.emplace_back(&savePath);
 	item.emplace_back(&checkSavePathWriteAccess);
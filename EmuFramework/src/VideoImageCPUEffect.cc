@@ -0,0 +1,564 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "CPUEffect"
+#include <emuframework/VideoImageCPUEffect.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/thread/ThreadPool.hh>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+static constexpr int bandLines = 16;
+static constexpr unsigned maxThreads = 4;
+
+void VideoImageCPUEffect::setEffect(uint8_t effect)
+{
+	if(effect >= LAST_EFFECT_VAL)
+		effect = NO_EFFECT;
+	if(effect == effect_)
+		return;
+	effect_ = effect;
+	logMsg("set effect:%d", effect);
+	if(effect == NO_EFFECT)
+	{
+		srcBuffer = {};
+	}
+	if(effect != HQ2X)
+	{
+		hq2xColor = {};
+		hq2xYUV = {};
+		hq2xPattern = {};
+	}
+}
+
+bool VideoImageCPUEffect::formatIsSupported(IG::PixelFormat format)
+{
+	switch(format.id())
+	{
+		case IG::PIXEL_RGB565:
+		case IG::PIXEL_RGBA8888:
+		case IG::PIXEL_BGRA8888:
+		case IG::PIXEL_RGBX8888:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool VideoImageCPUEffect::isActive(IG::PixmapDesc srcDesc) const
+{
+	return effect_ != NO_EFFECT && formatIsSupported(srcDesc.format());
+}
+
+IG::WP VideoImageCPUEffect::scale() const
+{
+	return effect_ == NO_EFFECT ? IG::WP{1, 1} : IG::WP{2, 2};
+}
+
+IG::PixmapDesc VideoImageCPUEffect::outputDesc(IG::PixmapDesc srcDesc) const
+{
+	if(!isActive(srcDesc))
+		return srcDesc;
+	return {srcDesc.size() * scale(), srcDesc.format()};
+}
+
+IG::Pixmap VideoImageCPUEffect::inputBuffer(IG::PixmapDesc srcDesc)
+{
+	if(!srcBuffer || (IG::PixmapDesc)srcBuffer != srcDesc)
+	{
+		logMsg("allocating %dx%d input buffer", srcDesc.w(), srcDesc.h());
+		srcBuffer = {srcDesc};
+	}
+	return srcBuffer.view();
+}
+
+void VideoImageCPUEffect::render(IG::Pixmap dest, IG::Pixmap src)
+{
+	assumeExpr(dest.format() == src.format());
+	assumeExpr(dest.size() == outputDesc(src).size());
+	destPix = dest;
+	srcPix = src;
+	unsigned bands = (src.h() + bandLines - 1) / bandLines;
+	if(effect_ == HQ2X)
+		allocHq2xBuffers(src.w(), bands);
+	IG::ThreadPool::shared().parallelFor(0, bands,
+		[this](unsigned b)
+		{
+			int y = b * bandLines;
+			renderBand(b, y, std::min(y + bandLines, (int)srcPix.h()));
+		}, maxThreads);
+}
+
+template <class T>
+static const T *srcLine(IG::Pixmap src, int y)
+{
+	y = std::clamp(y, 0, (int)src.h() - 1);
+	return (const T*)src.pixel({0, y});
+}
+
+template <class T>
+static T *destLine(IG::Pixmap dest, int y)
+{
+	return (T*)dest.pixel({0, y});
+}
+
+// Scale2x (AdvanceMAME), same rules as scale2x-f.txt, written branch-free so the
+// inner loop auto-vectorizes
+
+template <class T>
+static void scale2xLine(T *__restrict out0, T *__restrict out1,
+	const T *__restrict up, const T *__restrict mid, const T *__restrict down, int w)
+{
+	auto pixel = [&](int x, T D, T F)
+	{
+		T E = mid[x], B = up[x], H = down[x];
+		bool c = B != H && D != F;
+		out0[x * 2]     = c && D == B ? D : E;
+		out0[x * 2 + 1] = c && B == F ? F : E;
+		out1[x * 2]     = c && D == H ? D : E;
+		out1[x * 2 + 1] = c && H == F ? F : E;
+	};
+	if(w == 1)
+	{
+		pixel(0, mid[0], mid[0]);
+		return;
+	}
+	pixel(0, mid[0], mid[1]);
+	for(int x = 1; x < w - 1; x++)
+	{
+		pixel(x, mid[x - 1], mid[x + 1]);
+	}
+	pixel(w - 1, mid[w - 2], mid[w - 1]);
+}
+
+template <class T>
+static void prescale2xLine(T *__restrict out0, T *__restrict out1, const T *__restrict mid, int w)
+{
+	for(int x = 0; x < w; x++)
+	{
+		out0[x * 2] = out0[x * 2 + 1] = mid[x];
+	}
+	std::copy_n(out0, w * 2, out1);
+}
+
+// hq2x (MaxSt) using the same integer blends and pattern rules as
+// GBC.emu's vfilters/maxsthq2x.cpp, with its 256 case switch turned into a table.
+// Colors are handled as 0x00CCGGCC with green in the middle byte, the filter
+// treats the other two channels the same so their order doesn't matter.
+
+// each entry has one nibble per field: condition, rule if it's true, rule if false,
+// conditions 0-3 are the edge tests below and 4 always uses the first rule
+static const uint16_t hq2xRules[256][4]
+{
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x455, 0x444, 0x444}, {0x422, 0x455, 0x444, 0x444},
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x433, 0x444, 0x444}, {0x422, 0x433, 0x444, 0x444},
+	{0x455, 0x444, 0x466, 0x444}, {0x433, 0x444, 0x466, 0x444}, {0x014, 0x455, 0x466, 0x444}, {0x004, 0x455, 0x466, 0x444},
+	{0x455, 0x444, 0x466, 0x444}, {0x433, 0x444, 0x466, 0x444}, {0x01A, 0x038, 0x466, 0x444}, {0x00A, 0x038, 0x466, 0x444},
+	{0x444, 0x466, 0x444, 0x455}, {0x444, 0x466, 0x444, 0x455}, {0x466, 0x114, 0x444, 0x455}, {0x127, 0x11A, 0x444, 0x455},
+	{0x444, 0x422, 0x444, 0x455}, {0x444, 0x422, 0x444, 0x455}, {0x466, 0x104, 0x444, 0x455}, {0x127, 0x10A, 0x444, 0x455},
+	{0x455, 0x466, 0x466, 0x455}, {0x433, 0x466, 0x466, 0x455}, {0x004, 0x104, 0x466, 0x455}, {0x004, 0x411, 0x466, 0x455},
+	{0x455, 0x422, 0x466, 0x455}, {0x433, 0x422, 0x466, 0x455}, {0x411, 0x104, 0x466, 0x455}, {0x004, 0x104, 0x466, 0x455},
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x455, 0x444, 0x444}, {0x422, 0x455, 0x444, 0x444},
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x433, 0x444, 0x444}, {0x422, 0x433, 0x444, 0x444},
+	{0x455, 0x444, 0x422, 0x444}, {0x433, 0x444, 0x422, 0x444}, {0x01A, 0x455, 0x027, 0x444}, {0x00A, 0x455, 0x027, 0x444},
+	{0x455, 0x444, 0x422, 0x444}, {0x433, 0x444, 0x422, 0x444}, {0x019, 0x433, 0x422, 0x444}, {0x00B, 0x433, 0x422, 0x444},
+	{0x444, 0x466, 0x444, 0x455}, {0x444, 0x466, 0x444, 0x455}, {0x466, 0x114, 0x444, 0x455}, {0x127, 0x11A, 0x444, 0x455},
+	{0x444, 0x422, 0x444, 0x455}, {0x444, 0x422, 0x444, 0x455}, {0x466, 0x104, 0x444, 0x455}, {0x127, 0x10A, 0x444, 0x455},
+	{0x455, 0x466, 0x422, 0x455}, {0x433, 0x466, 0x422, 0x455}, {0x019, 0x119, 0x422, 0x455}, {0x004, 0x119, 0x422, 0x455},
+	{0x455, 0x422, 0x422, 0x455}, {0x433, 0x422, 0x422, 0x455}, {0x411, 0x104, 0x422, 0x455}, {0x00B, 0x104, 0x422, 0x455},
+	{0x444, 0x444, 0x455, 0x466}, {0x444, 0x444, 0x455, 0x466}, {0x466, 0x455, 0x455, 0x466}, {0x422, 0x455, 0x455, 0x466},
+	{0x444, 0x444, 0x455, 0x466}, {0x444, 0x444, 0x455, 0x466}, {0x466, 0x433, 0x455, 0x466}, {0x422, 0x433, 0x455, 0x466},
+	{0x455, 0x444, 0x214, 0x466}, {0x238, 0x444, 0x21A, 0x466}, {0x004, 0x455, 0x204, 0x466}, {0x004, 0x455, 0x411, 0x466},
+	{0x455, 0x444, 0x214, 0x466}, {0x238, 0x444, 0x21A, 0x466}, {0x019, 0x433, 0x219, 0x466}, {0x004, 0x433, 0x219, 0x466},
+	{0x444, 0x466, 0x455, 0x314}, {0x444, 0x466, 0x455, 0x314}, {0x466, 0x104, 0x455, 0x304}, {0x422, 0x119, 0x455, 0x319},
+	{0x444, 0x327, 0x455, 0x31A}, {0x444, 0x327, 0x455, 0x31A}, {0x466, 0x104, 0x455, 0x411}, {0x422, 0x104, 0x455, 0x319},
+	{0x455, 0x466, 0x204, 0x304}, {0x433, 0x466, 0x219, 0x319}, {0x019, 0x119, 0x219, 0x319}, {0x004, 0x119, 0x219, 0x319},
+	{0x455, 0x422, 0x219, 0x319}, {0x433, 0x422, 0x219, 0x319}, {0x019, 0x104, 0x219, 0x319}, {0x004, 0x104, 0x411, 0x411},
+	{0x444, 0x444, 0x433, 0x466}, {0x444, 0x444, 0x433, 0x466}, {0x466, 0x455, 0x433, 0x466}, {0x422, 0x455, 0x433, 0x466},
+	{0x444, 0x444, 0x433, 0x466}, {0x444, 0x444, 0x433, 0x466}, {0x466, 0x433, 0x433, 0x466}, {0x422, 0x433, 0x433, 0x466},
+	{0x455, 0x444, 0x204, 0x466}, {0x238, 0x444, 0x20A, 0x466}, {0x411, 0x455, 0x204, 0x466}, {0x004, 0x455, 0x204, 0x466},
+	{0x455, 0x444, 0x204, 0x466}, {0x238, 0x444, 0x20A, 0x466}, {0x411, 0x433, 0x204, 0x466}, {0x00B, 0x433, 0x204, 0x466},
+	{0x444, 0x466, 0x338, 0x31A}, {0x444, 0x466, 0x338, 0x31A}, {0x466, 0x119, 0x433, 0x319}, {0x422, 0x119, 0x433, 0x319},
+	{0x444, 0x422, 0x433, 0x319}, {0x444, 0x422, 0x433, 0x319}, {0x466, 0x104, 0x433, 0x411}, {0x127, 0x10A, 0x433, 0x411},
+	{0x455, 0x466, 0x204, 0x411}, {0x433, 0x466, 0x204, 0x319}, {0x019, 0x119, 0x204, 0x319}, {0x004, 0x411, 0x204, 0x411},
+	{0x455, 0x422, 0x204, 0x411}, {0x238, 0x422, 0x20A, 0x411}, {0x411, 0x104, 0x204, 0x411}, {0x00B, 0x104, 0x204, 0x411},
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x455, 0x444, 0x444}, {0x422, 0x455, 0x444, 0x444},
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x433, 0x444, 0x444}, {0x422, 0x433, 0x444, 0x444},
+	{0x455, 0x444, 0x466, 0x444}, {0x433, 0x444, 0x466, 0x444}, {0x014, 0x455, 0x466, 0x444}, {0x004, 0x455, 0x466, 0x444},
+	{0x455, 0x444, 0x466, 0x444}, {0x433, 0x444, 0x466, 0x444}, {0x01A, 0x038, 0x466, 0x444}, {0x00A, 0x038, 0x466, 0x444},
+	{0x444, 0x466, 0x444, 0x433}, {0x444, 0x466, 0x444, 0x433}, {0x466, 0x11A, 0x444, 0x138}, {0x422, 0x119, 0x444, 0x433},
+	{0x444, 0x422, 0x444, 0x433}, {0x444, 0x422, 0x444, 0x433}, {0x466, 0x10A, 0x444, 0x138}, {0x422, 0x10B, 0x444, 0x433},
+	{0x455, 0x466, 0x466, 0x433}, {0x433, 0x466, 0x466, 0x433}, {0x019, 0x119, 0x466, 0x433}, {0x004, 0x411, 0x466, 0x433},
+	{0x455, 0x422, 0x466, 0x433}, {0x433, 0x422, 0x466, 0x433}, {0x019, 0x104, 0x466, 0x433}, {0x004, 0x10B, 0x466, 0x433},
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x455, 0x444, 0x444}, {0x422, 0x455, 0x444, 0x444},
+	{0x444, 0x444, 0x444, 0x444}, {0x444, 0x444, 0x444, 0x444}, {0x466, 0x433, 0x444, 0x444}, {0x422, 0x433, 0x444, 0x444},
+	{0x455, 0x444, 0x422, 0x444}, {0x433, 0x444, 0x422, 0x444}, {0x01A, 0x455, 0x027, 0x444}, {0x00A, 0x455, 0x027, 0x444},
+	{0x455, 0x444, 0x422, 0x444}, {0x433, 0x444, 0x422, 0x444}, {0x019, 0x433, 0x422, 0x444}, {0x00B, 0x433, 0x422, 0x444},
+	{0x444, 0x466, 0x444, 0x433}, {0x444, 0x466, 0x444, 0x433}, {0x466, 0x11A, 0x444, 0x138}, {0x422, 0x119, 0x444, 0x433},
+	{0x444, 0x422, 0x444, 0x433}, {0x444, 0x422, 0x444, 0x433}, {0x466, 0x10A, 0x444, 0x138}, {0x422, 0x10B, 0x444, 0x433},
+	{0x455, 0x466, 0x422, 0x433}, {0x433, 0x466, 0x422, 0x433}, {0x019, 0x119, 0x422, 0x433}, {0x00A, 0x411, 0x027, 0x433},
+	{0x455, 0x422, 0x422, 0x433}, {0x433, 0x422, 0x422, 0x433}, {0x411, 0x10A, 0x422, 0x138}, {0x00B, 0x10B, 0x422, 0x433},
+	{0x444, 0x444, 0x455, 0x422}, {0x444, 0x444, 0x455, 0x422}, {0x466, 0x455, 0x455, 0x422}, {0x422, 0x455, 0x455, 0x422},
+	{0x444, 0x444, 0x455, 0x422}, {0x444, 0x444, 0x455, 0x422}, {0x466, 0x433, 0x455, 0x422}, {0x422, 0x433, 0x455, 0x422},
+	{0x455, 0x444, 0x21A, 0x227}, {0x433, 0x444, 0x219, 0x422}, {0x019, 0x455, 0x219, 0x422}, {0x004, 0x455, 0x411, 0x422},
+	{0x455, 0x444, 0x21A, 0x227}, {0x433, 0x444, 0x219, 0x422}, {0x019, 0x433, 0x219, 0x422}, {0x00A, 0x038, 0x411, 0x422},
+	{0x444, 0x466, 0x455, 0x304}, {0x444, 0x466, 0x455, 0x304}, {0x466, 0x411, 0x455, 0x304}, {0x422, 0x411, 0x455, 0x304},
+	{0x444, 0x327, 0x455, 0x30A}, {0x444, 0x327, 0x455, 0x30A}, {0x466, 0x104, 0x455, 0x304}, {0x422, 0x10B, 0x455, 0x304},
+	{0x455, 0x466, 0x411, 0x304}, {0x433, 0x466, 0x411, 0x304}, {0x019, 0x119, 0x219, 0x304}, {0x004, 0x411, 0x411, 0x304},
+	{0x455, 0x422, 0x219, 0x304}, {0x433, 0x327, 0x411, 0x30A}, {0x411, 0x104, 0x411, 0x304}, {0x004, 0x10B, 0x411, 0x304},
+	{0x444, 0x444, 0x433, 0x422}, {0x444, 0x444, 0x433, 0x422}, {0x466, 0x455, 0x433, 0x422}, {0x422, 0x455, 0x433, 0x422},
+	{0x444, 0x444, 0x433, 0x422}, {0x444, 0x444, 0x433, 0x422}, {0x466, 0x433, 0x433, 0x422}, {0x422, 0x433, 0x433, 0x422},
+	{0x455, 0x444, 0x20A, 0x227}, {0x433, 0x444, 0x20B, 0x422}, {0x019, 0x455, 0x204, 0x422}, {0x004, 0x455, 0x20B, 0x422},
+	{0x455, 0x444, 0x20A, 0x227}, {0x433, 0x444, 0x20B, 0x422}, {0x411, 0x433, 0x20A, 0x227}, {0x00B, 0x433, 0x20B, 0x422},
+	{0x444, 0x466, 0x338, 0x30A}, {0x444, 0x466, 0x338, 0x30A}, {0x466, 0x119, 0x433, 0x304}, {0x422, 0x411, 0x338, 0x30A},
+	{0x444, 0x422, 0x433, 0x30B}, {0x444, 0x422, 0x433, 0x30B}, {0x466, 0x104, 0x433, 0x30B}, {0x422, 0x10B, 0x433, 0x30B},
+	{0x455, 0x466, 0x204, 0x304}, {0x433, 0x466, 0x20B, 0x304}, {0x411, 0x411, 0x204, 0x304}, {0x004, 0x411, 0x20B, 0x304},
+	{0x455, 0x422, 0x204, 0x30B}, {0x433, 0x422, 0x20B, 0x30B}, {0x411, 0x104, 0x204, 0x30B}, {0x00B, 0x10B, 0x20B, 0x30B},
+};
+
+enum Hq2xFlags : uint16_t
+{
+	// set when the two edge neighbors next to each output pixel differ
+	HQ2X_DIFF_42 = 1 << 8, // top-left
+	HQ2X_DIFF_26 = 1 << 9, // top-right
+	HQ2X_DIFF_84 = 1 << 10, // bottom-left
+	HQ2X_DIFF_68 = 1 << 11, // bottom-right
+};
+
+static uint32_t hq2xBlend1(uint32_t c1, uint32_t c2)
+{
+	uint32_t lowbits = ((c1 & 0x030303) * 3 + (c2 & 0x030303)) & 0x030303;
+	return (c1 * 3 + c2 - lowbits) >> 2;
+}
+
+static uint32_t hq2xBlend2(uint32_t c1, uint32_t c2, uint32_t c3)
+{
+	uint32_t lowbits = ((c1 & 0x030303) * 2 + (c2 & 0x030303) + (c3 & 0x030303)) & 0x030303;
+	return (c1 * 2 + c2 + c3 - lowbits) >> 2;
+}
+
+static uint32_t hq2xBlend6(uint32_t c1, uint32_t c2, uint32_t c3)
+{
+	uint32_t lowbits = ((c1 & 0x070707) * 5 + (c2 & 0x070707) * 2 + (c3 & 0x070707)) & 0x070707;
+	return (c1 * 5 + c2 * 2 + c3 - lowbits) >> 3;
+}
+
+static uint32_t hq2xBlend7(uint32_t c1, uint32_t c2, uint32_t c3)
+{
+	uint32_t lowbits = ((c1 & 0x070707) * 6 + (c2 & 0x070707) + (c3 & 0x070707)) & 0x070707;
+	return (c1 * 6 + c2 + c3 - lowbits) >> 3;
+}
+
+static uint32_t hq2xBlend9(uint32_t c1, uint32_t c2, uint32_t c3)
+{
+	uint32_t lowbits = ((c1 & 0x070707) * 2 + ((c2 & 0x070707) + (c3 & 0x070707)) * 3) & 0x070707;
+	return (c1 * 2 + (c2 + c3) * 3 - lowbits) >> 3;
+}
+
+static uint32_t hq2xBlend10(uint32_t c1, uint32_t c2, uint32_t c3)
+{
+	uint32_t lowbits = ((c1 & 0x0F0F0F) * 14 + (c2 & 0x0F0F0F) + (c3 & 0x0F0F0F)) & 0x0F0F0F;
+	return (c1 * 14 + c2 + c3 - lowbits) >> 4;
+}
+
+// e is the center pixel, a and b the two edge neighbors next to the output pixel
+// and c the corner one, in the argument order of the PIXEL00_ rules
+static uint32_t hq2xBlend(unsigned rule, uint32_t e, uint32_t a, uint32_t b, uint32_t c)
+{
+	switch(rule)
+	{
+		default: return e;
+		case 1: return hq2xBlend1(e, c);
+		case 2: return hq2xBlend1(e, a);
+		case 3: return hq2xBlend1(e, b);
+		case 4: return hq2xBlend2(e, a, b);
+		case 5: return hq2xBlend2(e, c, b);
+		case 6: return hq2xBlend2(e, c, a);
+		case 7: return hq2xBlend6(e, b, a);
+		case 8: return hq2xBlend6(e, a, b);
+		case 9: return hq2xBlend7(e, a, b);
+		case 10: return hq2xBlend9(e, a, b);
+		case 11: return hq2xBlend10(e, a, b);
+	}
+}
+
+// Source line converted for the filter, padded with a copy of the edge pixel on
+// each side. The y/u/v values are the luma and chroma terms of maxsthq2x.cpp's
+// color difference test, two colors differ when any term is above its threshold.
+// one source line with a pixel of padding on each side, the arrays point into
+// the effect's per-band buffers
+struct Hq2xLine
+{
+	uint32_t *color;
+	int16_t *y, *u, *v;
+
+	Hq2xLine(uint32_t *color, int16_t *yuv, int w):
+		color{color}, y{yuv}, u{yuv + w + 2}, v{yuv + (w + 2) * 2} {}
+
+	template <class T>
+	void load(const T *src, int w)
+	{
+		for(int x = 0; x < w; x++)
+		{
+			uint32_t c = toHq2xColor(src[x]);
+			int c0 = c & 0xFF, g = (c >> 8) & 0xFF, c2 = c >> 16;
+			color[x + 1] = c;
+			y[x + 1] = c0 + g + c2;
+			u[x + 1] = c2 - c0;
+			v[x + 1] = g * 2 - c0 - c2;
+		}
+		for(auto *a : {&y, &u, &v})
+		{
+			(*a)[0] = (*a)[1];
+			(*a)[w + 1] = (*a)[w];
+		}
+		color[0] = color[1];
+		color[w + 1] = color[w];
+	}
+
+	static uint32_t toHq2xColor(uint16_t p)
+	{
+		uint32_t r = p >> 11, g = (p >> 5) & 0x3F, b = p & 0x1F;
+		return ((r << 3) | (r >> 2)) << 16 | ((g << 2) | (g >> 4)) << 8 | ((b << 3) | (b >> 2));
+	}
+
+	static uint32_t toHq2xColor(uint32_t p) { return p & 0xFFFFFF; }
+};
+
+static uint16_t fromHq2xColor(uint32_t c, uint16_t)
+{
+	return (c >> 19) << 11 | ((c >> 10) & 0x3F) << 5 | ((c >> 3) & 0x1F);
+}
+
+static uint32_t fromHq2xColor(uint32_t c, uint32_t)
+{
+	return c | 0xFF000000;
+}
+
+static const int16_t hq2xThreshold[3]{0xC0, 0x1C, 0x30};
+
+static bool hq2xDiff(const Hq2xLine &l1, int x1, const Hq2xLine &l2, int x2)
+{
+	return std::abs(l1.y[x1] - l2.y[x2]) > hq2xThreshold[0]
+		|| std::abs(l1.u[x1] - l2.u[x2]) > hq2xThreshold[1]
+		|| std::abs(l1.v[x1] - l2.v[x2]) > hq2xThreshold[2];
+}
+
+// pattern bits of the 8 neighbors as in maxsthq2x.cpp plus the Hq2xFlags,
+// x is the padded index of the center pixel
+static uint16_t hq2xPattern(const Hq2xLine &up, const Hq2xLine &mid, const Hq2xLine &down, int x)
+{
+	return hq2xDiff(mid, x, up, x - 1)
+		| hq2xDiff(mid, x, up, x) << 1
+		| hq2xDiff(mid, x, up, x + 1) << 2
+		| hq2xDiff(mid, x, mid, x - 1) << 3
+		| hq2xDiff(mid, x, mid, x + 1) << 4
+		| hq2xDiff(mid, x, down, x - 1) << 5
+		| hq2xDiff(mid, x, down, x) << 6
+		| hq2xDiff(mid, x, down, x + 1) << 7
+		| hq2xDiff(mid, x - 1, up, x) << 8
+		| hq2xDiff(up, x, mid, x + 1) << 9
+		| hq2xDiff(down, x, mid, x - 1) << 10
+		| hq2xDiff(mid, x + 1, down, x) << 11;
+}
+
+#if defined __SSE2__ || defined __ARM_NEON
+// the same tests for 8 pixels at once on the y/u/v terms
+#if defined __SSE2__
+using Hq2xVec = __m128i;
+
+static Hq2xVec hq2xLoad(const int16_t *p) { return _mm_loadu_si128((const __m128i*)p); }
+
+static Hq2xVec hq2xDiffTerm(Hq2xVec a, Hq2xVec b, int16_t threshold)
+{
+	auto d = _mm_sub_epi16(a, b);
+	auto absD = _mm_max_epi16(d, _mm_sub_epi16(_mm_setzero_si128(), d));
+	return _mm_cmpgt_epi16(absD, _mm_set1_epi16(threshold));
+}
+
+static Hq2xVec hq2xOr(Hq2xVec a, Hq2xVec b) { return _mm_or_si128(a, b); }
+
+static Hq2xVec hq2xBit(Hq2xVec mask, uint16_t bit) { return _mm_and_si128(mask, _mm_set1_epi16(bit)); }
+
+static void hq2xStore(uint16_t *dest, Hq2xVec v) { _mm_storeu_si128((__m128i*)dest, v); }
+#else
+using Hq2xVec = int16x8_t;
+
+static Hq2xVec hq2xLoad(const int16_t *p) { return vld1q_s16(p); }
+
+static Hq2xVec hq2xDiffTerm(Hq2xVec a, Hq2xVec b, int16_t threshold)
+{
+	return vreinterpretq_s16_u16(vcgtq_s16(vabdq_s16(a, b), vdupq_n_s16(threshold)));
+}
+
+static Hq2xVec hq2xOr(Hq2xVec a, Hq2xVec b) { return vorrq_s16(a, b); }
+
+static Hq2xVec hq2xBit(Hq2xVec mask, uint16_t bit) { return vandq_s16(mask, vdupq_n_s16(bit)); }
+
+static void hq2xStore(uint16_t *dest, Hq2xVec v) { vst1q_u16(dest, vreinterpretq_u16_s16(v)); }
+#endif
+
+static Hq2xVec hq2xDiffVec(const Hq2xLine &l1, int x1, const Hq2xLine &l2, int x2)
+{
+	auto diff = hq2xDiffTerm(hq2xLoad(&l1.y[x1]), hq2xLoad(&l2.y[x2]), hq2xThreshold[0]);
+	diff = hq2xOr(diff, hq2xDiffTerm(hq2xLoad(&l1.u[x1]), hq2xLoad(&l2.u[x2]), hq2xThreshold[1]));
+	return hq2xOr(diff, hq2xDiffTerm(hq2xLoad(&l1.v[x1]), hq2xLoad(&l2.v[x2]), hq2xThreshold[2]));
+}
+
+static void hq2xPatterns8(uint16_t *pattern, const Hq2xLine &up, const Hq2xLine &mid, const Hq2xLine &down, int x)
+{
+	auto p = hq2xBit(hq2xDiffVec(mid, x, up, x - 1), 1);
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x, up, x), 1 << 1));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x, up, x + 1), 1 << 2));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x, mid, x - 1), 1 << 3));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x, mid, x + 1), 1 << 4));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x, down, x - 1), 1 << 5));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x, down, x), 1 << 6));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x, down, x + 1), 1 << 7));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x - 1, up, x), HQ2X_DIFF_42));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(up, x, mid, x + 1), HQ2X_DIFF_26));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(down, x, mid, x - 1), HQ2X_DIFF_84));
+	p = hq2xOr(p, hq2xBit(hq2xDiffVec(mid, x + 1, down, x), HQ2X_DIFF_68));
+	hq2xStore(pattern, p);
+}
+#endif
+
+static void hq2xPatterns(uint16_t *pattern, const Hq2xLine &up, const Hq2xLine &mid, const Hq2xLine &down, int w)
+{
+	int x = 0;
+	#if defined __SSE2__ || defined __ARM_NEON
+	for(; x + 8 <= w; x += 8)
+	{
+		hq2xPatterns8(&pattern[x], up, mid, down, x + 1);
+	}
+	#endif
+	for(; x < w; x++)
+	{
+		pattern[x] = hq2xPattern(up, mid, down, x + 1);
+	}
+}
+
+template <class T>
+static void hq2xLine(T *out0, T *out1, const Hq2xLine &up, const Hq2xLine &mid, const Hq2xLine &down,
+	uint16_t *pattern, int w)
+{
+	hq2xPatterns(pattern, up, mid, down, w);
+	for(int x = 0; x < w; x++)
+	{
+		int i = x + 1;
+		uint32_t w1 = up.color[i - 1], w2 = up.color[i], w3 = up.color[i + 1],
+			w4 = mid.color[i - 1], w5 = mid.color[i], w6 = mid.color[i + 1],
+			w7 = down.color[i - 1], w8 = down.color[i], w9 = down.color[i + 1];
+		auto p = pattern[x];
+		auto &rules = hq2xRules[p & 0xFF];
+		auto pixel = [&](unsigned sub, uint32_t a, uint32_t b, uint32_t c)
+		{
+			unsigned entry = rules[sub];
+			unsigned cond = entry >> 8;
+			bool useFirst = cond == 4 || (p & (HQ2X_DIFF_42 << cond));
+			unsigned rule = useFirst ? (entry >> 4) & 0xF : entry & 0xF;
+			return fromHq2xColor(hq2xBlend(rule, w5, a, b, c), T{});
+		};
+		out0[x * 2]     = pixel(0, w4, w2, w1);
+		out0[x * 2 + 1] = pixel(1, w2, w6, w3);
+		out1[x * 2]     = pixel(2, w8, w4, w7);
+		out1[x * 2 + 1] = pixel(3, w6, w8, w9);
+	}
+}
+
+static constexpr size_t hq2xColorSize(int w) { return (w + 2) * 3; }
+static constexpr size_t hq2xYUVSize(int w) { return (w + 2) * 9; }
+
+template <class T>
+static void hq2xLines(IG::Pixmap dest, IG::Pixmap src, int srcY, int srcY2,
+	uint32_t *color, int16_t *yuv, uint16_t *pattern)
+{
+	int w = src.w();
+	Hq2xLine lines[3]
+	{
+		{color, yuv, w},
+		{color + (w + 2), yuv + (w + 2) * 3, w},
+		{color + (w + 2) * 2, yuv + (w + 2) * 6, w},
+	};
+	auto *up = &lines[0], *mid = &lines[1], *down = &lines[2];
+	up->load(srcLine<T>(src, srcY - 1), w);
+	mid->load(srcLine<T>(src, srcY), w);
+	for(int y = srcY; y < srcY2; y++)
+	{
+		down->load(srcLine<T>(src, y + 1), w);
+		hq2xLine(destLine<T>(dest, y * 2), destLine<T>(dest, y * 2 + 1), *up, *mid, *down, pattern, w);
+		std::swap(up, mid);
+		std::swap(mid, down);
+	}
+}
+
+template <class T>
+static void renderLines(uint8_t effect, IG::Pixmap dest, IG::Pixmap src, int srcY, int srcY2)
+{
+	int w = src.w();
+	for(int y = srcY; y < srcY2; y++)
+	{
+		auto up = srcLine<T>(src, y - 1);
+		auto mid = srcLine<T>(src, y);
+		auto down = srcLine<T>(src, y + 1);
+		auto out0 = destLine<T>(dest, y * 2);
+		auto out1 = destLine<T>(dest, y * 2 + 1);
+		switch(effect)
+		{
+			bcase VideoImageCPUEffect::SCALE2X: scale2xLine(out0, out1, up, mid, down, w);
+			bcase VideoImageCPUEffect::PRESCALE2X: prescale2xLine(out0, out1, mid, w);
+		}
+	}
+}
+
+void VideoImageCPUEffect::renderBand(unsigned band, int srcY, int srcY2)
+{
+	int w = srcPix.w();
+	if(effect_ == HQ2X)
+	{
+		auto color = &hq2xColor[hq2xColorSize(w) * band];
+		auto yuv = &hq2xYUV[hq2xYUVSize(w) * band];
+		auto pattern = &hq2xPattern[w * band];
+		if(srcPix.format().bytesPerPixel() == 2)
+			hq2xLines<uint16_t>(destPix, srcPix, srcY, srcY2, color, yuv, pattern);
+		else
+			hq2xLines<uint32_t>(destPix, srcPix, srcY, srcY2, color, yuv, pattern);
+	}
+	else
+	{
+		if(srcPix.format().bytesPerPixel() == 2)
+			renderLines<uint16_t>(effect_, destPix, srcPix, srcY, srcY2);
+		else
+			renderLines<uint32_t>(effect_, destPix, srcPix, srcY, srcY2);
+	}
+}
+
+void VideoImageCPUEffect::allocHq2xBuffers(int w, unsigned bands)
+{
+	if(hq2xColor.size() == hq2xColorSize(w) * bands && hq2xPattern.size() == (size_t)w * bands)
+		return;
+	logMsg("allocating hq2x buffers for %d pixel lines in %u bands", w, bands);
+	hq2xColor.resize(hq2xColorSize(w) * bands);
+	hq2xYUV.resize(hq2xYUVSize(w) * bands);
+	hq2xPattern.resize(w * bands);
+}
@@ -15,6 +15,7 @@
 
 #include <emuframework/VideoImageEffect.hh>
 #include <emuframework/EmuApp.hh>
+#include <emuframework/EmuVideo.hh>
 #include <imagine/io/FileIO.hh>
 #include <imagine/gfx/Renderer.hh>
 #include <imagine/gfx/RendererCommands.hh>
@@ -287,11 +288,18 @@ Gfx::Texture &VideoImageEffect::renderTarget()
 	return renderTarget_;
 }
 
-void VideoImageEffect::drawRenderTarget(Gfx::RendererCommands &cmds, const Gfx::Texture &img)
+void VideoImageEffect::drawRenderTarget(Gfx::RendererCommands &cmds, EmuVideo &video)
 {
 	auto viewport = Gfx::Viewport::makeFromRect({0, 0, (int)renderTargetImgSize.x, (int)renderTargetImgSize.y});
 	cmds.setViewport(viewport);
 	cmds.set(Gfx::CommonTextureSampler::NO_LINEAR_NO_MIP_CLAMP);
+	auto lineSpans = video.lineSpans();
+	if(lineSpans.size())
+	{
+		video.drawLineSpans(cmds, lineSpans, {-1., -1., 1., 1.}, {0., 1., 1., 0.});
+		return;
+	}
+	const Gfx::Texture &img = video.image();
 	Gfx::Sprite spr{{-1., -1., 1., 1.}, {&img, {0., 1., 1., 0.}}};
 	spr.draw(cmds);
 }
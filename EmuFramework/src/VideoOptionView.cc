@@ -17,6 +17,7 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuVideoLayer.hh>
 #include <emuframework/VideoImageEffect.hh>
+#include <emuframework/VideoImageCPUEffect.hh>
 #include "EmuOptions.hh"
 #include "private.hh"
 #include <imagine/base/Screen.hh>
@@ -215,6 +216,13 @@ static void setImgEffect(uint val, EmuVideoLayer &layer)
 }
 #endif
 
+static void setImgCPUEffect(uint val, EmuVideoLayer &layer)
+{
+	optionImgCPUEffect = val;
+	layer.emuVideo().setCPUEffect(val);
+	emuViewController().postDrawToEmuWindows();
+}
+
 static void setOverlayEffect(uint val, EmuVideoLayer &layer)
 {
 	optionOverlayEffect = val;
@@ -294,6 +302,15 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 			optionSkipLateFrames.val = item.flipBoolValue(*this);
 		}
 	},
+	frameDelay
+	{
+		"Adaptive Frame Delay",
+		(bool)optionFrameDelay,
+		[this](BoolMenuItem &item, Input::Event e)
+		{
+			optionFrameDelay.val = item.flipBoolValue(*this);
+		}
+	},
 	frameRate
 	{
 		nullptr,
@@ -467,6 +484,19 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 		imgEffectItem
 	},
 	#endif
+	imgCPUEffectItem
+	{
+		{"Off", [this]() { setImgCPUEffect(0, *videoLayer); }},
+		{"hq2x", [this]() { setImgCPUEffect(VideoImageCPUEffect::HQ2X, *videoLayer); }},
+		{"Scale2x", [this]() { setImgCPUEffect(VideoImageCPUEffect::SCALE2X, *videoLayer); }},
+		{"Prescale 2x", [this]() { setImgCPUEffect(VideoImageCPUEffect::PRESCALE2X, *videoLayer); }}
+	},
+	imgCPUEffect
+	{
+		"CPU Image Effect",
+		optionImgCPUEffect,
+		imgCPUEffectItem
+	},
 	overlayEffectItem
 	{
 		{"Off", [this]() { setOverlayEffect(0, *videoLayer); }},
@@ -741,6 +771,7 @@ void VideoOptionView::loadStockItems()
 	item.emplace_back(&frameInterval);
 	#endif
 	item.emplace_back(&dropLateFrames);
+	item.emplace_back(&frameDelay);
 	if(!optionFrameRate.isConst)
 	{
 		frameRate.setName(makeFrameRateStr().data());
@@ -756,6 +787,7 @@ void VideoOptionView::loadStockItems()
 	#ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
 	item.emplace_back(&imgEffect);
 	#endif
+	item.emplace_back(&imgCPUEffect);
 	item.emplace_back(&overlayEffect);
 	item.emplace_back(&overlayEffectLevel);
 	item.emplace_back(&screenShapeHeading);
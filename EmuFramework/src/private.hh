@@ -29,6 +29,7 @@
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
 #include "Recent.hh"
+#include "EmuTiming.hh"
 #include <memory>
 #include <atomic>
 
@@ -78,6 +79,8 @@ public:
 	void startMainViewportAnimation();
 	void updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames);
 	void clearEmuAudioStats();
+	void updateEmuFrameTraceStats(const FrameTrace::Stats &stats);
+	void clearEmuFrameTraceStats();
 	void closeSystem(bool allowAutosaveState = true);
 	void popToSystemActionsMenu();
 	void postDrawToEmuWindows();
@@ -119,6 +122,15 @@ protected:
 	[[no_unique_address]] IG::UseTypeIf<HAS_USE_RENDER_TIME, bool> useRendererTime_ = false;
 	uint8_t targetFastForwardSpeed = 0;
 	std::atomic_bool emuVideoInProgress{};
+	bool frameDelayActive = false;
+	EmuFrameDelay frameDelay{};
+	Base::Timer frameDelayTimer{"EmuViewController::frameDelayTimer"};
+	struct DelayedRunFrame
+	{
+		EmuAudio *audio{};
+		uint8_t frames{};
+		bool skipForward{};
+	} delayedRunFrame{};
 
 	void onFocusChange(uint in);
 	Base::OnFrameDelegate makeOnFrameDelayed(uint8_t delay);
@@ -164,6 +176,10 @@ bool hasGooglePlayStoreFeatures();
 void setCPUNeedsLowLatency(bool needed);
 void onMainMenuItemOptionChanged();
 void runBenchmarkOneShot();
+void loadBootSnapshot();
+void saveBootSnapshot();
+void cancelBootSnapshot();
+void runCmdLineBenchmark(const char *path, const char *statePath, uint32_t frames);
 void onSelectFileFromPicker(const char* name, Input::Event e, EmuSystemCreateParams params);
 void launchSystem(bool tryAutoState, bool addToRecent);
 Gfx::PixmapTexture &getAsset(Gfx::Renderer &r, AssetID assetID);
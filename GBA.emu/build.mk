@@ -28,6 +28,7 @@ gba/EEprom.cpp \
 gba/Flash.cpp \
 gba/GBA-arm.cpp \
 gba/GBA.cpp \
+gba/GBALocalLink.cpp \
 gba/gbafilter.cpp \
 gba/RTC.cpp \
 gba/Sound.cpp \
@@ -20,6 +20,7 @@
 #include "internal.hh"
 #include <vbam/gba/GBA.h>
 #include <vbam/gba/RTC.h>
+#include <vbam/gba/GBALocalLink.h>
 
 class ConsoleOptionView : public TableView
 {
@@ -69,6 +70,97 @@ public:
 	{}
 };
 
+class LinkView : public TableView
+{
+	TextHeadingMenuItem status{};
+
+	TextMenuItem connect
+	{
+		"Connect Second Console",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			EmuApp::syncEmulationThread();
+			localLinkStart(gGba, linkSavePath().data());
+			refreshStatus();
+			EmuApp::postMessage("Second console started with the same game");
+		}
+	};
+
+	TextMenuItem disconnect
+	{
+		"Disconnect",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			EmuApp::syncEmulationThread();
+			localLinkStop(linkSavePath().data());
+			refreshStatus();
+		}
+	};
+
+	TextMenuItem layoutItem[2]
+	{
+		{"Side by Side", [](){ linkScreenLayout = LINK_SCREEN_SIDE_BY_SIDE; }},
+		{"Picture in Picture", [](){ linkScreenLayout = LINK_SCREEN_PIP; }},
+	};
+
+	MultiChoiceMenuItem layout
+	{
+		"Screen Layout",
+		(int)linkScreenLayout,
+		layoutItem
+	};
+
+	BoolMenuItem controlPeer
+	{
+		"Control Second Console",
+		linkControlsPeer,
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			EmuApp::syncEmulationThread();
+			linkControlsPeer = item.flipBoolValue(*this);
+			// release any keys held on the console losing control
+			gGba.mem.ioMem.P1() = 0x03FF;
+			if(auto peer = localLinkPeer())
+			{
+				peer->mem.ioMem.P1() = 0x03FF;
+			}
+		}
+	};
+
+	std::array<MenuItem*, 5> menuItem
+	{
+		&status,
+		&connect,
+		&disconnect,
+		&layout,
+		&controlPeer,
+	};
+
+	void refreshStatus()
+	{
+		status.compile(localLinkIsActive() ? "Second console connected" : "Not connected", renderer(), projP);
+		connect.setActive(!localLinkIsActive());
+		disconnect.setActive(localLinkIsActive());
+	}
+
+public:
+	LinkView(ViewAttachParams attach):
+		TableView
+		{
+			"Link Cable",
+			attach,
+			menuItem
+		}
+	{}
+
+	void onShow() final
+	{
+		TableView::onShow();
+		EmuApp::syncEmulationThread();
+		refreshStatus();
+	}
+};
+
 class CustomSystemActionsView : public EmuSystemActionsView
 {
 	TextMenuItem options
@@ -83,10 +175,23 @@ class CustomSystemActionsView : public EmuSystemActionsView
 		}
 	};
 
+	TextMenuItem link
+	{
+		"Link Cable",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			if(EmuSystem::gameIsRunning())
+			{
+				pushAndShow(makeView<LinkView>(), e);
+			}
+		}
+	};
+
 public:
 	CustomSystemActionsView(ViewAttachParams attach): EmuSystemActionsView{attach, true}
 	{
 		item.emplace_back(&options);
+		item.emplace_back(&link);
 		loadStandardItems();
 	}
 };
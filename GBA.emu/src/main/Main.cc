@@ -23,6 +23,7 @@
 #include <vbam/gba/GBAGfx.h>
 #include <vbam/gba/Sound.h>
 #include <vbam/gba/RTC.h>
+#include <vbam/gba/GBALocalLink.h>
 #include <vbam/common/SoundDriver.h>
 #include <vbam/common/Patch.h>
 #include <vbam/Util.h>
@@ -36,9 +37,12 @@ bool CPUReadState(GBASys &gba, const char *);
 bool CPUWriteState(GBASys &gba, const char *);
 
 bool detectedRtcGame = 0;
+uint linkScreenLayout = LINK_SCREEN_SIDE_BY_SIDE;
+bool linkControlsPeer = false;
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2012-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nVBA-m Team\nvba-m.com";
 bool EmuSystem::hasBundledGames = true;
 bool EmuSystem::hasCheats = true;
+bool EmuSystem::hasRamSearch = true;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
@@ -86,6 +90,16 @@ void EmuSystem::reset(ResetMode mode)
 {
 	assert(gameIsRunning());
 	CPUReset(gGba);
+	localLinkReset();
+}
+
+std::vector<RamSearchRegion> EmuSystem::ramSearchRegions()
+{
+	return
+	{
+		{"EWRAM", gGba.mem.workRAM, sizeof(gGba.mem.workRAM), 0x2000000},
+		{"IWRAM", gGba.mem.internalRAM, sizeof(gGba.mem.internalRAM), 0x3000000},
+	};
 }
 
 FS::PathString EmuSystem::sprintStateFilename(int slot, const char *statePath, const char *gameName)
@@ -116,15 +130,25 @@ void EmuSystem::saveBackupMem()
 		logMsg("saving backup memory");
 		auto saveStr = FS::makePathStringPrintf("%s/%s.sav", savePath(), gameName().data());
 		CPUWriteBatteryFile(gGba, saveStr.data());
+		if(localLinkIsActive())
+		{
+			localLinkWritePeerBatteryFile(linkSavePath().data());
+		}
 		writeCheatFile();
 	}
 }
 
+FS::PathString linkSavePath()
+{
+	return FS::makePathStringPrintf("%s/%s-2.sav", EmuSystem::savePath(), EmuSystem::gameName().data());
+}
+
 void EmuSystem::closeSystem()
 {
 	assert(gameIsRunning());
 	logMsg("closing game %s", gameName().data());
 	saveBackupMem();
+	localLinkStop(nullptr);
 	CPUCleanUp();
 	detectedRtcGame = 0;
 	cheatsNumber = 0; // reset cheat list
@@ -191,21 +215,67 @@ void EmuSystem::onPrepareVideo(EmuVideo &video)
 	video.setFormat({{240, 160}, pixFmt});
 }
 
-void systemDrawScreen(EmuSystemTask *task, EmuVideo &video)
+static IG::Pixmap lcdPixmap(GBASys &gba)
+{
+	return {{{240, 160}, IG::PIXEL_RGB565}, gba.lcd.pix};
+}
+
+static void writeScreen(IG::Pixmap dest, IG::Pixmap framePix)
 {
-	auto img = video.startFrame(task);
-	IG::Pixmap framePix{{{240, 160}, IG::PIXEL_RGB565}, gGba.lcd.pix};
 	if(!directColorLookup)
 	{
-		img.pixmap().writeTransformed([](uint16_t p){ return systemColorMap.map16[p]; }, framePix);
+		dest.writeTransformed([](uint16_t p){ return systemColorMap.map16[p]; }, framePix);
 	}
 	else
 	{
-		img.pixmap().write(framePix);
+		dest.write(framePix);
 	}
+}
+
+// point samples framePix to half size
+static void writeHalfScreen(IG::Pixmap dest, IG::Pixmap framePix)
+{
+	for(int y = 0; y < (int)dest.h(); y++)
+	{
+		auto srcLine = (uint16_t*)framePix.pixel({0, y * 2});
+		auto destLine = (uint16_t*)dest.pixel({0, y});
+		for(int x = 0; x < (int)dest.w(); x++)
+		{
+			auto p = srcLine[x * 2];
+			destLine[x] = directColorLookup ? p : systemColorMap.map16[p];
+		}
+	}
+}
+
+void systemDrawScreen(EmuSystemTask *task, EmuVideo &video)
+{
+	// the size changes when showing both linked consoles
+	auto img = video.startFrameWithFormat(task, {{240, 160}, pixFmt});
+	writeScreen(img.pixmap(), lcdPixmap(gGba));
 	img.endFrame();
 }
 
+static void drawLinkedScreens(EmuSystemTask *task, EmuVideo &video)
+{
+	auto &peer = *localLinkPeer();
+	if(linkScreenLayout == LINK_SCREEN_PIP)
+	{
+		auto img = video.startFrameWithFormat(task, {{240, 160}, pixFmt});
+		auto pix = img.pixmap();
+		writeScreen(pix, lcdPixmap(gGba));
+		writeHalfScreen(pix.subView({120, 80}, {120, 80}), lcdPixmap(peer));
+		img.endFrame();
+	}
+	else
+	{
+		auto img = video.startFrameWithFormat(task, {{480, 160}, pixFmt});
+		auto pix = img.pixmap();
+		writeScreen(pix.subView({0, 0}, {240, 160}), lcdPixmap(gGba));
+		writeScreen(pix.subView({240, 0}, {240, 160}), lcdPixmap(peer));
+		img.endFrame();
+	}
+}
+
 void systemOnWriteDataToSoundBuffer(EmuAudio *audio, const u16 * finalWave, int length)
 {
 	//logMsg("%d audio frames", Audio::pPCM.bytesToFrames(length));
@@ -217,6 +287,15 @@ void systemOnWriteDataToSoundBuffer(EmuAudio *audio, const u16 * finalWave, int
 
 void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 {
+	if(localLinkIsActive())
+	{
+		localLinkRunFrame(gGba, task, video, audio);
+		if(video)
+		{
+			drawLinkedScreens(task, *video);
+		}
+		return;
+	}
 	CPULoop(gGba, task, video, audio);
 }
 
@@ -17,6 +17,7 @@
 #include <emuframework/EmuInput.hh>
 #include "internal.hh"
 #include <vbam/gba/GBA.h>
+#include <vbam/gba/GBALocalLink.h>
 
 enum
 {
@@ -136,10 +137,16 @@ uint EmuSystem::translateInputAction(uint input, bool &turbo)
 
 void EmuSystem::handleInputAction(uint state, uint emuKey)
 {
-	P1 = IG::setOrClearBits(P1, (uint16_t)emuKey, state != Input::PUSHED);
+	auto &gba = linkControlsPeer && localLinkIsActive() ? *localLinkPeer() : gGba;
+	auto &p1 = gba.mem.ioMem.P1();
+	p1 = IG::setOrClearBits(p1, (uint16_t)emuKey, state != Input::PUSHED);
 }
 
 void EmuSystem::clearInputBuffers(EmuInputView &)
 {
 	P1 = 0x03FF;
+	if(auto peer = localLinkPeer())
+	{
+		peer->mem.ioMem.P1() = 0x03FF;
+	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <emuframework/Option.hh>
+#include <imagine/fs/FS.hh>
 
 static const uint RTC_EMU_AUTO = 0, RTC_EMU_OFF = 1, RTC_EMU_ON = 2;
 
@@ -10,3 +11,11 @@ extern bool detectedRtcGame;
 void setRTC(uint mode);
 void readCheatFile();
 void writeCheatFile();
+
+static const uint LINK_SCREEN_SIDE_BY_SIDE = 0, LINK_SCREEN_PIP = 1;
+
+// second console on the in-process link cable
+extern uint linkScreenLayout;
+extern bool linkControlsPeer;
+
+FS::PathString linkSavePath();
@@ -8,25 +8,31 @@ int eepromMode = EEPROM_IDLE;
 int eepromByte = 0;
 int eepromBits = 0;
 int eepromAddress = 0;
-u8 eepromData[0x2000];
+static u8 eepromDataBuffer[0x2000];
+// points to the active console's EEPROM when linked
+u8 *eepromData = eepromDataBuffer;
 u8 eepromBuffer[16];
 bool eepromInUse = false;
 int eepromSize = 512;
 
+// the save game has the first 512 bytes of eepromData between these tables
 static const variable_desc eepromSaveData[] = {
   { &eepromMode, sizeof(int) },
   { &eepromByte, sizeof(int) },
   { &eepromBits , sizeof(int) },
   { &eepromAddress , sizeof(int) },
   { &eepromInUse, sizeof(bool) },
-  { &eepromData[0], 512 },
+  { NULL, 0 }
+};
+
+static const variable_desc eepromSaveData2[] = {
   { &eepromBuffer[0], 16 },
   { NULL, 0 }
 };
 
 void eepromInit()
 {
-  memset(eepromData, 255, sizeof(eepromData));
+  memset(eepromData, 255, 0x2000);
 }
 
 void eepromReset()
@@ -42,6 +48,8 @@ void eepromReset()
 void eepromSaveGame(gzFile gzFile)
 {
   utilWriteData(gzFile, eepromSaveData);
+  utilGzWrite(gzFile, eepromData, 512);
+  utilWriteData(gzFile, eepromSaveData2);
   utilWriteInt(gzFile, eepromSize);
   utilGzWrite(gzFile, eepromData, 0x2000);
 }
@@ -49,6 +57,8 @@ void eepromSaveGame(gzFile gzFile)
 void eepromReadGame(gzFile gzFile, int version)
 {
   utilReadData(gzFile, eepromSaveData);
+  utilGzRead(gzFile, eepromData, 512);
+  utilReadData(gzFile, eepromSaveData2);
   if(version >= SAVE_GAME_VERSION_3) {
     eepromSize = utilReadInt(gzFile);
     utilGzRead(gzFile, eepromData, 0x2000);
@@ -62,6 +72,8 @@ void eepromReadGameSkip(gzFile gzFile, int version)
 {
   // skip the eeprom data in a save game
   utilReadDataSkip(gzFile, eepromSaveData);
+  utilGzSeek(gzFile, 512, SEEK_CUR);
+  utilReadDataSkip(gzFile, eepromSaveData2);
   if(version >= SAVE_GAME_VERSION_3) {
     utilGzSeek(gzFile, sizeof(int), SEEK_CUR);
     utilGzSeek(gzFile, 0x2000, SEEK_CUR);
@@ -8,7 +8,7 @@ extern int eepromRead(u32 address);
 extern void eepromWrite(u32 address, u8 value, int cpuDmaCount);
 extern void eepromInit();
 extern void eepromReset();
-extern u8 eepromData[0x2000];
+extern u8 *eepromData;
 extern bool eepromInUse;
 extern int eepromSize;
 
@@ -18,7 +18,9 @@
 #define FLASH_PROGRAM            8
 #define FLASH_SETBANK            9
 
-u8 flashSaveMemory[FLASH_128K_SZ];
+static u8 flashSaveMemoryBuffer[FLASH_128K_SZ];
+// points to the active console's flash/SRAM when linked
+u8 *flashSaveMemory = flashSaveMemoryBuffer;
 int flashState = FLASH_READ_ARRAY;
 int flashReadState = FLASH_READ_ARRAY;
 int flashSize = 0x10000;
@@ -26,10 +28,10 @@ int flashDeviceID = 0x1b;
 int flashManufacturerID = 0x32;
 int flashBank = 0;
 
+// each table is followed by the flash memory in the save game
 static const variable_desc flashSaveData[] = {
   { &flashState, sizeof(int) },
   { &flashReadState, sizeof(int) },
-  { &flashSaveMemory[0], 0x10000 },
   { NULL, 0 }
 };
 
@@ -37,7 +39,6 @@ static const variable_desc flashSaveData2[] = {
   { &flashState, sizeof(int) },
   { &flashReadState, sizeof(int) },
   { &flashSize, sizeof(int) },
-  { &flashSaveMemory[0], 0x20000 },
   { NULL, 0 }
 };
 
@@ -46,13 +47,12 @@ static const variable_desc flashSaveData3[] = {
   { &flashReadState, sizeof(int) },
   { &flashSize, sizeof(int) },
   { &flashBank, sizeof(int) },
-  { &flashSaveMemory[0], 0x20000 },
   { NULL, 0 }
 };
 
 void flashInit()
 {
-  memset(flashSaveMemory, 0xff, sizeof(flashSaveMemory));
+  memset(flashSaveMemory, 0xff, FLASH_128K_SZ);
 }
 
 void flashReset()
@@ -65,30 +65,37 @@ void flashReset()
 void flashSaveGame(gzFile gzFile)
 {
   utilWriteData(gzFile, flashSaveData3);
+  utilGzWrite(gzFile, flashSaveMemory, 0x20000);
 }
 
 void flashReadGame(gzFile gzFile, int version)
 {
-  if(version < SAVE_GAME_VERSION_5)
+  if(version < SAVE_GAME_VERSION_5) {
     utilReadData(gzFile, flashSaveData);
-  else if(version < SAVE_GAME_VERSION_7) {
+    utilGzRead(gzFile, flashSaveMemory, 0x10000);
+  } else if(version < SAVE_GAME_VERSION_7) {
     utilReadData(gzFile, flashSaveData2);
+    utilGzRead(gzFile, flashSaveMemory, 0x20000);
     flashBank = 0;
     flashSetSize(flashSize);
   } else {
     utilReadData(gzFile, flashSaveData3);
+    utilGzRead(gzFile, flashSaveMemory, 0x20000);
   }
 }
 
 void flashReadGameSkip(gzFile gzFile, int version)
 {
   // skip the flash data in a save game
-  if(version < SAVE_GAME_VERSION_5)
+  if(version < SAVE_GAME_VERSION_5) {
     utilReadDataSkip(gzFile, flashSaveData);
-  else if(version < SAVE_GAME_VERSION_7) {
+    utilGzSeek(gzFile, 0x10000, SEEK_CUR);
+  } else if(version < SAVE_GAME_VERSION_7) {
     utilReadDataSkip(gzFile, flashSaveData2);
+    utilGzSeek(gzFile, 0x20000, SEEK_CUR);
   } else {
     utilReadDataSkip(gzFile, flashSaveData3);
+    utilGzSeek(gzFile, 0x20000, SEEK_CUR);
   }
 }
 
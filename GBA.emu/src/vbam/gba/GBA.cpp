@@ -21,6 +21,7 @@
 #include "../System.h"
 #include "agbprint.h"
 #include "GBALink.h"
+#include "GBALocalLink.h"
 #include <imagine/logger/logger.h>
 #include <imagine/io/FileIO.hh>
 
@@ -35,26 +36,45 @@
 #define PP_DUMMY_MAP(z, n, text) memoryMap{ (u8 *)&dummyAddress, 0, nullptr, nullptr, nullptr },
 #define PP_DUMMY_MAP_REPEAT(n) BOOST_PP_REPEAT(n, PP_DUMMY_MAP, )
 static int dummyAddress = 0;
+// null addresses are filled in by setupMemoryMap() for each GBASys
 static const memoryMap gbaMap[256] =
 {
-	memoryMap{ gGba.mem.bios, 0x3FFF , biosRead8, biosRead16, biosRead32 },
+	memoryMap{ nullptr, 0x3FFF , biosRead8, biosRead16, biosRead32 },
 	memoryMap{ (u8 *)&dummyAddress, 0, nullptr, nullptr, nullptr },
-	memoryMap{ gGba.mem.workRAM, 0x3FFFF, nullptr, nullptr, nullptr },
-	memoryMap{ gGba.mem.internalRAM, 0x7FFF, nullptr, nullptr, nullptr },
-	memoryMap{ gGba.mem.ioMem.b, 0x3FF , ioMemRead8, ioMemRead16, ioMemRead32 },
-	memoryMap{ gGba.lcd.paletteRAM, 0x3FF, nullptr, nullptr, nullptr },
-	memoryMap{ gGba.lcd.vram, 0x1FFFF , vramRead8, vramRead16, vramRead32 },
-	memoryMap{ gGba.lcd.oam, 0x3FF, nullptr, nullptr, nullptr },
-	memoryMap{ gGba.mem.rom, 0x1FFFFFF , nullptr, rtcRead16, nullptr },
-	memoryMap{ gGba.mem.rom, 0x1FFFFFF, nullptr, nullptr, nullptr },
-	memoryMap{ gGba.mem.rom, 0x1FFFFFF, nullptr, nullptr, nullptr },
+	memoryMap{ nullptr, 0x3FFFF, nullptr, nullptr, nullptr },
+	memoryMap{ nullptr, 0x7FFF, nullptr, nullptr, nullptr },
+	memoryMap{ nullptr, 0x3FF , ioMemRead8, ioMemRead16, ioMemRead32 },
+	memoryMap{ nullptr, 0x3FF, nullptr, nullptr, nullptr },
+	memoryMap{ nullptr, 0x1FFFF , vramRead8, vramRead16, vramRead32 },
+	memoryMap{ nullptr, 0x3FF, nullptr, nullptr, nullptr },
+	memoryMap{ nullptr, 0x1FFFFFF , nullptr, rtcRead16, nullptr },
+	memoryMap{ nullptr, 0x1FFFFFF, nullptr, nullptr, nullptr },
+	memoryMap{ nullptr, 0x1FFFFFF, nullptr, nullptr, nullptr },
 	memoryMap{ (u8 *)&dummyAddress, 0, nullptr, nullptr, nullptr },
-	memoryMap{ gGba.mem.rom, 0x1FFFFFF, nullptr, nullptr, nullptr },
+	memoryMap{ nullptr, 0x1FFFFFF, nullptr, nullptr, nullptr },
 	memoryMap{ (u8 *)&dummyAddress, 0 , eepromRead32, eepromRead32, eepromRead32 },
-	memoryMap{ flashSaveMemory, 0xFFFF , flashRead32, flashRead32, flashRead32 },
+	memoryMap{ nullptr, 0xFFFF , flashRead32, flashRead32, flashRead32 },
 	PP_DUMMY_MAP_REPEAT(241)
 };
 
+static void setupMemoryMap(GBASys &gba)
+{
+	auto &map = gba.cpu.map;
+	memcpy(map, gbaMap, sizeof(gbaMap));
+	map[0].address = gba.mem.bios;
+	map[2].address = gba.mem.workRAM;
+	map[3].address = gba.mem.internalRAM;
+	map[4].address = gba.mem.ioMem.b;
+	map[5].address = gba.lcd.paletteRAM;
+	map[6].address = gba.lcd.vram;
+	map[7].address = gba.lcd.oam;
+	map[8].address = gba.mem.rom;
+	map[9].address = gba.mem.rom;
+	map[10].address = gba.mem.rom;
+	map[12].address = gba.mem.rom;
+	map[14].address = flashSaveMemory;
+}
+
 GBASys gGba;
 
 #ifdef USE_MEM_HANDLERS
@@ -2695,7 +2715,10 @@ void CPUUpdateRegister(ARM7TDMI &cpu, u32 address, u16 value)
 
 
   case COMM_SIOCNT:
-	  StartLink(value);
+	  if(localLinkIsActive())
+		  localLinkWriteSIOCNT(*cpu.gba, value);
+	  else
+		  StartLink(value);
 	  break;
 
   case COMM_SIODATA8:
@@ -2707,7 +2730,7 @@ void CPUUpdateRegister(ARM7TDMI &cpu, u32 address, u16 value)
 	  break;
 
   case 0x130:
-	  P1 |= (value & 0x3FF);
+	  ioMem.P1() |= (value & 0x3FF);
 	  //UPDATE_REG(0x130, P1);
 	  break;
 
@@ -3001,7 +3024,7 @@ void CPUInit(GBASys &gba, const char *biosFileName, bool useBiosFile)
   for(i = 0x304; i < 0x400; i++)
     ioReadable[i] = false;*/
 
-  memcpy(gba.cpu.map, gbaMap, sizeof(gbaMap));
+  setupMemoryMap(gba);
 
   if(romSize < 0x1fe2000) {
   	*((uint16a *)&gba.mem.rom[0x1fe209c]) = 0xdffa; // SWI 0xFA
@@ -3044,7 +3067,7 @@ void CPUReset(GBASys &gba)
   gba.mem.ioMem.TM2CNT   = 0x0000;
   gba.mem.ioMem.TM3D     = 0x0000;
   gba.mem.ioMem.TM3CNT   = 0x0000;
-  P1       = 0x03FF;
+  gba.mem.ioMem.P1() = 0x03FF;
   gba.cpu.reset(gba.mem.ioMem, cpuIsMultiBoot, useBios, skipBios);
 
   //UPDATE_REG(0x00, DISPCNT);
@@ -3209,7 +3232,11 @@ void CPUInterrupt(GBASys &gba, ARM7TDMI &cpu)
 	gba.biosProtected[3] = 0xe5;
 }
 
-void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+// Runs until the frame is ready, or if sliceTicks is set, until that many ticks
+// have passed, continuing past the end of the frame. sliceTicks is then left
+// holding the ticks it ran over by as zero or less, to be carried into the next
+// slice. Returns true if the frame became ready.
+bool CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio, int *sliceTicks)
 {
 	auto cpu = gba.cpu;
 	auto &holdState = cpu.holdState;
@@ -3234,6 +3261,8 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
     cpu.cpuNextEvent = 1;
 
   bool cpuBreakLoop = false;
+  bool frameReady = false;
+  int ticksLeft = sliceTicks ? *sliceTicks : 0;
   cpu.cpuNextEvent = CPUUpdateTicks(cpu);
   /*if(cpu.cpuNextEvent > ticks)
     cpu.cpuNextEvent = ticks;*/
@@ -3274,7 +3303,7 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
         {
 					#ifdef BKPT_SUPPORT
         	gCpu = cpu;
-          return;
+          return false;
 					#endif
         }
       } else {
@@ -3282,7 +3311,7 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
         {
 					#ifdef BKPT_SUPPORT
         	gCpu = cpu;
-          return;
+          return false;
 					#endif
         }
       }
@@ -3310,6 +3339,8 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 
     updateLoop:
 
+      ticksLeft -= clockTicks;
+
 #ifdef VBAM_USE_IRQTICKS
       if (IRQTicks)
       {
@@ -3369,7 +3400,7 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
               // can enter the stop state without requesting an IRQ from
               // the joypad.
               if((P1CNT & 0x4000) || gba.stopState) {
-                u16 p1 = (0x3FF ^ P1) & 0x3FF;
+                u16 p1 = (0x3FF ^ ioMem.P1()) & 0x3FF;
                 if(P1CNT & 0x8000) {
                   if(p1 == (P1CNT & 0x3FF)) {
                     IF |= 0x1000;
@@ -3389,7 +3420,7 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
                 remainingTicks += cheatsCheckKeys(cpu, P1^0x3FF, ext);*/
               if(cheatsNumber)
               {
-              	remainingTicks += cheatsCheckKeys(cpu, P1^0x3FF, 0);
+              	remainingTicks += cheatsCheckKeys(cpu, ioMem.P1()^0x3FF, 0);
               }
 
               ioMem.DISPSTAT |= 1;
@@ -3401,7 +3432,9 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
               }
               CPUCheckDMA(gba, cpu, 1, 0x0f);
 
-              cpuBreakLoop = 1; // stop when frame ready
+              frameReady = true;
+              if(!sliceTicks)
+                cpuBreakLoop = 1; // stop when frame ready
             }
 
             //UPDATE_REG(0x04, DISPSTAT);
@@ -3462,7 +3495,8 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 				#endif
               }*/
             }
-            if(ioMem.VCOUNT == 159 && likely(video))
+            // a sliced caller presents the frame itself once the slices finish
+            if(ioMem.VCOUNT == 159 && likely(video) && !sliceTicks)
             {
             	systemDrawScreen(task, *video);
             }
@@ -3484,10 +3518,12 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	    // we shouldn't be doing sound in stop state, but we loose synchronization
       // if sound is disabled, so in stop state, soundTick will just produce
       // mute sound
-      soundTicks -= clockTicks;
-      if(soundTicks <= 0) {
-        psoundTickfn(audio);
-        soundTicks += SOUND_CLOCK_TICKS;
+      if(gba.hasSound) {
+        soundTicks -= clockTicks;
+        if(soundTicks <= 0) {
+          psoundTickfn(audio);
+          soundTicks += SOUND_CLOCK_TICKS;
+        }
       }
 
       if(!gba.stopState) {
@@ -3742,10 +3778,20 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
       /*if(ticks <= 0 || cpuBreakLoop)
         break;*/
 
+      if(sliceTicks && ticksLeft <= 0)
+        cpuBreakLoop = true;
     }
   } while(!cpuBreakLoop);
 
   gba.cpu = cpu;
+  if(sliceTicks)
+    *sliceTicks = ticksLeft;
+  return frameReady;
+}
+
+void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+	CPULoop(gba, task, video, audio, nullptr);
 }
 
 
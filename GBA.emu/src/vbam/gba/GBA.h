@@ -127,6 +127,10 @@ struct GBAMem
 			uint16_t IME;
 		};
 
+		// KEYINPUT, at 0x130
+		uint16a &P1() { return *((uint16a*)&b[0x130]); }
+		const uint16a &P1() const { return *((const uint16a*)&b[0x130]); }
+
 		void resetDmaRegs()
 		{
 		  DM0SAD_L = 0x0000;
@@ -962,6 +966,9 @@ struct GBASys
 #endif
 	bool intState = false;
 	bool stopState = false;
+	// false on a linked console whose sound isn't mixed, its sound
+	// register writes then only update ioMem
+	bool hasSound = true;
 	ARM7TDMI cpu {this};
 	u8 biosProtected[4] {0};
 	GBALCD lcd;
@@ -1035,6 +1042,8 @@ extern void applyTimer(ARM7TDMI &cpu);
 extern void CPUInit(GBASys &gba, const char *,bool);
 extern void CPUReset(GBASys &gba);
 extern void CPULoop(int);
+extern void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
+extern bool CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio, int *sliceTicks);
 extern void CPUCheckDMA(GBASys &gba, ARM7TDMI &cpu, int,int);
 extern bool CPUIsGBAImage(const char *);
 extern bool CPUIsZipFile(const char *);
@@ -0,0 +1,343 @@
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "GBA.h"
+#include "GBAcpu.h"
+#include "Globals.h"
+#include "EEprom.h"
+#include "Flash.h"
+#include "RTC.h"
+#include "GBALink.h"
+#include "GBALocalLink.h"
+#include "../common/Port.h"
+
+extern int flashState;
+extern int flashReadState;
+extern int flashDeviceID;
+extern int flashManufacturerID;
+extern int flashBank;
+extern int eepromMode;
+extern int eepromByte;
+extern int eepromBits;
+extern int eepromAddress;
+extern u8 eepromBuffer[16];
+extern int gbaSaveType;
+extern bool cpuSramEnabled;
+extern bool cpuFlashEnabled;
+extern bool cpuEEPROMEnabled;
+extern bool cpuEEPROMSensorEnabled;
+bool CPUReadBatteryFile(GBASys &gba, const char *);
+bool CPUWriteBatteryFile(GBASys &gba, const char *);
+
+// Cartridge state the core keeps in globals, the console that isn't running
+// has its copy here and swapCart() exchanges it with the globals
+struct LinkCartState
+{
+  u8 *flashSaveMemory;
+  int flashState;
+  int flashReadState;
+  int flashSize;
+  int flashDeviceID;
+  int flashManufacturerID;
+  int flashBank;
+  u8 *eepromData;
+  int eepromMode;
+  int eepromByte;
+  int eepromBits;
+  int eepromAddress;
+  int eepromSize;
+  u8 eepromBuffer[16];
+  bool eepromInUse;
+  int saveType;
+  int gbaSaveType;
+  bool cpuSramEnabled;
+  bool cpuFlashEnabled;
+  bool cpuEEPROMEnabled;
+  bool cpuEEPROMSensorEnabled;
+  void (*cpuSaveGameFunc)(u32, u8);
+  std::vector<u8> rtc;
+};
+
+struct LinkTransfer
+{
+  int ticks;
+  u8 master;
+  bool active;
+};
+
+// time to the end of a multiplayer transfer with one child for each baud rate,
+// from GBALink.cpp
+static const int multiplayerTransferTicks[4] = { 72527, 18132, 12088, 6044 };
+
+static std::unique_ptr<GBASys> peer;
+static std::unique_ptr<u8[]> peerFlashSaveMemory;
+static std::unique_ptr<u8[]> peerEepromData;
+static GBASys *console[2];
+static LinkCartState inactiveCart;
+static LinkTransfer transfer;
+// each console carries the ticks it ran past the last slice into the next
+static int sliceTicks[2];
+
+static void swapCart()
+{
+  auto &c = inactiveCart;
+  std::swap(c.flashSaveMemory, flashSaveMemory);
+  std::swap(c.flashState, flashState);
+  std::swap(c.flashReadState, flashReadState);
+  std::swap(c.flashSize, flashSize);
+  std::swap(c.flashDeviceID, flashDeviceID);
+  std::swap(c.flashManufacturerID, flashManufacturerID);
+  std::swap(c.flashBank, flashBank);
+  std::swap(c.eepromData, eepromData);
+  std::swap(c.eepromMode, eepromMode);
+  std::swap(c.eepromByte, eepromByte);
+  std::swap(c.eepromBits, eepromBits);
+  std::swap(c.eepromAddress, eepromAddress);
+  std::swap(c.eepromSize, eepromSize);
+  std::swap(c.eepromBuffer, eepromBuffer);
+  std::swap(c.eepromInUse, eepromInUse);
+  std::swap(c.saveType, saveType);
+  std::swap(c.gbaSaveType, gbaSaveType);
+  std::swap(c.cpuSramEnabled, cpuSramEnabled);
+  std::swap(c.cpuFlashEnabled, cpuFlashEnabled);
+  std::swap(c.cpuEEPROMEnabled, cpuEEPROMEnabled);
+  std::swap(c.cpuEEPROMSensorEnabled, cpuEEPROMSensorEnabled);
+  std::swap(c.cpuSaveGameFunc, cpuSaveGameFunc);
+  rtcSwapState(c.rtc.data());
+}
+
+static int sioMode(u16 siocnt, u16 rcnt)
+{
+  if(!(rcnt & 0x8000)) {
+    switch(siocnt & 0x3000) {
+    case 0x0000: return NORMAL8;
+    case 0x1000: return NORMAL32;
+    case 0x2000: return MULTIPLAYER;
+    case 0x3000: return UART;
+    }
+  }
+  if(rcnt & 0x4000)
+    return JOYBUS;
+  return UNSUPPORTED;
+}
+
+static u16 siocnt(const GBASys &gba)
+{
+  return READ16LE(&gba.mem.ioMem.b[COMM_SIOCNT]);
+}
+
+static int sioMode(const GBASys &gba)
+{
+  return sioMode(siocnt(gba), READ16LE(&gba.mem.ioMem.b[COMM_RCNT]));
+}
+
+static void setSiocnt(GBASys &gba, u16 value)
+{
+  UPDATE_REG(&gba, COMM_SIOCNT, value);
+}
+
+static bool isNormalMode(int mode)
+{
+  return mode == NORMAL8 || mode == NORMAL32;
+}
+
+// In normal mode SI reads the other console's SO, which is low while it waits
+// for a transfer with Start set, otherwise the level set in bit 3
+static void updateNormalModeSI()
+{
+  for(int i = 0; i < 2; i++) {
+    GBASys &gba = *console[i];
+    if(!isNormalMode(sioMode(gba)))
+      continue;
+    u16 other = siocnt(*console[!i]);
+    bool so = isNormalMode(sioMode(*console[!i])) ? !(other & 0x80) && (other & 0x08) : true;
+    setSiocnt(gba, (siocnt(gba) & ~0x04) | (so ? 0x04 : 0));
+  }
+}
+
+static void endTransfer(GBASys &gba)
+{
+  u16 value = siocnt(gba);
+  setSiocnt(gba, value & ~0x80);
+  if(value & 0x4000)
+    gba.mem.ioMem.IF |= 0x80;
+}
+
+static void finishTransfer()
+{
+  GBASys &master = *console[transfer.master];
+  GBASys &other = *console[!transfer.master];
+  transfer.active = false;
+  int mode = sioMode(master);
+  int otherMode = sioMode(other);
+  if(mode == MULTIPLAYER) {
+    u16 data[4] = { READ16LE(&master.mem.ioMem.b[COMM_SIOMLT_SEND]), 0xFFFF, 0xFFFF, 0xFFFF };
+    if(otherMode == MULTIPLAYER)
+      data[1] = READ16LE(&other.mem.ioMem.b[COMM_SIOMLT_SEND]);
+    for(GBASys *gba : console) {
+      if(sioMode(*gba) != MULTIPLAYER)
+        continue;
+      for(int i = 0; i < 4; i++)
+        UPDATE_REG(gba, COMM_SIOMULTI0 + i * 2, data[i]);
+      endTransfer(*gba);
+    }
+  } else if(isNormalMode(mode)) {
+    // the other side only shifts when it's waiting with an external clock
+    bool received = otherMode == mode && (siocnt(other) & 0x81) == 0x80;
+    if(mode == NORMAL8) {
+      u8 masterData = master.mem.ioMem.b[COMM_SIODATA8];
+      master.mem.ioMem.b[COMM_SIODATA8] = received ? other.mem.ioMem.b[COMM_SIODATA8] : 0xFF;
+      if(received)
+        other.mem.ioMem.b[COMM_SIODATA8] = masterData;
+    } else {
+      u32 masterData = READ32LE(&master.mem.ioMem.b[COMM_SIODATA32_L]);
+      WRITE32LE(&master.mem.ioMem.b[COMM_SIODATA32_L],
+        received ? READ32LE(&other.mem.ioMem.b[COMM_SIODATA32_L]) : 0xFFFFFFFF);
+      if(received)
+        WRITE32LE(&other.mem.ioMem.b[COMM_SIODATA32_L], masterData);
+    }
+    endTransfer(master);
+    if(received)
+      endTransfer(other);
+    updateNormalModeSI();
+  }
+}
+
+void localLinkWriteSIOCNT(GBASys &gba, u16 value)
+{
+  int idx = &gba == console[1];
+  switch(sioMode(value, READ16LE(&gba.mem.ioMem.b[COMM_RCNT]))) {
+  case MULTIPLAYER: {
+    // SI is low on the parent, SD is high since both consoles are connected,
+    // and the ID is the position on the cable
+    u16 cnt = (value & 0x7003) | (idx ? 0x04 : 0) | 0x08 | (idx << 4);
+    if(transfer.active) {
+      cnt |= 0x80;
+    } else if(!idx && (value & 0x80)) {
+      transfer = { multiplayerTransferTicks[value & 3], 0, true };
+      cnt |= 0x80;
+      GBASys &child = *console[1];
+      if(sioMode(child) == MULTIPLAYER)
+        setSiocnt(child, siocnt(child) | 0x80);
+    }
+    setSiocnt(gba, cnt);
+    break;
+  }
+  case NORMAL8:
+  case NORMAL32: {
+    u16 cnt = (value & 0x708B) | (siocnt(gba) & 0x04);
+    if(transfer.active && transfer.master == idx) {
+      cnt |= 0x80;
+    } else if((value & 0x81) == 0x81 && !transfer.active) {
+      // internal clock, 256KHz or 2MHz
+      int bits = (value & 0x1000) ? 32 : 8;
+      transfer = { bits * ((value & 0x02) ? 8 : 64), (u8)idx, true };
+    }
+    setSiocnt(gba, cnt);
+    updateNormalModeSI();
+    break;
+  }
+  default:
+    setSiocnt(gba, value);
+    break;
+  }
+}
+
+void localLinkStart(GBASys &gba, const char *peerBatteryFile)
+{
+  if(peer)
+    return;
+  peer = std::make_unique<GBASys>();
+  peerFlashSaveMemory = std::make_unique<u8[]>(FLASH_128K_SZ);
+  peerEepromData = std::make_unique<u8[]>(0x2000);
+  console[0] = &gba;
+  console[1] = peer.get();
+  transfer = {};
+  sliceTicks[0] = sliceTicks[1] = 0;
+  peer->hasSound = false;
+  memcpy(peer->mem.rom, gba.mem.rom, sizeof(peer->mem.rom));
+  // start from the game specific settings like the flash size, CPUInit() and
+  // CPUReset() then set everything else up as for the first console
+  inactiveCart.flashSaveMemory = peerFlashSaveMemory.get();
+  inactiveCart.flashSize = flashSize;
+  inactiveCart.flashDeviceID = flashDeviceID;
+  inactiveCart.flashManufacturerID = flashManufacturerID;
+  inactiveCart.eepromData = peerEepromData.get();
+  inactiveCart.eepromSize = eepromSize;
+  inactiveCart.cpuSaveGameFunc = flashSaveDecide;
+  inactiveCart.rtc.assign(rtcStateSize(), 0);
+  swapCart();
+  flashInit();
+  eepromInit();
+  CPUInit(*peer, 0, 0);
+  CPUReset(*peer);
+  if(peerBatteryFile)
+    CPUReadBatteryFile(*peer, peerBatteryFile);
+  swapCart();
+  logMsg("started local link");
+}
+
+void localLinkStop(const char *peerBatteryFile)
+{
+  if(!peer)
+    return;
+  if(peerBatteryFile)
+    localLinkWritePeerBatteryFile(peerBatteryFile);
+  peer.reset();
+  peerFlashSaveMemory.reset();
+  peerEepromData.reset();
+  inactiveCart = {};
+  console[0] = console[1] = nullptr;
+  transfer = {};
+  logMsg("stopped local link");
+}
+
+bool localLinkIsActive()
+{
+  return (bool)peer;
+}
+
+GBASys *localLinkPeer()
+{
+  return peer.get();
+}
+
+void localLinkReset()
+{
+  if(!peer)
+    return;
+  transfer = {};
+  sliceTicks[0] = sliceTicks[1] = 0;
+  swapCart();
+  CPUReset(*peer);
+  swapCart();
+}
+
+bool localLinkWritePeerBatteryFile(const char *peerBatteryFile)
+{
+  if(!peer)
+    return false;
+  swapCart();
+  bool success = CPUWriteBatteryFile(*peer, peerBatteryFile);
+  swapCart();
+  return success;
+}
+
+void localLinkRunFrame(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+  bool frameReady;
+  do {
+    sliceTicks[0] += LOCAL_LINK_SLICE_TICKS;
+    frameReady = CPULoop(gba, task, video, audio, &sliceTicks[0]);
+    swapCart();
+    sliceTicks[1] += LOCAL_LINK_SLICE_TICKS;
+    CPULoop(*peer, task, video, nullptr, &sliceTicks[1]);
+    swapCart();
+    if(transfer.active) {
+      transfer.ticks -= LOCAL_LINK_SLICE_TICKS;
+      if(transfer.ticks <= 0)
+        finishTransfer();
+    }
+  } while(!frameReady);
+}
@@ -0,0 +1,34 @@
+#ifndef GBA_GBALOCALLINK_H
+#define GBA_GBALOCALLINK_H
+
+// Link cable between a console and a second one run in the same process.
+// Both run on the calling thread, taking turns for LOCAL_LINK_SLICE_TICKS at a
+// time, and a serial transfer finishes at the first slice boundary after its
+// transfer time has passed, so the timing doesn't depend on the host at all.
+//
+// The second console runs the same ROM with its own backup memory and RTC
+// state, but its sound isn't emulated. Save states only cover the first one.
+
+struct GBASys;
+class EmuSystemTask;
+class EmuVideo;
+class EmuAudio;
+
+// one scanline
+#define LOCAL_LINK_SLICE_TICKS 1232
+
+// creates the second console from gba's loaded ROM and resets it, reading its
+// backup memory from peerBatteryFile if it exists
+void localLinkStart(GBASys &gba, const char *peerBatteryFile);
+// writes the second console's backup memory to peerBatteryFile if not null
+void localLinkStop(const char *peerBatteryFile);
+bool localLinkIsActive();
+GBASys *localLinkPeer();
+void localLinkReset();
+bool localLinkWritePeerBatteryFile(const char *peerBatteryFile);
+// runs both consoles until gba's frame is ready, if video is set each console
+// renders into its own lcd.pix and the caller presents them afterwards
+void localLinkRunFrame(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
+void localLinkWriteSIOCNT(GBASys &gba, u16 value);
+
+#endif // GBA_GBALOCALLINK_H
@@ -8,6 +8,7 @@
 #include <time.h>
 #include <string.h>
 #include <memory.h>
+#include <algorithm>
 
 enum RTCSTATE { IDLE, COMMAND, DATA, READDATA };
 
@@ -39,6 +40,16 @@ bool rtcIsEnabled()
   return rtcEnabled;
 }
 
+unsigned rtcStateSize()
+{
+  return sizeof(rtcClockData);
+}
+
+void rtcSwapState(u8 *state)
+{
+  std::swap_ranges(state, state + sizeof(rtcClockData), (u8 *)&rtcClockData);
+}
+
 u16 rtcRead(GBASys &gba, u32 address)
 {
   if(rtcEnabled) {
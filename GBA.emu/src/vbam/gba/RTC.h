@@ -6,6 +6,9 @@ bool rtcWrite(u32 address, u16 value);
 void rtcEnable(bool);
 bool rtcIsEnabled();
 void rtcReset();
+// the clock chip state as bytes, so each linked console can keep its own
+unsigned rtcStateSize();
+void rtcSwapState(u8 *state);
 
 void rtcReadGame(gzFile gzFile);
 void rtcSaveGame(gzFile gzFile);
@@ -285,6 +285,8 @@ void soundEvent(GBASys &gba, u32 address, u8 data)
 	if ( gb_addr )
 	{
 		gba.mem.ioMem.b[address] = data;
+		if ( !gba.hasSound )
+			return;
 		gb_apu.write_register( blip_time(), gb_addr, data );
 
 		if ( address == NR52 )
@@ -319,6 +321,12 @@ static void write_SGCNT0_H( GBASys &gba, int data )
 
 void soundEvent(GBASys &gba, u32 address, u16 data)
 {
+	if ( !gba.hasSound )
+	{
+		WRITE16LE( &gba.mem.ioMem.b[address], data );
+		return;
+	}
+
 	switch ( address )
 	{
 	case SGCNT0_H:
@@ -351,6 +359,8 @@ void soundEvent(GBASys &gba, u32 address, u16 data)
 
 void soundTimerOverflow(GBASys &gba, ARM7TDMI &cpu, int timer)
 {
+	if ( !gba.hasSound )
+		return;
 	pcm [0].timer_overflowed(gba, cpu, timer );
 	pcm [1].timer_overflowed(gba, cpu, timer );
 }
@@ -512,6 +522,12 @@ void soundReset(GBASys &gba)
 {
 	//soundDriver->reset();
 
+	if ( !gba.hasSound )
+	{
+		soundEvent( gba, NR52, (u8) 0x80 );
+		return;
+	}
+
 	remake_stereo_buffer(gba);
 	reset_apu();
 
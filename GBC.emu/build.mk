@@ -51,6 +51,7 @@ $(addprefix $(libgambattePath)/,$(libgambatteSrc))
 gambatteCommonSrc := resample/src/resamplerinfo.cpp \
 resample/src/makesinckernel.cpp \
 resample/src/chainresampler.cpp \
+resample/src/firdot.cpp \
 resample/src/u48div.cpp \
 resample/src/i0.cpp \
 resample/src/kaiser50sinc.cpp \
@@ -0,0 +1 @@
+../imagine/make/shortcut/common-builds/linux-x86_64-release-pgo-use.mk
\ No newline at end of file
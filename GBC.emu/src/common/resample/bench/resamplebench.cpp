@@ -0,0 +1,298 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License version 2 as     *
+ *   published by the Free Software Foundation.                            *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License version 2 for more details.                *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   version 2 along with this program; if not, write to the               *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.             *
+ ***************************************************************************/
+
+// Feeds gambatte output through every ResamplerInfo entry with each stereoFirDot
+// version, timing them and checking the output against the scalar build.
+//
+// The input is recorded from libgambatte running a small APU test program that
+// keeps retriggering all four channels at changing pitches and panning, chunked
+// the way GBC.emu's runFrame hands it to the resampler. A raw recording of a real
+// game (native endian 16-bit stereo at 2097152 Hz) can be given instead with -i.
+//
+// "make run" builds the program twice, writes reference hashes with the
+// RESAMPLE_NO_SIMD build and compares the default build's output against them.
+
+#include <gambatte.h>
+#include "resample/resampler.h"
+#include "resample/resamplerinfo.h"
+#include "resample/src/firdot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using gambatte::uint_least32_t;
+
+// only called for CGB palettes, the test program runs in DMG mode
+uint_least32_t gbcToRgb32(unsigned const bgr15) { return bgr15; }
+
+namespace {
+
+long const inRate = 2097152;
+long const outRates[] = { 48000, 44100, 22050, 96000 };
+std::size_t const samplesPerRun = 2064;
+std::size_t const maxChunk = 35112 + 2064;
+
+// placed at 0x150, entered from the jp at 0x100
+unsigned char const apuTestProgram[] = {
+	0xF3,                                     // di
+	0x3E, 0x80, 0xE0, 0x26,                   // NR52 = 0x80, sound on
+	0x3E, 0x77, 0xE0, 0x24,                   // NR50 = 0x77
+	0x3E, 0xFF, 0xE0, 0x25,                   // NR51 = 0xFF
+	0x3E, 0x15, 0xE0, 0x10,                   // NR10 = 0x15, sweep
+	0x3E, 0x80, 0xE0, 0x11,                   // NR11 = 0x80, 50% duty
+	0x3E, 0xF3, 0xE0, 0x12,                   // NR12 = 0xF3
+	0x3E, 0x40, 0xE0, 0x16,                   // NR21 = 0x40, 25% duty
+	0x3E, 0xA7, 0xE0, 0x17,                   // NR22 = 0xA7
+	0x3E, 0x00, 0xE0, 0x1A,                   // NR30 = 0, wave off
+	0x21, 0x30, 0xFF,                         // ld hl, 0xFF30
+	0x3E, 0x01, 0x22, 0x3E, 0x23, 0x22,       // wave RAM, ramp up and down
+	0x3E, 0x45, 0x22, 0x3E, 0x67, 0x22,
+	0x3E, 0x89, 0x22, 0x3E, 0xAB, 0x22,
+	0x3E, 0xCD, 0x22, 0x3E, 0xEF, 0x22,
+	0x3E, 0xFE, 0x22, 0x3E, 0xDC, 0x22,
+	0x3E, 0xBA, 0x22, 0x3E, 0x98, 0x22,
+	0x3E, 0x76, 0x22, 0x3E, 0x54, 0x22,
+	0x3E, 0x32, 0x22, 0x3E, 0x10, 0x22,
+	0x3E, 0x80, 0xE0, 0x1A,                   // NR30 = 0x80, wave on
+	0x3E, 0x20, 0xE0, 0x1C,                   // NR32 = 0x20, full volume
+	0x3E, 0xF2, 0xE0, 0x21,                   // NR42 = 0xF2
+	0x16, 0x00,                               // ld d, 0
+	// loop:
+	0x7A, 0xE0, 0x13, 0x3E, 0x86, 0xE0, 0x14, // NR13 = d, trigger ch1
+	0x7A, 0xEE, 0x5A, 0xE0, 0x18,             // NR23 = d ^ 0x5A
+	0x3E, 0x85, 0xE0, 0x19,                   // trigger ch2
+	0x7A, 0xC6, 0x40, 0xE0, 0x1D,             // NR33 = d + 0x40
+	0x3E, 0x87, 0xE0, 0x1E,                   // trigger ch3
+	0x7A, 0xE6, 0x77, 0xE0, 0x22,             // NR43 = d & 0x77
+	0x3E, 0x80, 0xE0, 0x23,                   // trigger ch4
+	0x7A, 0x07, 0x07, 0xF6, 0x5A, 0xE0, 0x25, // NR51 = rlc(rlc(d)) | 0x5A
+	0x14,                                     // inc d
+	0x1E, 0x17,                               // ld e, 23, wait about 23 ms
+	0x0E, 0x00,                               // ld c, 0
+	0x0D, 0x20, 0xFD,                         // dec c, jr nz
+	0x1D, 0x20, 0xF8,                         // dec e, jr nz
+	0x18, 0xC9,                               // jr loop
+};
+
+struct Input {
+	std::vector<short> samples;
+	std::vector<std::size_t> chunks;
+	std::size_t frames() const { return samples.size() / 2; }
+};
+
+bool recordGambatte(Input &input, std::size_t frames) {
+	std::vector<unsigned char> rom(0x8000);
+	unsigned char const entry[] = { 0x00, 0xC3, 0x50, 0x01 };
+	std::memcpy(&rom[0x100], entry, sizeof entry);
+	std::memcpy(&rom[0x134], "APUTEST", 7);
+	std::memcpy(&rom[0x150], apuTestProgram, sizeof apuTestProgram);
+	unsigned char headerSum = 0;
+	for (std::size_t i = 0x134; i < 0x14D; ++i)
+		headerSum -= rom[i] + 1;
+	rom[0x14D] = headerSum;
+
+	gambatte::GB gb;
+	if (gb.load(rom.data(), rom.size(), "aputest.gb", gambatte::GB::FORCE_DMG) != 0)
+		return false;
+
+	std::vector<uint_least32_t> video(160 * 144);
+	std::vector<uint_least32_t> snd(samplesPerRun + 2064);
+	input.samples.reserve(frames * 2 + snd.size() * 2);
+	while (input.frames() < frames) {
+		std::size_t samples = samplesPerRun;
+		gb.runFor(video.data(), 160, snd.data(), samples, {});
+		std::size_t const start = input.samples.size();
+		input.samples.resize(start + samples * 2);
+		std::memcpy(&input.samples[start], snd.data(), samples * 4);
+		input.chunks.push_back(samples);
+	}
+
+	return true;
+}
+
+bool readRecording(Input &input, char const *path) {
+	std::FILE *f = std::fopen(path, "rb");
+	if (!f)
+		return false;
+
+	short buf[samplesPerRun * 2];
+	std::size_t frames;
+	while ((frames = std::fread(buf, 4, samplesPerRun, f)) > 0) {
+		input.samples.insert(input.samples.end(), buf, buf + frames * 2);
+		input.chunks.push_back(frames);
+	}
+
+	std::fclose(f);
+	return !input.chunks.empty();
+}
+
+unsigned long long fnv1a(unsigned long long h, short const *s, std::size_t n) {
+	unsigned char const *p = reinterpret_cast<unsigned char const *>(s);
+	for (std::size_t i = 0; i < n * sizeof *s; ++i)
+		h = (h ^ p[i]) * 1099511628211ull;
+
+	return h;
+}
+
+struct Result {
+	unsigned long long hash;
+	double ms;
+};
+
+Result run(std::size_t resampler, long outRate, Input const &input, unsigned repeats) {
+	Result result = { 0, 1e30 };
+	for (unsigned r = 0; r < repeats; ++r) {
+		Resampler *const rs = ResamplerInfo::get(resampler).create(inRate, outRate, maxChunk);
+		std::vector<short> out(rs->maxOut(maxChunk) * 2);
+		unsigned long long hash = 14695981039346656037ull;
+		double ms = 0;
+		short const *in = input.samples.data();
+		for (std::size_t i = 0; i < input.chunks.size(); ++i) {
+			std::size_t const frames = input.chunks[i];
+			auto const t0 = std::chrono::steady_clock::now();
+			std::size_t const produced = rs->resample(out.data(), in, frames);
+			ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+			hash = fnv1a(hash, out.data(), produced * 2);
+			in += frames * 2;
+		}
+
+		delete rs;
+		result.hash = hash;
+		result.ms = std::min(result.ms, ms);
+	}
+
+	return result;
+}
+
+std::string refKey(std::size_t resampler, long outRate) {
+	char key[32];
+	std::snprintf(key, sizeof key, "%zu %ld", resampler, outRate);
+	return key;
+}
+
+void usage() {
+	std::fprintf(stderr, "usage: resamplebench [-i recording.raw] [-s seconds] [-n repeats]"
+	                     " [-w reference | -c reference]\n");
+}
+
+} // anon namespace
+
+int main(int argc, char **argv) {
+	char const *recording = 0;
+	char const *writeRef = 0;
+	char const *compareRef = 0;
+	double seconds = 4;
+	unsigned repeats = 3;
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 == argc) {
+			usage();
+			return EXIT_FAILURE;
+		}
+
+		if (!std::strcmp(argv[i], "-i"))
+			recording = argv[++i];
+		else if (!std::strcmp(argv[i], "-s"))
+			seconds = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "-n"))
+			repeats = std::max(std::atoi(argv[++i]), 1);
+		else if (!std::strcmp(argv[i], "-w"))
+			writeRef = argv[++i];
+		else if (!std::strcmp(argv[i], "-c"))
+			compareRef = argv[++i];
+		else {
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	Input input;
+	if (recording ? !readRecording(input, recording)
+	              : !recordGambatte(input, static_cast<std::size_t>(seconds * inRate))) {
+		std::fprintf(stderr, "can't get input from %s\n", recording ? recording : "libgambatte");
+		return EXIT_FAILURE;
+	}
+
+	double const inSeconds = static_cast<double>(input.frames()) / inRate;
+	std::printf("%.2f s of input in %zu chunks\n", inSeconds, input.chunks.size());
+
+	std::map<std::string, unsigned long long> reference;
+	if (compareRef) {
+		std::FILE *f = std::fopen(compareRef, "r");
+		if (!f) {
+			std::fprintf(stderr, "can't open %s\n", compareRef);
+			return EXIT_FAILURE;
+		}
+
+		std::size_t resampler;
+		long outRate;
+		unsigned long long hash;
+		while (std::fscanf(f, "%zu %ld %llx", &resampler, &outRate, &hash) == 3)
+			reference[refKey(resampler, outRate)] = hash;
+
+		std::fclose(f);
+	}
+
+	std::FILE *refOut = writeRef ? std::fopen(writeRef, "w") : 0;
+	if (writeRef && !refOut) {
+		std::fprintf(stderr, "can't create %s\n", writeRef);
+		return EXIT_FAILURE;
+	}
+
+	StereoFirDotVersion const *versions;
+	std::size_t const numVersions = stereoFirDotVersions(versions);
+	StereoFirDot const defaultDot = stereoFirDot;
+	unsigned mismatches = 0;
+	for (std::size_t v = 0; v < numVersions; ++v) {
+		stereoFirDot = versions[v].dot;
+		for (std::size_t n = 0; n < ResamplerInfo::num(); ++n) {
+			for (std::size_t r = 0; r < sizeof outRates / sizeof *outRates; ++r) {
+				Result const res = run(n, outRates[r], input, repeats);
+				char const *status = "";
+				if (compareRef) {
+					auto const it = reference.find(refKey(n, outRates[r]));
+					if (it == reference.end()) {
+						status = " no reference";
+						++mismatches;
+					} else if (it->second != res.hash) {
+						status = " DIFFERS FROM SCALAR";
+						++mismatches;
+					} else
+						status = " same as scalar";
+				}
+
+				std::printf("%-6s %-34s %5ld Hz: %6.2f ms per emulated second%s\n",
+				            versions[v].name, ResamplerInfo::get(n).desc, outRates[r],
+				            res.ms / inSeconds, status);
+				if (refOut && versions[v].dot == defaultDot)
+					std::fprintf(refOut, "%zu %ld %016llx\n", n, outRates[r], res.hash);
+			}
+		}
+	}
+
+	stereoFirDot = defaultDot;
+	if (refOut)
+		std::fclose(refOut);
+
+	if (mismatches)
+		std::printf("%u outputs differ from the scalar build\n", mismatches);
+
+	return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -19,10 +19,11 @@
 #ifndef CIC2_H
 #define CIC2_H
 
+#include "cicsample.h"
 #include "rshift16_round.h"
 #include "subresampler.h"
 
-template<unsigned channels>
+template<unsigned channels, class Sample = CicMonoSample>
 class Cic2Core {
 public:
 	explicit Cic2Core(unsigned div = 2) { reset(div); }
@@ -35,9 +36,11 @@ public:
 	}
 
 private:
-	unsigned long sum1_;
-	unsigned long sum2_;
-	unsigned long prev1_;
+	typedef typename Sample::Acc Acc;
+
+	Acc sum1_;
+	Acc sum2_;
+	Acc prev1_;
 	unsigned div_;
 	unsigned nextdivn_;
 
@@ -45,35 +48,35 @@ private:
 	static long mulForDiv(unsigned div) { return 0x10000 / (div * div); }
 };
 
-template<unsigned channels>
-void Cic2Core<channels>::reset(unsigned div) {
-	sum2_ = sum1_ = 0;
-	prev1_ = 0;
+template<unsigned channels, class Sample>
+void Cic2Core<channels, Sample>::reset(unsigned div) {
+	sum2_ = sum1_ = Acc();
+	prev1_ = Acc();
 	div_ = div;
 	nextdivn_ = div;
 }
 
-template<unsigned channels>
-std::size_t Cic2Core<channels>::filter(short *out, short const *const in, std::size_t inlen) {
+template<unsigned channels, class Sample>
+std::size_t Cic2Core<channels, Sample>::filter(short *out, short const *const in, std::size_t inlen) {
 	std::size_t const produced = (inlen + div_ - nextdivn_) / div_;
 	long const mul = mulForDiv(div_);
 	short const *s = in;
-	unsigned long sm1 = sum1_;
-	unsigned long sm2 = sum2_;
+	Acc sm1 = sum1_;
+	Acc sm2 = sum2_;
 
 	if (inlen >= nextdivn_) {
 		{
 			unsigned divn = nextdivn_;
 			do {
-				sm1 += static_cast<long>(*s);
+				sm1 += Sample::load(s);
 				s += channels;
 				sm2 += sm1;
 			} while (--divn);
 
-			unsigned long const out2 = sm2;
-			sm2 = 0;
+			Acc const out2 = sm2;
+			sm2 = Acc();
 
-			*out = rshift16_round(static_cast<long>(out2 - prev1_) * mul);
+			Sample::store(out, out2 - prev1_, mul);
 			prev1_ = out2;
 			out += channels;
 		}
@@ -82,39 +85,39 @@ std::size_t Cic2Core<channels>::filter(short *out, short const *const in, std::s
 			for (std::size_t n = produced; --n;) {
 				unsigned divn = div_ >> 1;
 				do {
-					sm1 += static_cast<long>(*s);
+					sm1 += Sample::load(s);
 					s += channels;
 					sm2 += sm1;
-					sm1 += static_cast<long>(*s);
+					sm1 += Sample::load(s);
 					s += channels;
 					sm2 += sm1;
 				} while (--divn);
 
-				sm1 += static_cast<long>(*s);
+				sm1 += Sample::load(s);
 				s += channels;
 				sm2 += sm1;
 
-				*out = rshift16_round(static_cast<long>(sm2 - prev1_) * mul);
+				Sample::store(out, sm2 - prev1_, mul);
 				out += channels;
 				prev1_ = sm2;
-				sm2 = 0;
+				sm2 = Acc();
 			}
 		} else {
 			for (std::size_t n = produced; --n;) {
 				unsigned divn = div_ >> 1;
 				do {
-					sm1 += static_cast<long>(*s);
+					sm1 += Sample::load(s);
 					s += channels;
 					sm2 += sm1;
-					sm1 += static_cast<long>(*s);
+					sm1 += Sample::load(s);
 					s += channels;
 					sm2 += sm1;
 				} while (--divn);
 
-				*out = rshift16_round(static_cast<long>(sm2 - prev1_) * mul);
+				Sample::store(out, sm2 - prev1_, mul);
 				out += channels;
 				prev1_ = sm2;
-				sm2 = 0;
+				sm2 = Acc();
 			}
 		}
 
@@ -126,7 +129,7 @@ std::size_t Cic2Core<channels>::filter(short *out, short const *const in, std::s
 		nextdivn_ -= divn;
 
 		while (divn--) {
-			sm1 += static_cast<long>(*s);
+			sm1 += Sample::load(s);
 			s += channels;
 			sm2 += sm1;
 		}
@@ -150,16 +153,29 @@ public:
 
 private:
 	Cic2Core<channels> cics_[channels];
+#ifdef CIC_STEREO_SIMD
+	// filters both channels at once when the input is stereo
+	Cic2Core<channels, CicStereoSample> stereoCic_;
+#endif
 };
 
 template<unsigned channels>
-Cic2<channels>::Cic2(unsigned div) {
+Cic2<channels>::Cic2(unsigned div)
+#ifdef CIC_STEREO_SIMD
+: stereoCic_(div)
+#endif
+{
 	for (unsigned i = 0; i < channels; ++i)
 		cics_[i].reset(div);
 }
 
 template<unsigned channels>
 std::size_t Cic2<channels>::resample(short *out, short const *in, std::size_t inlen) {
+#ifdef CIC_STEREO_SIMD
+	if (channels == 2)
+		return stereoCic_.filter(out, in, inlen);
+#endif
+
 	std::size_t samplesOut;
 	for (unsigned i = 0; i < channels; ++i)
 		samplesOut = cics_[i].filter(out + i, in + i, inlen);
@@ -19,10 +19,11 @@
 #ifndef CIC3_H
 #define CIC3_H
 
+#include "cicsample.h"
 #include "rshift16_round.h"
 #include "subresampler.h"
 
-template<unsigned channels>
+template<unsigned channels, class Sample = CicMonoSample>
 class Cic3Core {
 public:
 	explicit Cic3Core(unsigned div = 1) { reset(div); }
@@ -35,11 +36,13 @@ public:
 	}
 
 private:
-	unsigned long sum1_;
-	unsigned long sum2_;
-	unsigned long sum3_;
-	unsigned long prev1_;
-	unsigned long prev2_;
+	typedef typename Sample::Acc Acc;
+
+	Acc sum1_;
+	Acc sum2_;
+	Acc sum3_;
+	Acc prev1_;
+	Acc prev2_;
 	unsigned div_;
 	unsigned nextdivn_;
 
@@ -47,21 +50,21 @@ private:
 	static long mulForDiv(unsigned div) { return 0x10000 / (div * div * div); }
 };
 
-template<unsigned channels>
-void Cic3Core<channels>::reset(unsigned div) {
-	sum3_ = sum2_ = sum1_ = 0;
-	prev2_ = prev1_ = 0;
+template<unsigned channels, class Sample>
+void Cic3Core<channels, Sample>::reset(unsigned div) {
+	sum3_ = sum2_ = sum1_ = Acc();
+	prev2_ = prev1_ = Acc();
 	div_ = div;
 	nextdivn_ = div;
 }
 
-template<unsigned channels>
-std::size_t Cic3Core<channels>::filter(short *out, short const *const in, std::size_t inlen) {
+template<unsigned channels, class Sample>
+std::size_t Cic3Core<channels, Sample>::filter(short *out, short const *const in, std::size_t inlen) {
 	std::size_t const produced = (inlen + div_ - nextdivn_) / div_;
 	short const *s = in;
-	unsigned long sm1 = sum1_;
-	unsigned long sm2 = sum2_;
-	unsigned long sm3 = sum3_;
+	Acc sm1 = sum1_;
+	Acc sm2 = sum2_;
+	Acc sm3 = sum3_;
 
 	if (inlen >= nextdivn_) {
 		long const mul = mulForDiv(div_);
@@ -70,19 +73,19 @@ std::size_t Cic3Core<channels>::filter(short *out, short const *const in, std::s
 
 		do {
 			do {
-				sm1 += static_cast<long>(*s);
+				sm1 += Sample::load(s);
 				sm2 += sm1;
 				sm3 += sm2;
 				s += channels;
 			} while (--divn);
 
-			unsigned long const out2 = sm3 - prev2_;
+			Acc const out2 = sm3 - prev2_;
 			prev2_ = sm3;
-			*out = rshift16_round(static_cast<long>(out2 - prev1_) * mul);
+			Sample::store(out, out2 - prev1_, mul);
 			prev1_ = out2;
 			out += channels;
 			divn = div_;
-			sm3 = 0;
+			sm3 = Acc();
 		} while (--n);
 
 		nextdivn_ = div_;
@@ -93,7 +96,7 @@ std::size_t Cic3Core<channels>::filter(short *out, short const *const in, std::s
 		nextdivn_ -= divn;
 
 		while (divn--) {
-			sm1 += static_cast<long>(*s);
+			sm1 += Sample::load(s);
 			sm2 += sm1;
 			sm3 += sm2;
 			s += channels;
@@ -119,16 +122,29 @@ public:
 
 private:
 	Cic3Core<channels> cics_[channels];
+#ifdef CIC_STEREO_SIMD
+	// filters both channels at once when the input is stereo
+	Cic3Core<channels, CicStereoSample> stereoCic_;
+#endif
 };
 
 template<unsigned channels>
-Cic3<channels>::Cic3(unsigned div) {
+Cic3<channels>::Cic3(unsigned div)
+#ifdef CIC_STEREO_SIMD
+: stereoCic_(div)
+#endif
+{
 	for (unsigned i = 0; i < channels; ++i)
 		cics_[i].reset(div);
 }
 
 template<unsigned channels>
 std::size_t Cic3<channels>::resample(short *out, short const *in, std::size_t inlen) {
+#ifdef CIC_STEREO_SIMD
+	if (channels == 2)
+		return stereoCic_.filter(out, in, inlen);
+#endif
+
 	std::size_t samplesOut;
 	for (unsigned i = 0; i < channels; ++i)
 		samplesOut = cics_[i].filter(out + i, in + i, inlen);
@@ -19,10 +19,11 @@
 #ifndef CIC4_H
 #define CIC4_H
 
+#include "cicsample.h"
 #include "rshift16_round.h"
 #include "subresampler.h"
 
-template<unsigned channels>
+template<unsigned channels, class Sample = CicMonoSample>
 class Cic4Core {
 public:
 	explicit Cic4Core(unsigned div = 1) { reset(div); }
@@ -35,16 +36,18 @@ public:
 	}
 
 private:
+	typedef typename Sample::Acc Acc;
+
 	enum { buf_len = 64 };
-	unsigned long buf_[buf_len];
-	unsigned long sum1_;
-	unsigned long sum2_;
-	unsigned long sum3_;
-	unsigned long sum4_;
-	unsigned long prev1_;
-	unsigned long prev2_;
-	unsigned long prev3_;
-	unsigned long prev4_;
+	Acc buf_[buf_len];
+	Acc sum1_;
+	Acc sum2_;
+	Acc sum3_;
+	Acc sum4_;
+	Acc prev1_;
+	Acc prev2_;
+	Acc prev3_;
+	Acc prev4_;
 	unsigned div_;
 	unsigned bufpos_;
 
@@ -52,45 +55,45 @@ private:
 	static long mulForDiv(unsigned div) { return 0x10000 / (div * div * div * div); }
 };
 
-template<unsigned channels>
-void Cic4Core<channels>::reset(unsigned div) {
-	sum4_ = sum3_ = sum2_ = sum1_ = 0;
-	prev4_ = prev3_ = prev2_ = prev1_ = 0;
+template<unsigned channels, class Sample>
+void Cic4Core<channels, Sample>::reset(unsigned div) {
+	sum4_ = sum3_ = sum2_ = sum1_ = Acc();
+	prev4_ = prev3_ = prev2_ = prev1_ = Acc();
 	div_ = div;
 	bufpos_ = div - 1;
 }
 
-template<unsigned channels>
-std::size_t Cic4Core<channels>::filter(short *out, short const *const in, std::size_t inlen) {
+template<unsigned channels, class Sample>
+std::size_t Cic4Core<channels, Sample>::filter(short *out, short const *const in, std::size_t inlen) {
 	std::size_t const produced = (inlen + div_ - (bufpos_ + 1)) / div_;
 	long const mul = mulForDiv(div_);
 	short const *s = in;
 
-	unsigned long sm1 = sum1_;
-	unsigned long sm2 = sum2_;
-	unsigned long sm3 = sum3_;
-	unsigned long sm4 = sum4_;
-	unsigned long prv1 = prev1_;
-	unsigned long prv2 = prev2_;
-	unsigned long prv3 = prev3_;
-	unsigned long prv4 = prev4_;
+	Acc sm1 = sum1_;
+	Acc sm2 = sum2_;
+	Acc sm3 = sum3_;
+	Acc sm4 = sum4_;
+	Acc prv1 = prev1_;
+	Acc prv2 = prev2_;
+	Acc prv3 = prev3_;
+	Acc prv4 = prev4_;
 
 	while (inlen >> 2) {
 		unsigned const end = inlen < buf_len ? inlen & ~3 : buf_len & ~3;
-		unsigned long *b = buf_;
+		Acc *b = buf_;
 		unsigned n = end;
 
 		do {
-			unsigned long s1 = sm1 += static_cast<long>(s[0 * channels]);
-			sm1 += static_cast<long>(s[1 * channels]);
-			unsigned long s2 = sm2 += s1;
+			Acc s1 = sm1 += Sample::load(s + 0 * channels);
+			sm1 += Sample::load(s + 1 * channels);
+			Acc s2 = sm2 += s1;
 			sm2 += sm1;
-			unsigned long s3 = sm3 += s2;
+			Acc s3 = sm3 += s2;
 			sm3 += sm2;
 			b[0] = sm4 += s3;
 			b[1] = sm4 += sm3;
-			s1 = sm1 += static_cast<long>(s[2 * channels]);
-			sm1 += static_cast<long>(s[3 * channels]);
+			s1 = sm1 += Sample::load(s + 2 * channels);
+			sm1 += Sample::load(s + 3 * channels);
 			s2 = sm2 += s1;
 			sm2 += sm1;
 			s3 = sm3 += s2;
@@ -102,16 +105,16 @@ std::size_t Cic4Core<channels>::filter(short *out, short const *const in, std::s
 		} while (n -= 4);
 
 		while (bufpos_ < end) {
-			unsigned long const out4 = buf_[bufpos_] - prv4;
+			Acc const out4 = buf_[bufpos_] - prv4;
 			prv4 = buf_[bufpos_];
 			bufpos_ += div_;
 
-			unsigned long const out3 = out4 - prv3;
+			Acc const out3 = out4 - prv3;
 			prv3 = out4;
-			unsigned long const out2 = out3 - prv2;
+			Acc const out2 = out3 - prv2;
 			prv2 = out3;
 
-			*out = rshift16_round(static_cast<long>(out2 - prv1) * mul);
+			Sample::store(out, out2 - prv1, mul);
 			prv1 = out2;
 			out += channels;
 		}
@@ -125,7 +128,7 @@ std::size_t Cic4Core<channels>::filter(short *out, short const *const in, std::s
 		unsigned i = 0;
 
 		do {
-			sm1 += static_cast<long>(*s);
+			sm1 += Sample::load(s);
 			s += channels;
 			sm2 += sm1;
 			sm3 += sm2;
@@ -133,16 +136,16 @@ std::size_t Cic4Core<channels>::filter(short *out, short const *const in, std::s
 		} while (--n);
 
 		while (bufpos_ < inlen) {
-			unsigned long const out4 = buf_[bufpos_] - prv4;
+			Acc const out4 = buf_[bufpos_] - prv4;
 			prv4 = buf_[bufpos_];
 			bufpos_ += div_;
 
-			unsigned long const out3 = out4 - prv3;
+			Acc const out3 = out4 - prv3;
 			prv3 = out4;
-			unsigned long const out2 = out3 - prv2;
+			Acc const out2 = out3 - prv2;
 			prv2 = out3;
 
-			*out = rshift16_round(static_cast<long>(out2 - prv1) * mul);
+			Sample::store(out, out2 - prv1, mul);
 			prv1 = out2;
 			out += channels;
 		}
@@ -174,16 +177,29 @@ public:
 
 private:
 	Cic4Core<channels> cics_[channels];
+#ifdef CIC_STEREO_SIMD
+	// filters both channels at once when the input is stereo
+	Cic4Core<channels, CicStereoSample> stereoCic_;
+#endif
 };
 
 template<unsigned channels>
-Cic4<channels>::Cic4(unsigned div) {
+Cic4<channels>::Cic4(unsigned div)
+#ifdef CIC_STEREO_SIMD
+: stereoCic_(div)
+#endif
+{
 	for (unsigned i = 0; i < channels; ++i)
 		cics_[i].reset(div);
 }
 
 template<unsigned channels>
 std::size_t Cic4<channels>::resample(short *out, short const *in, std::size_t inlen) {
+#ifdef CIC_STEREO_SIMD
+	if (channels == 2)
+		return stereoCic_.filter(out, in, inlen);
+#endif
+
 	std::size_t samplesOut;
 	for (unsigned i = 0; i < channels; ++i)
 		samplesOut = cics_[i].filter(out + i, in + i, inlen);
@@ -0,0 +1,105 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License version 2 as     *
+ *   published by the Free Software Foundation.                            *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License version 2 for more details.                *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   version 2 along with this program; if not, write to the               *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.             *
+ ***************************************************************************/
+#ifndef CICSAMPLE_H
+#define CICSAMPLE_H
+
+#include "rshift16_round.h"
+#include <cstring>
+
+#if defined RESAMPLE_NO_SIMD
+#elif defined __SSE2__
+#include <emmintrin.h>
+#define CIC_STEREO_SIMD 1
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#define CIC_STEREO_SIMD 1
+#endif
+
+// The integrator and comb arithmetic of the CIC cores. A core instantiated with
+// CicMonoSample runs one channel, one with CicStereoSample runs both channels of
+// interleaved stereo input in the lanes of a SIMD register.
+//
+// The integrators wrap modulo the accumulator width, which is fine as long as the
+// comb output fits in it. With the MAX_DIV of each Cic that stays below 2^31, so
+// the 32-bit stereo lanes give the same output as unsigned long.
+
+class CicMonoSample {
+public:
+	typedef unsigned long Acc;
+
+	static Acc load(short const *s) { return static_cast<long>(*s); }
+
+	static void store(short *out, Acc v, long mul) {
+		*out = rshift16_round(static_cast<long>(v) * mul);
+	}
+};
+
+#ifdef CIC_STEREO_SIMD
+class CicStereoSample {
+public:
+	class Acc {
+	public:
+		Acc() : v_(zero()) {}
+
+		Acc & operator+=(Acc const &a) { v_ = add(v_, a.v_); return *this; }
+		Acc operator-(Acc const &a) const { return Acc(sub(v_, a.v_)); }
+		long left() const { return lane<0>(v_); }
+		long right() const { return lane<1>(v_); }
+
+#ifdef __SSE2__
+		typedef __m128i Vec;
+		explicit Acc(Vec v) : v_(v) {}
+		static Acc load(short const *s) {
+			int lr;
+			std::memcpy(&lr, s, sizeof lr);
+			__m128i const v = _mm_cvtsi32_si128(lr);
+			return Acc(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+		}
+
+	private:
+		static Vec zero() { return _mm_setzero_si128(); }
+		static Vec add(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+		static Vec sub(Vec a, Vec b) { return _mm_sub_epi32(a, b); }
+		template<int i> static long lane(Vec v) { return _mm_cvtsi128_si32(_mm_srli_si128(v, i * 4)); }
+#else
+		typedef int32x2_t Vec;
+		explicit Acc(Vec v) : v_(v) {}
+		static Acc load(short const *s) {
+			unsigned lr;
+			std::memcpy(&lr, s, sizeof lr);
+			return Acc(vget_low_s32(vmovl_s16(vreinterpret_s16_u32(vdup_n_u32(lr)))));
+		}
+
+	private:
+		static Vec zero() { return vdup_n_s32(0); }
+		static Vec add(Vec a, Vec b) { return vadd_s32(a, b); }
+		static Vec sub(Vec a, Vec b) { return vsub_s32(a, b); }
+		template<int i> static long lane(Vec v) { return vget_lane_s32(v, i); }
+#endif
+
+		Vec v_;
+	};
+
+	static Acc load(short const *s) { return Acc::load(s); }
+
+	static void store(short *out, Acc const &v, long mul) {
+		out[0] = rshift16_round(v.left() * mul);
+		out[1] = rshift16_round(v.right() * mul);
+	}
+};
+#endif
+
+#endif
@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License version 2 as     *
+ *   published by the Free Software Foundation.                            *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License version 2 for more details.                *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   version 2 along with this program; if not, write to the               *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.             *
+ ***************************************************************************/
+#include "firdot.h"
+
+#if defined RESAMPLE_NO_SIMD
+#elif defined __SSE2__
+#include <immintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+static inline void addTail(short const *k, short const *s, std::size_t i, std::size_t n,
+                           long &l, long &r)
+{
+	for (; i < n; ++i) {
+		l += k[i] * s[2 * i];
+		r += k[i] * s[2 * i + 1];
+	}
+}
+
+static void stereoFirDotScalar(short const *k, short const *s, std::size_t n, long &l, long &r) {
+	l = r = 0;
+	addTail(k, s, 0, n, l, r);
+}
+
+#if defined RESAMPLE_NO_SIMD
+
+static StereoFirDotVersion const versions[] = { { "scalar", stereoFirDotScalar } };
+static std::size_t const numVersions = 1;
+
+#elif defined __SSE2__
+
+// Reorders L0 R0 L1 R1 L2 R2 L3 R3 to L0 L1 R0 R1 L2 L3 R2 R3 so pmaddwd with
+// k0 k1 k0 k1 k2 k3 k2 k3 sums pairs of taps per channel, leaving 32-bit lanes
+// that alternate between left and right.
+static inline __m128i madd4(short const *k, short const *s) {
+	__m128i const lr = _mm_loadu_si128(reinterpret_cast<__m128i const *>(s));
+	__m128i const pairs = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lr, _MM_SHUFFLE(3, 1, 2, 0)),
+	                                          _MM_SHUFFLE(3, 1, 2, 0));
+	__m128i const kk = _mm_shuffle_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(k)),
+	                                     _MM_SHUFFLE(1, 1, 0, 0));
+	return _mm_madd_epi16(pairs, kk);
+}
+
+static inline void sumLanes(__m128i acc, short const *k, short const *s, std::size_t i,
+                            std::size_t n, long &l, long &r)
+{
+	acc = _mm_add_epi32(acc, _mm_unpackhi_epi64(acc, acc));
+	l = _mm_cvtsi128_si32(acc);
+	r = _mm_cvtsi128_si32(_mm_srli_si128(acc, 4));
+	addTail(k, s, i, n, l, r);
+}
+
+static void stereoFirDotSse2(short const *k, short const *s, std::size_t n, long &l, long &r) {
+	__m128i acc0 = _mm_setzero_si128();
+	__m128i acc1 = _mm_setzero_si128();
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		acc0 = _mm_add_epi32(acc0, madd4(k + i, s + 2 * i));
+		acc1 = _mm_add_epi32(acc1, madd4(k + i + 4, s + 2 * i + 8));
+	}
+
+	if (i + 4 <= n) {
+		acc0 = _mm_add_epi32(acc0, madd4(k + i, s + 2 * i));
+		i += 4;
+	}
+
+	sumLanes(_mm_add_epi32(acc0, acc1), k, s, i, n, l, r);
+}
+
+// Same as the SSE2 version on 8 frames at a time, the in-lane word shuffles
+// working per 128-bit half and the taps spread with a cross-lane permute.
+__attribute__((target("avx2")))
+static void stereoFirDotAvx2(short const *k, short const *s, std::size_t n, long &l, long &r) {
+	__m256i const spread = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+	__m256i acc = _mm256_setzero_si256();
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i const lr = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(s + 2 * i));
+		__m256i const pairs = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lr, _MM_SHUFFLE(3, 1, 2, 0)),
+		                                             _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i const taps = _mm_loadu_si128(reinterpret_cast<__m128i const *>(k + i));
+		__m256i const kk = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(taps), spread);
+		acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, kk));
+	}
+
+	__m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+	if (i + 4 <= n) {
+		acc128 = _mm_add_epi32(acc128, madd4(k + i, s + 2 * i));
+		i += 4;
+	}
+
+	sumLanes(acc128, k, s, i, n, l, r);
+}
+
+static StereoFirDotVersion const versions[] = {
+	{ "AVX2", stereoFirDotAvx2 },
+	{ "SSE2", stereoFirDotSse2 },
+	{ "scalar", stereoFirDotScalar },
+};
+
+static std::size_t countVersions() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? 3 : 2;
+}
+
+static std::size_t const numVersions = countVersions();
+
+#elif defined __ARM_NEON
+
+// vld2 splits the channels, leaving plain widening multiply-accumulates
+static void stereoFirDotNeon(short const *k, short const *s, std::size_t n, long &l, long &r) {
+	int32x4_t accl = vdupq_n_s32(0);
+	int32x4_t accr = vdupq_n_s32(0);
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int16x8x2_t const lr = vld2q_s16(s + 2 * i);
+		int16x8_t const kk = vld1q_s16(k + i);
+		accl = vmlal_s16(accl, vget_low_s16(lr.val[0]), vget_low_s16(kk));
+		accl = vmlal_s16(accl, vget_high_s16(lr.val[0]), vget_high_s16(kk));
+		accr = vmlal_s16(accr, vget_low_s16(lr.val[1]), vget_low_s16(kk));
+		accr = vmlal_s16(accr, vget_high_s16(lr.val[1]), vget_high_s16(kk));
+	}
+
+	int32x2_t const sum = vpadd_s32(vadd_s32(vget_low_s32(accl), vget_high_s32(accl)),
+	                                vadd_s32(vget_low_s32(accr), vget_high_s32(accr)));
+	l = vget_lane_s32(sum, 0);
+	r = vget_lane_s32(sum, 1);
+	addTail(k, s, i, n, l, r);
+}
+
+static StereoFirDotVersion const versions[] = {
+	{ "NEON", stereoFirDotNeon },
+	{ "scalar", stereoFirDotScalar },
+};
+static std::size_t const numVersions = 2;
+
+#else
+
+static StereoFirDotVersion const versions[] = { { "scalar", stereoFirDotScalar } };
+static std::size_t const numVersions = 1;
+
+#endif
+
+std::size_t stereoFirDotVersions(StereoFirDotVersion const *&v) {
+	v = versions + (sizeof versions / sizeof *versions - numVersions);
+	return numVersions;
+}
+
+StereoFirDot stereoFirDot = versions[sizeof versions / sizeof *versions - numVersions].dot;
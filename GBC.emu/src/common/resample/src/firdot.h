@@ -0,0 +1,42 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License version 2 as     *
+ *   published by the Free Software Foundation.                            *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License version 2 for more details.                *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   version 2 along with this program; if not, write to the               *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.             *
+ ***************************************************************************/
+#ifndef FIRDOT_H
+#define FIRDOT_H
+
+#include <cstddef>
+
+// Inner product of n kernel taps with interleaved stereo samples, summing
+// kernel[i] * s[2 * i] into l and kernel[i] * s[2 * i + 1] into r.
+//
+// The SIMD versions accumulate in 32 bits. That only changes bits of the sums
+// above the ones rshift16_round moves into a 16-bit output sample, so the
+// resampled output is the same as with the scalar long sums.
+typedef void (*StereoFirDot)(short const *kernel, short const *s, std::size_t n, long &l, long &r);
+
+// fastest version for the CPU, picked at startup
+extern StereoFirDot stereoFirDot;
+
+struct StereoFirDotVersion {
+	char const *name;
+	StereoFirDot dot;
+};
+
+// The versions the CPU can run, fastest first, so a benchmark can time each one
+// by pointing stereoFirDot at it. Building with RESAMPLE_NO_SIMD leaves only the
+// scalar version, here and in the CIC stages.
+std::size_t stereoFirDotVersions(StereoFirDotVersion const *&versions);
+
+#endif
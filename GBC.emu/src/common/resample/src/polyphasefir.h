@@ -20,6 +20,7 @@
 #define POLYPHASEFIR_H
 
 #include "array.h"
+#include "firdot.h"
 #include "rshift16_round.h"
 #include <algorithm>
 #include <cstring>
@@ -120,6 +121,18 @@ std::size_t PolyphaseFir<channels, phases>::filter(short *out,
 	// and we would end up referencing more variables which often compiles to bad
 	// code on x86, which is why I'm also hesitant to get rid of the template arguments.
 	for (; x < inlen; x += div_) {
+		if (channels == 2) {
+			// adjust phase so we do not start on a virtual 0 sample
+			short const *k = kernel_ + ((x + 1) % phases) * phaseLen;
+			long accl, accr;
+			stereoFirDot(k, in + (x / phases + 1 - phaseLen) * channels, phaseLen, accl, accr);
+
+			out[0] = rshift16_round(accl);
+			out[1] = rshift16_round(accr);
+			out += 2;
+			continue;
+		}
+
 		for (int c = 0; c < channels-1; c += 2) {
 			// adjust phase so we do not start on a virtual 0 sample
 			short const *k = kernel_ + ((x + 1) % phases) * phaseLen;
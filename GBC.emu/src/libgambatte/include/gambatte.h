@@ -24,6 +24,7 @@
 #include "loadres.h"
 #include <cstddef>
 #include <string>
+#include <vector>
 #include <imagine/util/DelegateFunc.hh>
 
 namespace gambatte {
@@ -154,6 +155,27 @@ public:
 	  */
 	bool loadState(std::string const &filepath);
 
+	/**
+	  * Saves emulator state to 'buf' in the same format as state files, replacing
+	  * its contents. Reusing one buffer avoids reallocating it on every save.
+	  *
+	  * @param  videoBuf 160x144 RGB32 (native endian) video frame buffer or 0 to skip
+	  *                  the thumbnail.
+	  * @param  pitch distance in number of pixels (not bytes) from the start of one line
+	  *               to the next in videoBuf.
+	  * @return success
+	  */
+	bool saveState(std::vector<char> &buf,
+	               gambatte::uint_least32_t const *videoBuf = 0, std::ptrdiff_t pitch = 0);
+
+	/**
+	  * Loads emulator state from memory holding a state from saveState() or the
+	  * contents of a state file. Unlike loading from a file, battery save data
+	  * isn't written out first.
+	  * @return success
+	  */
+	bool loadState(char const *data, std::size_t size);
+
 	/**
 	  * Selects which state slot to save state to or load state from.
 	  * There are 10 such slots, numbered from 0 to 9 (periodically extended for all n).
@@ -195,6 +195,33 @@ bool GB::saveState(gambatte::uint_least32_t const *videoBuf, std::ptrdiff_t pitc
 	return false;
 }
 
+bool GB::saveState(std::vector<char> &buf,
+                   gambatte::uint_least32_t const *videoBuf, std::ptrdiff_t pitch) {
+	if (p_->cpu.loaded()) {
+		SaveState state;
+		p_->cpu.setStatePtrs(state);
+		p_->cpu.saveState(state);
+		StateSaver::saveState(state, videoBuf, pitch, buf);
+		return true;
+	}
+
+	return false;
+}
+
+bool GB::loadState(char const *data, std::size_t size) {
+	if (p_->cpu.loaded()) {
+		SaveState state = SaveState();
+		p_->cpu.setStatePtrs(state);
+
+		if (StateSaver::loadState(state, data, size)) {
+			p_->cpu.loadState(state);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void GB::selectState(int n) {
 	n -= (n / 10) * 10;
 	p_->stateNo = n < 0 ? n + 10 : n;
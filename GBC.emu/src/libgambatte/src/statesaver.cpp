@@ -24,6 +24,7 @@
 #include <fstream>
 #include <functional>
 #include <vector>
+#include <cstdio>
 #include <cstring>
 
 namespace {
@@ -41,10 +42,85 @@ enum AsciiChar {
 	  p,   q,   r,   s,   t,   u,   v,   w,   x,   y,   z, LBR, BAR, RBR, TLD, DEL
 };
 
+// Save states are built in and parsed from memory, so RAM sections are single
+// copies and the many small fields cost no stream calls. File states are
+// written and read in one go.
+class omemstream {
+public:
+	explicit omemstream(std::vector<char> &buf) : buf_(buf) {}
+	void put(char c) { buf_.push_back(c); }
+	void write(char const *data, std::size_t size) { buf_.insert(buf_.end(), data, data + size); }
+
+private:
+	std::vector<char> &buf_;
+};
+
+// Follows the std::istream semantics the loader relies on: reads past the end
+// return EOF and clear good(), as does a getline() that fills its buffer
+// without finding the delimiter.
+class imemstream {
+public:
+	imemstream(char const *data, std::size_t size)
+	: p_(data), end_(data + size), good_(true)
+	{
+	}
+
+	int get() {
+		if (p_ == end_) {
+			good_ = false;
+			return EOF;
+		}
+
+		return *p_++ & 0xFF;
+	}
+
+	void ignore(std::size_t n = 1) {
+		if (n > left()) {
+			good_ = false;
+			n = left();
+		}
+
+		p_ += n;
+	}
+
+	void read(char *s, std::size_t n) {
+		if (n > left()) {
+			good_ = false;
+			n = left();
+		}
+
+		std::memcpy(s, p_, n);
+		p_ += n;
+	}
+
+	void getline(char *s, std::size_t n, char delim) {
+		// the delimiter may directly follow n - 1 characters
+		char const *const end = p_ + std::min(n, left());
+		char const *const found = std::find(p_, end, delim);
+		std::size_t const len = std::min<std::size_t>(found - p_, n - 1);
+		std::memcpy(s, p_, len);
+		s[len] = NUL;
+		if (found == end) {
+			good_ = false;
+			p_ += len;
+		} else
+			p_ = found + 1;
+	}
+
+	bool good() const { return good_; }
+
+private:
+	char const *p_;
+	char const *const end_;
+	bool good_;
+
+	std::size_t left() const { return end_ - p_; }
+};
+
 struct Saver {
 	char const *label;
-	void (*save)(std::ofstream &file, SaveState const &state);
-	void (*load)(std::ifstream &file, SaveState &state);
+	void (*save)(omemstream &file, SaveState const &state);
+	void (*load)(imemstream &file, SaveState &state);
 	std::size_t labelsize;
 };
 
@@ -52,56 +128,56 @@ inline bool operator<(Saver const &l, Saver const &r) {
 	return std::strcmp(l.label, r.label) < 0;
 }
 
-void put24(std::ofstream &file, unsigned long data) {
+void put24(omemstream &file, unsigned long data) {
 	file.put(data >> 16 & 0xFF);
 	file.put(data >>  8 & 0xFF);
 	file.put(data       & 0xFF);
 }
 
-void put32(std::ofstream &file, unsigned long data) {
+void put32(omemstream &file, unsigned long data) {
 	file.put(data >> 24 & 0xFF);
 	file.put(data >> 16 & 0xFF);
 	file.put(data >>  8 & 0xFF);
 	file.put(data       & 0xFF);
 }
 
-void write(std::ofstream &file, unsigned char data) {
+void write(omemstream &file, unsigned char data) {
 	static char const inf[] = { 0x00, 0x00, 0x01 };
 	file.write(inf, sizeof inf);
 	file.put(data & 0xFF);
 }
 
-void write(std::ofstream &file, unsigned short data) {
+void write(omemstream &file, unsigned short data) {
 	static char const inf[] = { 0x00, 0x00, 0x02 };
 	file.write(inf, sizeof inf);
 	file.put(data >> 8 & 0xFF);
 	file.put(data      & 0xFF);
 }
 
-void write(std::ofstream &file, unsigned long data) {
+void write(omemstream &file, unsigned long data) {
 	static char const inf[] = { 0x00, 0x00, 0x04 };
 	file.write(inf, sizeof inf);
 	put32(file, data);
 }
 
-void write(std::ofstream &file, unsigned char const *data, std::size_t size) {
+void write(omemstream &file, unsigned char const *data, std::size_t size) {
 	put24(file, size);
 	file.write(reinterpret_cast<char const *>(data), size);
 }
 
-void write(std::ofstream &file, bool const *data, std::size_t size) {
+void write(omemstream &file, bool const *data, std::size_t size) {
 	put24(file, size);
 	std::for_each(data, data + size,
 		[&file](auto &&data){ file.put(data); });
 }
 
-unsigned long get24(std::ifstream &file) {
+unsigned long get24(imemstream &file) {
 	unsigned long tmp = file.get() & 0xFF;
 	tmp =   tmp << 8 | (file.get() & 0xFF);
 	return  tmp << 8 | (file.get() & 0xFF);
 }
 
-unsigned long read(std::ifstream &file) {
+unsigned long read(imemstream &file) {
 	unsigned long size = get24(file);
 	if (size > 4) {
 		file.ignore(size - 4);
@@ -119,19 +195,19 @@ unsigned long read(std::ifstream &file) {
 	return out;
 }
 
-inline void read(std::ifstream &file, unsigned char &data) {
+inline void read(imemstream &file, unsigned char &data) {
 	data = read(file) & 0xFF;
 }
 
-inline void read(std::ifstream &file, unsigned short &data) {
+inline void read(imemstream &file, unsigned short &data) {
 	data = read(file) & 0xFFFF;
 }
 
-inline void read(std::ifstream &file, unsigned long &data) {
+inline void read(imemstream &file, unsigned long &data) {
 	data = read(file);
 }
 
-void read(std::ifstream &file, unsigned char *buf, std::size_t bufsize) {
+void read(imemstream &file, unsigned char *buf, std::size_t bufsize) {
 	std::size_t const size = get24(file);
 	std::size_t const minsize = std::min(size, bufsize);
 	file.read(reinterpret_cast<char*>(buf), minsize);
@@ -143,7 +219,7 @@ void read(std::ifstream &file, unsigned char *buf, std::size_t bufsize) {
 	}
 }
 
-void read(std::ifstream &file, bool *buf, std::size_t bufsize) {
+void read(imemstream &file, bool *buf, std::size_t bufsize) {
 	std::size_t const size = get24(file);
 	std::size_t const minsize = std::min(size, bufsize);
 	for (std::size_t i = 0; i < minsize; ++i)
@@ -172,8 +248,8 @@ private:
 };
 
 static void push(SaverList::list_t &list, char const *label,
-		void (*save)(std::ofstream &file, SaveState const &state),
-		void (*load)(std::ifstream &file, SaveState &state),
+		void (*save)(omemstream &file, SaveState const &state),
+		void (*load)(imemstream &file, SaveState &state),
 		std::size_t labelsize) {
 	Saver saver = { label, save, load, labelsize };
 	list.push_back(saver);
@@ -184,18 +260,18 @@ SaverList::SaverList()
 {
 #define ADD(arg) do { \
 	struct Func { \
-		static void save(std::ofstream &file, SaveState const &state) { write(file, state.arg); } \
-		static void load(std::ifstream &file, SaveState &state) { read(file, state.arg); } \
+		static void save(omemstream &file, SaveState const &state) { write(file, state.arg); } \
+		static void load(imemstream &file, SaveState &state) { read(file, state.arg); } \
 	}; \
 	push(list, label, Func::save, Func::load, sizeof label); \
 } while (0)
 
 #define ADDPTR(arg) do { \
 	struct Func { \
-		static void save(std::ofstream &file, SaveState const &state) { \
+		static void save(omemstream &file, SaveState const &state) { \
 			write(file, state.arg.get(), state.arg.size()); \
 		} \
-		static void load(std::ifstream &file, SaveState &state) { \
+		static void load(imemstream &file, SaveState &state) { \
 			read(file, state.arg.ptr, state.arg.size()); \
 		} \
 	}; \
@@ -204,10 +280,10 @@ SaverList::SaverList()
 
 #define ADDARRAY(arg) do { \
 	struct Func { \
-		static void save(std::ofstream &file, SaveState const &state) { \
+		static void save(omemstream &file, SaveState const &state) { \
 			write(file, state.arg, sizeof state.arg); \
 		} \
-		static void load(std::ifstream &file, SaveState &state) { \
+		static void load(imemstream &file, SaveState &state) { \
 			read(file, state.arg, sizeof state.arg); \
 		} \
 	}; \
@@ -361,7 +437,7 @@ void blendPairs(RgbSum *const dst, RgbSum const *const sums) {
 	dst->g  = sums[1].g  * 8 + (sums[0].g  - sums[1].g ) * 3;
 }
 
-void writeSnapShot(std::ofstream &file, uint_least32_t const *src, std::ptrdiff_t const pitch) {
+void writeSnapShot(omemstream &file, uint_least32_t const *src, std::ptrdiff_t const pitch) {
 	put24(file, src ? StateSaver::ss_width * StateSaver::ss_height * sizeof *src : 0);
 
 	if (src) {
@@ -395,12 +471,11 @@ SaverList list;
 
 } // anon namespace
 
-bool StateSaver::saveState(SaveState const &state,
+void StateSaver::saveState(SaveState const &state,
 		uint_least32_t const *const videoBuf,
-		std::ptrdiff_t const pitch, std::string const &filename) {
-	std::ofstream file(filename.c_str(), std::ios_base::binary);
-	if (!file)
-		return false;
+		std::ptrdiff_t const pitch, std::vector<char> &buf) {
+	buf.clear();
+	omemstream file(buf);
 
 	{ static char const ver[] = { 0, 1 }; file.write(ver, sizeof ver); }
 	writeSnapShot(file, videoBuf, pitch);
@@ -409,13 +484,25 @@ bool StateSaver::saveState(SaveState const &state,
 		file.write(it->label, it->labelsize);
 		(*it->save)(file, state);
 	}
+}
+
+bool StateSaver::saveState(SaveState const &state,
+		uint_least32_t const *const videoBuf,
+		std::ptrdiff_t const pitch, std::string const &filename) {
+	std::vector<char> buf;
+	saveState(state, videoBuf, pitch, buf);
+
+	std::ofstream file(filename.c_str(), std::ios_base::binary);
+	if (!file)
+		return false;
 
+	file.write(buf.data(), buf.size());
 	return !file.fail();
 }
 
-bool StateSaver::loadState(SaveState &state, std::string const &filename) {
-	std::ifstream file(filename.c_str(), std::ios_base::binary);
-	if (!file || file.get() != 0)
+bool StateSaver::loadState(SaveState &state, char const *data, std::size_t size) {
+	imemstream file(data, size);
+	if (file.get() != 0)
 		return false;
 
 	file.ignore();
@@ -446,3 +533,20 @@ bool StateSaver::loadState(SaveState &state, std::string const &filename) {
 
 	return true;
 }
+
+bool StateSaver::loadState(SaveState &state, std::string const &filename) {
+	std::ifstream file(filename.c_str(), std::ios_base::binary | std::ios_base::ate);
+	if (!file)
+		return false;
+
+	std::streamoff const size = file.tellg();
+	if (size <= 0)
+		return false;
+
+	std::vector<char> buf(size);
+	file.seekg(0);
+	if (!file.read(buf.data(), size))
+		return false;
+
+	return loadState(state, buf.data(), buf.size());
+}
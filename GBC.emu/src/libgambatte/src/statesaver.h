@@ -23,6 +23,7 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace gambatte {
 
@@ -40,6 +41,12 @@ public:
 			std::string const &filename);
 	static bool loadState(SaveState &state, std::string const &filename);
 
+	// in-memory versions, saveState() replaces the contents of buf
+	static void saveState(SaveState const &state,
+			uint_least32_t const *videoBuf, std::ptrdiff_t pitch,
+			std::vector<char> &buf);
+	static bool loadState(SaveState &state, char const *data, std::size_t size);
+
 private:
 	StateSaver();
 };
@@ -194,6 +194,8 @@ EmuSystem::Error EmuSystem::loadGame(IO &io, EmuSystemCreateParams, OnLoadProgre
 	return {};
 }
 
+uint8_t EmuSystem::subsystem() { return gbEmu.isCgb(); }
+
 void EmuSystem::onPrepareVideo(EmuVideo &video)
 {
 	auto fmt = (IG::PixelFormatID)optionRenderPixelFormat.val;
@@ -27,6 +27,8 @@ static const int16 config_mg = 1;
 static const int16 config_hg = 1;
 static const double config_rolloff = 0.990;
 extern bool config_ym2413_enabled;
+enum { SVP_CACHE_OFF, SVP_CACHE_ON, SVP_CACHE_VERIFY };
+extern uint8 config_svp_cache;
 static const int16 config_ym2612_clip = 1;
 static const uint8 config_force_dtack = 0;
 static const uint8 config_addr_error = 1;
@@ -810,6 +810,7 @@ int md_cart_context_load(uint8 *state)
     load_param(svp->iram_rom, 0x800);
     load_param(svp->dram,sizeof(svp->dram));
     load_param(&svp->ssp1601,sizeof(ssp1601_t));
+    ssp1601_invalidate_cache();
   }
   #endif
 
@@ -342,6 +342,7 @@
 static ssp1601_t *ssp = NULL;
 static unsigned short *PC;
 static int g_cycles;
+static int iram_dirty = 1; // IRAM written since the block cache looked up an IRAM image
 
 #ifdef USE_DEBUGGER
 static int running = 0;
@@ -533,6 +534,7 @@ static u32 pm_io(int reg, int write, u32 d)
         elprintf(EL_SVP, "ssp IRAM w [%06x] %04x (inc %i)", (addr<<1)&0x7ff, d, inc >> 16);
 #endif
         ((unsigned short *)svp->iram_rom)[addr&0x3ff] = d;
+        iram_dirty = 1;
         ssp->pmac_write[reg] += inc;
       }
 #ifdef LOG_SVP
@@ -982,6 +984,7 @@ void ssp1601_reset(ssp1601_t *l_ssp)
   rPC = 0x400;
   rSTACK = 0; // ? using ascending stack
   rST = 0;
+  ssp1601_invalidate_cache();
 }
 
 
@@ -1086,241 +1089,718 @@ static void debug(unsigned int pc, unsigned int op)
 #endif // USE_DEBUGGER
 
 
-void ssp1601_run(int cycles)
+// -----------------------------------------------------
+// instruction execution
+
+// run one instruction, PC points past its opcode
+static inline __attribute__((always_inline)) void ssp_exec(int op)
 {
-  SET_PC(rPC);
-  g_cycles = cycles;
+  u32 tmpv;
 
-  do
+  switch (op >> 9)
   {
-    int op;
-    u32 tmpv;
-
-    op = *PC++;
-#ifdef USE_DEBUGGER
-    debug(GET_PC()-1, op);
-#endif
-    switch (op >> 9)
-    {
-      // ld d, s
-      case 0x00:
-        if (op == 0) break; // nop
-        if (op == ((SSP_A<<4)|SSP_P)) { // A <- P
-          // not sure. MAME claims that only hi word is transfered.
-          read_P(); // update P
-          rA32 = rP.v;
-        }
-        else
-        {
-          tmpv = REG_READ(op & 0x0f);
-          REG_WRITE((op & 0xf0) >> 4, tmpv);
-        }
-        break;
-
-      // ld d, (ri)
-      case 0x01: tmpv = ptr1_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+    // ld d, s
+    case 0x00:
+      if (op == 0) break; // nop
+      if (op == ((SSP_A<<4)|SSP_P)) { // A <- P
+        // not sure. MAME claims that only hi word is transfered.
+        read_P(); // update P
+        rA32 = rP.v;
+      }
+      else
+      {
+        tmpv = REG_READ(op & 0x0f);
+        REG_WRITE((op & 0xf0) >> 4, tmpv);
+      }
+      break;
 
-      // ld (ri), s
-      case 0x02: tmpv = REG_READ((op & 0xf0) >> 4); ptr1_write(op, tmpv); break;
+    // ld d, (ri)
+    case 0x01: tmpv = ptr1_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
 
-      // ldi d, imm
-      case 0x04: tmpv = *PC++; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+    // ld (ri), s
+    case 0x02: tmpv = REG_READ((op & 0xf0) >> 4); ptr1_write(op, tmpv); break;
 
-      // ld d, ((ri))
-      case 0x05: tmpv = ptr2_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+    // ldi d, imm
+    case 0x04: tmpv = *PC++; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
 
-      // ldi (ri), imm
-      case 0x06: tmpv = *PC++; ptr1_write(op, tmpv); break;
+    // ld d, ((ri))
+    case 0x05: tmpv = ptr2_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
 
-      // ld adr, a
-      case 0x07: ssp->RAM[op & 0x1ff] = rA; break;
+    // ldi (ri), imm
+    case 0x06: tmpv = *PC++; ptr1_write(op, tmpv); break;
 
-      // ld d, ri
-      case 0x09: tmpv = rIJ[(op&3)|((op>>6)&4)]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+    // ld adr, a
+    case 0x07: ssp->RAM[op & 0x1ff] = rA; break;
 
-      // ld ri, s
-      case 0x0a: rIJ[(op&3)|((op>>6)&4)] = REG_READ((op & 0xf0) >> 4); break;
+    // ld d, ri
+    case 0x09: tmpv = rIJ[(op&3)|((op>>6)&4)]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
 
-      // ldi ri, simm
-      case 0x0c:
-      case 0x0d:
-      case 0x0e:
-      case 0x0f: rIJ[(op>>8)&7] = op; break;
+    // ld ri, s
+    case 0x0a: rIJ[(op&3)|((op>>6)&4)] = REG_READ((op & 0xf0) >> 4); break;
 
-      // call cond, addr
-      case 0x24: {
-        int cond = 0;
-        COND_CHECK
-        if (cond) { int new_PC = *PC++; write_STACK(GET_PC()); write_PC(new_PC); }
-        else PC++;
-        break;
-      }
+    // ldi ri, simm
+    case 0x0c:
+    case 0x0d:
+    case 0x0e:
+    case 0x0f: rIJ[(op>>8)&7] = op; break;
+
+    // call cond, addr
+    case 0x24: {
+      int cond = 0;
+      COND_CHECK
+      if (cond) { int new_PC = *PC++; write_STACK(GET_PC()); write_PC(new_PC); }
+      else PC++;
+      break;
+    }
 
-      // ld d, (a)
-      case 0x25: tmpv = ((unsigned short *)svp->iram_rom)[rA]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+    // ld d, (a)
+    case 0x25: tmpv = ((unsigned short *)svp->iram_rom)[rA]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
 
-      // bra cond, addr
-      case 0x26: {
-        int cond = 0;
-        COND_CHECK
-        if (cond) { int new_PC = *PC++; write_PC(new_PC); }
-        else PC++;
-        break;
-      }
+    // bra cond, addr
+    case 0x26: {
+      int cond = 0;
+      COND_CHECK
+      if (cond) { int new_PC = *PC++; write_PC(new_PC); }
+      else PC++;
+      break;
+    }
 
-      // mod cond, op
-      case 0x48: {
-        int cond = 0;
-        COND_CHECK
-        if (cond) {
-          switch (op & 7) {
-            case 2: rA32 = (signed int)rA32 >> 1; break; // shr (arithmetic)
-            case 3: rA32 <<= 1; break; // shl
-            case 6: rA32 = -(signed int)rA32; break; // neg
-            case 7: if ((int)rA32 < 0) rA32 = -(signed int)rA32; break; // abs
-            default:
+    // mod cond, op
+    case 0x48: {
+      int cond = 0;
+      COND_CHECK
+      if (cond) {
+        switch (op & 7) {
+          case 2: rA32 = (signed int)rA32 >> 1; break; // shr (arithmetic)
+          case 3: rA32 <<= 1; break; // shl
+          case 6: rA32 = -(signed int)rA32; break; // neg
+          case 7: if ((int)rA32 < 0) rA32 = -(signed int)rA32; break; // abs
+          default:
 #ifdef LOG_SVP
-              elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: unhandled mod %i @ %04x",
-                op&7, GET_PPC_OFFS());
+            elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: unhandled mod %i @ %04x",
+              op&7, GET_PPC_OFFS());
 #endif
-              break;
-          }
-          UPD_ACC_ZN // ?
+            break;
         }
-        break;
+        UPD_ACC_ZN // ?
       }
+      break;
+    }
 
-      // mpys?
-      case 0x1b:
+    // mpys?
+    case 0x1b:
 #ifdef LOG_SVP
-        if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
+      if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
 #endif
-        read_P(); // update P
-        rA32 -= rP.v;  // maybe only upper word?
-        UPD_ACC_ZN      // there checking flags after this
-        rX = ptr1_read_(op&3, 0, (op<<1)&0x18); // ri (maybe rj?)
-        rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); // rj
-        break;
-
-      // mpya (rj), (ri), b
-      case 0x4b:
+      read_P(); // update P
+      rA32 -= rP.v;  // maybe only upper word?
+      UPD_ACC_ZN      // there checking flags after this
+      rX = ptr1_read_(op&3, 0, (op<<1)&0x18); // ri (maybe rj?)
+      rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); // rj
+      break;
+
+    // mpya (rj), (ri), b
+    case 0x4b:
 #ifdef LOG_SVP
-        if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
+      if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
 #endif
-        read_P(); // update P
-        rA32 += rP.v; // confirmed to be 32bit
-        UPD_ACC_ZN // ?
-        rX = ptr1_read_(op&3, 0, (op<<1)&0x18); // ri (maybe rj?)
-        rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); // rj
-        break;
-
-      // mld (rj), (ri), b
-      case 0x5b:
+      read_P(); // update P
+      rA32 += rP.v; // confirmed to be 32bit
+      UPD_ACC_ZN // ?
+      rX = ptr1_read_(op&3, 0, (op<<1)&0x18); // ri (maybe rj?)
+      rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); // rj
+      break;
+
+    // mld (rj), (ri), b
+    case 0x5b:
 #ifdef LOG_SVP
-        if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
+      if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
 #endif
-        rA32 = 0;
-        rST &= 0x0fff; // ?
-        rX = ptr1_read_(op&3, 0, (op<<1)&0x18); // ri (maybe rj?)
-        rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); // rj
-        break;
-
-      // OP a, s
-      case 0x10: OP_CHECK32(OP_SUBA32); tmpv = REG_READ(op & 0x0f); OP_SUBA(tmpv); break;
-      case 0x30: OP_CHECK32(OP_CMPA32); tmpv = REG_READ(op & 0x0f); OP_CMPA(tmpv); break;
-      case 0x40: OP_CHECK32(OP_ADDA32); tmpv = REG_READ(op & 0x0f); OP_ADDA(tmpv); break;
-      case 0x50: OP_CHECK32(OP_ANDA32); tmpv = REG_READ(op & 0x0f); OP_ANDA(tmpv); break;
-      case 0x60: OP_CHECK32(OP_ORA32 ); tmpv = REG_READ(op & 0x0f); OP_ORA (tmpv); break;
-      case 0x70: OP_CHECK32(OP_EORA32); tmpv = REG_READ(op & 0x0f); OP_EORA(tmpv); break;
-
-      // OP a, (ri)
-      case 0x11: tmpv = ptr1_read(op); OP_SUBA(tmpv); break;
-      case 0x31: tmpv = ptr1_read(op); OP_CMPA(tmpv); break;
-      case 0x41: tmpv = ptr1_read(op); OP_ADDA(tmpv); break;
-      case 0x51: tmpv = ptr1_read(op); OP_ANDA(tmpv); break;
-      case 0x61: tmpv = ptr1_read(op); OP_ORA (tmpv); break;
-      case 0x71: tmpv = ptr1_read(op); OP_EORA(tmpv); break;
-
-      // OP a, adr
-      case 0x03: tmpv = ssp->RAM[op & 0x1ff]; OP_LDA (tmpv); break;
-      case 0x13: tmpv = ssp->RAM[op & 0x1ff]; OP_SUBA(tmpv); break;
-      case 0x33: tmpv = ssp->RAM[op & 0x1ff]; OP_CMPA(tmpv); break;
-      case 0x43: tmpv = ssp->RAM[op & 0x1ff]; OP_ADDA(tmpv); break;
-      case 0x53: tmpv = ssp->RAM[op & 0x1ff]; OP_ANDA(tmpv); break;
-      case 0x63: tmpv = ssp->RAM[op & 0x1ff]; OP_ORA (tmpv); break;
-      case 0x73: tmpv = ssp->RAM[op & 0x1ff]; OP_EORA(tmpv); break;
-
-      // OP a, imm
-      case 0x14: tmpv = *PC++; OP_SUBA(tmpv); break;
-      case 0x34: tmpv = *PC++; OP_CMPA(tmpv); break;
-      case 0x44: tmpv = *PC++; OP_ADDA(tmpv); break;
-      case 0x54: tmpv = *PC++; OP_ANDA(tmpv); break;
-      case 0x64: tmpv = *PC++; OP_ORA (tmpv); break;
-      case 0x74: tmpv = *PC++; OP_EORA(tmpv); break;
-
-      // OP a, ((ri))
-      case 0x15: tmpv = ptr2_read(op); OP_SUBA(tmpv); break;
-      case 0x35: tmpv = ptr2_read(op); OP_CMPA(tmpv); break;
-      case 0x45: tmpv = ptr2_read(op); OP_ADDA(tmpv); break;
-      case 0x55: tmpv = ptr2_read(op); OP_ANDA(tmpv); break;
-      case 0x65: tmpv = ptr2_read(op); OP_ORA (tmpv); break;
-      case 0x75: tmpv = ptr2_read(op); OP_EORA(tmpv); break;
-
-      // OP a, ri
-      case 0x19: tmpv = rIJ[IJind]; OP_SUBA(tmpv); break;
-      case 0x39: tmpv = rIJ[IJind]; OP_CMPA(tmpv); break;
-      case 0x49: tmpv = rIJ[IJind]; OP_ADDA(tmpv); break;
-      case 0x59: tmpv = rIJ[IJind]; OP_ANDA(tmpv); break;
-      case 0x69: tmpv = rIJ[IJind]; OP_ORA (tmpv); break;
-      case 0x79: tmpv = rIJ[IJind]; OP_EORA(tmpv); break;
-
-      // OP simm
-      case 0x1c:
-        OP_SUBA(op & 0xff);
+      rA32 = 0;
+      rST &= 0x0fff; // ?
+      rX = ptr1_read_(op&3, 0, (op<<1)&0x18); // ri (maybe rj?)
+      rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); // rj
+      break;
+
+    // OP a, s
+    case 0x10: OP_CHECK32(OP_SUBA32); tmpv = REG_READ(op & 0x0f); OP_SUBA(tmpv); break;
+    case 0x30: OP_CHECK32(OP_CMPA32); tmpv = REG_READ(op & 0x0f); OP_CMPA(tmpv); break;
+    case 0x40: OP_CHECK32(OP_ADDA32); tmpv = REG_READ(op & 0x0f); OP_ADDA(tmpv); break;
+    case 0x50: OP_CHECK32(OP_ANDA32); tmpv = REG_READ(op & 0x0f); OP_ANDA(tmpv); break;
+    case 0x60: OP_CHECK32(OP_ORA32 ); tmpv = REG_READ(op & 0x0f); OP_ORA (tmpv); break;
+    case 0x70: OP_CHECK32(OP_EORA32); tmpv = REG_READ(op & 0x0f); OP_EORA(tmpv); break;
+
+    // OP a, (ri)
+    case 0x11: tmpv = ptr1_read(op); OP_SUBA(tmpv); break;
+    case 0x31: tmpv = ptr1_read(op); OP_CMPA(tmpv); break;
+    case 0x41: tmpv = ptr1_read(op); OP_ADDA(tmpv); break;
+    case 0x51: tmpv = ptr1_read(op); OP_ANDA(tmpv); break;
+    case 0x61: tmpv = ptr1_read(op); OP_ORA (tmpv); break;
+    case 0x71: tmpv = ptr1_read(op); OP_EORA(tmpv); break;
+
+    // OP a, adr
+    case 0x03: tmpv = ssp->RAM[op & 0x1ff]; OP_LDA (tmpv); break;
+    case 0x13: tmpv = ssp->RAM[op & 0x1ff]; OP_SUBA(tmpv); break;
+    case 0x33: tmpv = ssp->RAM[op & 0x1ff]; OP_CMPA(tmpv); break;
+    case 0x43: tmpv = ssp->RAM[op & 0x1ff]; OP_ADDA(tmpv); break;
+    case 0x53: tmpv = ssp->RAM[op & 0x1ff]; OP_ANDA(tmpv); break;
+    case 0x63: tmpv = ssp->RAM[op & 0x1ff]; OP_ORA (tmpv); break;
+    case 0x73: tmpv = ssp->RAM[op & 0x1ff]; OP_EORA(tmpv); break;
+
+    // OP a, imm
+    case 0x14: tmpv = *PC++; OP_SUBA(tmpv); break;
+    case 0x34: tmpv = *PC++; OP_CMPA(tmpv); break;
+    case 0x44: tmpv = *PC++; OP_ADDA(tmpv); break;
+    case 0x54: tmpv = *PC++; OP_ANDA(tmpv); break;
+    case 0x64: tmpv = *PC++; OP_ORA (tmpv); break;
+    case 0x74: tmpv = *PC++; OP_EORA(tmpv); break;
+
+    // OP a, ((ri))
+    case 0x15: tmpv = ptr2_read(op); OP_SUBA(tmpv); break;
+    case 0x35: tmpv = ptr2_read(op); OP_CMPA(tmpv); break;
+    case 0x45: tmpv = ptr2_read(op); OP_ADDA(tmpv); break;
+    case 0x55: tmpv = ptr2_read(op); OP_ANDA(tmpv); break;
+    case 0x65: tmpv = ptr2_read(op); OP_ORA (tmpv); break;
+    case 0x75: tmpv = ptr2_read(op); OP_EORA(tmpv); break;
+
+    // OP a, ri
+    case 0x19: tmpv = rIJ[IJind]; OP_SUBA(tmpv); break;
+    case 0x39: tmpv = rIJ[IJind]; OP_CMPA(tmpv); break;
+    case 0x49: tmpv = rIJ[IJind]; OP_ADDA(tmpv); break;
+    case 0x59: tmpv = rIJ[IJind]; OP_ANDA(tmpv); break;
+    case 0x69: tmpv = rIJ[IJind]; OP_ORA (tmpv); break;
+    case 0x79: tmpv = rIJ[IJind]; OP_EORA(tmpv); break;
+
+    // OP simm
+    case 0x1c:
+      OP_SUBA(op & 0xff);
 #ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
 #endif
-        break;
-      case 0x3c:
-        OP_CMPA(op & 0xff); 
+      break;
+    case 0x3c:
+      OP_CMPA(op & 0xff); 
 #ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
 #endif
-        break;
-      case 0x4c:
-        OP_ADDA(op & 0xff);
+      break;
+    case 0x4c:
+      OP_ADDA(op & 0xff);
 #ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
 #endif
-        break;
-      // MAME code only does LSB of top word, but this looks wrong to me.
-      case 0x5c:
-        OP_ANDA(op & 0xff);
+      break;
+    // MAME code only does LSB of top word, but this looks wrong to me.
+    case 0x5c:
+      OP_ANDA(op & 0xff);
 #ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
 #endif
-        break;
-      case 0x6c:
-        OP_ORA (op & 0xff);
+      break;
+    case 0x6c:
+      OP_ORA (op & 0xff);
 #ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
 #endif
-        break;
-      case 0x7c:
-        OP_EORA(op & 0xff); 
+      break;
+    case 0x7c:
+      OP_EORA(op & 0xff); 
 #ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
 #endif
-        break;
+      break;
 
-      default:
+    default:
 #ifdef LOG_SVP
-        elprintf(EL_ANOMALY|EL_SVP, "ssp FIXME unhandled op %04x @ %04x", op, GET_PPC_OFFS());
+      elprintf(EL_ANOMALY|EL_SVP, "ssp FIXME unhandled op %04x @ %04x", op, GET_PPC_OFFS());
 #endif
+      break;
+  }
+}
+
+// -----------------------------------------------------
+// block cache
+//
+// Runs of instructions are decoded once into ssp_insn_t arrays holding a
+// handler for the instruction's form and its pre-fetched operands, so they
+// run without fetching or decoding. Handlers leave PC and the registers as
+// the interpreter would, so a block can be left after any instruction.
+// ROM only changes on reset and its blocks are indexed by PC. The SVP code
+// keeps reloading IRAM with new routines, so IRAM blocks are kept per IRAM
+// image, found by a hash of its contents and confirmed with a full compare.
+
+#define SSP_BLOCK_MAX   32      // instructions per block
+#define SSP_POOL_SIZE   0x8000  // decoded instructions of all blocks
+#define SSP_IRAM_WORDS  0x400
+#define SSP_ROM_END     0xffff  // instructions at or past here aren't cached
+#define SSP_IRAM_IMAGES 8
+
+typedef struct ssp_insn_s ssp_insn_t;
+typedef void (*ssp_handler_t)(const ssp_insn_t *in);
+
+struct ssp_insn_s
+{
+  ssp_handler_t exec;  // NULL ends the block
+  unsigned short op;
+  unsigned short imm;  // immediate word or RAM address
+  unsigned short pc;
+  unsigned short next; // PC after the instruction
+  unsigned char a, b;  // destination & source register indexes
+  unsigned char flags;
+};
+
+#define SSP_INSN_FLOW 0x01 // may read or write PC, or wait
+
+typedef struct
+{
+  unsigned short iram[SSP_IRAM_WORDS];
+  unsigned short block[SSP_IRAM_WORDS]; // pool index of the block starting at each PC, 0 if none
+  u32 hash;
+  unsigned int last_used;
+  int valid;
+} ssp_iram_image_t;
+
+static ssp_insn_t insn_pool[SSP_POOL_SIZE];
+static int pool_used = 1; // index 0 means no block
+static unsigned short rom_block[0x10000];
+static ssp_iram_image_t iram_images[SSP_IRAM_IMAGES];
+static ssp_iram_image_t *iram_image = NULL;
+static unsigned int iram_clock = 0;
+
+// handlers run with PC already past the instruction and its immediate
+static void ssp_step(void)
+{
+  int op = *PC++;
+  ssp_exec(op);
+}
+
+static void h_generic(const ssp_insn_t *in)
+{
+  SET_PC(in->pc);
+  ssp_step();
+}
+
+static void h_nop(const ssp_insn_t *in) {}
+
+// ld d, s
+static void h_ld_gr(const ssp_insn_t *in) { ssp->gr[in->a].h = ssp->gr[in->b].h; }
+
+// ld d, (ri)
+static void h_ld_gr_ptr1(const ssp_insn_t *in) { ssp->gr[in->a].h = ptr1_read(in->op); }
+
+// ld (ri), s
+static void h_ld_ptr1_gr(const ssp_insn_t *in) { ptr1_write(in->op, ssp->gr[in->b].h); }
+
+// ldi d, imm
+static void h_ldi_gr(const ssp_insn_t *in) { ssp->gr[in->a].h = in->imm; }
+
+// ld adr, a
+static void h_ld_adr_a(const ssp_insn_t *in) { ssp->RAM[in->imm] = rA; }
+
+// ld d, ri
+static void h_ld_gr_ri(const ssp_insn_t *in) { ssp->gr[in->a].h = rIJ[in->b]; }
+
+// ld ri, s
+static void h_ld_ri_gr(const ssp_insn_t *in) { rIJ[in->a] = ssp->gr[in->b].h; }
+
+// ldi ri, simm
+static void h_ldi_ri(const ssp_insn_t *in) { rIJ[in->a] = in->op; }
+
+// call cond, addr
+static void h_call(const ssp_insn_t *in)
+{
+  int op = in->op, cond = 0;
+  COND_CHECK
+  if (cond) { write_STACK(GET_PC()); write_PC(in->imm); }
+}
+
+// bra cond, addr
+static void h_bra(const ssp_insn_t *in)
+{
+  int op = in->op, cond = 0;
+  COND_CHECK
+  if (cond) write_PC(in->imm);
+}
+
+// mpys?
+static void h_mpys(const ssp_insn_t *in)
+{
+  int op = in->op;
+  read_P(); // update P
+  rA32 -= rP.v;
+  UPD_ACC_ZN
+  rX = ptr1_read_(op&3, 0, (op<<1)&0x18);
+  rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18);
+}
+
+// mpya (rj), (ri), b
+static void h_mpya(const ssp_insn_t *in)
+{
+  int op = in->op;
+  read_P(); // update P
+  rA32 += rP.v;
+  UPD_ACC_ZN
+  rX = ptr1_read_(op&3, 0, (op<<1)&0x18);
+  rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18);
+}
+
+// mld (rj), (ri), b
+static void h_mld(const ssp_insn_t *in)
+{
+  int op = in->op;
+  rA32 = 0;
+  rST &= 0x0fff;
+  rX = ptr1_read_(op&3, 0, (op<<1)&0x18);
+  rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18);
+}
+
+// OP a, s / OP a, (ri) / OP a, adr / OP a, imm & simm / OP a, ri
+#define SSP_OP_HANDLERS(name, OP) \
+static void h_##name##_gr(const ssp_insn_t *in)   { u32 tmpv = ssp->gr[in->b].h; OP(tmpv); } \
+static void h_##name##_ptr1(const ssp_insn_t *in) { u32 tmpv = ptr1_read(in->op); OP(tmpv); } \
+static void h_##name##_adr(const ssp_insn_t *in)  { u32 tmpv = ssp->RAM[in->imm]; OP(tmpv); } \
+static void h_##name##_imm(const ssp_insn_t *in)  { u32 tmpv = in->imm; OP(tmpv); } \
+static void h_##name##_ri(const ssp_insn_t *in)   { u32 tmpv = rIJ[in->b]; OP(tmpv); }
+
+SSP_OP_HANDLERS(sub, OP_SUBA)
+SSP_OP_HANDLERS(cmp, OP_CMPA)
+SSP_OP_HANDLERS(add, OP_ADDA)
+SSP_OP_HANDLERS(and, OP_ANDA)
+SSP_OP_HANDLERS(or,  OP_ORA)
+SSP_OP_HANDLERS(eor, OP_EORA)
+
+static void h_lda_adr(const ssp_insn_t *in) { u32 tmpv = ssp->RAM[in->imm]; OP_LDA(tmpv); }
+
+// indexed by op >> 13
+static const ssp_handler_t op_gr_handlers[8] =
+  { NULL, h_sub_gr, NULL, h_cmp_gr, h_add_gr, h_and_gr, h_or_gr, h_eor_gr };
+static const ssp_handler_t op_ptr1_handlers[8] =
+  { NULL, h_sub_ptr1, NULL, h_cmp_ptr1, h_add_ptr1, h_and_ptr1, h_or_ptr1, h_eor_ptr1 };
+static const ssp_handler_t op_adr_handlers[8] =
+  { h_lda_adr, h_sub_adr, NULL, h_cmp_adr, h_add_adr, h_and_adr, h_or_adr, h_eor_adr };
+static const ssp_handler_t op_imm_handlers[8] =
+  { NULL, h_sub_imm, NULL, h_cmp_imm, h_add_imm, h_and_imm, h_or_imm, h_eor_imm };
+static const ssp_handler_t op_ri_handlers[8] =
+  { NULL, h_sub_ri, NULL, h_cmp_ri, h_add_ri, h_and_ri, h_or_ri, h_eor_ri };
+
+// fill in the instruction at pc, returns non-zero if it always leaves the block
+static int ssp_decode(ssp_insn_t *in, int pc)
+{
+  const unsigned short *code = (unsigned short *)svp->iram_rom;
+  int op = code[pc];
+  int d = (op & 0xf0) >> 4, s = op & 0x0f;
+
+  in->exec = h_generic;
+  in->op = op;
+  in->imm = 0;
+  in->pc = pc;
+  in->next = pc + 1;
+  in->a = in->b = 0;
+
+  switch (op >> 9)
+  {
+    // ld d, s
+    case 0x00:
+      if (s <= SSP_ST && d < SSP_ST)
+      {
+        // r0 ignores writes and nothing up to ST has read side effects
+        in->exec = d ? h_ld_gr : h_nop;
+        in->a = d;
+        in->b = s;
+      }
+      return d == SSP_PC;
+
+    // ld d, (ri)
+    case 0x01:
+      if (d > 0 && d < SSP_ST) { in->exec = h_ld_gr_ptr1; in->a = d; }
+      return d == SSP_PC;
+
+    // ld (ri), s
+    case 0x02:
+      if (d <= SSP_ST) { in->exec = h_ld_ptr1_gr; in->b = d; }
+      break;
+
+    // ldi d, imm
+    case 0x04:
+      in->imm = code[pc + 1];
+      in->next = pc + 2;
+      if (d < SSP_ST) { in->exec = d ? h_ldi_gr : h_nop; in->a = d; }
+      return d == SSP_PC;
+
+    // ld d, ((ri)) & ld d, (a)
+    case 0x05:
+    case 0x25:
+      return d == SSP_PC;
+
+    // ldi (ri), imm
+    case 0x06:
+      in->next = pc + 2;
+      break;
+
+    // ld adr, a
+    case 0x07: in->exec = h_ld_adr_a; in->imm = op & 0x1ff; break;
+
+    // ld d, ri
+    case 0x09:
+      if (d > 0 && d < SSP_ST) { in->exec = h_ld_gr_ri; in->a = d; in->b = (op&3)|((op>>6)&4); }
+      return d == SSP_PC;
+
+    // ld ri, s
+    case 0x0a:
+      if (d <= SSP_ST) { in->exec = h_ld_ri_gr; in->a = (op&3)|((op>>6)&4); in->b = d; }
+      break;
+
+    // ldi ri, simm
+    case 0x0c:
+    case 0x0d:
+    case 0x0e:
+    case 0x0f: in->exec = h_ldi_ri; in->a = (op>>8)&7; break;
+
+    // call cond, addr & bra cond, addr
+    case 0x24:
+    case 0x26:
+      in->exec = (op >> 9) == 0x24 ? h_call : h_bra;
+      in->imm = code[pc + 1];
+      in->next = pc + 2;
+      return (op & 0xf0) == 0x00;
+
+    case 0x1b: in->exec = h_mpys; break;
+    case 0x4b: in->exec = h_mpya; break;
+    case 0x5b: in->exec = h_mld; break;
+
+    // OP a, s, A and P sources stay with the interpreter
+    case 0x10: case 0x30: case 0x40: case 0x50: case 0x60: case 0x70:
+      if (s <= SSP_ST && s != SSP_A) { in->exec = op_gr_handlers[op >> 13]; in->b = s; }
+      break;
+
+    // OP a, (ri)
+    case 0x11: case 0x31: case 0x41: case 0x51: case 0x61: case 0x71:
+      in->exec = op_ptr1_handlers[op >> 13];
+      break;
+
+    // OP a, adr
+    case 0x03: case 0x13: case 0x33: case 0x43: case 0x53: case 0x63: case 0x73:
+      in->exec = op_adr_handlers[op >> 13];
+      in->imm = op & 0x1ff;
+      break;
+
+    // OP a, imm
+    case 0x14: case 0x34: case 0x44: case 0x54: case 0x64: case 0x74:
+      in->exec = op_imm_handlers[op >> 13];
+      in->imm = code[pc + 1];
+      in->next = pc + 2;
+      break;
+
+    // OP a, ri
+    case 0x19: case 0x39: case 0x49: case 0x59: case 0x69: case 0x79:
+      in->exec = op_ri_handlers[op >> 13];
+      in->b = IJind;
+      break;
+
+    // OP simm
+    case 0x1c: case 0x3c: case 0x4c: case 0x5c: case 0x6c: case 0x7c:
+      in->exec = op_imm_handlers[op >> 13];
+      in->imm = op & 0xff;
+      break;
+  }
+
+  return 0;
+}
+
+static void ssp_flush_blocks(void)
+{
+  int i;
+  memset(rom_block, 0, sizeof(rom_block));
+  for (i = 0; i < SSP_IRAM_IMAGES; i++)
+    memset(iram_images[i].block, 0, sizeof(iram_images[i].block));
+  pool_used = 1;
+}
+
+static int ssp_build_block(int pc, int end)
+{
+  ssp_insn_t *in;
+  int start, count = 0;
+
+  if (pool_used + SSP_BLOCK_MAX + 1 > SSP_POOL_SIZE)
+    ssp_flush_blocks();
+  start = pool_used;
+  in = &insn_pool[start];
+  for (;;)
+  {
+    int leaves = ssp_decode(in, pc);
+    in->flags = (in->exec == h_generic || in->exec == h_call || in->exec == h_bra) ? SSP_INSN_FLOW : 0;
+    pc = in->next;
+    in++;
+    if (leaves || pc >= end || ++count == SSP_BLOCK_MAX)
+      break;
+  }
+  in->exec = NULL;
+  pool_used = in - insn_pool + 1;
+  return start;
+}
+
+static void ssp_select_iram_image(void)
+{
+  const unsigned short *iram = (unsigned short *)svp->iram_rom;
+  ssp_iram_image_t *victim = &iram_images[0];
+  u32 hash = 2166136261u;
+  int i;
+
+  for (i = 0; i < SSP_IRAM_WORDS; i++)
+    hash = (hash ^ iram[i]) * 16777619u;
+  iram_dirty = 0;
+
+  for (i = 0; i < SSP_IRAM_IMAGES; i++)
+  {
+    ssp_iram_image_t *img = &iram_images[i];
+    if (img->valid && img->hash == hash && !memcmp(img->iram, iram, sizeof(img->iram)))
+    {
+      img->last_used = ++iram_clock;
+      iram_image = img;
+      return;
+    }
+    if (!img->valid || (victim->valid && img->last_used < victim->last_used))
+      victim = img;
+  }
+
+  // replace the least recently used image, its blocks stay in the pool until the next flush
+  memcpy(victim->iram, iram, sizeof(victim->iram));
+  memset(victim->block, 0, sizeof(victim->block));
+  victim->hash = hash;
+  victim->last_used = ++iram_clock;
+  victim->valid = 1;
+  iram_image = victim;
+}
+
+static const ssp_insn_t *ssp_get_block(u32 pc)
+{
+  unsigned short *block;
+  int end;
+
+  if (pc < SSP_IRAM_WORDS)
+  {
+    if (iram_dirty)
+      ssp_select_iram_image();
+    block = &iram_image->block[pc];
+    end = SSP_IRAM_WORDS;
+  }
+  else if (pc < SSP_ROM_END)
+  {
+    block = &rom_block[pc];
+    end = SSP_ROM_END;
+  }
+  else
+    return NULL;
+
+  if (!*block)
+  {
+    int start = ssp_build_block(pc, end);
+    // building may have flushed the pool, so set the entry afterwards
+    *block = start;
+  }
+  return &insn_pool[*block];
+}
+
+void ssp1601_invalidate_cache(void)
+{
+  int i;
+  ssp_flush_blocks();
+  for (i = 0; i < SSP_IRAM_IMAGES; i++)
+    iram_images[i].valid = 0;
+  iram_image = NULL;
+  iram_dirty = 1;
+}
+
+static void ssp_run_cached(void)
+{
+  const unsigned short *base = (unsigned short *)svp->iram_rom;
+  int cycles = g_cycles;
+
+  if (ssp->emu_status & SSP_WAIT_MASK)
+  {
+    // the interpreter always runs one instruction
+    ssp_step();
+    return;
+  }
+
+  for (;;)
+  {
+    const ssp_insn_t *in = ssp_get_block(GET_PC());
+    int in_iram;
+
+    if (!in)
+    {
+      g_cycles = cycles;
+      ssp_step();
+      cycles = g_cycles;
+      if (--cycles <= 0 || (ssp->emu_status & SSP_WAIT_MASK))
+        break;
+      continue;
+    }
+
+    // only SSP_INSN_FLOW instructions see PC and can branch or wait
+    in_iram = in->pc < SSP_IRAM_WORDS;
+    for (;;)
+    {
+      if (in->flags & SSP_INSN_FLOW)
+      {
+        SET_PC(in->next);
+        g_cycles = cycles;
+        in->exec(in);
+        cycles = g_cycles;
+        if (--cycles <= 0 || (ssp->emu_status & SSP_WAIT_MASK))
+          goto end;
+        // branched, or IRAM code rewrote IRAM
+        if (PC != base + in->next || (in_iram && iram_dirty))
+          break;
+      }
+      else
+      {
+        in->exec(in);
+        if (--cycles <= 0)
+        {
+          SET_PC(in->next);
+          goto end;
+        }
+      }
+      if (!in[1].exec)
+      {
+        SET_PC(in->next);
         break;
+      }
+      in++;
     }
   }
+
+end:
+  g_cycles = cycles;
+}
+
+static void ssp_run_interp(void)
+{
+  do
+  {
+    int op = *PC++;
+#ifdef USE_DEBUGGER
+    debug(GET_PC()-1, op);
+#endif
+    ssp_exec(op);
+  }
   while (--g_cycles > 0 && !(ssp->emu_status & SSP_WAIT_MASK));
+}
+
+static void ssp_run(int cycles, int cached)
+{
+  SET_PC(rPC);
+  g_cycles = cycles;
+
+#ifdef USE_DEBUGGER
+  cached = 0;
+#endif
+  if (cached)
+    ssp_run_cached();
+  else
+    ssp_run_interp();
 
   read_P(); // update P
   rPC = GET_PC();
@@ -1331,3 +1811,72 @@ void ssp1601_run(int cycles)
 #endif
 }
 
+// -----------------------------------------------------
+// verify mode, runs the interpreter and the block cache from the same state
+// and keeps the interpreter's result if they differ
+
+typedef struct
+{
+  unsigned char iram[SSP_IRAM_WORDS*2];
+  unsigned char dram[sizeof(((svp_t *)0)->dram)];
+  ssp1601_t ssp1601;
+} ssp_snapshot_t;
+
+static ssp_snapshot_t *verify_start = NULL, *verify_ref = NULL;
+
+static void ssp_save_snapshot(ssp_snapshot_t *s)
+{
+  memcpy(s->iram, svp->iram_rom, sizeof(s->iram));
+  memcpy(s->dram, svp->dram, sizeof(s->dram));
+  memcpy(&s->ssp1601, ssp, sizeof(s->ssp1601));
+}
+
+static void ssp_load_snapshot(const ssp_snapshot_t *s)
+{
+  memcpy(svp->iram_rom, s->iram, sizeof(s->iram));
+  memcpy(svp->dram, s->dram, sizeof(s->dram));
+  memcpy(ssp, &s->ssp1601, sizeof(s->ssp1601));
+  iram_dirty = 1;
+}
+
+static void ssp_run_verify(int cycles)
+{
+  if (!verify_start)
+  {
+    verify_start = (ssp_snapshot_t *)malloc(sizeof(ssp_snapshot_t));
+    verify_ref = (ssp_snapshot_t *)malloc(sizeof(ssp_snapshot_t));
+    if (!verify_start || !verify_ref)
+    {
+      free(verify_start);
+      free(verify_ref);
+      verify_start = verify_ref = NULL;
+      ssp_run(cycles, 0);
+      return;
+    }
+  }
+
+  ssp_save_snapshot(verify_start);
+  ssp_run(cycles, 0);
+  ssp_save_snapshot(verify_ref);
+  ssp_load_snapshot(verify_start);
+  ssp_run(cycles, 1);
+
+  if (memcmp(svp->iram_rom, verify_ref->iram, sizeof(verify_ref->iram)) ||
+      memcmp(svp->dram, verify_ref->dram, sizeof(verify_ref->dram)) ||
+      memcmp(ssp, &verify_ref->ssp1601, sizeof(verify_ref->ssp1601)))
+  {
+    logErr("block cache result differs from interpreter running %d cycles from PC %04x",
+      cycles, verify_start->ssp1601.gr[SSP_PC].h);
+    ssp_load_snapshot(verify_ref);
+    ssp1601_invalidate_cache();
+  }
+}
+
+
+void ssp1601_run(int cycles)
+{
+  if (config_svp_cache == SVP_CACHE_VERIFY)
+    ssp_run_verify(cycles);
+  else
+    ssp_run(cycles, config_svp_cache == SVP_CACHE_ON);
+}
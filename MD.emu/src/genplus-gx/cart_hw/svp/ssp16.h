@@ -79,5 +79,6 @@ typedef struct
 
 void ssp1601_reset(ssp1601_t *ssp);
 void ssp1601_run(int cycles);
+void ssp1601_invalidate_cache(void);
 
 #endif
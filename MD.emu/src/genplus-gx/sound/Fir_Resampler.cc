@@ -317,6 +317,51 @@ int Fir_Resampler_read( sample_t* out, long count )
   return out - out_;
 }
 
+/* advances like Fir_Resampler_read() without generating the output */
+int Fir_Resampler_skip( long count )
+{
+  sample_t* in = buffer;
+  sample_t* end_pos = write_pos;
+  unsigned long skip = skip_bits >> imp_phase;
+  int remain = res - imp_phase;
+  long skipped = 0;
+
+  if ( end_pos - in >= WIDTH * STEREO )
+  {
+    end_pos -= WIDTH * STEREO;
+    do
+    {
+      count--;
+
+      if ( count < 0 )
+        break;
+
+      remain--;
+
+      in += (skip * STEREO) & STEREO;
+      skip >>= 1;
+      in += step;
+
+      if ( !remain )
+      {
+        skip = skip_bits;
+        remain = res;
+      }
+
+      skipped++;
+    }
+    while ( in <= end_pos );
+  }
+
+  imp_phase = res - remain;
+
+  int left = write_pos - in;
+  write_pos = &buffer [left];
+  memmove( buffer, in, left * sizeof *in );
+
+  return skipped * STEREO;
+}
+
  /* fixed (Eke_Eke) */
 int Fir_Resampler_input_needed( long output_count )
 {
@@ -39,6 +39,7 @@ extern int Fir_Resampler_written( void );
 extern int Fir_Resampler_avail( void );
 extern void Fir_Resampler_write( long count );
 extern int Fir_Resampler_read( sample_t* out, long count );
+extern int Fir_Resampler_skip( long count );
 extern int Fir_Resampler_input_needed( long output_count );
 extern int Fir_Resampler_skip_input( long count );
 
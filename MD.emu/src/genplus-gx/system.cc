@@ -160,7 +160,7 @@ int audioUpdateAll(int16 *sb)
 	bool doPCM = hasSegaCD && (sCD.pcm.control & 0x80) && sCD.pcm.enabled;
 	if(doPCM)
 	{
-		scd_pcm_update(cdPCMBuff, size, 1);
+		scd_pcm_update(sb ? cdPCMBuff : nullptr, size, 1);
 	}
 	auto cddaRatio = snd.cddaRatio;
 	uint cddaFrames = round((float)size*cddaRatio);
@@ -168,8 +168,8 @@ int audioUpdateAll(int16 *sb)
 	int16 *cdda = cddaBuff;
 	int16 cddaRemsampledBuff[size*2];
 	extern int readCDDA(void *dest, uint size);
-	bool doCDDA = hasSegaCD && readCDDA(cddaBuff, cddaFrames);
-	if(doCDDA && snd.sample_rate != 44100)
+	bool doCDDA = hasSegaCD && readCDDA(sb ? cddaBuff : nullptr, cddaFrames);
+	if(doCDDA && sb && snd.sample_rate != 44100)
 	{
 		auto cddaPtr = (int32*)cddaBuff;
 		auto cddaResampledPtr = (int32*)cddaRemsampledBuff;
@@ -190,7 +190,10 @@ int audioUpdateAll(int16 *sb)
   if (config_hq_fm)
   {
     /* resample into FM output buffer */
-    Fir_Resampler_read(fm, size);
+    if (sb)
+      Fir_Resampler_read(fm, size);
+    else
+      Fir_Resampler_skip(size);
 
 #ifdef LOGSOUND
     error("%d FM samples remaining\n",Fir_Resampler_written() >> 1);
@@ -214,6 +217,14 @@ int audioUpdateAll(int16 *sb)
 #endif
 
   assert(size < snd.buffer_size);
+  if (!sb)
+  {
+    /* no output needed, drop this frame's samples and keep the remaining ones */
+    memcpy(snd.fm.buffer, fm + size * 2, (snd.fm.pos - snd.fm.buffer) * sizeof(FMSampleType));
+    memcpy(snd.psg.buffer, psg + size, (snd.psg.pos - snd.psg.buffer) * sizeof(int16));
+    return size;
+  }
+
   /* mix samples */
   for (i = 0; i < size; i ++)
   {
@@ -236,6 +236,20 @@ class CustomSystemOptionView : public SystemOptionView
 		}
 	};
 
+	TextMenuItem svpCacheItem[3]
+	{
+		{"Off", [](){ config_svp_cache = SVP_CACHE_OFF; }},
+		{"On", [](){ config_svp_cache = SVP_CACHE_ON; }},
+		{"On (Verify)", [](){ config_svp_cache = SVP_CACHE_VERIFY; }},
+	};
+
+	MultiChoiceMenuItem svpCache
+	{
+		"SVP Block Cache",
+		config_svp_cache,
+		svpCacheItem
+	};
+
 	#ifndef NO_SCD
 	static constexpr const char *biosHeadingStr[3]
 	{
@@ -314,6 +328,7 @@ public:
 	{
 		loadStockItems();
 		item.emplace_back(&bigEndianSram);
+		item.emplace_back(&svpCache);
 		#ifndef NO_SCD
 		cdBiosPathInit();
 		#endif
@@ -41,6 +41,7 @@ bool EmuSystem::hasCheats = true;
 bool EmuSystem::hasPALVideoSystem = true;
 t_config config{};
 bool config_ym2413_enabled = true;
+uint8 config_svp_cache = SVP_CACHE_ON;
 int8 mdInputPortDev[2]{-1, -1};
 t_bitmap bitmap{};
 static uint autoDetectedVidSysPAL = 0;
@@ -84,7 +85,7 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	system_frame(task, video);
 
 	int16 audioBuff[snd.buffer_size * 2];
-	int frames = audio_update(audioBuff);
+	int frames = audio_update(audio ? audioBuff : nullptr);
 	if(audio)
 	{
 		//logMsg("%d frames", frames);
@@ -95,6 +96,12 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 
 bool EmuSystem::vidSysIsPAL() { return vdp_pal; }
 
+uint8_t EmuSystem::subsystem()
+{
+	// system_hw is left at 0 (SYSTEM_PBC) until a game loads
+	return gameIsRunning() && system_hw == SYSTEM_PBC;
+}
+
 void EmuSystem::reset(ResetMode mode)
 {
 	assert(gameIsRunning());
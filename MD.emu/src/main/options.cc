@@ -24,7 +24,7 @@ enum
 	CFGKEY_MD_CD_BIOS_JPN_PATH = 282, CFGKEY_MD_CD_BIOS_EUR_PATH = 283,
 	CFGKEY_MD_REGION = 284, CFGKEY_VIDEO_SYSTEM = 285,
 	CFGKEY_INPUT_PORT_1 = 286, CFGKEY_INPUT_PORT_2 = 287,
-	CFGKEY_MULTITAP = 288
+	CFGKEY_MULTITAP = 288, CFGKEY_SVP_CACHE = 289
 };
 
 const char *EmuSystem::configFilename = "MdEmu.config";
@@ -48,6 +48,8 @@ PathOption optionCDBiosJpnPath{CFGKEY_MD_CD_BIOS_JPN_PATH, cdBiosJpnPath, ""};
 PathOption optionCDBiosEurPath{CFGKEY_MD_CD_BIOS_EUR_PATH, cdBiosEurPath, ""};
 #endif
 Byte1Option optionVideoSystem{CFGKEY_VIDEO_SYSTEM, 0, false, optionIsValidWithMax<2>};
+static Option<OptionMethodRef<uint8, config_svp_cache>, uint8> optionSVPCache{CFGKEY_SVP_CACHE,
+	SVP_CACHE_ON, false, optionIsValidWithMax<SVP_CACHE_VERIFY>};
 
 void EmuSystem::initOptions()
 {
@@ -111,6 +113,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 	{
 		bcase CFGKEY_BIG_ENDIAN_SRAM: optionBigEndianSram.readFromIO(io, readSize);
 		bcase CFGKEY_SMS_FM: optionSmsFM.readFromIO(io, readSize);
+		bcase CFGKEY_SVP_CACHE: optionSVPCache.readFromIO(io, readSize);
 		#ifndef NO_SCD
 		bcase CFGKEY_MD_CD_BIOS_USA_PATH: optionCDBiosUsaPath.readFromIO(io, readSize);
 		bcase CFGKEY_MD_CD_BIOS_JPN_PATH: optionCDBiosJpnPath.readFromIO(io, readSize);
@@ -125,6 +128,7 @@ void EmuSystem::writeConfig(IO &io)
 {
 	optionBigEndianSram.writeWithKeyIfNotDefault(io);
 	optionSmsFM.writeWithKeyIfNotDefault(io);
+	optionSVPCache.writeWithKeyIfNotDefault(io);
 	#ifndef NO_SCD
 	optionCDBiosUsaPath.writeToIO(io);
 	optionCDBiosJpnPath.writeToIO(io);
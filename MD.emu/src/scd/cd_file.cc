@@ -90,10 +90,32 @@ static void readCddaLBA(void *dest, int lba)
 	cdImage->Read_Sector((uint8*)dest, lba, 2352);
 }
 
+// advances the play position like readCDDA() without reading any sectors
+static void skipCDDA(uint size)
+{
+	if(sCD.cddaDataLeftover)
+	{
+		uint skipSize = std::min((uint)sCD.cddaDataLeftover, size);
+		sCD.cddaDataLeftover -= skipSize;
+		if(!sCD.cddaDataLeftover)
+			sCD.cddaLBA++;
+		size -= skipSize;
+	}
+	sCD.cddaLBA += size / 588;
+	if(size % 588)
+		sCD.cddaDataLeftover = 588 - size % 588;
+}
+
 int readCDDA(void *dest, uint size)
 {
 	if(!sCD.gate[0x36] && sCD.Status_CDD == 0x0100/*sCD.Cur_Track > 1 /*sCD.audioTrack && sCD.Status_CDD == 0x0100*/)
 	{
+		if(!dest) // output not needed
+		{
+			skipCDDA(size);
+			sCD.Cur_LBA = sCD.cddaLBA+12;
+			return 1;
+		}
 		auto cddaBuffPos = (int32*)dest;
 		auto sizeToWrite = size;
 		//logMsg("%d frames in buffer", size);
@@ -66,6 +66,8 @@ void scd_pcm_setRate(int rate)
 }
 
 
+// buffer is null when the output isn't needed, the channel addresses still
+// advance since the sub CPU can read them back
 void scd_pcm_update(PCMSampleType *buffer, int length, int stereo)
 {
 	SegaCD::PCM::Channel *ch;
@@ -116,17 +118,20 @@ void scd_pcm_update(PCMSampleType *buffer, int length, int stereo)
 
 			//if(j == 0)
 				//logMsg("pcm out %d", smp * mul_l);
-			if(activeCH == 1)
-				*out++ = smp * mul_l; // max 128 * 119 = 15232
-			else
-				*out++ += smp * mul_l; // max 128 * 119 = 15232
-
-			if(stereo)
+			if(out)
 			{
 				if(activeCH == 1)
-					*out++ = smp * mul_r;
+					*out++ = smp * mul_l; // max 128 * 119 = 15232
 				else
-					*out++ += smp * mul_r;
+					*out++ += smp * mul_l; // max 128 * 119 = 15232
+
+				if(stereo)
+				{
+					if(activeCH == 1)
+						*out++ = smp * mul_r;
+					else
+						*out++ += smp * mul_r;
+				}
 			}
 
 			// update address register
@@ -34,14 +34,56 @@
 // Must be power of 2
 #define ALLOC_BLOCK_SIZE 256
 
+#define MEMORY_STATE_MAGIC   0x4d534d42 // "BMSM"
+#define MEMORY_STATE_VERSION 1
+
+// Section data holds native-endian words, so states only load on a host
+// with the byte order they were saved with
+#define MEMORY_STATE_LITTLE_ENDIAN 0
+#define MEMORY_STATE_BIG_ENDIAN    1
+
+#define MEMORY_STATE_INDEX_ENTRY_SIZE (64 + 2 * 4)
+#define MEMORY_STATE_TRAILER_SIZE     (4 * 4)
+
 struct SaveState {
     UInt32 allocSize;
     UInt32 size;
     UInt32 offset;
     UInt32 *buffer;
+    int    ownsBuffer;
     char   fileName[64];
 };
 
+typedef enum {
+    STATE_IO_NONE,
+    STATE_IO_ZIP_READ,
+    STATE_IO_ZIP_WRITE,
+    STATE_IO_MEMORY_READ,
+    STATE_IO_MEMORY_WRITE
+} StateIo;
+
+typedef struct {
+    char   fileName[64];
+    UInt32 offset;
+    UInt32 size;
+} StateSection;
+
+// All device sections of a state are kept in one contiguous buffer and
+// written to the zip in a single pass when the state is destroyed, or
+// handed to the caller as-is for in-memory states. Memory states end with
+// the section index and a trailer holding the entry count, format version,
+// section data byte order and a magic number, all little-endian.
+static struct {
+    StateIo       io;
+    UInt8*        data;
+    UInt32        size;
+    UInt32        allocSize;
+    StateSection* section;
+    int           sectionCount;
+    int           sectionAllocCount;
+    int           nextSection;
+} container;
+
 static char stateFile[512];
 
 static UInt32 tagFromName(const char* tagName)
@@ -103,8 +145,89 @@ static char* getIndexedFilename(const char* fileName)
     return indexedFileName;
 }
 
+static UInt32 nativeByteOrder(void)
+{
+    const UInt32 one = 1;
+    return *(const UInt8*)&one ? MEMORY_STATE_LITTLE_ENDIAN : MEMORY_STATE_BIG_ENDIAN;
+}
+
+static void storeLE32(UInt8* p, UInt32 value)
+{
+    p[0] = (UInt8)value;
+    p[1] = (UInt8)(value >> 8);
+    p[2] = (UInt8)(value >> 16);
+    p[3] = (UInt8)(value >> 24);
+}
+
+static UInt32 loadLE32(const UInt8* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((UInt32)p[3] << 24);
+}
+
+static void containerReset(StateIo io)
+{
+    if (container.io == STATE_IO_ZIP_WRITE || container.io == STATE_IO_MEMORY_WRITE) {
+        free(container.data);
+    }
+    free(container.section);
+    memset(&container, 0, sizeof(container));
+    container.io = io;
+}
+
+static void containerReserve(UInt32 size)
+{
+    if (size > container.allocSize) {
+        container.allocSize = (size + 2 * container.allocSize + ALLOC_BLOCK_SIZE - 1) & ~(ALLOC_BLOCK_SIZE - 1);
+        container.data = realloc(container.data, container.allocSize);
+    }
+}
+
+static StateSection* containerAddSection(const char* fileName, UInt32 offset, UInt32 size)
+{
+    StateSection* section;
+
+    if (container.sectionCount == container.sectionAllocCount) {
+        container.sectionAllocCount = container.sectionAllocCount ? container.sectionAllocCount * 2 : 64;
+        container.section = realloc(container.section, container.sectionAllocCount * sizeof(StateSection));
+    }
+    section = &container.section[container.sectionCount++];
+    strcpy(section->fileName, fileName);
+    section->offset = offset;
+    section->size = size;
+    return section;
+}
+
+static void containerAppend(const char* fileName, const void* buffer, UInt32 size)
+{
+    containerReserve(container.size + size);
+    memcpy(container.data + container.size, buffer, size);
+    containerAddSection(fileName, container.size, size);
+    container.size += size;
+}
+
+static StateSection* containerFindSection(const char* fileName)
+{
+    int i;
+
+    // sections are normally read back in the order they were written
+    for (i = container.nextSection; i < container.sectionCount; i++) {
+        if (0 == strcmp(fileName, container.section[i].fileName)) {
+            container.nextSection = i + 1;
+            return &container.section[i];
+        }
+    }
+    for (i = 0; i < container.nextSection; i++) {
+        if (0 == strcmp(fileName, container.section[i].fileName)) {
+            container.nextSection = i + 1;
+            return &container.section[i];
+        }
+    }
+    return NULL;
+}
+
 void saveStateCreateForRead(const char* fileName)
 {
+    containerReset(STATE_IO_ZIP_READ);
     tableCount = 0;
     strcpy(stateFile, fileName);
     zipCacheReadOnlyZip(fileName);
@@ -112,19 +235,133 @@ void saveStateCreateForRead(const char* fileName)
 
 void saveStateCreateForWrite(const char* fileName)
 {
+    containerReset(STATE_IO_ZIP_WRITE);
     tableCount = 0;
     strcpy(stateFile, fileName);
 }
 
+int saveStateCreateForReadMemory(const void* data, UInt32 size)
+{
+    const UInt8* trailer = (const UInt8*)data + size - MEMORY_STATE_TRAILER_SIZE;
+    const UInt8* entry;
+    UInt32 count;
+    int i;
+
+    containerReset(STATE_IO_MEMORY_READ);
+    tableCount = 0;
+    stateFile[0] = 0;
+
+    if (size < MEMORY_STATE_TRAILER_SIZE || loadLE32(trailer + 12) != MEMORY_STATE_MAGIC ||
+        loadLE32(trailer + 4) != MEMORY_STATE_VERSION || loadLE32(trailer + 8) != nativeByteOrder()) {
+        return 0;
+    }
+    count = loadLE32(trailer);
+    if (count > (size - MEMORY_STATE_TRAILER_SIZE) / MEMORY_STATE_INDEX_ENTRY_SIZE) {
+        return 0;
+    }
+    container.data = (UInt8*)data;
+    container.size = size - MEMORY_STATE_TRAILER_SIZE - count * MEMORY_STATE_INDEX_ENTRY_SIZE;
+    container.sectionCount = count;
+    container.sectionAllocCount = count;
+    container.section = malloc(count ? count * sizeof(StateSection) : 1);
+
+    // memory states can come from files, so check the index before using it
+    entry = container.data + container.size;
+    for (i = 0; i < container.sectionCount; i++, entry += MEMORY_STATE_INDEX_ENTRY_SIZE) {
+        StateSection* section = &container.section[i];
+        memcpy(section->fileName, entry, sizeof(section->fileName));
+        section->offset = loadLE32(entry + 64);
+        section->size = loadLE32(entry + 68);
+        if (section->offset > container.size || section->size > container.size - section->offset ||
+            memchr(section->fileName, 0, sizeof(section->fileName)) == NULL) {
+            containerReset(STATE_IO_MEMORY_READ);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void saveStateCreateForWriteMemory(void)
+{
+    containerReset(STATE_IO_MEMORY_WRITE);
+    tableCount = 0;
+    stateFile[0] = 0;
+}
+
+void* saveStateReleaseMemory(UInt32* size)
+{
+    UInt32 indexSize = container.sectionCount * MEMORY_STATE_INDEX_ENTRY_SIZE;
+    UInt8* entry;
+    UInt8* trailer;
+    void* data;
+    int i;
+
+    if (container.io != STATE_IO_MEMORY_WRITE) {
+        *size = 0;
+        return NULL;
+    }
+    containerReserve(container.size + indexSize + MEMORY_STATE_TRAILER_SIZE);
+    entry = container.data + container.size;
+    for (i = 0; i < container.sectionCount; i++, entry += MEMORY_STATE_INDEX_ENTRY_SIZE) {
+        StateSection* section = &container.section[i];
+        memcpy(entry, section->fileName, sizeof(section->fileName));
+        storeLE32(entry + 64, section->offset);
+        storeLE32(entry + 68, section->size);
+    }
+    trailer = entry;
+    storeLE32(trailer, container.sectionCount);
+    storeLE32(trailer + 4, MEMORY_STATE_VERSION);
+    storeLE32(trailer + 8, nativeByteOrder());
+    storeLE32(trailer + 12, MEMORY_STATE_MAGIC);
+    *size = container.size + indexSize + MEMORY_STATE_TRAILER_SIZE;
+    data = container.data;
+    container.data = NULL;
+    containerReset(STATE_IO_NONE);
+    return data;
+}
+
 void saveStateDestroy(void)
 {
-    zipCacheReadOnlyZip(NULL);
+    int i;
+
+    if (container.io == STATE_IO_ZIP_WRITE) {
+        for (i = 0; i < container.sectionCount; i++) {
+            StateSection* section = &container.section[i];
+            zipSaveFile(stateFile, section->fileName, 1, container.data + section->offset, section->size);
+        }
+    }
+    if (container.io == STATE_IO_MEMORY_WRITE) {
+        return; // kept until saveStateReleaseMemory()
+    }
+    if (container.io == STATE_IO_ZIP_READ) {
+        zipCacheReadOnlyZip(NULL);
+    }
+    containerReset(STATE_IO_NONE);
 }
 
 SaveState* saveStateOpenForRead(const char* fileName) {
     SaveState* state = (SaveState*)malloc(sizeof(SaveState));
+    const char* indexedFileName = getIndexedFilename(fileName);
     Int32 size = 0;
-    void* buffer = zipLoadFile(stateFile, getIndexedFilename(fileName), &size);
+    void* buffer = NULL;
+
+    if (container.io == STATE_IO_MEMORY_READ) {
+        StateSection* section = containerFindSection(indexedFileName);
+        if (section != NULL) {
+            buffer = container.data + section->offset;
+            size = section->size;
+        }
+        state->ownsBuffer = 0;
+    }
+    else if (zipIsCached(stateFile)) {
+        // sections are only read, so use the cached archive data in place
+        buffer = (void*)zipCachedFile(stateFile, indexedFileName, &size);
+        state->ownsBuffer = 0;
+    }
+    else {
+        buffer = zipLoadFile(stateFile, indexedFileName, &size);
+        state->ownsBuffer = 1;
+    }
 
     state->allocSize = size;
     state->buffer = buffer;
@@ -138,10 +375,11 @@ SaveState* saveStateOpenForRead(const char* fileName) {
 SaveState* saveStateOpenForWrite(const char* fileName) {
     SaveState* state = (SaveState*)malloc(sizeof(SaveState));
 
-    state->size      = 0;
-    state->offset    = 0;
-    state->buffer    = NULL;
-    state->allocSize = 0;
+    state->size       = 0;
+    state->offset     = 0;
+    state->buffer     = NULL;
+    state->allocSize  = 0;
+    state->ownsBuffer = 1;
 
     strcpy(state->fileName, getIndexedFilename(fileName));
 
@@ -150,9 +388,9 @@ SaveState* saveStateOpenForWrite(const char* fileName) {
 
 void saveStateClose(SaveState* state) {
     if (state->fileName[0]) {
-        zipSaveFile(stateFile, state->fileName, 1, state->buffer, state->offset * sizeof(UInt32));
+        containerAppend(state->fileName, state->buffer, state->offset * sizeof(UInt32));
     }
-    if (state->buffer != NULL) {
+    if (state->buffer != NULL && state->ownsBuffer) {
         free(state->buffer);
     }
     state->allocSize = 0;
@@ -36,6 +36,14 @@ void saveStateCreateForRead(const char* fileName);
 void saveStateCreateForWrite(const char* fileName);
 void saveStateDestroy(void);
 
+// In-memory states use the same section format without a zip container.
+// saveStateCreateForReadMemory() returns 0 if the data isn't a memory state,
+// the data must stay valid until saveStateDestroy(). After writing,
+// saveStateReleaseMemory() returns the state buffer for the caller to free().
+int saveStateCreateForReadMemory(const void* data, UInt32 size);
+void saveStateCreateForWriteMemory(void);
+void* saveStateReleaseMemory(UInt32* size);
+
 SaveState* saveStateOpenForRead(const char* fileName);
 SaveState* saveStateOpenForWrite(const char* fileName);
 void saveStateClose(SaveState* state);
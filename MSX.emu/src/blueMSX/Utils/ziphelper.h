@@ -40,6 +40,9 @@ void memZipFileSystemCreate(int maxFiles);
 void memZipFileSystemDestroy();
 
 void zipCacheReadOnlyZip(const char* zipName);
+// zipCachedFile() returns data owned by the cache, valid until it's replaced
+int zipIsCached(const char* zipName);
+const void* zipCachedFile(const char* zipName, const char* fileName, int* size);
 void* zipLoadFile(const char* zipName, const char* fileName, int* size);
 int zipSaveFile(const char* zipName, const char* fileName, int append, const void* buffer, int size);
 int zipFileExists(const char* zipName, const char* fileName);
@@ -16,7 +16,10 @@
 #define LOGTAG "main"
 
 #include <imagine/pixmap/Pixmap.hh>
+#include <imagine/util/algorithm.h>
 #include <imagine/logger/logger.h>
+#include <algorithm>
+#include <array>
 
 extern "C"
 {
@@ -37,14 +40,16 @@ class FrameBufferImpl
 public:
 	constexpr FrameBufferImpl() {}
 
-	int width() const
+	int lineWidth(bool doubleWidth) const
 	{
-		return (doubleWidthFrame ? maxWidth * 2 : maxWidth) - widthCrop() * 2;
+		// the right border is cropped
+		return doubleWidth ? maxWidth * 2 - 32 : maxWidth - 16;
 	}
 
-	int widthCrop() const
+	int pitch() const
 	{
-		return doubleWidthFrame ? 16 : 8;
+		// lines keep a fixed pitch so the width can change mid-frame
+		return maxWidth * 2;
 	}
 
 	void setMaxWidth(int w)
@@ -52,45 +57,56 @@ public:
 		maxWidth = w;
 	}
 
-	bool doubleWidth() const
+	bool doubleWidth(int y) const
 	{
-		return doubleWidthFrame;
+		return lineIsDoubleWidth[y];
 	}
 
-	bool setDoubleWidth(bool val)
+	bool setDoubleWidth(int y, bool val)
 	{
-		if(doubleWidthFrame == val)
+		if(lineIsDoubleWidth[y] == val)
 			return false;
-		doubleWidthFrame = val;
-		updatePixmapSize();
+		lineIsDoubleWidth[y] = val;
 		return true;
 	}
 
 	void setLines(int lines_)
 	{
-		lines = lines_;
-		updatePixmapSize();
+		lines = std::min(lines_, FB_MAX_LINES);
 	}
 
-	IG::PixmapDesc makePixmapDesc() const
+	void setPixmapData(void *data)
 	{
-		return {{width(), lines}, pixFmt};
+		this->data = (uint16_t*)data;
 	}
 
-	void setPixmapData(void *data)
+	void *pixmapData() const
 	{
-		pix = {makePixmapDesc(), data};
+		return data;
 	}
 
-	IG::Pixmap pixmap() const
+	// pixmap of the lines inside the vertical border with the widest line's width,
+	// mixedLineWidths is set when lines don't all share that width
+	IG::Pixmap pixmap(const int32_t *&mixedLineWidths)
 	{
-		return pix;
+		const int y = 8;
+		int height = lines - 16;
+		bool hasSingleWidth = false, hasDoubleWidth = false;
+		iterateTimes(height, i)
+		{
+			bool doubleWidth = lineIsDoubleWidth[y + i];
+			frameLineWidth[i] = lineWidth(doubleWidth);
+			hasSingleWidth |= !doubleWidth;
+			hasDoubleWidth |= doubleWidth;
+		}
+		mixedLineWidths = hasSingleWidth && hasDoubleWidth ? frameLineWidth.data() : nullptr;
+		return {{{lineWidth(hasDoubleWidth), height}, pixFmt}, data + y * pitch(), {(uint32_t)pitch(), IG::Pixmap::PIXEL_UNITS}};
 	}
 
 	void *setCurrentScanline(int line)
 	{
 		currentLine = line;
-		return pix.pixel({0, line});
+		return data + line * pitch();
 	}
 
 	int currentScanline() const
@@ -99,24 +115,25 @@ public:
 	}
 
 protected:
-	IG::Pixmap pix{};
+	uint16_t *data{};
 	int maxWidth = 1;
 	int lines = 1;
 	int currentLine = 0;
-	bool doubleWidthFrame = false;
-
-	void updatePixmapSize()
-	{
-		pix = {makePixmapDesc(), pix.pixel({})};
-	}
+	std::array<bool, FB_MAX_LINES> lineIsDoubleWidth{};
+	std::array<int32_t, FB_MAX_LINES> frameLineWidth{};
 };
 
 static FrameBufferImpl fb{};
+static const int32_t *mixedLineWidths{};
 
 IG::Pixmap frameBufferPixmap()
 {
-	auto fbPix = fb.pixmap();
-	return fbPix.subView({0, 8}, {(int)fbPix.w(), (int)fbPix.h() - 16});
+	return fb.pixmap(mixedLineWidths);
+}
+
+const int32_t *frameBufferLineWidths()
+{
+	return mixedLineWidths;
 }
 
 FrameBufferData* frameBufferDataCreate(int maxWidth, int maxHeight, int defaultHorizZoom)
@@ -137,7 +154,7 @@ FrameBuffer* frameBufferFlipDrawFrame() { return &fb; }
 
 FrameBufferData* frameBufferGetActive()
 {
-	return (FrameBufferData*)fb.pixmap().pixel({});
+	return (FrameBufferData*)fb.pixmapData();
 }
 
 void frameBufferSetActive(FrameBufferData* frameData)
@@ -170,13 +187,12 @@ Pixel* frameBufferGetLine(FrameBuffer* frameBuffer, int y)
 
 int frameBufferGetDoubleWidth(FrameBuffer* frameBuffer, int y)
 {
-	return ((FrameBufferImpl*)frameBuffer)->doubleWidth();
+	return ((FrameBufferImpl*)frameBuffer)->doubleWidth(y);
 }
 
 void frameBufferSetDoubleWidth(FrameBuffer* frameBuffer, int y, int val)
 {
-	if(((FrameBufferImpl*)frameBuffer)->setDoubleWidth(val))
-		logMsg("set double width:%d on line:%d", val, y);
+	((FrameBufferImpl*)frameBuffer)->setDoubleWidth(y, val);
 }
 
 // Used by gunstick and asciilaser, line is set in frameBufferGetLine()
@@ -53,6 +53,8 @@ extern "C"
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nBlueMSX Team\nbluemsx.com";
 bool EmuSystem::handlesGenericIO = false; // TODO: need to re-factor BlueMSX file loading code
 bool EmuSystem::hasResetModes = true;
+bool EmuSystem::hasBootSnapshots = true;
+bool EmuSystem::hasMemoryStates = true;
 BoardInfo boardInfo{};
 Machine *machine{};
 Mixer *mixer{};
@@ -66,6 +68,7 @@ static FS::FileString tapeName{};
 FS::FileString hdName[4]{};
 static EmuSystemTask *emuSysTask{};
 static EmuVideo *emuVideo{};
+static uint32_t bootFrames{}, bootDriveIdleFrames{};
 static const char saveStateVersion[] = "blueMSX - state  v 8";
 extern int pendingInt;
 
@@ -475,23 +478,8 @@ FS::PathString EmuSystem::sprintStateFilename(int slot, const char *statePath, c
 	return FS::makePathStringPrintf("%s/%s.0%c.sta", statePath, gameName, saveSlotCharUpper(slot));
 }
 
-static EmuSystem::Error saveBlueMSXState(const char *filename)
+static void saveBlueMSXStateSections()
 {
-	if(!zipStartWrite(filename))
-	{
-		logErr("error creating zip:%s", filename);
-		return EmuSystem::makeFileWriteError();
-	}
-	saveStateCreateForWrite(filename);
-	int rv = zipSaveFile(filename, "version", 0, saveStateVersion, sizeof(saveStateVersion));
-	if (!rv)
-	{
-		saveStateDestroy();
-		zipEndWrite();
-		logErr("error writing to zip:%s", filename);
-		return EmuSystem::makeFileWriteError();
-	}
-
 	SaveState* state = saveStateOpenForWrite("board");
 
 	saveStateSet(state, "pendingInt", pendingInt);
@@ -517,11 +505,38 @@ static EmuSystem::Error saveBlueMSXState(const char *filename)
 
 	machineSaveState(machine);
 	boardInfo.saveState();
+}
+
+static EmuSystem::Error saveBlueMSXState(const char *filename)
+{
+	if(!zipStartWrite(filename))
+	{
+		logErr("error creating zip:%s", filename);
+		return EmuSystem::makeFileWriteError();
+	}
+	saveStateCreateForWrite(filename);
+	int rv = zipSaveFile(filename, "version", 0, saveStateVersion, sizeof(saveStateVersion));
+	if (!rv)
+	{
+		saveStateDestroy();
+		zipEndWrite();
+		logErr("error writing to zip:%s", filename);
+		return EmuSystem::makeFileWriteError();
+	}
+	saveBlueMSXStateSections();
 	saveStateDestroy();
 	zipEndWrite();
 	return {};
 }
 
+void *saveBlueMSXStateToMemory(uint32_t *size)
+{
+	saveStateCreateForWriteMemory();
+	saveBlueMSXStateSections();
+	saveStateDestroy();
+	return saveStateReleaseMemory(size);
+}
+
 EmuSystem::Error EmuSystem::saveState(const char *path)
 {
 	return saveBlueMSXState(path);
@@ -539,29 +554,8 @@ static FS::FileString saveStateGetFileString(SaveState* state, const char* tagNa
 	return name;
 }
 
-static EmuSystem::Error loadBlueMSXState(const char *filename)
+static EmuSystem::Error loadBlueMSXStateSections()
 {
-	logMsg("loading state %s", filename);
-
-	assert(machine);
-	ejectMedia();
-
-	saveStateCreateForRead(filename);
-	int size;
-	char *version = (char*)zipLoadFile(filename, "version", &size);
-	if(!version)
-	{
-		saveStateDestroy();
-		return EmuSystem::makeFileReadError();
-	}
-	if(0 != strncmp(version, saveStateVersion, sizeof(saveStateVersion) - 1))
-	{
-		free(version);
-		saveStateDestroy();
-		return EmuSystem::makeError("Incorrect state version");
-	}
-	free(version);
-
 	machineLoadState(machine);
 
 	// from this point on, errors are fatal and require the existing game to close
@@ -600,11 +594,64 @@ static EmuSystem::Error loadBlueMSXState(const char *filename)
 	return {};
 }
 
+static EmuSystem::Error loadBlueMSXState(const char *filename)
+{
+	logMsg("loading state %s", filename);
+
+	assert(machine);
+	ejectMedia();
+
+	saveStateCreateForRead(filename);
+	int size;
+	char *version = (char*)zipLoadFile(filename, "version", &size);
+	if(!version)
+	{
+		saveStateDestroy();
+		return EmuSystem::makeFileReadError();
+	}
+	if(0 != strncmp(version, saveStateVersion, sizeof(saveStateVersion) - 1))
+	{
+		free(version);
+		saveStateDestroy();
+		return EmuSystem::makeError("Incorrect state version");
+	}
+	free(version);
+	return loadBlueMSXStateSections();
+}
+
+EmuSystem::Error loadBlueMSXStateFromMemory(const void *data, uint32_t size)
+{
+	assert(machine);
+	ejectMedia();
+	if(!saveStateCreateForReadMemory(data, size))
+	{
+		saveStateDestroy();
+		return EmuSystem::makeError("Invalid memory state");
+	}
+	return loadBlueMSXStateSections();
+}
+
 EmuSystem::Error EmuSystem::loadState(const char *path)
 {
 	return loadBlueMSXState(path);
 }
 
+std::vector<uint8_t> EmuSystem::saveStateToMemory()
+{
+	uint32_t size;
+	auto data = (uint8_t*)saveBlueMSXStateToMemory(&size);
+	if(!data)
+		return {};
+	std::vector<uint8_t> state{data, data + size};
+	free(data);
+	return state;
+}
+
+EmuSystem::Error EmuSystem::loadStateFromMemory(const uint8_t *data, size_t size)
+{
+	return loadBlueMSXStateFromMemory(data, size);
+}
+
 void EmuSystem::saveBackupMem()
 {
 	if(gameIsRunning())
@@ -708,9 +755,32 @@ EmuSystem::Error EmuSystem::loadGame(IO &, EmuSystemCreateParams, OnLoadProgress
 		return EmuSystem::makeError("Unknown file type");
 	}
 	destroyMachineOnReturn.cancel();
+	bootFrames = bootDriveIdleFrames = 0;
+	uint64_t configHash = loadDiskAsHD;
+	for(auto name = currentMachineName(); *name; name++)
+	{
+		configHash = configHash * 31 + *name;
+	}
+	useBootSnapshot(configHash);
 	return {};
 }
 
+static void updateBootReady(EmuSystemTask *task)
+{
+	// treat the machine as booted once it's run for a few seconds and the
+	// disk drive has gone idle, disk games load in bursts during that time
+	static constexpr uint32_t MIN_BOOT_FRAMES = 60 * 6, DRIVE_IDLE_FRAMES = 60;
+	if(!task || bootFrames == UINT32_MAX)
+		return;
+	bootFrames++;
+	bootDriveIdleFrames = fdcActive ? 0 : bootDriveIdleFrames + 1;
+	if(bootFrames >= MIN_BOOT_FRAMES && bootDriveIdleFrames >= DRIVE_IDLE_FRAMES)
+	{
+		bootFrames = UINT32_MAX;
+		EmuSystem::markBootReady(task);
+	}
+}
+
 void EmuSystem::configAudioRate(IG::FloatSeconds frameTime, uint32_t rate)
 {
 	assumeExpr(rate == 44100);// TODO: not all sound chips handle non-44100Hz sample rate
@@ -740,7 +810,15 @@ void RefreshScreen(int screenMode)
 	//logMsg("called RefreshScreen");
 	if(likely(emuVideo))
 	{
-		emuVideo->startFrameWithFormat(emuSysTask, frameBufferPixmap());
+		auto fbPix = frameBufferPixmap();
+		if(auto lineWidth = frameBufferLineWidths())
+		{
+			emuVideo->startFrameWithLineWidths(emuSysTask, fbPix, lineWidth);
+		}
+		else
+		{
+			emuVideo->startFrameWithFormat(emuSysTask, fbPix);
+		}
 		emuVideo = {};
 		emuSysTask = {};
 	}
@@ -755,6 +833,7 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	boardInfo.run(boardInfo.cpuRef);
 	((R800*)boardInfo.cpuRef)->terminate = 0;
 	commitUnchangedVideoFrame(); // runs if emuVideo wasn't unset in emulation of this frame
+	updateBootReady(task);
 }
 
 bool EmuSystem::shouldFastForward()
@@ -50,6 +50,9 @@ void zipEndWrite();
 const char *machineBasePathStr();
 void setupVKeyboardMap(uint boardType);
 IG::Pixmap frameBufferPixmap();
+const int32_t *frameBufferLineWidths();
+void *saveBlueMSXStateToMemory(uint32_t *size);
+EmuSystem::Error loadBlueMSXStateFromMemory(const void *data, uint32_t size);
 bool setDefaultMachineName(const char *name);
 const char *currentMachineName();
 EmuSystem::Error setCurrentMachineName(const char *machineName, bool insertMediaFiles = true);
@@ -22,16 +22,87 @@
 #include <imagine/util/ScopeGuard.hh>
 #include "ziphelper.h"
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+struct CachedZipFile
+{
+	FS::FileString name{};
+	std::unique_ptr<uint8_t[]> data{};
+	int size{};
+};
 
 static struct archive *writeArch{};
+static FS::PathString cachedZipName{};
+static std::vector<CachedZipFile> cachedZipFiles{};
 
 void zipCacheReadOnlyZip(const char* zipName)
 {
-	// TODO
+	// read all files of the archive in one pass so each zipLoadFile()
+	// doesn't have to re-open and scan it
+	cachedZipFiles.clear();
+	cachedZipFiles.shrink_to_fit();
+	cachedZipName = {};
+	if(!zipName)
+		return;
+	std::error_code ec{};
+	for(auto &entry : FS::ArchiveIterator{zipName, ec})
+	{
+		if(entry.type() == FS::file_type::directory)
+		{
+			continue;
+		}
+		auto io = entry.moveIO();
+		int fileSize = io.size();
+		auto &file = cachedZipFiles.emplace_back();
+		string_copy(file.name, entry.name());
+		file.data = std::make_unique<uint8_t[]>(fileSize);
+		file.size = io.read(file.data.get(), fileSize);
+	}
+	if(ec)
+	{
+		logErr("error caching archive:%s", zipName);
+		cachedZipFiles.clear();
+		return;
+	}
+	string_copy(cachedZipName, zipName);
+}
+
+int zipIsCached(const char* zipName)
+{
+	return strlen(cachedZipName.data()) && string_equal(zipName, cachedZipName.data());
+}
+
+const void* zipCachedFile(const char* zipName, const char* fileName, int* size)
+{
+	if(!zipIsCached(zipName))
+		return nullptr;
+	for(auto &file : cachedZipFiles)
+	{
+		if(string_equal(file.name.data(), fileName))
+		{
+			*size = file.size;
+			return file.data.get();
+		}
+	}
+	logErr("file %s not in archive:%s", fileName, zipName);
+	return nullptr;
 }
 
 void* zipLoadFile(const char* zipName, const char* fileName, int* size)
 {
+	if(zipIsCached(zipName))
+	{
+		int fileSize;
+		auto data = zipCachedFile(zipName, fileName, &fileSize);
+		if(!data)
+			return nullptr;
+		void *buff = malloc(fileSize);
+		memcpy(buff, data, fileSize);
+		*size = fileSize;
+		return buff;
+	}
 	ArchiveIO io{};
 	std::error_code ec{};
 	for(auto &entry : FS::ArchiveIterator{zipName, ec})
@@ -23,6 +23,9 @@
 #include <zlib.h>
 #endif
 #include "unzip.h"
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #include "video.h"
 #include "transpack.h"
@@ -63,6 +66,10 @@ void neogeo_cmc50_m1_decrypt(GAME_ROMS *r);
 
 static int need_decrypt = 1;
 
+/* v2 .gno file mapped by dr_open_gno, its regions point inside it */
+static Uint8 *gno_map = NULL;
+static size_t gno_map_size = 0;
+
 int neogeo_fix_bank_type = 0;
 
 int bankoffset_kof99[64] = {
@@ -940,9 +947,13 @@ static int allocate_region(ROM_REGION *r, Uint32 size, int region) {
 	return 0;
 }
 
+static int in_gno_map(const Uint8 *p) {
+	return gno_map && p >= gno_map && p < gno_map + gno_map_size;
+}
+
 static void free_region(ROM_REGION *r) {
 	DEBUG_LOG("Free Region %p %p %d", r, r->p, r->size);
-	if (r->p)
+	if (r->p && !in_gno_map(r->p))
 		free(r->p);
 	r->size = 0;
 	r->p = NULL;
@@ -1600,78 +1611,77 @@ int dr_load_game(char *name, char romerror[1024]) {
 
 #if defined(HAVE_LIBZ)//&& defined (HAVE_MMAP)
 
-static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id, Uint8 type,
-		Uint32 block_size, uint verbose) {
+/* .gno files cache a game's regions after loading, decryption and
+ * conversion. v1 files store the sprites in zlib compressed 4KB blocks that
+ * are decompressed on demand through the sprite cache. v2 files store every
+ * region uncompressed at a GNO_ALIGN aligned offset so the file can be mapped
+ * and used in place, the OS then pages tiles in as they're drawn and can
+ * drop them again under memory pressure:
+ *
+ * "gnodmpv2", name[8], flags (Uint32), nb_sec (Uint8), 3 bytes padding,
+ * nb_sec GNO_SECTION entries, then the region data */
+
+#define GNO_ALIGN 0x4000 /* largest page size of the supported platforms */
+#define GNO_MAX_SECTIONS 16
+
+typedef struct GNO_SECTION {
+	Uint32 size;
+	Uint32 offset;
+	Uint8 id;
+	Uint8 pad[3];
+}GNO_SECTION;
+
+static ROM_REGION *region_by_id(GAME_ROMS *roms, Uint8 lid) {
+	switch (lid) {
+		case REGION_MAIN_CPU_CARTRIDGE:
+			return &roms->cpu_m68k;
+		case REGION_AUDIO_CPU_CARTRIDGE:
+			return &roms->cpu_z80;
+		case REGION_AUDIO_DATA_1:
+			return &roms->adpcma;
+		case REGION_AUDIO_DATA_2:
+			return &roms->adpcmb;
+		case REGION_FIXED_LAYER_CARTRIDGE:
+			return &roms->game_sfix;
+		case REGION_SPRITES:
+			return &roms->tiles;
+		case REGION_SPR_USAGE:
+			return &roms->spr_usage;
+		case REGION_GAME_FIX_USAGE:
+			return &roms->gfix_usage;
+		case REGION_FIXED_LAYER_BIOS:
+			return &roms->bios_sfix;
+		case REGION_MAIN_CPU_BIOS:
+			return &roms->bios_m68k;
+		default:
+			return NULL;
+	}
+}
+
+static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id,
+		GNO_SECTION *sec, Uint8 *nb_sec) {
+	long pos;
 	if (rom->p == NULL)
+		return true;
+	pos = (ftell(gno) + GNO_ALIGN - 1) & ~(long)(GNO_ALIGN - 1);
+	if (fseek(gno, pos, SEEK_SET) != 0
+			|| fwrite(rom->p, rom->size, 1, gno) != 1)
 		return false;
-	fwrite(&rom->size, sizeof (Uint32), 1, gno);
-	fwrite(&id, sizeof (Uint8), 1, gno);
-	fwrite(&type, sizeof (Uint8), 1, gno);
-	if (type == 0) {
-		if(verbose) logMsg("Dump %d %08x", id, rom->size);
-		fwrite(rom->p, rom->size, 1, gno);
-	} else {
-		Uint32 nb_block = rom->size / block_size;
-		Uint32 *block_offset;
-		Uint32 cur_offset = 0;
-		long offset_pos;
-		Uint32 i;
-		const Uint8 *inbuf = rom->p;
-		Uint8 *outbuf;
-		uLongf outbuf_len;
-		uLongf outlen;
-		Uint32 outlen32;
-		Uint32 cmpsize = 0;
-		int rc;
-		if(verbose) logMsg("nb_block=%d", nb_block);
-		fwrite(&block_size, sizeof (Uint32), 1, gno);
-		if ((rom->size & (block_size - 1)) != 0) {
-			if(verbose) logMsg("Waring: Block_size and totsize not compatible %x %x\n",
-					rom->size, block_size);
-		}
-		block_offset = malloc(nb_block * sizeof (Uint32));
-		/* Zlib compress output buffer need to be at least the size
-		 of inbuf + 0.1% + 12 byte */
-		outbuf_len = compressBound(block_size);
-		outbuf = malloc(outbuf_len);
-		offset_pos = ftell(gno);
-		fseek(gno, nb_block * 4 + 4, SEEK_CUR); /* Skip all the offset table + the total compressed size */
-
-		for (i = 0; i < nb_block; i++) {
-			cur_offset = ftell(gno);
-			block_offset[i] = cur_offset;
-			outlen = outbuf_len;
-			rc = compress(outbuf, &outlen, inbuf, block_size);
-			if(verbose) logMsg("%d %ld", rc, outlen);
-			//cur_offset += outlen;
-			cmpsize += outlen;
-			if(verbose) logMsg("cmpsize=%d %ld", cmpsize, (long int)sizeof (uLongf));
-			inbuf += block_size;
-			outlen32 = (Uint32) outlen;
-			fwrite(&outlen32, sizeof (Uint32), 1, gno);
-			if(verbose) logMsg("bank %d outlen=%d offset=%d", i, outlen32, cur_offset);
-			fwrite(outbuf, outlen, 1, gno);
-		}
-		free(outbuf);
-		/* Now, write the offset table */
-		fseek(gno, offset_pos, SEEK_SET);
-		fwrite(block_offset, sizeof (Uint32), nb_block, gno);
-		free(block_offset);
-		fwrite(&cmpsize, sizeof (Uint32), 1, gno);
-		if(verbose) logMsg("cmpsize=%d", cmpsize);
-		fseek(gno, 0, SEEK_END);
-		offset_pos = ftell(gno);
-		if(verbose) logMsg("currpos=%li", offset_pos);
-	}
+	sec[*nb_sec].size = rom->size;
+	sec[*nb_sec].offset = pos;
+	sec[*nb_sec].id = id;
+	(*nb_sec)++;
 	return true;
 }
 
 int dr_save_gno(GAME_ROMS *r, char *filename) {
 	FILE *gno;
-	char *fid = "gnodmpv1";
+	char *fid = "gnodmpv2";
 	char fname[9];
+	Uint8 pad[3] = {0};
+	GNO_SECTION sec[GNO_MAX_SECTIONS];
 	Uint8 nb_sec = 0;
-	int i;
+	int ok = true;
 
 	gn_init_pbar(PBAR_ACTION_SAVEGNO, 4);
 	gno = fopen(filename, "wb");
@@ -1680,67 +1690,52 @@ int dr_save_gno(GAME_ROMS *r, char *filename) {
 
 	/* restore game vector */
 	memcpy(memory.rom.cpu_m68k.p, memory.game_vector, 0x80);
-	/*for (i = 0; i < 0x80; i++)
-		printf("%02x ", memory.rom.cpu_m68k.p[i]);
-	printf("\n");*/
-
-	if (r->cpu_m68k.p)
-		nb_sec++;
-	if (r->cpu_z80.p)
-		nb_sec++;
-	if (r->adpcma.p)
-		nb_sec++;
-	if (r->adpcmb.p && (r->adpcmb.p != r->adpcma.p))
-		nb_sec++;
-	if (r->game_sfix.p)
-		nb_sec++;
-	if (r->tiles.p)
-		nb_sec += 2; /* Sprite + Sprite usage */
-	if (r->gfix_usage.p)
-		nb_sec++;
-	/* Do we need Custom Bios? */
-	if ((r->info.flags & HAS_CUSTOM_CPU_BIOS)) {
-		logMsg("Has custom CPU BIOS");
-		nb_sec++;
-	}
-	if ((r->info.flags & HAS_CUSTOM_SFIX_BIOS)) {
-		logMsg("Has custom SFIX BIOS");
-		nb_sec++;
-	}
-
 
-	/* Header information */
+	/* Header information, the section table is written once the regions are */
+	memset(sec, 0, sizeof(sec));
 	fwrite(fid, 8, 1, gno);
 	snprintf(fname, 9, "%-8s", r->info.name);
 	fwrite(fname, 8, 1, gno);
 	fwrite(&r->info.flags, sizeof (Uint32), 1, gno);
 	fwrite(&nb_sec, sizeof (Uint8), 1, gno);
+	fwrite(pad, sizeof(pad), 1, gno);
+	fwrite(sec, sizeof(sec), 1, gno);
 
 	/* Now each section */
-	dump_region(gno, &r->cpu_m68k, REGION_MAIN_CPU_CARTRIDGE, 0, 0, 0);
-	dump_region(gno, &r->cpu_z80, REGION_AUDIO_CPU_CARTRIDGE, 0, 0, 0);
+	ok &= dump_region(gno, &r->cpu_m68k, REGION_MAIN_CPU_CARTRIDGE, sec, &nb_sec);
+	ok &= dump_region(gno, &r->cpu_z80, REGION_AUDIO_CPU_CARTRIDGE, sec, &nb_sec);
 	gn_update_pbar(1);
-	dump_region(gno, &r->adpcma, REGION_AUDIO_DATA_1, 0, 0, 0);
+	ok &= dump_region(gno, &r->adpcma, REGION_AUDIO_DATA_1, sec, &nb_sec);
 	if (r->adpcma.p != r->adpcmb.p)
-		dump_region(gno, &r->adpcmb, REGION_AUDIO_DATA_2, 0, 0, 0);
+		ok &= dump_region(gno, &r->adpcmb, REGION_AUDIO_DATA_2, sec, &nb_sec);
 	gn_update_pbar(2);
-	dump_region(gno, &r->game_sfix, REGION_FIXED_LAYER_CARTRIDGE, 0, 0, 0);
-	dump_region(gno, &r->spr_usage, REGION_SPR_USAGE, 0, 0, 0);
-	dump_region(gno, &r->gfix_usage, REGION_GAME_FIX_USAGE, 0, 0, 0);
+	ok &= dump_region(gno, &r->game_sfix, REGION_FIXED_LAYER_CARTRIDGE, sec, &nb_sec);
+	ok &= dump_region(gno, &r->spr_usage, REGION_SPR_USAGE, sec, &nb_sec);
+	ok &= dump_region(gno, &r->gfix_usage, REGION_GAME_FIX_USAGE, sec, &nb_sec);
 	if ((r->info.flags & HAS_CUSTOM_CPU_BIOS)) {
-		dump_region(gno, &r->bios_m68k, REGION_MAIN_CPU_BIOS, 0, 0, 0);
+		logMsg("Has custom CPU BIOS");
+		ok &= dump_region(gno, &r->bios_m68k, REGION_MAIN_CPU_BIOS, sec, &nb_sec);
 	}
 	if ((r->info.flags & HAS_CUSTOM_SFIX_BIOS)) {
-		dump_region(gno, &r->bios_sfix, REGION_FIXED_LAYER_BIOS, 0, 0, 0);
+		logMsg("Has custom SFIX BIOS");
+		ok &= dump_region(gno, &r->bios_sfix, REGION_FIXED_LAYER_BIOS, sec, &nb_sec);
 	}
 	gn_update_pbar(3);
-	/* TODO, there is a bug in the loading routine, only one compressed (type 1)
-	 * region can be present at the end of the file */
-	dump_region(gno, &r->tiles, REGION_SPRITES, 1, 4096, 0);
-
+	ok &= dump_region(gno, &r->tiles, REGION_SPRITES, sec, &nb_sec);
 
-	fclose(gno);
-	return true;
+	if (ok) {
+		fseek(gno, 8 + 8 + sizeof (Uint32), SEEK_SET);
+		ok = fwrite(&nb_sec, sizeof (Uint8), 1, gno) == 1;
+		fseek(gno, sizeof(pad), SEEK_CUR);
+		ok = ok && fwrite(sec, sizeof(sec), 1, gno) == 1;
+	}
+	if (fclose(gno) != 0)
+		ok = false;
+	if (!ok) {
+		logMsg("error writing %s", filename);
+		remove(filename);
+	}
+	return ok;
 }
 
 int read_region(FILE *gno, GAME_ROMS *roms) {
@@ -1756,41 +1751,9 @@ int read_region(FILE *gno, GAME_ROMS *roms) {
 	totread += fread(&lid, sizeof (Uint8), 1, gno);
 	totread += fread(&type, sizeof (Uint8), 1, gno);
 
-	switch (lid) {
-		case REGION_MAIN_CPU_CARTRIDGE:
-			r = &roms->cpu_m68k;
-			break;
-		case REGION_AUDIO_CPU_CARTRIDGE:
-			r = &roms->cpu_z80;
-			break;
-		case REGION_AUDIO_DATA_1:
-			r = &roms->adpcma;
-			break;
-		case REGION_AUDIO_DATA_2:
-			r = &roms->adpcmb;
-			break;
-		case REGION_FIXED_LAYER_CARTRIDGE:
-			r = &roms->game_sfix;
-			break;
-		case REGION_SPRITES:
-			r = &roms->tiles;
-			break;
-		case REGION_SPR_USAGE:
-			r = &roms->spr_usage;
-			break;
-		case REGION_GAME_FIX_USAGE:
-			r = &roms->gfix_usage;
-			break;
-		case REGION_FIXED_LAYER_BIOS:
-			r = &roms->bios_sfix;
-			break;
-		case REGION_MAIN_CPU_BIOS://break;
-			logMsg("reading custom CPU BIOS");
-			r = &roms->bios_m68k;
-			break;
-		default:
-			return false;
-	}
+	r = region_by_id(roms, lid);
+	if (!r)
+		return false;
 
 	logMsg("Read region %d %08X type %d\n", lid, size, type);
 	if (type == 0) {
@@ -1827,13 +1790,68 @@ int read_region(FILE *gno, GAME_ROMS *roms) {
 	return true;
 }
 
+static int read_gno_v2(FILE *gno, GAME_ROMS *roms, Uint8 nb_sec) {
+	GNO_SECTION sec[GNO_MAX_SECTIONS];
+	Uint8 pad[3];
+	long file_size;
+	int i;
+
+	if (nb_sec > GNO_MAX_SECTIONS
+			|| fread(pad, sizeof(pad), 1, gno) != 1
+			|| fread(sec, sizeof(sec), 1, gno) != 1
+			|| fseek(gno, 0, SEEK_END) != 0
+			|| (file_size = ftell(gno)) < 0) {
+		fclose(gno);
+		return false;
+	}
+	for (i = 0; i < nb_sec; i++) {
+		if (!region_by_id(roms, sec[i].id)
+				|| (uint64_t)sec[i].offset + sec[i].size > (uint64_t)file_size) {
+			logMsg("bad GNO section %d", sec[i].id);
+			fclose(gno);
+			return false;
+		}
+	}
+
+#ifdef HAVE_MMAP
+	/* Private writable mapping so the few regions patched after loading,
+	 * like the 68k vectors, get copied on write */
+	gno_map = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(gno), 0);
+	if (gno_map == MAP_FAILED) {
+		logMsg("can't map GNO file, reading it instead");
+		gno_map = NULL;
+	} else
+		gno_map_size = file_size;
+#endif
+
+	for (i = 0; i < nb_sec; i++) {
+		ROM_REGION *r = region_by_id(roms, sec[i].id);
+		gn_update_pbar(i);
+		if (gno_map) {
+			logMsg("Map region %d %08X", sec[i].id, sec[i].size);
+			r->p = gno_map + sec[i].offset;
+			r->size = sec[i].size;
+		} else {
+			logMsg("Read region %d %08X", sec[i].id, sec[i].size);
+			allocate_region(r, sec[i].size, sec[i].id);
+			if (fseek(gno, sec[i].offset, SEEK_SET) != 0
+					|| fread(r->p, r->size, 1, gno) != 1) {
+				fclose(gno);
+				return false;
+			}
+		}
+	}
+	fclose(gno);
+	return true;
+}
+
 int dr_open_gno(char *filename, char romerror[1024]) {
 	FILE *gno;
-	char fid[9]; // = "gnodmpv1";
+	char fid[9]; // = "gnodmpv1" or "gnodmpv2";
 	char name[9] = {0,};
 	GAME_ROMS *r = &memory.rom;
 	Uint8 nb_sec;
-	int i;
+	int i, version;
 	char *a;
 	size_t totread = 0;
 
@@ -1851,7 +1869,11 @@ int dr_open_gno(char *filename, char romerror[1024]) {
 	}
 
 	totread += fread(fid, 8, 1, gno);
-	if (strncmp(fid, "gnodmpv1", 8) != 0) {
+	if (strncmp(fid, "gnodmpv1", 8) == 0)
+		version = 1;
+	else if (strncmp(fid, "gnodmpv2", 8) == 0)
+		version = 2;
+	else {
 		fclose(gno);
 		sprintf(romerror, "Invalid GNO file");
 		return false;
@@ -1865,9 +1887,16 @@ int dr_open_gno(char *filename, char romerror[1024]) {
 	totread += fread(&nb_sec, sizeof (Uint8), 1, gno);
 
 	gn_init_pbar(PBAR_ACTION_LOADGNO, nb_sec);
-	for (i = 0; i < nb_sec; i++) {
-		gn_update_pbar(i);
-		read_region(gno, r);
+	if (version == 1) {
+		/* the sprite cache keeps reading from the file */
+		for (i = 0; i < nb_sec; i++) {
+			gn_update_pbar(i);
+			read_region(gno, r);
+		}
+	} else if (!read_gno_v2(gno, r, nb_sec)) {
+		gn_terminate_pbar();
+		sprintf(romerror, "Invalid GNO file");
+		return false;
 	}
 	gn_terminate_pbar();
 
@@ -1900,7 +1929,7 @@ int dr_open_gno(char *filename, char romerror[1024]) {
 
 char *dr_gno_romname(char *filename) {
 	FILE *gno;
-	char fid[9]; // = "gnodmpv1";
+	char fid[9]; // = "gnodmpv1" or "gnodmpv2";
 	char name[9] = {0,};
 	size_t totread = 0;
 
@@ -1909,7 +1938,7 @@ char *dr_gno_romname(char *filename) {
 		return NULL;
 
 	totread += fread(fid, 8, 1, gno);
-	if (strncmp(fid, "gnodmpv1", 8) != 0) {
+	if (strncmp(fid, "gnodmpv1", 8) != 0 && strncmp(fid, "gnodmpv2", 8) != 0) {
 		fclose(gno);
 		logMsg("Invalid GNO file");
 		return NULL;
@@ -1923,10 +1952,6 @@ char *dr_gno_romname(char *filename) {
 
 #else
 
-static int dump_region(FILE *gno, ROM_REGION *rom, Uint8 id, Uint8 type, Uint32 block_size) {
-	return TRUE;
-}
-
 int dr_save_gno(GAME_ROMS *r, char *filename) {
 	return TRUE;
 }
@@ -1963,9 +1988,18 @@ void dr_free_roms(GAME_ROMS *r) {
 	free_region(&r->bios_sfix);
 
 	free(memory.ng_lo);
-	free(memory.fix_game_usage);
+	if (!in_gno_map(memory.fix_game_usage))
+		free(memory.fix_game_usage);
 	free_region(&r->spr_usage);
 
+#ifdef HAVE_MMAP
+	if (gno_map) {
+		munmap(gno_map, gno_map_size);
+		gno_map = NULL;
+		gno_map_size = 0;
+	}
+#endif
+
 	//free(r->info.name);
 	//free(r->info.longname);
 
@@ -10,7 +10,9 @@ main/EmuControls.cc \
 main/EmuMenuViews.cc \
 main/FceuApi.cc \
 main/Cheats.cc \
-main/EmuFileIO.cc
+main/EmuFileIO.cc \
+main/Netplay.cc \
+main/RollbackNetplay.cc
 
 CPPFLAGS += -I$(projectPath)/src \
 -DHAVE_ASPRINTF \
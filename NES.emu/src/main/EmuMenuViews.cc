@@ -412,6 +412,110 @@ public:
 	}
 };
 
+class NetplayView : public TableView
+{
+private:
+	static constexpr uint16_t DEFAULT_PORT = 7845;
+
+	TextHeadingMenuItem status{};
+
+	TextMenuItem host
+	{
+		"Host Game",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			EmuApp::pushAndShowNewCollectValueInputView<int>(attachParams(), e,
+				"Input port to listen on", string_makePrintf<8>("%u", DEFAULT_PORT).data(),
+				[this](auto port)
+				{
+					if(port < 1 || port > 0xFFFF)
+					{
+						EmuApp::postErrorMessage("Port must be 1 to 65535");
+						return false;
+					}
+					return start(nullptr, port);
+				});
+		}
+	};
+
+	TextMenuItem join
+	{
+		"Join Game",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			EmuApp::pushAndShowNewCollectValueInputView<const char*>(attachParams(), e,
+				"Input host address, and port if not the default", "",
+				[this](auto str)
+				{
+					std::array<char, 256> address{};
+					unsigned port = DEFAULT_PORT;
+					if(sscanf(str, "%255[^:]:%u", address.data(), &port) < 1 || port < 1 || port > 0xFFFF)
+					{
+						EmuApp::postErrorMessage("Enter an address like 192.168.0.2 or 192.168.0.2:7845");
+						return false;
+					}
+					return start(address.data(), port);
+				});
+		}
+	};
+
+	TextMenuItem endSession
+	{
+		"End Session",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			EmuApp::syncEmulationThread();
+			endNetplay();
+			refreshStatus();
+		}
+	};
+
+	std::array<MenuItem*, 4> menuItem
+	{
+		&status,
+		&host,
+		&join,
+		&endSession,
+	};
+
+	bool start(const char *address, uint16_t port)
+	{
+		EmuApp::syncEmulationThread();
+		if(auto err = startNetplay(address, port);
+			err)
+		{
+			EmuApp::postErrorMessage(err);
+			return false;
+		}
+		refreshStatus();
+		EmuApp::postMessage(address ? "Return to the game to connect" : "Return to the game to wait for player 2");
+		return true;
+	}
+
+	void refreshStatus()
+	{
+		status.compile(netplayStatusString(), renderer(), projP);
+		endSession.setActive(netplayIsActive());
+	}
+
+public:
+	NetplayView(ViewAttachParams attach):
+		TableView
+		{
+			"Netplay",
+			attach,
+			menuItem
+		}
+	{}
+
+	void onShow() final
+	{
+		TableView::onShow();
+		EmuApp::syncEmulationThread();
+		refreshStatus();
+	}
+};
+
 class CustomSystemActionsView : public EmuSystemActionsView
 {
 private:
@@ -454,11 +558,24 @@ private:
 		}
 	};
 
+	TextMenuItem netplay
+	{
+		"Netplay",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			if(EmuSystem::gameIsRunning())
+			{
+				pushAndShow(makeView<NetplayView>(), e);
+			}
+		}
+	};
+
 public:
 	CustomSystemActionsView(ViewAttachParams attach): EmuSystemActionsView{attach, true}
 	{
 		item.emplace_back(&fdsControl);
 		item.emplace_back(&options);
+		item.emplace_back(&netplay);
 		loadStandardItems();
 	}
 
@@ -37,6 +37,7 @@ void FCEU_setDefaultPalettePtr(pal *ptr);
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nFCEUX Team\nfceux.com";
 bool EmuSystem::hasCheats = true;
+bool EmuSystem::hasRamSearch = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 uint fceuCheats = 0;
@@ -110,12 +111,18 @@ EmuSystem::NameFilterFunc EmuSystem::defaultBenchmarkFsFilter = hasNESExtension;
 void EmuSystem::reset(ResetMode mode)
 {
 	assert(gameIsRunning());
+	endNetplay();
 	if(mode == RESET_HARD)
 		FCEUI_PowerNES();
 	else
 		FCEUI_ResetNES();
 }
 
+std::vector<RamSearchRegion> EmuSystem::ramSearchRegions()
+{
+	return {{"RAM", RAM, 0x800, 0}};
+}
+
 static char saveSlotCharNES(int slot)
 {
 	switch(slot)
@@ -141,6 +148,8 @@ EmuSystem::Error EmuSystem::saveState(const char *path)
 
 EmuSystem::Error EmuSystem::loadState(const char *path)
 {
+	// the other side wouldn't load the same state
+	endNetplay();
 	if(!FCEUI_LoadState(path))
 		return EmuSystem::makeFileReadError();
 	else
@@ -163,6 +172,7 @@ void EmuSystem::saveBackupMem() // for manually saving when not closing game
 
 void EmuSystem::closeSystem()
 {
+	endNetplay();
 	FCEUI_CloseGame();
 	fceuCheats = 0;
 }
@@ -424,6 +434,11 @@ void FCEUPPU_FrameReady(EmuSystemTask *task, EmuVideo *video, uint8 *buf)
 
 void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 {
+	if(netplayIsActive())
+	{
+		runNetplayFrame(task, video, audio);
+		return;
+	}
 	bool skip = !video && !optionCompatibleFrameskip;
 	FCEUI_Emulate(task, video, skip, audio);
 }
@@ -0,0 +1,145 @@
+/*  This file is part of NES.emu.
+
+	NES.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	NES.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with NES.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "netplay"
+#include <emuframework/EmuApp.hh>
+#include <emuframework/EmuVideo.hh>
+#include <imagine/logger/logger.h>
+#include "internal.hh"
+#include "RollbackNetplay.hh"
+#include <fceu/driver.h>
+#include <fceu/fceu.h>
+#include <fceu/state.h>
+#include <fceu/emufile.h>
+#include <fceu/git.h>
+#include <zlib.h>
+#include <memory>
+
+static std::unique_ptr<UdpTransport> transport{};
+static std::unique_ptr<RollbackNetplay> session{};
+static const char *lastError{};
+// where the frame currently being run outputs to, only set while in runNetplayFrame()
+static EmuSystemTask *frameTask{};
+static EmuVideo *frameVideo{};
+static EmuAudio *frameAudio{};
+
+static RollbackNetplay::Game nesGame()
+{
+	return
+	{
+		[](std::vector<uint8_t> &state)
+		{
+			EMUFILE_MEMORY file{&state};
+			file.truncate(0);
+			FCEUSS_SaveMS(&file, Z_NO_COMPRESSION);
+		},
+		[](std::vector<uint8_t> &state)
+		{
+			EMUFILE_MEMORY file{&state};
+			return FCEUSS_LoadFP(&file, SSLOADPARAM_NOBACKUP);
+		},
+		[](RollbackNetplay::Input p1, RollbackNetplay::Input p2, bool output)
+		{
+			netplayPadData = p1 | p2 << 8;
+			// always render since the fast frameskip mode approximates sprite 0 hits,
+			// which could make a re-simulated frame differ from the other side's
+			FCEUI_Emulate(frameTask, output ? frameVideo : nullptr, 0, output ? frameAudio : nullptr);
+		}
+	};
+}
+
+static uint32_t gameId()
+{
+	uint32_t id;
+	memcpy(&id, GameInfo->MD5.data, sizeof(id));
+	return id;
+}
+
+static void closeSession()
+{
+	session.reset();
+	transport.reset();
+	// connect the gamepads to the local input again
+	setupNESInputPorts();
+}
+
+const char *startNetplay(const char *host, uint16_t port)
+{
+	assert(GameInfo);
+	if(usingZapper)
+		return "Netplay needs gamepads on both ports";
+	endNetplay();
+	lastError = {};
+	transport = std::make_unique<UdpTransport>();
+	if(host ? !transport->connect(host, port) : !transport->listen(port))
+	{
+		transport.reset();
+		return host ? "Can't find host address" : "Can't listen on port";
+	}
+	logMsg("starting %s session on port %d", host ? "client" : "host", port);
+	session = std::make_unique<RollbackNetplay>(*transport, nesGame(), !host, gameId());
+	setupNESInputPorts();
+	return {};
+}
+
+void endNetplay()
+{
+	if(!session)
+		return;
+	session->disconnect();
+	closeSession();
+}
+
+bool netplayIsActive()
+{
+	return (bool)session;
+}
+
+const char *netplayStatusString()
+{
+	if(!session)
+		return lastError ? lastError : "Not connected";
+	switch(session->status())
+	{
+		case RollbackNetplay::Status::CONNECTING:
+			return session->isHost() ? "Waiting for player 2" : "Connecting to host";
+		case RollbackNetplay::Status::SYNCING:
+			return session->isHost() ? "Sending game to player 2" : "Receiving game from host";
+		case RollbackNetplay::Status::RUNNING:
+			return session->isHost() ? "Connected as player 1" : "Connected as player 2";
+		default:
+			return session->errorString() ? session->errorString() : "Disconnected";
+	}
+}
+
+void runNetplayFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+	frameTask = task;
+	frameVideo = video;
+	frameAudio = audio;
+	bool ranFrame = session->advance(localPlayerInput());
+	frameTask = {};
+	frameVideo = {};
+	frameAudio = {};
+	if(session->status() == RollbackNetplay::Status::DISCONNECTED)
+	{
+		lastError = session->errorString();
+		closeSession();
+	}
+	if(!ranFrame && video)
+	{
+		video->startUnchangedFrame(task);
+	}
+}
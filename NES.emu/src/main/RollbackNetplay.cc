@@ -0,0 +1,475 @@
+/*  This file is part of NES.emu.
+
+	NES.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	NES.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with NES.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "netplay"
+#include "RollbackNetplay.hh"
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static constexpr uint32_t PROTOCOL_VERSION = 1;
+// keeps the start state datagrams under a typical MTU
+static constexpr unsigned STATE_CHUNK_SIZE = 1200;
+static constexpr unsigned STATE_CHUNKS_PER_SEND = 8;
+static constexpr unsigned STATE_RESEND_TICKS = 8;
+static constexpr uint32_t MAX_STATE_SIZE = 4 * 1024 * 1024;
+static constexpr unsigned HELLO_TICKS = 15;
+static constexpr unsigned TIMEOUT_TICKS = 600;
+static constexpr unsigned SYNC_TICKS = 10;
+static constexpr unsigned MAX_PACKET_SIZE = 1500;
+
+enum PacketType : uint8_t
+{
+	// version, game id
+	PACKET_HELLO = 1,
+	// total size, offset, data
+	PACKET_START_STATE,
+	// bytes received
+	PACKET_START_STATE_ACK,
+	// sender's frame, count of inputs received, frame advantage, first input frame, input count, inputs
+	PACKET_INPUTS,
+	PACKET_BYE,
+};
+
+static void writeU32(uint8_t *p, uint32_t v)
+{
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint32_t readU32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+UdpTransport::~UdpTransport()
+{
+	if(fd != -1)
+		::close(fd);
+}
+
+bool UdpTransport::open(uint16_t bindPort)
+{
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if(fd == -1)
+	{
+		logErr("error creating socket:%s", strerror(errno));
+		return false;
+	}
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	if(bindPort)
+	{
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(bindPort);
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		if(bind(fd, (sockaddr*)&addr, sizeof(addr)) == -1)
+		{
+			logErr("error binding port %d:%s", bindPort, strerror(errno));
+			::close(fd);
+			fd = -1;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UdpTransport::listen(uint16_t port)
+{
+	return open(port);
+}
+
+bool UdpTransport::connect(const char *host, uint16_t port)
+{
+	addrinfo hints{};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo *info{};
+	if(int err = getaddrinfo(host, nullptr, &hints, &info);
+		err || !info)
+	{
+		logErr("error looking up %s:%s", host, gai_strerror(err));
+		return false;
+	}
+	memcpy(&peerAddr, info->ai_addr, sizeof(peerAddr));
+	freeaddrinfo(info);
+	peerAddr.sin_port = htons(port);
+	hasPeer = true;
+	return open(0);
+}
+
+bool UdpTransport::send(const uint8_t *data, size_t size)
+{
+	if(!hasPeer)
+		return false;
+	return sendto(fd, data, size, 0, (sockaddr*)&peerAddr, sizeof(peerAddr)) == (ssize_t)size;
+}
+
+size_t UdpTransport::receive(uint8_t *data, size_t size)
+{
+	while(true)
+	{
+		sockaddr_in addr{};
+		socklen_t addrLen = sizeof(addr);
+		auto bytes = recvfrom(fd, data, size, 0, (sockaddr*)&addr, &addrLen);
+		if(bytes <= 0)
+			return 0;
+		if(!hasPeer)
+		{
+			logMsg("got datagram from %s:%d", inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+			peerAddr = addr;
+			hasPeer = true;
+		}
+		else if(addr.sin_addr.s_addr != peerAddr.sin_addr.s_addr || addr.sin_port != peerAddr.sin_port)
+		{
+			continue;
+		}
+		return bytes;
+	}
+}
+
+RollbackNetplay::RollbackNetplay(NetplayTransport &transport, Game game, bool isHost, uint32_t gameId, unsigned inputDelay):
+	transport{transport}, game{game}, gameId{gameId},
+	inputDelay{std::min(inputDelay, MAX_INPUT_DELAY)}, isHost_{isHost}
+{}
+
+RollbackNetplay::~RollbackNetplay()
+{
+	disconnect();
+}
+
+bool RollbackNetplay::advance(Input input)
+{
+	if(status_ == Status::DISCONNECTED)
+		return false;
+	ticks++;
+	ticksSinceReceive++;
+	receive();
+	if(status_ == Status::CONNECTING && !isHost_ && ticks % HELLO_TICKS == 1)
+	{
+		sendHello();
+	}
+	else if(status_ == Status::SYNCING && isHost_)
+	{
+		sendStartState();
+	}
+	// the host waits for someone to join for as long as it's asked to
+	if(ticksSinceReceive > TIMEOUT_TICKS && (status_ != Status::CONNECTING || !isHost_))
+	{
+		logErr("no data for %u ticks", ticksSinceReceive);
+		sendBye();
+		end("Connection timed out");
+	}
+	if(status_ != Status::RUNNING)
+		return false;
+	if(shouldStall())
+	{
+		sendInputs();
+		return false;
+	}
+	localInput[localCount % INPUT_RING] = input;
+	localCount++;
+	if(rollbackFrame < frame_)
+	{
+		rollbacks_++;
+		rollbackFrames_ += frame_ - rollbackFrame;
+		game.loadState(state[rollbackFrame % STATE_RING]);
+		for(auto f = rollbackFrame; f < frame_; f++)
+		{
+			if(f != rollbackFrame)
+				game.saveState(state[f % STATE_RING]);
+			runFrame(f, false);
+		}
+	}
+	rollbackFrame = NO_ROLLBACK;
+	game.saveState(state[frame_ % STATE_RING]);
+	runFrame(frame_, true);
+	frame_++;
+	sendInputs();
+	return true;
+}
+
+void RollbackNetplay::disconnect()
+{
+	if(status_ == Status::DISCONNECTED)
+		return;
+	// nothing confirms a goodbye so send a few in case some are lost
+	iterateTimes(3, i)
+	{
+		sendBye();
+	}
+	end({});
+}
+
+bool RollbackNetplay::shouldStall()
+{
+	// too many frames with predicted input to roll back
+	if(frame_ >= remoteCount + MAX_PREDICTION)
+		return true;
+	// too many local inputs the other side hasn't acknowledged to resend
+	if(localCount - peerAck >= INPUT_RING - 1)
+		return true;
+	// Each side sees the other's frame delayed by the same latency, so a difference
+	// in how far ahead each side thinks it is means one side really is ahead and
+	// should give the other a frame to catch up
+	int localAdvantage = (int)(frame_ - remoteFrame);
+	if(frame_ % SYNC_TICKS == 0 && frame_ != syncStallFrame && localAdvantage - remoteAdvantage >= 2)
+	{
+		syncStallFrame = frame_;
+		return true;
+	}
+	return false;
+}
+
+void RollbackNetplay::runFrame(uint32_t frame, bool output)
+{
+	auto local = localInput[frame % INPUT_RING];
+	Input remote;
+	if(frame < remoteCount)
+	{
+		remote = remoteInput[frame % INPUT_RING];
+	}
+	else
+	{
+		remote = remoteCount ? remoteInput[(remoteCount - 1) % INPUT_RING] : 0;
+		predictedInput[frame % INPUT_RING] = remote;
+	}
+	if(isHost_)
+		game.runFrame(local, remote, output);
+	else
+		game.runFrame(remote, local, output);
+}
+
+void RollbackNetplay::receive()
+{
+	uint8_t buff[MAX_PACKET_SIZE];
+	while(auto size = transport.receive(buff, sizeof(buff)))
+	{
+		ticksSinceReceive = 0;
+		handlePacket(buff, size);
+		if(status_ == Status::DISCONNECTED)
+			return;
+	}
+}
+
+void RollbackNetplay::handlePacket(const uint8_t *data, size_t size)
+{
+	switch(data[0])
+	{
+		case PACKET_HELLO:
+		{
+			if(!isHost_ || status_ != Status::CONNECTING || size < 9)
+				return;
+			if(readU32(&data[1]) != PROTOCOL_VERSION || readU32(&data[5]) != gameId)
+			{
+				logErr("other side has version %u game id 0x%X", readU32(&data[1]), readU32(&data[5]));
+				sendBye();
+				end("Other player has a different game or app version");
+				return;
+			}
+			game.saveState(startState);
+			startStateSize = startState.size();
+			startStateBytes = 0;
+			logMsg("sending %u byte start state", startStateSize);
+			status_ = Status::SYNCING;
+			return;
+		}
+		case PACKET_START_STATE:
+		{
+			if(isHost_ || size < 9)
+				return;
+			auto totalSize = readU32(&data[1]);
+			auto offset = readU32(&data[5]);
+			if(status_ == Status::CONNECTING)
+			{
+				if(totalSize > MAX_STATE_SIZE)
+				{
+					sendBye();
+					end("Host sent an invalid state");
+					return;
+				}
+				startState.resize(totalSize);
+				startStateSize = totalSize;
+				startStateBytes = 0;
+				status_ = Status::SYNCING;
+			}
+			if(status_ == Status::SYNCING && totalSize == startStateSize && offset == startStateBytes)
+			{
+				auto bytes = std::min((uint32_t)size - 9, startStateSize - offset);
+				memcpy(&startState[offset], &data[9], bytes);
+				startStateBytes += bytes;
+			}
+			// also acknowledge chunks that arrive after starting in case the last acknowledgement was lost
+			sendStartStateAck();
+			if(status_ == Status::SYNCING && startStateBytes == startStateSize)
+			{
+				if(!game.loadState(startState))
+				{
+					sendBye();
+					end("Error loading the host's state");
+					return;
+				}
+				startRunning();
+			}
+			return;
+		}
+		case PACKET_START_STATE_ACK:
+		{
+			if(!isHost_ || status_ != Status::SYNCING || size < 5)
+				return;
+			startStateBytes = std::max(startStateBytes, std::min(readU32(&data[1]), startStateSize));
+			if(startStateBytes == startStateSize)
+				startRunning();
+			return;
+		}
+		case PACKET_INPUTS:
+		{
+			if(size < 15)
+				return;
+			// the joining side only sends inputs after loading the whole start state
+			if(isHost_ && status_ == Status::SYNCING)
+				startRunning();
+			if(status_ != Status::RUNNING)
+				return;
+			unsigned count = data[14];
+			if(size < 15 + count)
+				return;
+			remoteFrame = std::max(remoteFrame, readU32(&data[1]));
+			peerAck = std::clamp(readU32(&data[5]), peerAck, localCount);
+			remoteAdvantage = (int8_t)data[9];
+			handleInputs(readU32(&data[10]), &data[15], count);
+			return;
+		}
+		case PACKET_BYE:
+		{
+			logMsg("other side disconnected");
+			end(status_ == Status::CONNECTING ? "Host refused the connection" : "Other player left");
+			return;
+		}
+	}
+}
+
+void RollbackNetplay::handleInputs(uint32_t firstFrame, const uint8_t *inputs, unsigned count)
+{
+	iterateTimes(count, i)
+	{
+		auto frame = firstFrame + i;
+		if(frame < remoteCount)
+			continue;
+		// inputs come in order, anything past a gap or too far ahead to store is sent again later
+		if(frame != remoteCount || frame >= frame_ + INPUT_RING - MAX_PREDICTION)
+			break;
+		remoteInput[frame % INPUT_RING] = inputs[i];
+		if(frame < frame_ && predictedInput[frame % INPUT_RING] != inputs[i])
+			rollbackFrame = std::min(rollbackFrame, frame);
+		remoteCount++;
+	}
+}
+
+void RollbackNetplay::startRunning()
+{
+	logMsg("starting session as %s with %u frame input delay", isHost_ ? "host" : "client", inputDelay);
+	startState = {};
+	status_ = Status::RUNNING;
+	frame_ = 0;
+	// the first inputs are empty since the local input of a frame applies after the delay
+	localInput = {};
+	localCount = inputDelay;
+	remoteCount = 0;
+	peerAck = 0;
+	remoteFrame = 0;
+	remoteAdvantage = 0;
+	rollbackFrame = NO_ROLLBACK;
+	syncStallFrame = NO_ROLLBACK;
+	sendInputs();
+}
+
+void RollbackNetplay::end(const char *errorStr)
+{
+	if(errorStr)
+		logErr("ending session:%s", errorStr);
+	else
+		logMsg("ending session after %u frames, %u rollbacks of %u frames", frame_, rollbacks_, rollbackFrames_);
+	error = errorStr;
+	status_ = Status::DISCONNECTED;
+	startState = {};
+	for(auto &s : state)
+	{
+		s = {};
+	}
+}
+
+void RollbackNetplay::sendHello()
+{
+	uint8_t buff[9]{PACKET_HELLO};
+	writeU32(&buff[1], PROTOCOL_VERSION);
+	writeU32(&buff[5], gameId);
+	transport.send(buff, sizeof(buff));
+}
+
+void RollbackNetplay::sendStartState()
+{
+	// send the next chunks after each acknowledgement, resending them if it takes too long
+	if(startStateBytes == startStateSentBytes && ticks - startStateSendTick < STATE_RESEND_TICKS)
+		return;
+	startStateSentBytes = startStateBytes;
+	startStateSendTick = ticks;
+	uint8_t buff[9 + STATE_CHUNK_SIZE]{PACKET_START_STATE};
+	writeU32(&buff[1], startStateSize);
+	for(uint32_t offset = startStateBytes, chunks = 0;
+		offset < startStateSize && chunks < STATE_CHUNKS_PER_SEND;
+		offset += STATE_CHUNK_SIZE, chunks++)
+	{
+		auto bytes = std::min(STATE_CHUNK_SIZE, startStateSize - offset);
+		writeU32(&buff[5], offset);
+		memcpy(&buff[9], &startState[offset], bytes);
+		transport.send(buff, 9 + bytes);
+	}
+}
+
+void RollbackNetplay::sendStartStateAck()
+{
+	uint8_t buff[5]{PACKET_START_STATE_ACK};
+	writeU32(&buff[1], startStateBytes);
+	transport.send(buff, sizeof(buff));
+}
+
+void RollbackNetplay::sendInputs()
+{
+	uint8_t buff[15 + INPUT_RING]{PACKET_INPUTS};
+	unsigned count = localCount - peerAck;
+	writeU32(&buff[1], frame_);
+	writeU32(&buff[5], remoteCount);
+	buff[9] = std::clamp((int)(frame_ - remoteFrame), -128, 127);
+	writeU32(&buff[10], peerAck);
+	buff[14] = count;
+	iterateTimes(count, i)
+	{
+		buff[15 + i] = localInput[(peerAck + i) % INPUT_RING];
+	}
+	transport.send(buff, 15 + count);
+}
+
+void RollbackNetplay::sendBye()
+{
+	uint8_t buff[1]{PACKET_BYE};
+	transport.send(buff, sizeof(buff));
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+/*  This file is part of NES.emu.
+
+	NES.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	NES.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with NES.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/DelegateFunc.hh>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <netinet/in.h>
+
+// Sends and receives whole datagrams without blocking
+class NetplayTransport
+{
+public:
+	virtual ~NetplayTransport() = default;
+	virtual bool send(const uint8_t *data, size_t size) = 0;
+	// returns the datagram size or 0 if none is waiting
+	virtual size_t receive(uint8_t *data, size_t size) = 0;
+};
+
+// IPv4 UDP socket, the host side learns its peer's address from the first datagram
+class UdpTransport : public NetplayTransport
+{
+public:
+	UdpTransport() {}
+	~UdpTransport();
+	UdpTransport(const UdpTransport &) = delete;
+	UdpTransport &operator=(const UdpTransport &) = delete;
+	bool listen(uint16_t port);
+	bool connect(const char *host, uint16_t port);
+	bool send(const uint8_t *data, size_t size) final;
+	size_t receive(uint8_t *data, size_t size) final;
+
+private:
+	int fd = -1;
+	sockaddr_in peerAddr{};
+	bool hasPeer = false;
+
+	bool open(uint16_t bindPort);
+};
+
+// Two player rollback session over a NetplayTransport. Each side sends its inputs
+// for every frame, runs ahead with the last known input of the other side when its
+// inputs haven't arrived, and on a misprediction loads the state from the first
+// wrong frame and runs the frames since again without output.
+//
+// The host sends its current state to the joining side so both start from the same
+// frame, the game must then only change through runFrame() for the sides to stay
+// in sync.
+
+class RollbackNetplay
+{
+public:
+	using Input = uint8_t;
+
+	struct Game
+	{
+		DelegateFunc<void(std::vector<uint8_t> &state)> saveState;
+		DelegateFunc<bool(std::vector<uint8_t> &state)> loadState;
+		// runs one frame, output is false when re-simulating or otherwise not shown
+		DelegateFunc<void(Input p1, Input p2, bool output)> runFrame;
+	};
+
+	enum class Status : uint8_t
+	{
+		CONNECTING, SYNCING, RUNNING, DISCONNECTED
+	};
+
+	static constexpr unsigned MAX_PREDICTION = 8;
+	static constexpr unsigned MAX_INPUT_DELAY = 8;
+
+	// the host is player 1, gameId must match on both sides
+	RollbackNetplay(NetplayTransport &transport, Game game, bool isHost, uint32_t gameId, unsigned inputDelay = 2);
+	~RollbackNetplay();
+	// advances one frame with the local input, returns false without running a frame
+	// when connecting or waiting for the other side to catch up
+	bool advance(Input localInput);
+	void disconnect();
+	Status status() const { return status_; }
+	bool isHost() const { return isHost_; }
+	const char *errorString() const { return error; }
+	uint32_t frame() const { return frame_; }
+	uint32_t rollbacks() const { return rollbacks_; }
+	uint32_t rollbackFrames() const { return rollbackFrames_; }
+
+private:
+	static constexpr unsigned INPUT_RING = 64;
+	static constexpr unsigned STATE_RING = MAX_PREDICTION + 1;
+	static constexpr uint32_t NO_ROLLBACK = UINT32_MAX;
+
+	NetplayTransport &transport;
+	Game game;
+	const char *error{};
+	std::array<std::vector<uint8_t>, STATE_RING> state{};
+	std::vector<uint8_t> startState{};
+	std::array<Input, INPUT_RING> localInput{};
+	std::array<Input, INPUT_RING> remoteInput{};
+	std::array<Input, INPUT_RING> predictedInput{};
+	uint32_t gameId;
+	unsigned inputDelay;
+	uint32_t frame_{};
+	// count of inputs from the start of the session
+	uint32_t localCount{};
+	uint32_t remoteCount{};
+	// count of local inputs the other side has
+	uint32_t peerAck{};
+	uint32_t rollbackFrame = NO_ROLLBACK;
+	uint32_t remoteFrame{};
+	int remoteAdvantage{};
+	uint32_t syncStallFrame = NO_ROLLBACK;
+	// bytes of startState the joining side acknowledged, or received on the joining side
+	uint32_t startStateBytes{};
+	uint32_t startStateSize{};
+	uint32_t startStateSentBytes = UINT32_MAX;
+	unsigned startStateSendTick{};
+	unsigned ticksSinceReceive{};
+	unsigned ticks{};
+	uint32_t rollbacks_{};
+	uint32_t rollbackFrames_{};
+	Status status_{Status::CONNECTING};
+	bool isHost_;
+
+	void receive();
+	void handlePacket(const uint8_t *data, size_t size);
+	void handleInputs(uint32_t firstFrame, const uint8_t *inputs, unsigned count);
+	void startRunning();
+	void end(const char *errorStr);
+	void sendHello();
+	void sendStartState();
+	void sendStartStateAck();
+	void sendInputs();
+	void sendBye();
+	void runFrame(uint32_t frame, bool output);
+	bool shouldStall();
+};
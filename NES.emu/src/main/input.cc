@@ -46,6 +46,8 @@ const bool EmuSystem::inputHasTriggerBtns = false;
 const bool EmuSystem::inputHasRevBtnLayout = false;
 const uint EmuSystem::maxPlayers = 4;
 static uint32 padData = 0;
+// what the gamepads read during netplay, both players' inputs for the frame being run
+uint32 netplayPadData = 0;
 uint32 zapperData[3]{};
 bool usingZapper = false;
 
@@ -55,7 +57,7 @@ void connectNESInput(int port, ESI type)
 	if(type == SI_GAMEPAD)
 	{
 		//logMsg("gamepad to port %d", port);
-		FCEUI_SetInput(port, SI_GAMEPAD, &padData, 0);
+		FCEUI_SetInput(port, SI_GAMEPAD, netplayIsActive() ? &netplayPadData : &padData, 0);
 	}
 	else if(type == SI_ZAPPER)
 	{
@@ -68,6 +70,11 @@ void connectNESInput(int port, ESI type)
 	}
 }
 
+uint8 localPlayerInput()
+{
+	return padData & 0xFF;
+}
+
 void GetMouseData(uint32 (&d)[3])
 {
 	// TODO
@@ -4,6 +4,8 @@
 #include <fceu/driver.h>
 
 class EmuAudio;
+class EmuVideo;
+class EmuSystemTask;
 
 namespace EmuControls
 {
@@ -24,6 +26,7 @@ extern ESI nesInputPortDev[2];
 extern uint autoDetectedRegion;
 extern uint32 zapperData[3];
 extern bool usingZapper;
+extern uint32 netplayPadData;
 
 bool hasFDSBIOSExtension(const char *name);
 void setupNESInputPorts();
@@ -33,3 +36,10 @@ const char *regionToStr(int region);
 void emulateSound(EmuAudio *audio);
 void setDefaultPalette(const char *palPath);
 void setRegion(int region, int defaultRegion, int detectedRegion);
+uint8 localPlayerInput();
+// starts hosting a session when host is null, returns an error string on failure
+const char *startNetplay(const char *host, uint16_t port);
+void endNetplay();
+bool netplayIsActive();
+const char *netplayStatusString();
+void runNetplayFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
@@ -0,0 +1,222 @@
+/*  This file is part of NES.emu.
+
+	NES.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	NES.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with NES.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+// Runs two RollbackNetplay peers in one process over an in-memory transport with
+// injected latency, jitter, reordering and packet loss, driving a deterministic
+// stand-in for the emulator, and checks both sides end in the same state.
+// Build and run with "make -C NES.emu/src/main/tests check".
+
+#include "../RollbackNetplay.hh"
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+
+static unsigned now; // ticks, one per displayed frame
+static bool verbose;
+
+CLINK void logger_printf(LoggerSeverity, const char *msg, ...)
+{
+	if(!verbose)
+		return;
+	va_list args;
+	va_start(args, msg);
+	vfprintf(stderr, msg, args);
+	va_end(args);
+}
+
+struct LinkConfig
+{
+	unsigned latency;
+	unsigned jitter;
+	double loss;
+};
+
+// one direction of the connection, datagrams become readable once their delivery
+// tick passes, jitter lets later ones overtake earlier ones
+struct LossyLink
+{
+	struct Datagram
+	{
+		unsigned due;
+		std::vector<uint8_t> data;
+	};
+
+	std::deque<Datagram> queue{};
+};
+
+class LossyTransport : public NetplayTransport
+{
+public:
+	LossyTransport(LossyLink &out, LossyLink &in, LinkConfig config, std::mt19937 &rng):
+		out{out}, in{in}, config{config}, rng{rng} {}
+
+	bool send(const uint8_t *data, size_t size) final
+	{
+		if(std::uniform_real_distribution<>{0., 1.}(rng) < config.loss)
+			return true; // dropped
+		unsigned due = now + config.latency + (config.jitter ? rng() % (config.jitter + 1) : 0);
+		out.queue.push_back({due, {data, data + size}});
+		return true;
+	}
+
+	size_t receive(uint8_t *data, size_t size) final
+	{
+		for(auto it = in.queue.begin(); it != in.queue.end(); ++it)
+		{
+			if(it->due > now)
+				continue;
+			size_t bytes = std::min(size, it->data.size());
+			memcpy(data, it->data.data(), bytes);
+			in.queue.erase(it);
+			return bytes;
+		}
+		return 0;
+	}
+
+private:
+	LossyLink &out, &in;
+	LinkConfig config;
+	std::mt19937 &rng;
+};
+
+// deterministic game whose state depends on every input of every frame
+struct TestGame
+{
+	uint64_t hash = 1469598103934665603ull;
+	uint32_t frame{};
+	std::vector<uint8_t> ram = std::vector<uint8_t>(5000);
+
+	void run(RollbackNetplay::Input p1, RollbackNetplay::Input p2)
+	{
+		hash = (hash ^ (p1 | p2 << 8 | (uint64_t)frame << 16)) * 1099511628211ull;
+		ram[frame % ram.size()] ^= hash;
+		frame++;
+	}
+
+	void save(std::vector<uint8_t> &state) const
+	{
+		state.resize(sizeof(hash) + sizeof(frame) + ram.size());
+		auto p = state.data();
+		memcpy(p, &hash, sizeof(hash));
+		memcpy(p + sizeof(hash), &frame, sizeof(frame));
+		memcpy(p + sizeof(hash) + sizeof(frame), ram.data(), ram.size());
+	}
+
+	bool load(const std::vector<uint8_t> &state)
+	{
+		if(state.size() != sizeof(hash) + sizeof(frame) + ram.size())
+			return false;
+		auto p = state.data();
+		memcpy(&hash, p, sizeof(hash));
+		memcpy(&frame, p + sizeof(hash), sizeof(frame));
+		memcpy(ram.data(), p + sizeof(hash) + sizeof(frame), ram.size());
+		return true;
+	}
+
+	bool operator==(const TestGame &rhs) const
+	{
+		return hash == rhs.hash && frame == rhs.frame && ram == rhs.ram;
+	}
+};
+
+static RollbackNetplay::Game makeGame(TestGame &game)
+{
+	return
+	{
+		[&game](std::vector<uint8_t> &state){ game.save(state); },
+		[&game](std::vector<uint8_t> &state){ return game.load(state); },
+		[&game](RollbackNetplay::Input p1, RollbackNetplay::Input p2, bool){ game.run(p1, p2); }
+	};
+}
+
+static bool runSession(LinkConfig config, unsigned seed)
+{
+	constexpr uint32_t gameId = 0x1234;
+	std::mt19937 rng{seed};
+	LossyLink toJoiner, toHost;
+	LossyTransport hostTransport{toJoiner, toHost, config, rng};
+	LossyTransport joinTransport{toHost, toJoiner, config, rng};
+	TestGame hostGame, joinGame;
+	// the joining side must end up with the host's state, so start them apart
+	for(unsigned i = 0; i < 300; i++)
+		hostGame.run(i, i * 3);
+	joinGame.hash = 42;
+	RollbackNetplay host{hostTransport, makeGame(hostGame), true, gameId};
+	RollbackNetplay joiner{joinTransport, makeGame(joinGame), false, gameId};
+	std::mt19937 inputRng{seed + 1};
+	RollbackNetplay::Input hostInput{}, joinInput{};
+	auto tick = [&](bool runHost, bool runJoiner)
+	{
+		now++;
+		if(runHost)
+			host.advance(hostInput);
+		if(runJoiner)
+			joiner.advance(joinInput);
+	};
+	// the host starts a little later and the joining side misses a tick now and then
+	for(unsigned i = 0; i < 6000; i++)
+	{
+		if(i % 7 == 0)
+			hostInput = inputRng();
+		if(i % 5 == 0)
+			joinInput = inputRng();
+		tick(i > 20, i % 97 != 0);
+	}
+	// hold the inputs steady until every prediction is confirmed, then bring both
+	// sides to the same frame
+	hostInput = joinInput = 0;
+	for(unsigned i = 0; i < 500; i++)
+		tick(true, true);
+	for(unsigned i = 0; i < 1000 && host.frame() != joiner.frame(); i++)
+		tick(host.frame() < joiner.frame(), joiner.frame() < host.frame());
+	bool same = host.status() == RollbackNetplay::Status::RUNNING &&
+		joiner.status() == RollbackNetplay::Status::RUNNING &&
+		host.frame() == joiner.frame() && hostGame == joinGame;
+	printf("latency:%2u jitter:%2u loss:%2.0f%% seed:%u frames:%u/%u rollbacks:%u/%u %s\n",
+		config.latency, config.jitter, config.loss * 100., seed, host.frame(), joiner.frame(),
+		host.rollbacks(), joiner.rollbacks(), same ? "ok" : "MISMATCH");
+	return same;
+}
+
+int main(int argc, char **argv)
+{
+	verbose = getenv("NETPLAY_TEST_VERBOSE");
+	const LinkConfig configs[]
+	{
+		{0, 0, 0.},
+		{2, 0, 0.},
+		{5, 3, .05},
+		{10, 6, .2},
+		{30, 10, .4},
+	};
+	unsigned seeds = argc > 1 ? atoi(argv[1]) : 3;
+	unsigned failures = 0;
+	for(auto config : configs)
+	{
+		for(unsigned seed = 1; seed <= seeds; seed++)
+		{
+			if(!runSession(config, seed))
+				failures++;
+		}
+	}
+	if(failures)
+		printf("%u session(s) ended out of sync\n", failures);
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
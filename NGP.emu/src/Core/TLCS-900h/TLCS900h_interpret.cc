@@ -62,6 +62,7 @@
 #include "TLCS900h_interpret_src.h"
 #include "TLCS900h_interpret_dst.h"
 #include "TLCS900h_interpret_reg.h"
+#include <imagine/logger/logger.h>
 
 //=========================================================================
 
@@ -818,89 +819,54 @@ static void (*regDecode[256])() =
 
 //=========================================================================
 
-static void src_B()
-{
-	second = FETCH8;			//Get the second opcode
-	R = second & 7;
-	size = 0;					//Byte Size
-
-	(*srcDecode[second])();		//Call
-}
+typedef void (*InstrHandler)(void);
 
-static void src_W()
+//Prefix byte decoding, returns the handler for the second opcode
+static InstrHandler src_decode(int opSize)
 {
 	second = FETCH8;			//Get the second opcode
 	R = second & 7;
-	size = 1;					//Word Size
+	size = opSize;
 
-	(*srcDecode[second])();		//Call
+	return srcDecode[second];
 }
 
-static void src_L()
-{
-	second = FETCH8;			//Get the second opcode
-	R = second & 7;
-	size = 2;					//Long Size
+static void src_B()	{ (*src_decode(0))(); }	//Byte Size
+static void src_W()	{ (*src_decode(1))(); }	//Word Size
+static void src_L()	{ (*src_decode(2))(); }	//Long Size
 
-	(*srcDecode[second])();		//Call
-}
-
-static void dst()
+static InstrHandler dst_decode(void)
 {
 	second = FETCH8;			//Get the second opcode
 	R = second & 7;
 
-	(*dstDecode[second])();		//Call
+	return dstDecode[second];
 }
 
+static void dst()	{ (*dst_decode())(); }
+
 static uint8 rCodeConversionB[8] = { 0xE1, 0xE0, 0xE5, 0xE4, 0xE9, 0xE8, 0xED, 0xEC };
 static uint8 rCodeConversionW[8] = { 0xE0, 0xE4, 0xE8, 0xEC, 0xF0, 0xF4, 0xF8, 0xFC };
 static uint8 rCodeConversionL[8] = { 0xE0, 0xE4, 0xE8, 0xEC, 0xF0, 0xF4, 0xF8, 0xFC };
 
-static void reg_B()
-{
-	second = FETCH8;			//Get the second opcode
-	R = second & 7;
-	size = 0;					//Byte Size
-
-	if (brCode == FALSE)
-	{
-		brCode = TRUE;
-		rCode = rCodeConversionB[first & 7];
-	}
-
-	(*regDecode[second])();		//Call
-}
-
-static void reg_W()
+static InstrHandler reg_decode(int opSize, const uint8 *rCodeConversion)
 {
 	second = FETCH8;			//Get the second opcode
 	R = second & 7;
-	size = 1;					//Word Size
+	size = opSize;
 
 	if (brCode == FALSE)
 	{
 		brCode = TRUE;
-		rCode = rCodeConversionW[first & 7];
+		rCode = rCodeConversion[first & 7];
 	}
 
-	(*regDecode[second])();		//Call
+	return regDecode[second];
 }
 
-static void reg_L()
-{
-	second = FETCH8;			//Get the second opcode
-	R = second & 7;
-	size = 2;					//Long Size
-
-	if (brCode == FALSE)
-	{
-		brCode = TRUE;
-		rCode = rCodeConversionL[first & 7];
-	}
-
-	(*regDecode[second])();		//Call
-}
+static void reg_B()	{ (*reg_decode(0, rCodeConversionB))(); }
+static void reg_W()	{ (*reg_decode(1, rCodeConversionW))(); }
+static void reg_L()	{ (*reg_decode(2, rCodeConversionL))(); }
 
 //=============================================================================
 
@@ -943,7 +909,7 @@ static void (*decode[256])() =
 
 //=============================================================================
 
-uint32 TLCS900h_interpret(void)
+static uint32 interpret(void)
 {
 	brCode = FALSE;
 
@@ -956,7 +922,341 @@ uint32 TLCS900h_interpret(void)
 
 	(*decode[first])();	//Decode
 
+	//The BIOS HLE writes RAM directly
+	if (decode[first] == iBIOSHLE)
+		memory_invalidate_code(FALSE);
+
+	return cycles + cycles_extra;
+}
+
+//=============================================================================
+
+// Decoded instruction cache: the addressing mode bytes and prefix opcodes of
+// an instruction are decoded once into the handler to call and the state it
+// expects (first, second, R, size, rCode). Handlers still fetch their own
+// immediate operands and set their own cycle counts. Entries are tagged with
+// the memory generation of their address, see memory_code_generation().
+
+static const uint32 noCodeGeneration = 0;
+static const uint32 NO_PC = 0xFFFFFFFF;
+
+uint8 decode_cache_mode = DECODE_CACHE_ON;
+
+enum
+{
+	EA_NONE,
+	EA_REG,			//XWA..XSP
+	EA_REG_D8,		//XWA..XSP + d8
+	EA_ABS,			//8/16/24 bit address, also PC + d16
+	EA_R32,
+	EA_R32_D16,
+	EA_R32_R8,
+	EA_R32_R16,
+	EA_DEC,			//-(r32)
+	EA_INC,			//(r32+)
+	EA_RC,			//register code
+};
+
+enum
+{
+	DECODED_SECOND = 1,	//second & R set
+	DECODED_SIZE = 2,
+	DECODED_RCODE = 4,
+};
+
+struct DecodedInstr
+{
+	uint32 pc = NO_PC;
+	uint32 gen;
+	const uint32 *genPtr = &noCodeGeneration;
+	InstrHandler handler;
+	uint32 eaValue;		//address or displacement
+	uint8 length;
+	uint8 first, second, size;
+	uint8 ea, eaReg, eaIndex;
+	uint8 rCode;
+	uint8 flags;
+	uint8 cyclesExtra;
+};
+
+static const unsigned DECODE_CACHE_SIZE = 8192;
+static DecodedInstr decodeCache[DECODE_CACHE_SIZE];
+
+static bool decode_instr(uint32 address, DecodedInstr &d)
+{
+	uint32 p = address;
+	uint8 op = loadB(p++);
+	void (*extra)() = decodeExtra[op];
+
+	d.first = op;
+	d.ea = EA_NONE;
+	d.cyclesExtra = 0;
+	d.flags = 0;
+
+	if (!extra)
+		;
+	else if (extra == Ex8)
+	{
+		d.ea = EA_ABS; d.eaValue = loadB(p); p += 1; d.cyclesExtra = 2;
+	}
+	else if (extra == Ex16)
+	{
+		d.ea = EA_ABS; d.eaValue = loadW(p); p += 2; d.cyclesExtra = 2;
+	}
+	else if (extra == Ex24)
+	{
+		d.ea = EA_ABS; d.eaValue = loadW(p) | (loadB(p + 2) << 16); p += 3; d.cyclesExtra = 3;
+	}
+	else if (extra == ExR32)
+	{
+		uint8 data = loadB(p++);
+		if (data == 0x03 || data == 0x07)
+		{
+			d.ea = data == 0x03 ? EA_R32_R8 : EA_R32_R16;
+			d.eaReg = loadB(p++);
+			d.eaIndex = loadB(p++);
+			d.cyclesExtra = 8;
+		}
+		else if (data == 0x13)
+		{
+			p += 2;
+			d.ea = EA_ABS; d.eaValue = p + (int16)loadW(p - 2);
+			d.cyclesExtra = 8;
+		}
+		else if ((data & 3) == 1)
+		{
+			d.ea = EA_R32_D16; d.eaReg = data; d.eaValue = (int16)loadW(p); p += 2;
+			d.cyclesExtra = 5;
+		}
+		else
+		{
+			d.ea = EA_R32; d.eaReg = data;
+			d.cyclesExtra = 5;
+		}
+	}
+	else if (extra == ExDec || extra == ExInc)
+	{
+		d.ea = extra == ExDec ? EA_DEC : EA_INC;
+		d.eaReg = loadB(p++);
+		d.cyclesExtra = 3;
+	}
+	else if (extra == ExRC)
+	{
+		d.ea = EA_RC;
+		d.rCode = loadB(p++);
+		d.flags |= DECODED_RCODE;
+		d.cyclesExtra = 1;
+	}
+	else
+	{
+		//ExXWA..ExXSPd
+		d.ea = op & 8 ? EA_REG_D8 : EA_REG;
+		d.eaReg = op & 7;
+		if (op & 8)
+		{
+			d.eaValue = (int8)loadB(p++);
+			d.cyclesExtra = 2;
+		}
+	}
+
+	InstrHandler prefix = decode[op];
+	if (prefix == src_B || prefix == src_W || prefix == src_L || prefix == dst
+		|| prefix == reg_B || prefix == reg_W || prefix == reg_L)
+	{
+		d.second = loadB(p++);
+		d.flags |= DECODED_SECOND;
+		if (prefix == dst)
+			d.handler = dstDecode[d.second];
+		else
+		{
+			d.flags |= DECODED_SIZE;
+			if (prefix == src_B || prefix == reg_B)
+				d.size = 0;
+			else if (prefix == src_W || prefix == reg_W)
+				d.size = 1;
+			else
+				d.size = 2;
+			if (prefix == src_B || prefix == src_W || prefix == src_L)
+				d.handler = srcDecode[d.second];
+			else
+			{
+				if (!(d.flags & DECODED_RCODE))
+				{
+					const uint8 *conversion = prefix == reg_B ? rCodeConversionB :
+						prefix == reg_W ? rCodeConversionW : rCodeConversionL;
+					d.rCode = conversion[op & 7];
+					d.flags |= DECODED_RCODE;
+				}
+				d.handler = regDecode[d.second];
+			}
+		}
+	}
+	else
+		d.handler = prefix;
+
+	if (d.handler == iBIOSHLE)
+		return FALSE;
+
+	//Keep the instruction within one page so its generation covers it
+	if ((address ^ (p - 1)) & ~0xFFF)
+		return FALSE;
+	d.length = p - address;
+	d.pc = address;
+	return TRUE;
+}
+
+static InstrHandler apply_decoded(const DecodedInstr &d)
+{
+	static const uint8 incDec[4] = { 1, 2, 4, 0 };
+
+	first = d.first;
+	if (d.flags & DECODED_SECOND)
+	{
+		second = d.second;
+		R = second & 7;
+	}
+	if (d.flags & DECODED_SIZE)
+		size = d.size;
+	brCode = (d.flags & DECODED_RCODE) != 0;
+	if (brCode)
+		rCode = d.rCode;
+	cycles_extra = d.cyclesExtra;
+
+	switch (d.ea)
+	{
+	case EA_REG:		mem = regL(d.eaReg);	break;
+	case EA_REG_D8:		mem = regL(d.eaReg) + d.eaValue;	break;
+	case EA_ABS:		mem = d.eaValue;	break;
+	case EA_R32:		mem = rCodeL(d.eaReg);	break;
+	case EA_R32_D16:	mem = rCodeL(d.eaReg) + d.eaValue;	break;
+	case EA_R32_R8:		mem = rCodeL(d.eaReg) + (int8)rCodeB(d.eaIndex);	break;
+	case EA_R32_R16:	mem = rCodeL(d.eaReg) + (int16)rCodeW(d.eaIndex);	break;
+	case EA_DEC:
+		if (incDec[d.eaReg & 3])
+		{
+			rCodeL(d.eaReg & 0xFC) -= incDec[d.eaReg & 3];
+			mem = rCodeL(d.eaReg & 0xFC);
+		}
+		break;
+	case EA_INC:
+		if (incDec[d.eaReg & 3])
+		{
+			mem = rCodeL(d.eaReg & 0xFC);
+			rCodeL(d.eaReg & 0xFC) += incDec[d.eaReg & 3];
+		}
+		break;
+	}
+
+	pc += d.length;
+	return d.handler;
+}
+
+//=============================================================================
+
+// CPU state touched by instruction decoding
+struct DecodeState
+{
+	uint32 pc, mem, gprBank[4][4], gpr[4], rErr;
+	int size;
+	uint32 cycles_extra;
+	uint8 first, second, R, rCode;
+	bool brCode;
+};
+
+static void save_decode_state(DecodeState &s)
+{
+	memset(&s, 0, sizeof(s));
+	s.pc = pc; s.mem = mem; s.rErr = rErr;
+	memcpy(s.gprBank, gprBank, sizeof(s.gprBank));
+	memcpy(s.gpr, gpr, sizeof(s.gpr));
+	s.size = size; s.cycles_extra = cycles_extra;
+	s.first = first; s.second = second; s.R = R; s.rCode = rCode;
+	s.brCode = brCode;
+}
+
+static void load_decode_state(const DecodeState &s)
+{
+	pc = s.pc; mem = s.mem; rErr = s.rErr;
+	memcpy(gprBank, s.gprBank, sizeof(s.gprBank));
+	memcpy(gpr, s.gpr, sizeof(s.gpr));
+	size = s.size; cycles_extra = s.cycles_extra;
+	first = s.first; second = s.second; R = s.R; rCode = s.rCode;
+	brCode = s.brCode;
+}
+
+// Decode with the interpreter's own functions and the cached entry from the
+// same starting state, keeping the interpreter's result if they differ
+static InstrHandler verify_decoded(DecodedInstr &d)
+{
+	DecodeState start, ref, cached;
+	save_decode_state(start);
+
+	brCode = FALSE;
+	first = FETCH8;
+	cycles_extra = 0;
+	if (decodeExtra[first])
+		(*decodeExtra[first])();
+	InstrHandler handler = decode[first];
+	if (handler == src_B)	handler = src_decode(0);
+	else if (handler == src_W)	handler = src_decode(1);
+	else if (handler == src_L)	handler = src_decode(2);
+	else if (handler == dst)	handler = dst_decode();
+	else if (handler == reg_B)	handler = reg_decode(0, rCodeConversionB);
+	else if (handler == reg_W)	handler = reg_decode(1, rCodeConversionW);
+	else if (handler == reg_L)	handler = reg_decode(2, rCodeConversionL);
+	save_decode_state(ref);
+
+	load_decode_state(start);
+	InstrHandler cachedHandler = apply_decoded(d);
+	save_decode_state(cached);
+
+	if (cachedHandler != handler || memcmp(&ref, &cached, sizeof(ref)))
+	{
+		logErr("decoded instruction mismatch at %06X (%02X %02X), mem:%06X/%06X pc:%06X/%06X",
+			start.pc, ref.first, ref.second, ref.mem, cached.mem, ref.pc, cached.pc);
+		load_decode_state(ref);
+		d.pc = NO_PC;
+		memory_invalidate_code(TRUE);
+	}
+	return handler;
+}
+
+static uint32 decode_and_interpret(DecodedInstr &d)
+{
+	if (decode_cache_mode == DECODE_CACHE_OFF || eepromStatusEnable)
+		return interpret();
+
+	const uint32 *gen = memory_code_generation(pc);
+	if (!gen)
+		return interpret();
+	if (d.pc != pc || d.gen != *gen)
+	{
+		if (!decode_instr(pc, d))
+		{
+			d.pc = NO_PC;
+			return interpret();
+		}
+		d.gen = *gen;
+		d.genPtr = gen;
+		memory_watch_code(pc);
+	}
+
+	InstrHandler handler = decode_cache_mode == DECODE_CACHE_VERIFY ? verify_decoded(d) : apply_decoded(d);
+	(*handler)();	//Execute
+
 	return cycles + cycles_extra;
 }
 
+uint32 TLCS900h_interpret(void)
+{
+	DecodedInstr &d = decodeCache[(pc ^ (pc >> 13)) & (DECODE_CACHE_SIZE - 1)];
+	// the EEPROM status hack changes what the next ROM read returns
+	if (d.pc == pc && d.gen == *d.genPtr && decode_cache_mode == DECODE_CACHE_ON && !eepromStatusEnable)
+	{
+		(*apply_decoded(d))();	//Execute
+		return cycles + cycles_extra;
+	}
+	return decode_and_interpret(d);
+}
+
 //=============================================================================
@@ -0,0 +1,151 @@
+/*  This file is part of NGP.emu.
+
+	NGP.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	NGP.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with NGP.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+// Times loadB/W/L and storeB/W/L over a pre-generated access trace mixing work
+// RAM, a 32MBit cartridge's low and high ROM, the BIOS and I/O registers in
+// roughly the proportions TLCS-900h code produces, and prints a checksum of
+// the loaded values and final RAM.
+//
+// "make run" builds mem.cc with and without NEOPOP_NO_PAGE_TABLE, runs both
+// and checks their checksums match.
+
+#include "neopop.h"
+#include "mem.h"
+#include "flash.h"
+#include "sound.h"
+#include "interrupt.h"
+#include "Z80_interface.h"
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// the parts of the core mem.cc links against
+uint8 bios[0x10000];
+RomInfo rom{};
+RomHeader* rom_header;
+bool language_english = 1;
+COLOURMODE system_colour;
+uint32 timer_hint;
+uint8 timer[4];
+SoundChip toneChip;
+SoundChip noiseChip;
+void flash_write(uint32, uint16) {}
+void WriteSoundChip(SoundChip*, uint8) {}
+void Z80_nmi(void) {}
+void dac_write(void) {}
+CLINK void logger_printf(LoggerSeverity, const char*, ...) {}
+
+enum class Op : uint8 { LOAD_B, LOAD_W, LOAD_L, STORE_B, STORE_W, STORE_L };
+
+struct Access
+{
+	uint32 address;
+	uint32 data;
+	Op op;
+};
+
+static std::vector<Access> makeTrace(size_t size, unsigned seed)
+{
+	std::mt19937 rng{seed};
+	auto inRange = [&](uint32 start, uint32 end) -> uint32 { return start + rng() % (end - start + 1); };
+	std::vector<Access> trace;
+	trace.reserve(size);
+	for(size_t i = 0; i < size; i++)
+	{
+		auto width = rng() % 3;
+		auto load = Op(width);
+		auto store = Op(width + 3);
+		auto kind = rng() % 100;
+		if(kind < 40) // work RAM reads
+			trace.push_back({inRange(0x4000, 0x6FFB), 0, load});
+		else if(kind < 62) // work RAM writes
+			trace.push_back({inRange(0x4000, 0x6BFB), (uint32)rng(), store});
+		else if(kind < 80) // low ROM reads
+			trace.push_back({inRange(ROM_START, ROM_END - 3), 0, load});
+		else if(kind < 85) // high ROM reads
+			trace.push_back({inRange(HIROM_START, HIROM_END - 3), 0, load});
+		else if(kind < 90) // BIOS reads
+			trace.push_back({inRange(BIOS_START, BIOS_END - 3), 0, load});
+		else if(kind < 94) // timer/interrupt register reads
+			trace.push_back({inRange(0x20, 0x2F), 0, Op::LOAD_B});
+		else if(kind < 97) // video register and VRAM reads
+			trace.push_back({inRange(0x8000, 0xBFFB), 0, load});
+		else // video register and VRAM writes
+			trace.push_back({inRange(0x8010, 0xBFFB), (uint32)rng(), store});
+	}
+	return trace;
+}
+
+static uint32 runTrace(const std::vector<Access> &trace)
+{
+	uint32 sum = 0;
+	for(auto a : trace)
+	{
+		switch(a.op)
+		{
+			case Op::LOAD_B: sum = sum * 31 + loadB(a.address); break;
+			case Op::LOAD_W: sum = sum * 31 + loadW(a.address); break;
+			case Op::LOAD_L: sum = sum * 31 + loadL(a.address); break;
+			case Op::STORE_B: storeB(a.address, a.data); break;
+			case Op::STORE_W: storeW(a.address, a.data); break;
+			case Op::STORE_L: storeL(a.address, a.data); break;
+		}
+	}
+	return sum;
+}
+
+static void resetSystem(std::vector<uint8> &romData)
+{
+	for(size_t i = 0; i < romData.size(); i++)
+		romData[i] = i * 7 + (i >> 11);
+	for(size_t i = 0; i < sizeof(bios); i++)
+		bios[i] = i * 13 + (i >> 9);
+	rom.data = romData.data();
+	rom.length = romData.size();
+	rom_header = (RomHeader*)rom.data;
+	reset_memory();
+}
+
+int main(int argc, char **argv)
+{
+	unsigned runs = argc > 1 ? atoi(argv[1]) : 10;
+	auto trace = makeTrace(1 << 22, 1);
+	std::vector<uint8> romData(0x400000);
+	resetSystem(romData);
+	uint32 sum = runTrace(trace);
+	for(auto b : ram)
+		sum = sum * 31 + b;
+	double best = 1e9;
+	for(unsigned i = 0; i < runs; i++)
+	{
+		resetSystem(romData);
+		auto start = std::chrono::steady_clock::now();
+		runTrace(trace);
+		std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count() / trace.size());
+	}
+#ifdef NEOPOP_NO_PAGE_TABLE
+	const char *name = "translate_address only";
+#else
+	const char *name = "page table";
+#endif
+	printf("%s: %.2f ns per access (best of %u)\n", name, best, runs);
+	printf("checksum: %08x\n", sum);
+	return 0;
+}
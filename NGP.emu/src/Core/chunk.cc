@@ -155,6 +155,7 @@ bool read_SNAP(FILE *fp, uint32 size)
 			break;
 		case TAG_RAM:
 			memcpy(ram, p, SIZE_RAM);
+			memory_invalidate_code(FALSE);
 			break;
 		case TAG_REGS:
 			read_REGS(p);
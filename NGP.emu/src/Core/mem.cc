@@ -90,6 +90,7 @@ should stop "Gals Fighters" from writing all over itself.
 #include <assert.h>
 #include <imagine/logger/logger.h>
 #include <imagine/util/bits.h>
+#include <algorithm>
 
 using uint16u [[gnu::aligned(1)]] = uint16;
 using uint32u [[gnu::aligned(1)]] = uint32;
@@ -131,6 +132,131 @@ static void memory_error(uint32 address, bool read)
 
 //=============================================================================
 
+// Host pointers for 4KB pages of plain RAM/ROM, null pages go through
+// translate_address_read/write for I/O, flash and EEPROM handling
+static const unsigned PAGE_SHIFT = 12;
+static const unsigned PAGES = 0x1000000 >> PAGE_SHIFT;
+static uint8 *readPage[PAGES];
+static uint8 *writePage[PAGES];
+
+static void map_pages(uint8 **page, uint32 start, uint32 end, uint8 *data)
+{
+	// only map pages lying completely inside start to end (inclusive)
+	uint32 first = (start + (1 << PAGE_SHIFT) - 1) >> PAGE_SHIFT;
+	uint32 last = (end + 1) >> PAGE_SHIFT;
+	for (uint32 i = first; i < last; i++)
+		page[i] = data + ((i << PAGE_SHIFT) - start);
+}
+
+// Generations for the CPU's decoded instruction cache, one per 256 byte block
+// of work RAM and one for all of ROM. RAM pages holding cached code are taken
+// out of writePage along with the page before them (for word writes crossing
+// into them) so stores go through the slow path and bump their generation.
+static const unsigned CODE_BLOCK_SHIFT = 8;
+static const uint32 CODE_RAM_START = 0x4000;
+static const uint32 CODE_RAM_END = 0x6FFF;
+static uint32 ramCodeGen[(CODE_RAM_END + 1) >> CODE_BLOCK_SHIFT];
+static uint32 romCodeGen;
+static bool codePage[(RAM_END + 1) >> PAGE_SHIFT];
+
+static void map_memory_pages(void)
+{
+	memset(readPage, 0, sizeof(readPage));
+	memset(writePage, 0, sizeof(writePage));
+	memset(codePage, 0, sizeof(codePage));
+	memory_invalidate_code(TRUE);
+
+	map_pages(readPage, RAM_START, RAM_END, ram);
+	readPage[0x8008 >> PAGE_SHIFT] = NULL; // RAS.H
+#ifdef NEOPOP_DEBUG
+	readPage[0] = NULL; // NULL pointer checks
+#endif
+	if (rom.data)
+	{
+		map_pages(readPage, ROM_START, std::min(rom.realEnd, (uint32)ROM_END), rom.data);
+		if (rom.length > 0x200000)
+			map_pages(readPage, HIROM_START, std::min(rom.realHEnd, (uint32)HIROM_END), rom.data + 0x200000);
+	}
+	map_pages(readPage, BIOS_START, BIOS_END, bios);
+
+	// first page holds the registers needing post_write()
+	map_pages(writePage, RAM_START + (1 << PAGE_SHIFT), RAM_END, ram + (1 << PAGE_SHIFT));
+}
+
+// NEOPOP_NO_PAGE_TABLE sends every access through the slow path, bench/ uses
+// it to time the page table against the plain translate_address_read/write
+static uint8 *read_page(uint32 address)
+{
+#ifdef NEOPOP_NO_PAGE_TABLE
+	return NULL;
+#endif
+	// the EEPROM status hack applies to the next non-RAM read
+	if (eepromStatusEnable)
+		return NULL;
+	uint8 *page = readPage[(address & 0xFFFFFF) >> PAGE_SHIFT];
+	return page ? page + (address & ((1 << PAGE_SHIFT) - 1)) : NULL;
+}
+
+static uint8 *write_page(uint32 address)
+{
+#ifdef NEOPOP_NO_PAGE_TABLE
+	return NULL;
+#endif
+	uint8 *page = writePage[(address & 0xFFFFFF) >> PAGE_SHIFT];
+	return page ? page + (address & ((1 << PAGE_SHIFT) - 1)) : NULL;
+}
+
+//=============================================================================
+
+const uint32 *memory_code_generation(uint32 address)
+{
+	address &= 0xFFFFFF;
+	if (address >= CODE_RAM_START && address <= CODE_RAM_END)
+		return &ramCodeGen[address >> CODE_BLOCK_SHIFT];
+	// mapped ROM & BIOS pages
+	if (address > RAM_END && readPage[address >> PAGE_SHIFT])
+		return &romCodeGen;
+	return NULL;
+}
+
+void memory_watch_code(uint32 address)
+{
+	address &= 0xFFFFFF;
+	if (address > RAM_END)
+		return;
+	uint32 page = address >> PAGE_SHIFT;
+	if (codePage[page])
+		return;
+	codePage[page] = TRUE;
+	writePage[page] = NULL;
+	if (page)
+		writePage[page - 1] = NULL;
+}
+
+void memory_invalidate_code(bool includeROM)
+{
+	for (auto &gen : ramCodeGen)
+		gen++;
+	if (includeROM)
+		romCodeGen++;
+}
+
+static void code_write(uint32 address, uint32 bytes)
+{
+	address &= 0xFFFFFF;
+	uint32 last = address + bytes - 1;
+	if (address > CODE_RAM_END || last < CODE_RAM_START)
+		return;
+	if (!codePage[address >> PAGE_SHIFT] && !codePage[last >> PAGE_SHIFT])
+		return;
+	// instructions starting in the block before can extend into this one
+	last = std::min(last, CODE_RAM_END);
+	for (uint32 block = (address >> CODE_BLOCK_SHIFT) - 1; block <= last >> CODE_BLOCK_SHIFT; block++)
+		ramCodeGen[block]++;
+}
+
+//=============================================================================
+
 static uint32 memNullVal = 0;
 
 void* translate_address_read(uint32 address)
@@ -244,7 +370,10 @@ void* translate_address_write(uint32 address)
 		if (/*rom.data &&*/ address >= ROM_START && address <= ROM_END)
 		{
 			if (address <= ROM_START + rom.length)
+			{
+				romCodeGen++;
 				return rom.data + (address - ROM_START);
+			}
 			else
 			{
 				logMsg("write 0x%X past size of low rom", address);
@@ -256,7 +385,10 @@ void* translate_address_write(uint32 address)
 		if (/*rom.data &&*/ address >= HIROM_START && address <= HIROM_END)
 		{
 			if (address <= HIROM_START + (rom.length - 0x200000))
+			{
+				romCodeGen++;
 				return rom.data + 0x200000 + (address - HIROM_START);
+			}
 			else
 			{
 				logMsg("write 0x%X past size of high rom", address);
@@ -303,6 +435,7 @@ void* translate_address_write(uint32 address)
 				if (address <= ROM_START + rom.length)
 				{
 					logMsg("write 0x%X to rom", address);
+					romCodeGen++;
 					return rom.data + (address - ROM_START);
 				}
 			}
@@ -356,6 +489,8 @@ static const bool ALIGN_ACCESS = 0;
 
 uint8 loadB(uint32 address)
 {
+	if (uint8 *page = read_page(address))
+		return *page;
 	uint8* ptr = (uint8*)translate_address_read(address);
 	/*if (ptr == NULL)
 		return 0;
@@ -365,6 +500,8 @@ uint8 loadB(uint32 address)
 
 uint16 loadW(uint32 address)
 {
+	if (uint8 *page = read_page(address))
+		return le16toh(*(uint16u*)page);
 	uint16u *ptr = (uint16u*)translate_address_read(address);
 	if((uintptr_t)ptr % 2 != 0)
 	{
@@ -385,6 +522,8 @@ uint16 loadW(uint32 address)
 
 uint32 loadL(uint32 address)
 {
+	if (uint8 *page = read_page(address))
+		return le32toh(*(uint32u*)page);
 	uint32u *ptr = (uint32u*)translate_address_read(address);
 	if((uintptr_t)ptr % 4 != 0)
 	{
@@ -408,6 +547,11 @@ uint32 loadL(uint32 address)
 
 void storeB(uint32 address, uint8 data)
 {
+	if (uint8 *page = write_page(address))
+	{
+		*page = data;
+		return;
+	}
 	uint8* ptr = (uint8*)translate_address_write(address);
 
 	//Write
@@ -415,11 +559,17 @@ void storeB(uint32 address, uint8 data)
 	{
 		*ptr = data;
 		post_write(address);
+		code_write(address, 1);
 	}
 }
 
 void storeW(uint32 address, uint16 data)
 {
+	if (uint8 *page = write_page(address))
+	{
+		*(uint16u*)page = htole16(data);
+		return;
+	}
 	uint16u *ptr = (uint16u*)translate_address_write(address);
 	if((uintptr_t)ptr % 2 != 0)
 	{
@@ -436,11 +586,17 @@ void storeW(uint32 address, uint16 data)
 	{
 
 		post_write(address);
+		code_write(address, 2);
 	}
 }
 
 void storeL(uint32 address, uint32 data)
 {
+	if (uint8 *page = write_page(address))
+	{
+		*(uint32u*)page = htole32(data);
+		return;
+	}
 	uint32u *ptr = (uint32u*)translate_address_write(address);
 	if((uintptr_t)ptr % 4 != 0)
 	{
@@ -455,6 +611,7 @@ void storeL(uint32 address, uint32 data)
 		*ptr = htole32(data);
 	{
 		post_write(address);
+		code_write(address, 4);
 	}
 }
 
@@ -609,6 +766,8 @@ void reset_memory(void)
 
 	ram[0x8400] = 0xFF;	// LED on
 	ram[0x8402] = 0x80;	// Flash cycle = 1.3s
+
+	map_memory_pages();
 }
 
 //=============================================================================
@@ -78,5 +78,15 @@ void storeB(uint32 address, uint8 data) __attribute__ ((hot));
 void storeW(uint32 address, uint16 data) __attribute__ ((hot));
 void storeL(uint32 address, uint32 data) __attribute__ ((hot));
 
+//Generation counter of the decoded instructions at address, NULL if they can't be cached
+const uint32 *memory_code_generation(uint32 address);
+
+//Bump the generation when the RAM page holding address is written
+void memory_watch_code(uint32 address);
+
+//Drop all decoded RAM instructions (and ROM ones if includeROM is set),
+//needed after writing RAM without storeB/W/L
+void memory_invalidate_code(bool includeROM);
+
 //=============================================================================
 #endif
@@ -221,6 +221,13 @@ RomHeader;
 	// false = Japanese.
 	extern bool language_english;
 
+	// Caching of decoded CPU instructions, verify mode checks
+	// each one against the interpreter's own decoding
+	#define DECODE_CACHE_OFF	0
+	#define DECODE_CACHE_ON		1
+	#define DECODE_CACHE_VERIFY	2
+	extern uint8 decode_cache_mode;
+
 /*!	Emulate a single instruction with correct TLCS900h:Z80 timing */
 
 	void emulate(void);
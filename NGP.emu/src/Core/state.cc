@@ -179,6 +179,7 @@ static bool read_state_0050(const char* filename)
 
 		//Memory
 		memcpy(ram, &state.ram, 0xC000);
+		memory_invalidate_code(FALSE);
 		system_sound_chipreset(); // reset sound chip again or sample_chip_noise() can hang
 		return TRUE;
 	}
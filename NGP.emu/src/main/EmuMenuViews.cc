@@ -30,11 +30,26 @@ class CustomSystemOptionView : public SystemOptionView
 		}
 	};
 
+	TextMenuItem decodeCacheItem[3]
+	{
+		{"Off", [](){ decode_cache_mode = DECODE_CACHE_OFF; }},
+		{"On", [](){ decode_cache_mode = DECODE_CACHE_ON; }},
+		{"On (Verify)", [](){ decode_cache_mode = DECODE_CACHE_VERIFY; }},
+	};
+
+	MultiChoiceMenuItem decodeCache
+	{
+		"Instruction Cache",
+		decode_cache_mode,
+		decodeCacheItem
+	};
+
 public:
 	CustomSystemOptionView(ViewAttachParams attach): SystemOptionView{attach, true}
 	{
 		loadStockItems();
 		item.emplace_back(&ngpLanguage);
+		item.emplace_back(&decodeCache);
 	}
 };
 
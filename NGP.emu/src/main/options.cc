@@ -19,7 +19,7 @@
 
 enum
 {
-	CFGKEY_NGPKEY_LANGUAGE = 269,
+	CFGKEY_NGPKEY_LANGUAGE = 269, CFGKEY_DECODE_CACHE = 270,
 };
 
 const char *EmuSystem::configFilename = "NgpEmu.config";
@@ -31,6 +31,8 @@ const AspectRatioInfo EmuSystem::aspectRatioInfo[] =
 const uint EmuSystem::aspectRatioInfos = std::size(EmuSystem::aspectRatioInfo);
 
 static Option<OptionMethodRef<bool, language_english>, uint8> optionNGPLanguage{CFGKEY_NGPKEY_LANGUAGE, 1};
+static Option<OptionMethodRef<uint8, decode_cache_mode>, uint8> optionDecodeCache{CFGKEY_DECODE_CACHE,
+	DECODE_CACHE_ON, false, optionIsValidWithMax<DECODE_CACHE_VERIFY>};
 
 bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 {
@@ -38,6 +40,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 	{
 		default: return 0;
 		bcase CFGKEY_NGPKEY_LANGUAGE: optionNGPLanguage.readFromIO(io, readSize);
+		bcase CFGKEY_DECODE_CACHE: optionDecodeCache.readFromIO(io, readSize);
 	}
 	return 1;
 }
@@ -45,4 +48,5 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 void EmuSystem::writeConfig(IO &io)
 {
 	optionNGPLanguage.writeWithKeyIfNotDefault(io);
+	optionDecodeCache.writeWithKeyIfNotDefault(io);
 }
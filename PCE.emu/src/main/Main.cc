@@ -246,131 +246,19 @@ void MDFND_commitVideoFrame(EmulateSpecStruct *espec)
 {
 	const auto spec = *espec;
 	int pixHeight = spec.DisplayRect.h;
-	bool uses256 = false;
-	bool uses341 = false;
-	bool uses512 = false;
-	for(int i = spec.DisplayRect.y; i < spec.DisplayRect.y + pixHeight; i++)
-	{
-		int w = spec.LineWidths[i];
-		assumeExpr(w == 256 || w == 341 || w == 512);
-		switch(w)
-		{
-			bcase 256: uses256 = true;
-			bcase 341: uses341 = true;
-			bcase 512: uses512 = true;
-		}
-	}
+	auto lineWidth = spec.LineWidths + spec.DisplayRect.y;
 	int pixWidth = 256;
-	int multiResOutputWidth = 0;
-	if(uses512)
-	{
-		pixWidth = 512;
-		if(uses341)
-		{
-			multiResOutputWidth = 1024;
-		}
-		else if(uses256)
-		{
-			multiResOutputWidth = 512;
-		}
-	}
-	else if(uses341)
+	iterateTimes(pixHeight, h)
 	{
-		pixWidth = 341;
-		if(uses256)
-		{
-			multiResOutputWidth = 1024;
-		}
+		int w = lineWidth[h];
+		assumeExpr(w == 256 || w == 341 || w == 512);
+		pixWidth = std::max(pixWidth, w);
 	}
 	IG::Pixmap srcPix = mSurfacePix.subView(
 		{spec.DisplayRect.x, spec.DisplayRect.y},
 		{pixWidth, pixHeight});
-	auto &video = *espec->video;
-	if(multiResOutputWidth)
-	{
-		auto img = video.startFrameWithFormat(espec->task, {{multiResOutputWidth, pixHeight}, pixFmt});
-		auto destPixAddr = (Pixel*)img.pixmap().pixel({0,0});
-		auto lineWidth = spec.LineWidths + spec.DisplayRect.y;
-		if(multiResOutputWidth == 1024)
-		{
-			// scale 256x4, 341x3 + 1x4, 512x2
-			iterateTimes(pixHeight, h)
-			{
-				auto srcPixAddr = (Pixel*)srcPix.pixel({0,(int)h});
-				int width = lineWidth[h];
-				switch(width)
-				{
-					bdefault:
-						bug_unreachable("width == %d", width);
-					bcase 256:
-					{
-						iterateTimes(256, w)
-						{
-							*destPixAddr++ = *srcPixAddr;
-							*destPixAddr++ = *srcPixAddr;
-							*destPixAddr++ = *srcPixAddr;
-							*destPixAddr++ = *srcPixAddr++;
-						}
-					}
-					bcase 341:
-					{
-						iterateTimes(340, w)
-						{
-							*destPixAddr++ = *srcPixAddr;
-							*destPixAddr++ = *srcPixAddr;
-							*destPixAddr++ = *srcPixAddr++;
-						}
-						*destPixAddr++ = *srcPixAddr;
-						*destPixAddr++ = *srcPixAddr;
-						*destPixAddr++ = *srcPixAddr;
-						*destPixAddr++ = *srcPixAddr++;
-					}
-					bcase 512:
-					{
-						iterateTimes(512, w)
-						{
-							*destPixAddr++ = *srcPixAddr;
-							*destPixAddr++ = *srcPixAddr++;
-						}
-					}
-				}
-				destPixAddr += img.pixmap().paddingPixels();
-			}
-		}
-		else // 512 width
-		{
-			iterateTimes(pixHeight, h)
-			{
-				auto srcPixAddr = (Pixel*)srcPix.pixel({0,(int)h});
-				int width = lineWidth[h];
-				switch(width)
-				{
-					bdefault:
-						bug_unreachable("width == %d", width);
-					bcase 256:
-					{
-						iterateTimes(256, w)
-						{
-							*destPixAddr++ = *srcPixAddr;
-							*destPixAddr++ = *srcPixAddr++;
-						}
-					}
-					bcase 512:
-					{
-						memcpy(destPixAddr, srcPixAddr, 512 * sizeof(Pixel));
-						destPixAddr += 512;
-						srcPixAddr += 512;
-					}
-				}
-				destPixAddr += img.pixmap().paddingPixels();
-			}
-		}
-		img.endFrame();
-	}
-	else
-	{
-		video.startFrameWithFormat(espec->task, srcPix);
-	}
+	// mixed resolution lines are stretched to the widest one when drawn
+	espec->video->startFrameWithLineWidths(espec->task, srcPix, lineWidth);
 }
 
 }
@@ -18,6 +18,7 @@
 #include <emuframework/EmuAppInlines.hh>
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
+#include <imagine/thread/ThreadPool.hh>
 #include "internal.hh"
 
 extern "C"
@@ -36,9 +37,11 @@ extern "C"
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2012-2020\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2012 the\nYabause Team\nyabause.org";
 bool EmuSystem::handlesGenericIO = false;
+bool EmuSystem::hasBootSnapshots = true;
 static EmuSystemTask *emuSysTask{};
 static EmuAudio *emuAudio{};
 static EmuVideo *emuVideo{};
+static uint32_t bootFrames{}, bootCDIdleFrames{};
 PerPad_struct *pad[2];
 // from sh2_dynarec.c
 #define SH2CORE_DYNAREC 2
@@ -237,6 +240,16 @@ CLINK void YuiSwapBuffers()
 	}
 }
 
+CLINK int YuiWorkerThreads()
+{
+	return IG::ThreadPool::shared().threads() + 1;
+}
+
+CLINK void YuiParallelFor(int count, void (*func)(int index, void *data), void *data)
+{
+	IG::ThreadPool::shared().parallelFor(0, count, [=](unsigned i){ func(i, data); });
+}
+
 CLINK void YuiSetVideoAttribute(int type, int val) { }
 CLINK int YuiSetVideoMode(int width, int height, int bpp, int fullscreen) { return 0; }
 
@@ -320,9 +333,39 @@ EmuSystem::Error EmuSystem::loadGame(IO &, EmuSystemCreateParams, OnLoadProgress
 	pad[1] = PerPadAdd(&PORTDATA2);
 	ScspSetFrameAccurate(1);
 
+	bootFrames = bootCDIdleFrames = 0;
+	uint64_t configHash = yinit.sh2coretype;
+	for(auto name = biosPath.data(); *name; name++)
+	{
+		configHash = configHash * 31 + *name;
+	}
+	useBootSnapshot(configHash);
 	return {};
 }
 
+static bool cdIsIdle()
+{
+	static constexpr uint8_t CDB_STAT_PAUSE = 0x01, CDB_STAT_STANDBY = 0x02;
+	auto status = Cs2Area->status & 0xF;
+	return status == CDB_STAT_PAUSE || status == CDB_STAT_STANDBY;
+}
+
+static void updateBootReady(EmuSystemTask *task)
+{
+	// treat the game as booted once the BIOS intro has passed and the
+	// CD drive has stopped reading for a couple of seconds
+	static constexpr uint32_t MIN_BOOT_FRAMES = 60 * 10, CD_IDLE_FRAMES = 120;
+	if(!task || bootFrames == UINT32_MAX)
+		return;
+	bootFrames++;
+	bootCDIdleFrames = cdIsIdle() ? bootCDIdleFrames + 1 : 0;
+	if(bootFrames >= MIN_BOOT_FRAMES && bootCDIdleFrames >= CD_IDLE_FRAMES)
+	{
+		bootFrames = UINT32_MAX;
+		EmuSystem::markBootReady(task);
+	}
+}
+
 void EmuSystem::configAudioRate(IG::FloatSeconds frameTime, uint32_t rate)
 {
 	// TODO: use frameTime
@@ -336,6 +379,7 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	SNDImagine.UpdateAudio = audio ? SNDImagineUpdateAudio : SNDImagineUpdateAudioNull;
 	YabauseEmulate();
 	emuAudio = {};
+	updateBootReady(task);
 }
 
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
@@ -165,6 +165,81 @@ static int resyratio;
 
 typedef struct { s16 x; s16 y; } vdp1vertex;
 
+typedef struct _COLOR_PARAMS
+{
+	double r,g,b;
+} COLOR_PARAMS;
+
+typedef union _COLOR { // xbgr x555
+	struct {
+#ifdef WORDS_BIGENDIAN
+	u16 x:1;
+	u16 b:5;
+	u16 g:5;
+	u16 r:5;
+#else
+     u16 r:5;
+     u16 g:5;
+     u16 b:5;
+     u16 x:1;
+#endif
+	};
+	u16 value;
+} COLOR;
+
+// Drawing commands are recorded while Vdp1Draw() walks the command table, with
+// the local coordinates, clipping and gouraud table they were issued with, and
+// rasterized by VIDSoftVdp1DrawEnd(). The framebuffer is split into bands of
+// rows that are drawn in parallel, every band walks the whole list in order
+// but only writes the pixels stored in its rows, so each pixel goes through the
+// same writes in the same order as when drawing the list serially.
+
+#define VDP1_MAX_DRAW_COMMANDS 2000
+#define VDP1_MAX_BANDS 16
+
+enum { VDP1DRAW_QUAD, VDP1DRAW_POLYLINE, VDP1DRAW_LINE };
+
+typedef struct
+{
+	vdp1cmd_struct cmd;
+	int type;
+	// vertices with the local coordinates applied
+	int x[4];
+	int y[4];
+	int clipxstart;
+	int clipxend;
+	int clipystart;
+	int clipyend;
+	// a quad's corner colors, or each line segment's end colors
+	COLOR gouraud[8];
+} vdp1drawcmd_struct;
+
+typedef struct
+{
+	const vdp1drawcmd_struct *drawcmd;
+	const vdp1cmd_struct *cmd;
+	// framebuffer pixel offsets written by this band
+	int pixelstart;
+	int pixelend;
+	// the current command can end a line early on an endcode
+	int endcodes;
+	COLOR_PARAMS leftColumnColor;
+	int currentPixel;
+	int currentPixelIsVisible;
+	int characterWidth;
+	int characterHeight;
+	int xleft[1000];
+	int yleft[1000];
+	int xright[1000];
+	int yright[1000];
+} vdp1band_struct;
+
+static vdp1drawcmd_struct vdp1drawlist[VDP1_MAX_DRAW_COMMANDS];
+static int vdp1drawlistsize;
+// set when a command reuses the pixel fetched by the command drawn before it
+static int vdp1drawserial;
+static vdp1band_struct vdp1bands[VDP1_MAX_BANDS];
+
 typedef struct
 {
    int pagepixelwh, pagepixelwh_bits, pagepixelwh_mask;
@@ -1829,12 +1904,40 @@ void VIDSoftVdp1DrawStart(void)
    vdp1clipystart = Vdp1Regs->userclipY1 = Vdp1Regs->systemclipY1 = 0;
    vdp1clipxend = Vdp1Regs->userclipX2 = Vdp1Regs->systemclipX2 = vdp1width;
    vdp1clipyend = Vdp1Regs->userclipY2 = Vdp1Regs->systemclipY2 = vdp1height;
+
+   vdp1drawlistsize = 0;
+   vdp1drawserial = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
+static void drawBand(int index, void *data);
+
 void VIDSoftVdp1DrawEnd(void)
 {
+   int bands, i;
+
+   if (vdp1drawlistsize == 0)
+      return;
+
+   // a couple of bands per thread evens out the rows that draw more
+   bands = vdp1drawserial ? 1 : YuiWorkerThreads() * 2;
+   if (bands > VDP1_MAX_BANDS)
+      bands = VDP1_MAX_BANDS;
+
+   // the first and last bands also take any offsets outside the framebuffer
+   for (i = 0; i < bands; i++)
+   {
+      vdp1bands[i].pixelstart = i == 0 ? INT_MIN : (vdp1height * i / bands) * vdp1width;
+      vdp1bands[i].pixelend = i == bands - 1 ? INT_MAX : (vdp1height * (i + 1) / bands) * vdp1width;
+   }
+
+   if (bands == 1)
+      drawBand(0, NULL);
+   else
+      YuiParallelFor(bands, drawBand, NULL);
+
+   vdp1drawlistsize = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1883,22 +1986,9 @@ static INLINE u32 alphablend16(u32 d, u32 s, u32 level)
 	return r|g|b;
 }
 
-typedef struct _COLOR_PARAMS
-{
-	double r,g,b;
-} COLOR_PARAMS;
-
-COLOR_PARAMS leftColumnColor;
-
-vdp1cmd_struct cmd;
-
-int currentPixel;
-int currentPixelIsVisible;
-int characterWidth;
-int characterHeight;
-
-static int getpixel(int linenumber, int currentlineindex) {
+static int getpixel(vdp1band_struct *band, int linenumber, int currentlineindex) {
 	
+	const vdp1cmd_struct *cmd = band->cmd;
 	u32 characterAddress;
 	u32 colorlut;
 	u16 colorbank;
@@ -1907,59 +1997,59 @@ static int getpixel(int linenumber, int currentlineindex) {
 	int endcodesEnabled;
 	int untexturedColor = 0;
 	int isTextured = 1;
-	int currentShape = cmd.CMDCTRL & 0x7;
+	int currentShape = cmd->CMDCTRL & 0x7;
 	int flip;
 
-	characterAddress = cmd.CMDSRCA << 3;
-	colorbank = cmd.CMDCOLR;
+	characterAddress = cmd->CMDSRCA << 3;
+	colorbank = cmd->CMDCOLR;
 	colorlut = (u32)colorbank << 3;
-	SPD = ((cmd.CMDPMOD & 0x40) != 0);//show the actual color of transparent pixels if 1 (they won't be drawn transparent)
-	endcodesEnabled = (( cmd.CMDPMOD & 0x80) == 0 )?1:0;
-	flip = (cmd.CMDCTRL & 0x30) >> 4;
+	SPD = ((cmd->CMDPMOD & 0x40) != 0);//show the actual color of transparent pixels if 1 (they won't be drawn transparent)
+	endcodesEnabled = (( cmd->CMDPMOD & 0x80) == 0 )?1:0;
+	flip = (cmd->CMDCTRL & 0x30) >> 4;
 
 	//4 polygon, 5 polyline or 6 line
 	if(currentShape == 4 || currentShape == 5 || currentShape == 6) {
 		isTextured = 0;
-		untexturedColor = cmd.CMDCOLR;
+		untexturedColor = cmd->CMDCOLR;
 	}
 
 	switch( flip ) {
 		case 1:
 			// Horizontal flipping
-			currentlineindex = characterWidth - currentlineindex-1;
+			currentlineindex = band->characterWidth - currentlineindex-1;
 			break;
 		case 2:
 			// Vertical flipping
-			linenumber = characterHeight - linenumber-1;
+			linenumber = band->characterHeight - linenumber-1;
 
 			break;
 		case 3:
 			// Horizontal/Vertical flipping
-			linenumber = characterHeight - linenumber-1;
-			currentlineindex = characterWidth - currentlineindex-1;
+			linenumber = band->characterHeight - linenumber-1;
+			currentlineindex = band->characterWidth - currentlineindex-1;
 			break;
 	}
 
-	switch ((cmd.CMDPMOD >> 3) & 0x7)
+	switch ((cmd->CMDPMOD >> 3) & 0x7)
 	{
 		case 0x0: //4bpp bank
 			endcode = 0xf;
-			currentPixel = Vdp1ReadPattern16( characterAddress + (linenumber*(characterWidth>>1)), currentlineindex );
-			if(isTextured && endcodesEnabled && currentPixel == endcode)
+			band->currentPixel = Vdp1ReadPattern16( characterAddress + (linenumber*(band->characterWidth>>1)), currentlineindex );
+			if(isTextured && endcodesEnabled && band->currentPixel == endcode)
 				return 1;
-			if (!((currentPixel == 0) && !SPD)) 
-				currentPixel = colorbank | currentPixel;
-			currentPixelIsVisible = 0xf;
+			if (!((band->currentPixel == 0) && !SPD)) 
+				band->currentPixel = colorbank | band->currentPixel;
+			band->currentPixelIsVisible = 0xf;
 			break;
 
 		case 0x1://4bpp lut
 			endcode = 0xf;
-			currentPixel = Vdp1ReadPattern16( characterAddress + (linenumber*(characterWidth>>1)), currentlineindex );
-			if(isTextured && endcodesEnabled && currentPixel == endcode)
+			band->currentPixel = Vdp1ReadPattern16( characterAddress + (linenumber*(band->characterWidth>>1)), currentlineindex );
+			if(isTextured && endcodesEnabled && band->currentPixel == endcode)
 				return 1;
-			if (!(currentPixel == 0 && !SPD))
-				currentPixel = T1ReadWord(Vdp1Ram, (currentPixel * 2 + colorlut) & 0x7FFFF);
-			currentPixelIsVisible = 0xffff;
+			if (!(band->currentPixel == 0 && !SPD))
+				band->currentPixel = T1ReadWord(Vdp1Ram, (band->currentPixel * 2 + colorlut) & 0x7FFFF);
+			band->currentPixelIsVisible = 0xffff;
 			break;
 		case 0x2://8pp bank (64 color)
 			//is there a hardware bug with endcodes in this color mode?
@@ -1970,53 +2060,53 @@ static int getpixel(int linenumber, int currentlineindex) {
 			//this needs more hardware testing
 
 			endcode = 63;
-			currentPixel = Vdp1ReadPattern64( characterAddress + (linenumber*(characterWidth)), currentlineindex );
-			if(isTextured && endcodesEnabled && currentPixel == endcode)
-				currentPixel = 0;
+			band->currentPixel = Vdp1ReadPattern64( characterAddress + (linenumber*(band->characterWidth)), currentlineindex );
+			if(isTextured && endcodesEnabled && band->currentPixel == endcode)
+				band->currentPixel = 0;
 		//		return 1;
-			if (!((currentPixel == 0) && !SPD)) 
-				currentPixel = colorbank | currentPixel;
-			currentPixelIsVisible = 0x3f;
+			if (!((band->currentPixel == 0) && !SPD)) 
+				band->currentPixel = colorbank | band->currentPixel;
+			band->currentPixelIsVisible = 0x3f;
 			break;
 		case 0x3://128 color
 			endcode = 0xff;
-			currentPixel = Vdp1ReadPattern128( characterAddress + (linenumber*characterWidth), currentlineindex );
-			if(isTextured && endcodesEnabled && currentPixel == endcode)
+			band->currentPixel = Vdp1ReadPattern128( characterAddress + (linenumber*band->characterWidth), currentlineindex );
+			if(isTextured && endcodesEnabled && band->currentPixel == endcode)
 				return 1;
-			if (!((currentPixel == 0) && !SPD)) 
-				currentPixel = colorbank | currentPixel;
-			currentPixelIsVisible = 0x7f;
+			if (!((band->currentPixel == 0) && !SPD)) 
+				band->currentPixel = colorbank | band->currentPixel;
+			band->currentPixelIsVisible = 0x7f;
 			break;
 		case 0x4://256 color
 			endcode = 0xff;
-			currentPixel = Vdp1ReadPattern256( characterAddress + (linenumber*characterWidth), currentlineindex );
-			if(isTextured && endcodesEnabled && currentPixel == endcode)
+			band->currentPixel = Vdp1ReadPattern256( characterAddress + (linenumber*band->characterWidth), currentlineindex );
+			if(isTextured && endcodesEnabled && band->currentPixel == endcode)
 				return 1;
-			currentPixelIsVisible = 0xff;
-			if (!((currentPixel == 0) && !SPD)) 
-				currentPixel = colorbank | currentPixel;
+			band->currentPixelIsVisible = 0xff;
+			if (!((band->currentPixel == 0) && !SPD)) 
+				band->currentPixel = colorbank | band->currentPixel;
 			break;
 		case 0x5://16bpp bank
 			endcode = 0x7fff;
-			currentPixel = Vdp1ReadPattern64k( characterAddress + (linenumber*characterWidth*2), currentlineindex );
-			if(isTextured && endcodesEnabled && currentPixel == endcode)
+			band->currentPixel = Vdp1ReadPattern64k( characterAddress + (linenumber*band->characterWidth*2), currentlineindex );
+			if(isTextured && endcodesEnabled && band->currentPixel == endcode)
 				return 1;
 
 			/* the transparent pixel in 16bpp is supposed to be 0x0000
 			but some games use pixels with invalid values and expect
 			them to be transparent (see vdp1 doc p. 92) */
-			if (!(currentPixel & 0x8000) && !SPD)
-				currentPixel = 0;
+			if (!(band->currentPixel & 0x8000) && !SPD)
+				band->currentPixel = 0;
 
-			currentPixelIsVisible = 0xffff;
+			band->currentPixelIsVisible = 0xffff;
 			break;
 	}
 
 	if(!isTextured)
-		currentPixel = untexturedColor;
+		band->currentPixel = untexturedColor;
 
 	//force the MSB to be on if MSBON is set
-	//currentPixel |= cmd.CMDPMOD & (1 << 15);
+	//band->currentPixel |= cmd->CMDPMOD & (1 << 15);
 
 	return 0;
 }
@@ -2031,56 +2121,51 @@ static int gouraudAdjust( int color, int tableValue )
 	return color;
 }
 
-static void putpixel8(int x, int y) {
+static void putpixel8(vdp1band_struct *band, int x, int y) {
 
+    const vdp1cmd_struct *cmd = band->cmd;
+    const vdp1drawcmd_struct *drawcmd = band->drawcmd;
     int x2 = x / 2;
     int y2 = y / vdp1interlace;
     u8 * iPix = &vdp1backframebuffer[(y2 * vdp1width) + x2];
-    int mesh = cmd.CMDPMOD & 0x0100;
-    int SPD = ((cmd.CMDPMOD & 0x40) != 0);//show the actual color of transparent pixels if 1 (they won't be drawn transparent)
+    int mesh = cmd->CMDPMOD & 0x0100;
+    int SPD = ((cmd->CMDPMOD & 0x40) != 0);//show the actual color of transparent pixels if 1 (they won't be drawn transparent)
 
     if (iPix >= (vdp1backframebuffer + 0x40000))
         return;
 
-    currentPixel &= 0xFF;
+    band->currentPixel &= 0xFF;
 
     if(mesh && ((x2 ^ y2) & 1)) {
         return;
     }
 
-    {
-        int clipped;
-
-        if (cmd.CMDPMOD & 0x0400) PushUserClipping((cmd.CMDPMOD >> 9) & 0x1);
-
-        clipped = ! (x2 >= vdp1clipxstart &&
-            x2 < vdp1clipxend &&
-            y2 >= vdp1clipystart &&
-            y2 < vdp1clipyend);
-
-        if (cmd.CMDPMOD & 0x0400) PopUserClipping();
-
-        if (clipped) return;
-    }
+    if (! (x2 >= drawcmd->clipxstart &&
+        x2 < drawcmd->clipxend &&
+        y2 >= drawcmd->clipystart &&
+        y2 < drawcmd->clipyend))
+        return;
 
-    if ( SPD || (currentPixel & currentPixelIsVisible))
+    if ( SPD || (band->currentPixel & band->currentPixelIsVisible))
     {
-        switch( cmd.CMDPMOD & 0x7 )//we want bits 0,1,2
+        switch( cmd->CMDPMOD & 0x7 )//we want bits 0,1,2
         {
         default:
         case 0:	// replace
-            if (!((currentPixel == 0) && !SPD))
-                *(iPix) = currentPixel;
+            if (!((band->currentPixel == 0) && !SPD))
+                *(iPix) = band->currentPixel;
             break;
         }
     }
 }
 
-static void putpixel(int x, int y) {
+static void putpixel(vdp1band_struct *band, int x, int y) {
 
+	const vdp1cmd_struct *cmd = band->cmd;
+	const vdp1drawcmd_struct *drawcmd = band->drawcmd;
 	u16* iPix;
-	int mesh = cmd.CMDPMOD & 0x0100;
-	int SPD = ((cmd.CMDPMOD & 0x40) != 0);//show the actual color of transparent pixels if 1 (they won't be drawn transparent)
+	int mesh = cmd->CMDPMOD & 0x0100;
+	int SPD = ((cmd->CMDPMOD & 0x40) != 0);//show the actual color of transparent pixels if 1 (they won't be drawn transparent)
 
 	y /= vdp1interlace;
 	iPix = &((u16 *)vdp1backframebuffer)[(y * vdp1width) + x];
@@ -2091,49 +2176,40 @@ static void putpixel(int x, int y) {
 	if(mesh && (x^y)&1)
 		return;
 
-	{
-		int clipped;
-
-		if (cmd.CMDPMOD & 0x0400) PushUserClipping((cmd.CMDPMOD >> 9) & 0x1);
-
-		clipped = ! (x >= vdp1clipxstart &&
-			x < vdp1clipxend &&
-			y >= vdp1clipystart &&
-			y < vdp1clipyend);
-
-		if (cmd.CMDPMOD & 0x0400) PopUserClipping();
-
-		if (clipped) return;
-	}
+	if (! (x >= drawcmd->clipxstart &&
+		x < drawcmd->clipxend &&
+		y >= drawcmd->clipystart &&
+		y < drawcmd->clipyend))
+		return;
 
-	if ((cmd.CMDPMOD & (1 << 15)) && ((Vdp2Regs->SPCTL & 0x10) == 0))
+	if ((cmd->CMDPMOD & (1 << 15)) && ((Vdp2Regs->SPCTL & 0x10) == 0))
 	{
-		if (currentPixel) {
+		if (band->currentPixel) {
 			*iPix |= 0x8000;
 			return;
 		}
 	}
 
-	if ( SPD || (currentPixel & currentPixelIsVisible))
+	if ( SPD || (band->currentPixel & band->currentPixelIsVisible))
 	{
-		switch( cmd.CMDPMOD & 0x7 )//we want bits 0,1,2
+		switch( cmd->CMDPMOD & 0x7 )//we want bits 0,1,2
 		{
 		case 0:	// replace
-			if (!((currentPixel == 0) && !SPD)) 
-				*(iPix) = currentPixel;
+			if (!((band->currentPixel == 0) && !SPD)) 
+				*(iPix) = band->currentPixel;
 			break;
 		case 1: // shadow
 			if (*(iPix) & (1 << 15)) // only if MSB of framebuffer data is set
 				*(iPix) = alphablend16(*(iPix), 0, (1 << 7)) | (1 << 15);
 			break;
 		case 2: // half luminance
-			*(iPix) = ((currentPixel & ~0x8421) >> 1) | (1 << 15);
+			*(iPix) = ((band->currentPixel & ~0x8421) >> 1) | (1 << 15);
 			break;
 		case 3: // half transparent
 			if ( *(iPix) & (1 << 15) )//only if MSB of framebuffer data is set 
-				*(iPix) = alphablend16( *(iPix), currentPixel, (1 << 7) ) | (1 << 15);
+				*(iPix) = alphablend16( *(iPix), band->currentPixel, (1 << 7) ) | (1 << 15);
 			else
-				*(iPix) = currentPixel;
+				*(iPix) = band->currentPixel;
 			break;
 		case 4: //gouraud
 			#define COLOR(r,g,b)    (((r)&0x1F)|(((g)&0x1F)<<5)|(((b)&0x1F)<<10) |0x8000 )
@@ -2141,33 +2217,33 @@ static void putpixel(int x, int y) {
 			//handle the special case demonstrated in the sgl chrome demo
 			//if we are in a paletted bank mode and the other two colors are unused, adjust the index value instead of rgb
 			if(
-				(((cmd.CMDPMOD >> 3) & 0x7) != 5) &&
-				(((cmd.CMDPMOD >> 3) & 0x7) != 1) && 
-				(int)leftColumnColor.g == 16 && 
-				(int)leftColumnColor.b == 16) 
+				(((cmd->CMDPMOD >> 3) & 0x7) != 5) &&
+				(((cmd->CMDPMOD >> 3) & 0x7) != 1) && 
+				(int)band->leftColumnColor.g == 16 && 
+				(int)band->leftColumnColor.b == 16) 
 			{
-				int c = (int)(leftColumnColor.r-0x10);
+				int c = (int)(band->leftColumnColor.r-0x10);
 				if(c < 0) c = 0;
-				currentPixel = currentPixel+c;
-				*(iPix) = currentPixel;
+				band->currentPixel = band->currentPixel+c;
+				*(iPix) = band->currentPixel;
 				break;
 			}
 			*(iPix) = COLOR(
 				gouraudAdjust(
-				currentPixel&0x001F,
-				(int)leftColumnColor.r),
+				band->currentPixel&0x001F,
+				(int)band->leftColumnColor.r),
 
 				gouraudAdjust(
-				(currentPixel&0x03e0) >> 5,
-				(int)leftColumnColor.g),
+				(band->currentPixel&0x03e0) >> 5,
+				(int)band->leftColumnColor.g),
 
 				gouraudAdjust(
-				(currentPixel&0x7c00) >> 10,
-				(int)leftColumnColor.b)
+				(band->currentPixel&0x7c00) >> 10,
+				(int)band->leftColumnColor.b)
 				);
 			break;
 		default:
-			*(iPix) = alphablend16( COLOR((int)leftColumnColor.r,(int)leftColumnColor.g, (int)leftColumnColor.b), currentPixel, (1 << 7) ) | (1 << 15);
+			*(iPix) = alphablend16( COLOR((int)band->leftColumnColor.r,(int)band->leftColumnColor.g, (int)band->leftColumnColor.b), band->currentPixel, (1 << 7) ) | (1 << 15);
 			break;
 		}
 	}
@@ -2256,6 +2332,7 @@ static int iterateOverLine(int x1, int y1, int x2, int y2, int greedy, void *dat
 }
 
 typedef struct {
+	vdp1band_struct *band;
 	double linenumber;
 	double texturestep;
 	double xredstep;
@@ -2265,25 +2342,55 @@ typedef struct {
 	int previousStep;
 } DrawLineData;
 
+// framebuffer offset of the pixel drawn at x,y
+static INLINE int Vdp1PixelOffset(int x, int y)
+{
+	if (vdp1pixelsize == 1)
+		x /= 2;
+	return (y / vdp1interlace) * vdp1width + x;
+}
+
+static INLINE int PixelInBand(const vdp1band_struct *band, int x, int y)
+{
+	int offset = Vdp1PixelOffset(x, y);
+	return offset >= band->pixelstart && offset < band->pixelend;
+}
+
+// iterateOverLine() stays within the box of the line's end points
+static INLINE int LineInBand(const vdp1band_struct *band, int x1, int y1, int x2, int y2)
+{
+	int first = Vdp1PixelOffset(x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2);
+	int last = Vdp1PixelOffset(x1 > x2 ? x1 : x2, y1 > y2 ? y1 : y2);
+	return last >= band->pixelstart && first < band->pixelend;
+}
+
 static int DrawLineCallback(int x, int y, int i, void *data)
 {
 	int currentStep;
+	int inband;
 	DrawLineData *linedata = data;
+	vdp1band_struct *band = linedata->band;
 
-	leftColumnColor.r += linedata->xredstep;
-	leftColumnColor.g += linedata->xgreenstep;
-	leftColumnColor.b += linedata->xbluestep;
+	band->leftColumnColor.r += linedata->xredstep;
+	band->leftColumnColor.g += linedata->xgreenstep;
+	band->leftColumnColor.b += linedata->xbluestep;
 
 	currentStep = (int)i * linedata->texturestep;
-	if (getpixel(linedata->linenumber, currentStep)) {
+	inband = PixelInBand(band, x, y);
+	// another band's pixels are only fetched to find the endcodes ending the line
+	if (!inband && !band->endcodes)
+		return 0;
+	if (getpixel(band, linedata->linenumber, currentStep)) {
 		if (currentStep != linedata->previousStep) {
 			linedata->previousStep = currentStep;
 			linedata->endcodesdetected ++;
 		}
+	} else if (!inband) {
+		return 0;
 	} else if (vdp1pixelsize == 2) {
-		putpixel(x, y);
+		putpixel(band, x, y);
 	} else {
-		putpixel8(x, y);
+		putpixel8(band, x, y);
     }
 
 	if (linedata->endcodesdetected == 2) return -1;
@@ -2291,10 +2398,14 @@ static int DrawLineCallback(int x, int y, int i, void *data)
 	return 0;
 }
 
-static int DrawLine( int x1, int y1, int x2, int y2, int greedy, double linenumber, double texturestep, double xredstep, double xgreenstep, double xbluestep)
+static int DrawLine(vdp1band_struct *band, int x1, int y1, int x2, int y2, int greedy, double linenumber, double texturestep, double xredstep, double xgreenstep, double xbluestep)
 {
 	DrawLineData data;
 
+	if (!LineInBand(band, x1, y1, x2, y2))
+		return 0;
+
+	data.band = band;
 	data.linenumber = linenumber;
 	data.texturestep = texturestep;
 	data.xredstep = xredstep;
@@ -2318,48 +2429,6 @@ static INLINE double interpolate(double start, double end, int numberofsteps) {
 	return stepvalue;
 }
 
-typedef union _COLOR { // xbgr x555
-	struct {
-#ifdef WORDS_BIGENDIAN
-	u16 x:1;
-	u16 b:5;
-	u16 g:5;
-	u16 r:5;
-#else
-     u16 r:5;
-     u16 g:5;
-     u16 b:5;
-     u16 x:1;
-#endif
-	};
-	u16 value;
-} COLOR;
-
-
-COLOR gouraudA;
-COLOR gouraudB;
-COLOR gouraudC;
-COLOR gouraudD;
-
-static void gouraudTable(void)
-{
-	int gouraudTableAddress;
-
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
-
-	gouraudTableAddress = (((unsigned int)cmd.CMDGRDA) << 3);
-
-	gouraudA.value = T1ReadWord(Vdp1Ram,gouraudTableAddress);
-	gouraudB.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+2);
-	gouraudC.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+4);
-	gouraudD.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+6);
-}
-
-int xleft[1000];
-int yleft[1000];
-int xright[1000];
-int yright[1000];
-
 static int
 storeLineCoords(int x, int y, int i, void *arrays) {
 	int **intArrays = arrays;
@@ -2374,13 +2443,14 @@ storeLineCoords(int x, int y, int i, void *arrays) {
 //this is why endcodes are possible
 //this is also the reason why half-transparent shading causes moire patterns
 //and the reason why gouraud shading can be applied to a single line draw command
-static void drawQuad(s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y, s16 br_x, s16 br_y){
+static void drawQuad(vdp1band_struct *band, s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y, s16 br_x, s16 br_y){
 
 	int totalleft;
 	int totalright;
 	int total;
 	int i;
 	int *intarrays[2];
+	const vdp1cmd_struct *cmd = band->cmd;
 
 	COLOR_PARAMS topLeftToBottomLeftColorStep = {0,0,0}, topRightToBottomRightColorStep = {0,0,0};
 		
@@ -2389,15 +2459,14 @@ static void drawQuad(s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y,
 	double rightLineStep = 1; 
 
 	//a lookup table for the gouraud colors
-	COLOR colors[4];
+	const COLOR *colors = band->drawcmd->gouraud;
 
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
-	characterWidth = ((cmd.CMDSIZE >> 8) & 0x3F) * 8;
-	characterHeight = cmd.CMDSIZE & 0xFF;
+	band->characterWidth = ((cmd->CMDSIZE >> 8) & 0x3F) * 8;
+	band->characterHeight = cmd->CMDSIZE & 0xFF;
 
-	intarrays[0] = xleft; intarrays[1] = yleft;
+	intarrays[0] = band->xleft; intarrays[1] = band->yleft;
 	totalleft  = iterateOverLine(tl_x, tl_y, bl_x, bl_y, 0, intarrays, storeLineCoords);
-	intarrays[0] = xright; intarrays[1] = yright;
+	intarrays[0] = band->xright; intarrays[1] = band->yright;
 	totalright  = iterateOverLine(tr_x, tr_y, br_x, br_y, 0, intarrays, storeLineCoords);
 
 	//just for now since burning rangers will freeze up trying to draw huge shapes
@@ -2407,11 +2476,8 @@ static void drawQuad(s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y,
 	total = totalleft > totalright ? totalleft : totalright;
 
 
-	if(cmd.CMDPMOD & (1 << 2)) {
-
-		gouraudTable();
+	if(cmd->CMDPMOD & (1 << 2)) {
 
-		{ colors[0] = gouraudA; colors[1] = gouraudD; colors[2] = gouraudB; colors[3] = gouraudC; }
 
 		topLeftToBottomLeftColorStep.r = interpolate(colors[0].r,colors[1].r,total);
 		topLeftToBottomLeftColorStep.g = interpolate(colors[0].g,colors[1].g,total);
@@ -2446,46 +2512,54 @@ static void drawQuad(s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y,
 
 		COLOR_PARAMS leftToRightStep = {0,0,0};
 
+		if(!LineInBand(band,
+			band->xleft[(int)(i*leftLineStep)],
+			band->yleft[(int)(i*leftLineStep)],
+			band->xright[(int)(i*rightLineStep)],
+			band->yright[(int)(i*rightLineStep)]))
+			continue;
+
 		//get the length of the line we are about to draw
 		xlinelength = iterateOverLine(
-			xleft[(int)(i*leftLineStep)],
-			yleft[(int)(i*leftLineStep)],
-			xright[(int)(i*rightLineStep)],
-			yright[(int)(i*rightLineStep)],
+			band->xleft[(int)(i*leftLineStep)],
+			band->yleft[(int)(i*leftLineStep)],
+			band->xright[(int)(i*rightLineStep)],
+			band->yright[(int)(i*rightLineStep)],
 			1, NULL, NULL);
 
 		//so from 0 to the width of the texture / the length of the line is how far we need to step
-		xtexturestep=interpolate(0,characterWidth,xlinelength);
+		xtexturestep=interpolate(0,band->characterWidth,xlinelength);
 
 		//now we need to interpolate the y texture coordinate across multiple lines
-		ytexturestep=interpolate(0,characterHeight,total);
+		ytexturestep=interpolate(0,band->characterHeight,total);
 
 		//gouraud interpolation
-		if(cmd.CMDPMOD & (1 << 2)) {
+		if(cmd->CMDPMOD & (1 << 2)) {
 
 			//for each new line we need to step once more through each column
 			//and add the orignal color + the number of steps taken times the step value to the bottom of the shape
 			//to get the current colors to use to interpolate across the line
 
-			leftColumnColor.r = colors[0].r +(topLeftToBottomLeftColorStep.r*i);
-			leftColumnColor.g = colors[0].g +(topLeftToBottomLeftColorStep.g*i);
-			leftColumnColor.b = colors[0].b +(topLeftToBottomLeftColorStep.b*i);
+			band->leftColumnColor.r = colors[0].r +(topLeftToBottomLeftColorStep.r*i);
+			band->leftColumnColor.g = colors[0].g +(topLeftToBottomLeftColorStep.g*i);
+			band->leftColumnColor.b = colors[0].b +(topLeftToBottomLeftColorStep.b*i);
 
 			rightColumnColor.r = colors[2].r +(topRightToBottomRightColorStep.r*i);
 			rightColumnColor.g = colors[2].g +(topRightToBottomRightColorStep.g*i);
 			rightColumnColor.b = colors[2].b +(topRightToBottomRightColorStep.b*i);
 
 			//interpolate colors across to get the right step values
-			leftToRightStep.r = interpolate(leftColumnColor.r,rightColumnColor.r,xlinelength);
-			leftToRightStep.g = interpolate(leftColumnColor.g,rightColumnColor.g,xlinelength);
-			leftToRightStep.b = interpolate(leftColumnColor.b,rightColumnColor.b,xlinelength);
+			leftToRightStep.r = interpolate(band->leftColumnColor.r,rightColumnColor.r,xlinelength);
+			leftToRightStep.g = interpolate(band->leftColumnColor.g,rightColumnColor.g,xlinelength);
+			leftToRightStep.b = interpolate(band->leftColumnColor.b,rightColumnColor.b,xlinelength);
 		}
 
 		DrawLine(
-			xleft[(int)(i*leftLineStep)],
-			yleft[(int)(i*leftLineStep)],
-			xright[(int)(i*rightLineStep)],
-			yright[(int)(i*rightLineStep)],
+			band,
+			band->xleft[(int)(i*leftLineStep)],
+			band->yleft[(int)(i*leftLineStep)],
+			band->xright[(int)(i*rightLineStep)],
+			band->yright[(int)(i*rightLineStep)],
 			1,
 			ytexturestep*i, 
 			xtexturestep,
@@ -2496,8 +2570,82 @@ static void drawQuad(s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y,
 	}
 }
 
+COLOR gouraudA;
+COLOR gouraudB;
+COLOR gouraudC;
+COLOR gouraudD;
+
+static void gouraudTable(const vdp1cmd_struct *cmd)
+{
+	int gouraudTableAddress;
+
+	gouraudTableAddress = (((unsigned int)cmd->CMDGRDA) << 3);
+
+	gouraudA.value = T1ReadWord(Vdp1Ram,gouraudTableAddress);
+	gouraudB.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+2);
+	gouraudC.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+4);
+	gouraudD.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+6);
+}
+
+static vdp1drawcmd_struct *Vdp1RecordCommand(const vdp1cmd_struct *cmd, int type)
+{
+	vdp1drawcmd_struct *drawcmd;
+
+	if (vdp1drawlistsize == VDP1_MAX_DRAW_COMMANDS)
+		return NULL;
+
+	drawcmd = &vdp1drawlist[vdp1drawlistsize++];
+	drawcmd->cmd = *cmd;
+	drawcmd->type = type;
+
+	if (cmd->CMDPMOD & 0x0400) PushUserClipping((cmd->CMDPMOD >> 9) & 0x1);
+
+	drawcmd->clipxstart = vdp1clipxstart;
+	drawcmd->clipxend = vdp1clipxend;
+	drawcmd->clipystart = vdp1clipystart;
+	drawcmd->clipyend = vdp1clipyend;
+
+	if (cmd->CMDPMOD & 0x0400) PopUserClipping();
+
+	//the invalid color modes don't fetch a pixel and draw the one left by the previous command
+	if (((cmd->CMDPMOD >> 3) & 0x7) > 5)
+		vdp1drawserial = 1;
+
+	return drawcmd;
+}
+
+static INLINE int lineTooLong(int x1, int y1, int x2, int y2)
+{
+	return abs(x2 - x1) > 999 || abs(y2 - y1) > 999;
+}
+
+static void recordQuad(const vdp1cmd_struct *cmd, s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y, s16 br_x, s16 br_y){
+
+	vdp1drawcmd_struct *drawcmd = Vdp1RecordCommand(cmd, VDP1DRAW_QUAD);
+
+	if (!drawcmd)
+		return;
+
+	drawcmd->x[0] = tl_x; drawcmd->y[0] = tl_y;
+	drawcmd->x[1] = bl_x; drawcmd->y[1] = bl_y;
+	drawcmd->x[2] = tr_x; drawcmd->y[2] = tr_y;
+	drawcmd->x[3] = br_x; drawcmd->y[3] = br_y;
+
+	//drawQuad() skips the gouraud table of the shapes it doesn't draw
+	if(lineTooLong(tl_x, tl_y, bl_x, bl_y) || lineTooLong(tr_x, tr_y, br_x, br_y))
+		return;
+
+	if(cmd->CMDPMOD & (1 << 2)) {
+
+		gouraudTable(cmd);
+
+		{ drawcmd->gouraud[0] = gouraudA; drawcmd->gouraud[1] = gouraudD; drawcmd->gouraud[2] = gouraudB; drawcmd->gouraud[3] = gouraudC; }
+	}
+}
+
 void VIDSoftVdp1NormalSpriteDraw() {
 
+	vdp1cmd_struct cmd;
 	s16 topLeftx,topLefty,topRightx,topRighty,bottomRightx,bottomRighty,bottomLeftx,bottomLefty;
 	int spriteWidth;
 	int spriteHeight;
@@ -2515,11 +2663,12 @@ void VIDSoftVdp1NormalSpriteDraw() {
 	bottomLeftx = topLeftx;
 	bottomLefty = topLefty + (spriteHeight - 1);
 
-	drawQuad(topLeftx,topLefty,bottomLeftx,bottomLefty,topRightx,topRighty,bottomRightx,bottomRighty);
+	recordQuad(&cmd,topLeftx,topLefty,bottomLeftx,bottomLefty,topRightx,topRighty,bottomRightx,bottomRighty);
 }
 
 void VIDSoftVdp1ScaledSpriteDraw(){
 
+	vdp1cmd_struct cmd;
 	s32 topLeftx,topLefty,topRightx,topRighty,bottomRightx,bottomRighty,bottomLeftx,bottomLefty;
 	int x0,y0,x1,y1;
 	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
@@ -2612,11 +2761,12 @@ void VIDSoftVdp1ScaledSpriteDraw(){
 	bottomLeftx = topLeftx;
 	bottomLefty = y1+y0 - 1;
 
-	drawQuad(topLeftx,topLefty,bottomLeftx,bottomLefty,topRightx,topRighty,bottomRightx,bottomRighty);
+	recordQuad(&cmd,topLeftx,topLefty,bottomLeftx,bottomLefty,topRightx,topRighty,bottomRightx,bottomRighty);
 }
 
 void VIDSoftVdp1DistortedSpriteDraw() {
 
+	vdp1cmd_struct cmd;
 	s32 xa,ya,xb,yb,xc,yc,xd,yd;
 
 	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
@@ -2633,31 +2783,35 @@ void VIDSoftVdp1DistortedSpriteDraw() {
     xd = (s32)(cmd.CMDXD + Vdp1Regs->localX);
     yd = (s32)(cmd.CMDYD + Vdp1Regs->localY);
 
-	drawQuad(xa,ya,xd,yd,xb,yb,xc,yc);
+	recordQuad(&cmd,xa,ya,xd,yd,xb,yb,xc,yc);
 }
 
-static void gouraudLineSetup(double * redstep, double * greenstep, double * bluestep, int length, COLOR table1, COLOR table2) {
-
-	gouraudTable();
+static void gouraudLineSetup(vdp1band_struct *band, double * redstep, double * greenstep, double * bluestep, int length, COLOR table1, COLOR table2) {
 
 	*redstep =interpolate(table1.r,table2.r,length);
 	*greenstep =interpolate(table1.g,table2.g,length);
 	*bluestep =interpolate(table1.b,table2.b,length);
 
-	leftColumnColor.r = table1.r;
-	leftColumnColor.g = table1.g;
-	leftColumnColor.b = table1.b;
+	band->leftColumnColor.r = table1.r;
+	band->leftColumnColor.g = table1.g;
+	band->leftColumnColor.b = table1.b;
 }
 
 void VIDSoftVdp1PolylineDraw(void)
 {
-	int X[4];
-	int Y[4];
-	double redstep = 0, greenstep = 0, bluestep = 0;
-	int length;
+	vdp1cmd_struct cmd;
+	vdp1drawcmd_struct *drawcmd;
+	int *X;
+	int *Y;
 
 	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
 
+	if ((drawcmd = Vdp1RecordCommand(&cmd, VDP1DRAW_POLYLINE)) == NULL)
+		return;
+
+	X = drawcmd->x;
+	Y = drawcmd->y;
+
 	X[0] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0C));
 	Y[0] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0E));
 	X[1] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x10));
@@ -2667,39 +2821,106 @@ void VIDSoftVdp1PolylineDraw(void)
 	X[3] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x18));
 	Y[3] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x1A));
 
+	//the first segment's colors are taken before this command's gouraud table is read
+	drawcmd->gouraud[0] = gouraudA;
+	drawcmd->gouraud[1] = gouraudB;
+	gouraudTable(&cmd);
+	drawcmd->gouraud[2] = gouraudB;
+	drawcmd->gouraud[3] = gouraudC;
+	drawcmd->gouraud[4] = gouraudD;
+	drawcmd->gouraud[5] = gouraudC;
+	drawcmd->gouraud[6] = gouraudA;
+	drawcmd->gouraud[7] = gouraudD;
+}
+
+static void drawPolyline(vdp1band_struct *band)
+{
+	const int *X = band->drawcmd->x;
+	const int *Y = band->drawcmd->y;
+	const COLOR *gouraud = band->drawcmd->gouraud;
+	double redstep = 0, greenstep = 0, bluestep = 0;
+	int length;
+
 	length = iterateOverLine(X[0], Y[0], X[1], Y[1], 1, NULL, NULL);
-	gouraudLineSetup(&redstep,&greenstep,&bluestep,length, gouraudA, gouraudB);
-	DrawLine(X[0], Y[0], X[1], Y[1], 0, 0,0,redstep,greenstep,bluestep);
+	gouraudLineSetup(band, &redstep,&greenstep,&bluestep,length, gouraud[0], gouraud[1]);
+	DrawLine(band, X[0], Y[0], X[1], Y[1], 0, 0,0,redstep,greenstep,bluestep);
 
 	length = iterateOverLine(X[1], Y[1], X[2], Y[2], 1, NULL, NULL);
-	gouraudLineSetup(&redstep,&greenstep,&bluestep,length, gouraudB, gouraudC);
-	DrawLine(X[1], Y[1], X[2], Y[2], 0, 0,0,redstep,greenstep,bluestep);
+	gouraudLineSetup(band, &redstep,&greenstep,&bluestep,length, gouraud[2], gouraud[3]);
+	DrawLine(band, X[1], Y[1], X[2], Y[2], 0, 0,0,redstep,greenstep,bluestep);
 
 	length = iterateOverLine(X[2], Y[2], X[3], Y[3], 1, NULL, NULL);
-	gouraudLineSetup(&redstep,&greenstep,&bluestep,length, gouraudD, gouraudC);
-	DrawLine(X[3], Y[3], X[2], Y[2], 0, 0,0,redstep,greenstep,bluestep);
+	gouraudLineSetup(band, &redstep,&greenstep,&bluestep,length, gouraud[4], gouraud[5]);
+	DrawLine(band, X[3], Y[3], X[2], Y[2], 0, 0,0,redstep,greenstep,bluestep);
 
 	length = iterateOverLine(X[3], Y[3], X[0], Y[0], 1, NULL, NULL);
-	gouraudLineSetup(&redstep,&greenstep,&bluestep,length, gouraudA,gouraudD);
-	DrawLine(X[0], Y[0], X[3], Y[3], 0, 0,0,redstep,greenstep,bluestep);
+	gouraudLineSetup(band, &redstep,&greenstep,&bluestep,length, gouraud[6], gouraud[7]);
+	DrawLine(band, X[0], Y[0], X[3], Y[3], 0, 0,0,redstep,greenstep,bluestep);
 }
 
 void VIDSoftVdp1LineDraw(void)
 {
-	int x1, y1, x2, y2;
-	double redstep = 0, greenstep = 0, bluestep = 0;
-	int length;
+	vdp1cmd_struct cmd;
+	vdp1drawcmd_struct *drawcmd;
 
 	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
 
-	x1 = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0C));
-	y1 = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0E));
-	x2 = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x10));
-	y2 = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x12));
+	if ((drawcmd = Vdp1RecordCommand(&cmd, VDP1DRAW_LINE)) == NULL)
+		return;
+
+	drawcmd->x[0] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0C));
+	drawcmd->y[0] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0E));
+	drawcmd->x[1] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x10));
+	drawcmd->y[1] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x12));
+
+	//the colors are taken before this command's gouraud table is read
+	drawcmd->gouraud[0] = gouraudA;
+	drawcmd->gouraud[1] = gouraudB;
+	gouraudTable(&cmd);
+}
+
+static void drawLine(vdp1band_struct *band)
+{
+	int x1 = band->drawcmd->x[0], y1 = band->drawcmd->y[0];
+	int x2 = band->drawcmd->x[1], y2 = band->drawcmd->y[1];
+	double redstep = 0, greenstep = 0, bluestep = 0;
+	int length;
 
 	length = iterateOverLine(x1, y1, x2, y2, 1, NULL, NULL);
-	gouraudLineSetup(&redstep,&bluestep,&greenstep,length, gouraudA, gouraudB);
-	DrawLine(x1, y1, x2, y2, 0, 0,0,redstep,greenstep,bluestep);
+	gouraudLineSetup(band, &redstep,&bluestep,&greenstep,length, band->drawcmd->gouraud[0], band->drawcmd->gouraud[1]);
+	DrawLine(band, x1, y1, x2, y2, 0, 0,0,redstep,greenstep,bluestep);
+}
+
+static void drawBand(int index, UNUSED void *data)
+{
+	vdp1band_struct *band = &vdp1bands[index];
+	int i;
+
+	for (i = 0; i < vdp1drawlistsize; i++)
+	{
+		const vdp1drawcmd_struct *drawcmd = &vdp1drawlist[i];
+		int currentShape = drawcmd->cmd.CMDCTRL & 0x7;
+
+		band->drawcmd = drawcmd;
+		band->cmd = &drawcmd->cmd;
+		//same test as getpixel()
+		band->endcodes = !(currentShape == 4 || currentShape == 5 || currentShape == 6) &&
+			(drawcmd->cmd.CMDPMOD & 0x80) == 0;
+
+		switch (drawcmd->type)
+		{
+			case VDP1DRAW_QUAD:
+				drawQuad(band, drawcmd->x[0], drawcmd->y[0], drawcmd->x[1], drawcmd->y[1],
+					drawcmd->x[2], drawcmd->y[2], drawcmd->x[3], drawcmd->y[3]);
+				break;
+			case VDP1DRAW_POLYLINE:
+				drawPolyline(band);
+				break;
+			case VDP1DRAW_LINE:
+				drawLine(band);
+				break;
+		}
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -36,6 +36,14 @@ void YuiErrorMsg(const char *string);
    up being moved to the Video Core. */
 void YuiSwapBuffers(void);
 
+/* Returns how many threads YuiParallelFor can run calls on at once, including
+   the calling one. */
+int YuiWorkerThreads(void);
+
+/* Calls func(i, data) for each i from 0 to count - 1, possibly on several
+   threads at once, and returns once every call has finished. */
+void YuiParallelFor(int count, void (*func)(int index, void *data), void *data);
+
 //////////////////////////////////////////////////////////////////////////////
 // Helper functions(you can use these in your own port)
 //////////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,8 @@
 #include <apu/apu.h>
 #include <apu/bapu/snes/snes.hpp>
 #include <ppu.h>
+#include <gfx.h>
+#include <fxemu.h>
 #endif
 #include <emuframework/EmuApp.hh>
 #include <emuframework/OptionView.hh>
@@ -13,6 +15,70 @@
 static constexpr bool HAS_NSRT = !IS_SNES9X_VERSION_1_4;
 
 #ifndef SNES9X_VERSION_1_4
+class CustomVideoOptionView : public VideoOptionView
+{
+	void setRenderThreads(uint8_t val)
+	{
+		logMsg("set render threads:%u", val);
+		optionRenderThreads = val;
+		S9xSetRenderThreads(val);
+	}
+
+	TextMenuItem renderThreadsItem[4]
+	{
+		{"1", [this](){ setRenderThreads(1); }},
+		{"2", [this](){ setRenderThreads(2); }},
+		{"3", [this](){ setRenderThreads(3); }},
+		{"4", [this](){ setRenderThreads(4); }},
+	};
+
+	MultiChoiceMenuItem renderThreads
+	{
+		"Render Threads",
+		optionRenderThreads - 1,
+		renderThreadsItem
+	};
+
+public:
+	CustomVideoOptionView(ViewAttachParams attach): VideoOptionView{attach, true}
+	{
+		loadStockItems();
+		item.emplace_back(&systemSpecificHeading);
+		item.emplace_back(&renderThreads);
+	}
+};
+
+class CustomSystemOptionView : public SystemOptionView
+{
+	void setSuperFXThread(uint8_t val)
+	{
+		logMsg("set SuperFX thread mode:%u", val);
+		optionSuperFXThread = val;
+		S9xSetSuperFXThreadMode(val);
+	}
+
+	TextMenuItem superFXThreadItem[3]
+	{
+		{"Off", [this](){ setSuperFXThread(SUPERFX_THREAD_OFF); }},
+		{"On", [this](){ setSuperFXThread(SUPERFX_THREAD_ON); }},
+		{"On (Verify)", [this](){ setSuperFXThread(SUPERFX_THREAD_VERIFY); }},
+	};
+
+	MultiChoiceMenuItem superFXThread
+	{
+		"SuperFX Thread",
+		optionSuperFXThread,
+		superFXThreadItem
+	};
+
+public:
+	CustomSystemOptionView(ViewAttachParams attach): SystemOptionView{attach, true}
+	{
+		loadStockItems();
+		item.emplace_back(&superFXThread);
+	}
+};
+
 class CustomAudioOptionView : public AudioOptionView
 {
 	void setDSPInterpolation(uint8_t val)
@@ -252,7 +318,9 @@ std::unique_ptr<View> EmuApp::makeCustomView(ViewAttachParams attach, ViewID id)
 	switch(id)
 	{
 		#ifndef SNES9X_VERSION_1_4
+		case ViewID::VIDEO_OPTIONS: return std::make_unique<CustomVideoOptionView>(attach);
 		case ViewID::AUDIO_OPTIONS: return std::make_unique<CustomAudioOptionView>(attach);
+		case ViewID::SYSTEM_OPTIONS: return std::make_unique<CustomSystemOptionView>(attach);
 		#endif
 		case ViewID::SYSTEM_ACTIONS: return std::make_unique<CustomSystemActionsView>(attach);
 		case ViewID::EDIT_CHEATS: return std::make_unique<EmuEditCheatListView>(attach);
@@ -26,6 +26,7 @@ static EmuVideo *emuVideo{};
 static const uint heightChangeFrameDelay = 4;
 static uint heightChangeFrames = heightChangeFrameDelay;
 bool EmuSystem::hasCheats = true;
+bool EmuSystem::hasRamSearch = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 
@@ -100,6 +101,11 @@ void EmuSystem::reset(ResetMode mode)
 	}
 }
 
+std::vector<RamSearchRegion> EmuSystem::ramSearchRegions()
+{
+	return {{"WRAM", Memory.RAM, 0x20000, 0x7E0000}};
+}
+
 #ifndef SNES9X_VERSION_1_4
 #define FREEZE_EXT "frz"
 #else
@@ -230,6 +236,14 @@ static void mixSamples(uint32_t samples, EmuAudio *audio)
 	if(unlikely(!samples))
 		return;
 	assumeExpr(samples % 2 == 0);
+	#ifndef SNES9X_VERSION_1_4
+	if(!audio)
+	{
+		// DSP output is already generated, just drop the resampler's contents
+		S9xClearSamples();
+		return;
+	}
+	#endif
 	int16_t audioBuff[samples];
 	S9xMixSamples((uint8*)audioBuff, samples);
 	if(audio)
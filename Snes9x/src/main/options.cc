@@ -2,6 +2,7 @@
 #include <apu/apu.h>
 #include <apu/bapu/snes/snes.hpp>
 #include <ppu.h>
+#include <gfx.h>
 #include <fxemu.h>
 #endif
 #include <emuframework/EmuApp.hh>
@@ -13,7 +14,8 @@ enum
 	CFGKEY_MULTITAP = 276, CFGKEY_BLOCK_INVALID_VRAM_ACCESS = 277,
 	CFGKEY_VIDEO_SYSTEM = 278, CFGKEY_INPUT_PORT = 279,
 	CFGKEY_AUDIO_DSP_INTERPOLATON = 280, CFGKEY_SEPARATE_ECHO_BUFFER = 281,
-	CFGKEY_SUPERFX_CLOCK_MULTIPLIER = 282
+	CFGKEY_SUPERFX_CLOCK_MULTIPLIER = 282, CFGKEY_RENDER_THREADS = 283,
+	CFGKEY_SUPERFX_THREAD = 284
 };
 
 #ifdef SNES9X_VERSION_1_4
@@ -32,6 +34,8 @@ Byte1Option optionBlockInvalidVRAMAccess{CFGKEY_BLOCK_INVALID_VRAM_ACCESS, 1};
 Byte1Option optionSeparateEchoBuffer{CFGKEY_SEPARATE_ECHO_BUFFER, 0};
 Byte1Option optionSuperFXClockMultiplier{CFGKEY_SUPERFX_CLOCK_MULTIPLIER, 100, false, optionIsValidWithMinMax<5, 250>};
 Byte1Option optionAudioDSPInterpolation{CFGKEY_AUDIO_DSP_INTERPOLATON, DSP_INTERPOLATION_GAUSSIAN, false, optionIsValidWithMax<4>};
+Byte1Option optionRenderThreads{CFGKEY_RENDER_THREADS, 1, false, optionIsValidWithMinMax<1, 4>};
+Byte1Option optionSuperFXThread{CFGKEY_SUPERFX_THREAD, SUPERFX_THREAD_OFF, false, optionIsValidWithMax<SUPERFX_THREAD_VERIFY>};
 #endif
 const AspectRatioInfo EmuSystem::aspectRatioInfo[] =
 {
@@ -68,6 +72,8 @@ EmuSystem::Error EmuSystem::onOptionsLoaded()
 {
 	#ifndef SNES9X_VERSION_1_4
 	SNES::dsp.spc_dsp.interpolation = optionAudioDSPInterpolation;
+	S9xSetRenderThreads(optionRenderThreads);
+	S9xSetSuperFXThreadMode(optionSuperFXThread);
 	#endif
 	return {};
 }
@@ -79,6 +85,8 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		default: return false;
 		#ifndef SNES9X_VERSION_1_4
 		bcase CFGKEY_AUDIO_DSP_INTERPOLATON: optionAudioDSPInterpolation.readFromIO(io, readSize);
+		bcase CFGKEY_RENDER_THREADS: optionRenderThreads.readFromIO(io, readSize);
+		bcase CFGKEY_SUPERFX_THREAD: optionSuperFXThread.readFromIO(io, readSize);
 		#endif
 	}
 	return true;
@@ -88,6 +96,8 @@ void EmuSystem::writeConfig(IO &io)
 {
 	#ifndef SNES9X_VERSION_1_4
 	optionAudioDSPInterpolation.writeWithKeyIfNotDefault(io);
+	optionRenderThreads.writeWithKeyIfNotDefault(io);
+	optionSuperFXThread.writeWithKeyIfNotDefault(io);
 	#endif
 }
 
@@ -185,6 +185,9 @@ template void S9xMainLoop2<false>();
 void S9xMainLoop (void)
 {
 	CPU.exec();
+	// leave no GSU burst running between frames
+	if (Settings.SuperFX)
+		S9xSuperFXSync();
 }
 
 static inline void S9xReschedule (void)
@@ -8,7 +8,12 @@
 #include "memmap.h"
 #include "fxinst.h"
 #include "fxemu.h"
+#include "getset.h"
+#include <imagine/thread/Semaphore.hh>
 #include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
 
 static void FxReset (struct FxInfo_s *);
 static void fx_readRegisterSpace (void);
@@ -19,6 +24,39 @@ static bool8 fx_checkStartAddress (void);
 static uint32 FxEmulate (uint32);
 static void FxCacheWriteAccess (uint16);
 static void FxFlushCache (void);
+static void S9xSuperFXCheckIRQ (void);
+
+// The GSU runs a line's worth of cycles per burst and only touches its own
+// registers, RAM and the ROM while it does. With a GSU thread a burst runs
+// there while the CPU carries on, and any access to the GSU registers waits
+// for it first. GSU RAM is mapped as MAP_SUPERFX_RAM in the meantime so CPU,
+// DMA and HDMA accesses to it wait too, whether or not RON/RAN allow them.
+// Resets and the end of a frame are the other sync points.
+struct SuperFXThread
+{
+	std::thread		thread;
+	IG::Semaphore	start{0};
+	IG::Semaphore	done{0};
+	uint32			cycles = 0;
+	bool			quit = false;
+
+	// verify mode state from before the burst
+	bool8				verify = FALSE;
+	struct FxRegs_s		regs;
+	uint8				registers[0x300];
+	std::vector<uint8>	ram;
+
+	~SuperFXThread ()
+	{
+		quit = true;
+		start.notify();
+		thread.join();
+	}
+};
+
+static std::unique_ptr<SuperFXThread>	gsuThread;
+static bool8	gsuBusy = FALSE;
+static uint32	gsuVerifyErrors = 0;
 
 
 void S9xInitSuperFX (void)
@@ -36,8 +74,107 @@ void S9xSetSuperFXTiming(uint16 speedMultiplier)
 	S9xPrintf("set SuperFX speed/line 1x:%u 2x:%u\n", SuperFX.speedPerLine, SuperFX.speedPerLine2x);
 }
 
+static void S9xRemapSuperFXRAM (void)
+{
+	if (!Settings.SuperFX)
+		return;
+
+	Memory.map_SuperFXRAM(S9xSuperFXThreadActive());
+	Memory.map_WriteProtectROM();
+	S9xSetPCBase(Registers.PBPC);
+}
+
+void S9xSetSuperFXThreadMode (int mode)
+{
+	S9xSuperFXSync();
+	if (mode == SUPERFX_THREAD_OFF)
+	{
+		gsuThread.reset();
+		S9xRemapSuperFXRAM();
+		return;
+	}
+
+	if (!gsuThread)
+	{
+		gsuThread = std::make_unique<SuperFXThread>();
+		SuperFXThread	&t = *gsuThread;
+		t.thread = std::thread(
+			[&t]()
+			{
+				while (true)
+				{
+					t.start.wait();
+					if (t.quit)
+						return;
+					FxEmulate(t.cycles);
+					t.done.notify();
+				}
+			});
+	}
+
+	gsuThread->verify = mode == SUPERFX_THREAD_VERIFY;
+	gsuVerifyErrors = 0;
+	S9xRemapSuperFXRAM();
+}
+
+bool8 S9xSuperFXThreadActive (void)
+{
+	return (gsuThread != nullptr);
+}
+
+uint8 * S9xGetSuperFXRAM (uint32 Address)
+{
+	S9xSuperFXSync();
+
+	// banks 0x70-0x71, or the first 8KB mirrored at 0x6000-0x7fff
+	if ((Address & 0xfe0000) == 0x700000)
+		return (SuperFX.pvRam + (Address & 0x1ffff));
+
+	return (SuperFX.pvRam + (Address & 0x1fff));
+}
+
+static void S9xSuperFXVerify (void)
+{
+	SuperFXThread	&t = *gsuThread;
+	uint8	*ram = SuperFX.pvRam;
+	size_t	ramSize = t.ram.size();
+
+	// keep the threaded results and re-run the burst from the saved state
+	struct FxRegs_s		threadRegs = GSU;
+	uint8				threadRegisters[0x300];
+	std::vector<uint8>	threadRam(ram, ram + ramSize);
+	memcpy(threadRegisters, SuperFX.pvRegisters, sizeof(threadRegisters));
+
+	GSU = t.regs;
+	memcpy(SuperFX.pvRegisters, t.registers, sizeof(t.registers));
+	memcpy(ram, t.ram.data(), ramSize);
+	FxEmulate(t.cycles);
+
+	if (memcmp(&threadRegs, &GSU, sizeof(GSU)) ||
+		memcmp(threadRegisters, SuperFX.pvRegisters, sizeof(threadRegisters)) ||
+		memcmp(threadRam.data(), ram, ramSize))
+	{
+		gsuVerifyErrors++;
+		S9xPrintf("SuperFX thread mismatch at R15:%04x (%u total)\n", (unsigned) GSU.avReg[15], gsuVerifyErrors);
+	}
+}
+
+void S9xSuperFXSync (void)
+{
+	if (!gsuBusy)
+		return;
+
+	gsuThread->done.wait();
+	gsuBusy = FALSE;
+	if (gsuThread->verify)
+		S9xSuperFXVerify();
+
+	S9xSuperFXCheckIRQ();
+}
+
 void S9xResetSuperFX (void)
 {
+	S9xSuperFXSync();
 	// FIXME: Snes9x only runs the SuperFX at the end of every line.
 	// 5823405 is a magic number that seems to work for most games.
 	S9xSetSuperFXTiming(Settings.SuperFXClockMultiplier);
@@ -49,6 +186,8 @@ void S9xResetSuperFX (void)
 
 void S9xSetSuperFX (uint8 byte, uint16 address)
 {
+	S9xSuperFXSync();
+
 	switch (address)
 	{
 		case 0x3030:
@@ -140,6 +279,8 @@ uint8 S9xGetSuperFX (uint16 address)
 {
 	uint8	byte;
 
+	S9xSuperFXSync();
+
 	byte = Memory.FillRAM[address];
 
 	if (address == 0x3031)
@@ -151,15 +292,39 @@ uint8 S9xGetSuperFX (uint16 address)
 	return (byte);
 }
 
+static void S9xSuperFXCheckIRQ (void)
+{
+	uint16 GSUStatus = Memory.FillRAM[0x3000 + GSU_SFR] | (Memory.FillRAM[0x3000 + GSU_SFR + 1] << 8);
+	if ((GSUStatus & (FLG_G | FLG_IRQ)) == FLG_IRQ)
+		CPU.IRQExternal = TRUE;
+}
+
 void S9xSuperFXExec (void)
 {
+	S9xSuperFXSync();
+
 	if ((Memory.FillRAM[0x3000 + GSU_SFR] & FLG_G) && (Memory.FillRAM[0x3000 + GSU_SCMR] & 0x18) == 0x18)
 	{
-		FxEmulate((Memory.FillRAM[0x3000 + GSU_CLSR] & 1) ? SuperFX.speedPerLine2x : SuperFX.speedPerLine);
+		uint32	cycles = (Memory.FillRAM[0x3000 + GSU_CLSR] & 1) ? SuperFX.speedPerLine2x : SuperFX.speedPerLine;
+
+		if (gsuThread)
+		{
+			SuperFXThread	&t = *gsuThread;
+			if (t.verify)
+			{
+				t.regs = GSU;
+				memcpy(t.registers, SuperFX.pvRegisters, sizeof(t.registers));
+				t.ram.assign(SuperFX.pvRam, SuperFX.pvRam + SuperFX.nRamBanks * 65536);
+			}
+
+			t.cycles = cycles;
+			gsuBusy = TRUE;
+			t.start.notify();
+			return;
+		}
 
-		uint16 GSUStatus = Memory.FillRAM[0x3000 + GSU_SFR] | (Memory.FillRAM[0x3000 + GSU_SFR + 1] << 8);
-		if ((GSUStatus & (FLG_G | FLG_IRQ)) == FLG_IRQ)
-			CPU.IRQExternal = TRUE;
+		FxEmulate(cycles);
+		S9xSuperFXCheckIRQ();
 	}
 }
 
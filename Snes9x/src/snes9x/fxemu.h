@@ -26,10 +26,19 @@ struct FxInfo_s
 
 extern struct FxInfo_s	SuperFX;
 
+// S9xSetSuperFXThreadMode() values
+#define SUPERFX_THREAD_OFF		0
+#define SUPERFX_THREAD_ON		1
+#define SUPERFX_THREAD_VERIFY	2	// also re-run each burst on the calling thread and compare
+
 void S9xInitSuperFX (void);
 void S9xSetSuperFXTiming(uint16);
 void S9xResetSuperFX (void);
 void S9xSuperFXExec (void);
+void S9xSetSuperFXThreadMode (int);
+bool8 S9xSuperFXThreadActive (void);
+void S9xSuperFXSync (void);
+uint8 * S9xGetSuperFXRAM (uint32);
 void S9xSetSuperFX (uint8, uint16);
 uint8 S9xGetSuperFX (uint16);
 void fx_flushCache (void);
@@ -15,6 +15,7 @@
 #include "obc1.h"
 #include "seta.h"
 #include "bsx.h"
+#include "fxemu.h"
 #include "msu1.h"
 
 static void addCyclesInMemoryAccess(SCPUState &CPU, int32 speed)
@@ -153,6 +154,11 @@ inline uint8 S9xGetByte (uint32 Address)
 			addCyclesInMemoryAccess(CPU, speed);
 			return (byte);
 
+		case CMemory::MAP_SUPERFX_RAM:
+			byte = *S9xGetSuperFXRAM(Address);
+			addCyclesInMemoryAccess(CPU, speed);
+			return (byte);
+
 		case CMemory::MAP_NONE:
 		default:
 			byte = OpenBus;
@@ -313,6 +319,11 @@ inline uint16 S9xGetWord (uint32 Address, enum s9xwrap_t w = WRAP_NONE)
 			addCyclesInMemoryAccess(CPU, speed);
 			return (word);
 
+		case CMemory::MAP_SUPERFX_RAM:
+			word = READ_WORD(S9xGetSuperFXRAM(Address));
+			addCyclesInMemoryAccess_x2(CPU, speed);
+			return (word);
+
 		case CMemory::MAP_NONE:
 		default:
 			word = OpenBus | (OpenBus << 8);
@@ -420,6 +431,11 @@ inline void S9xSetByte (uint8 Byte, uint32 Address)
 			addCyclesInMemoryAccess(CPU, speed);
 			return;
 
+		case CMemory::MAP_SUPERFX_RAM:
+			*S9xGetSuperFXRAM(Address) = Byte;
+			addCyclesInMemoryAccess(CPU, speed);
+			return;
+
 		case CMemory::MAP_NONE:
 		default:
 			addCyclesInMemoryAccess(CPU, speed);
@@ -691,6 +707,11 @@ inline void S9xSetWord (uint16 Word, uint32 Address, enum s9xwrap_t w = WRAP_NON
 				return;
 			}
 
+		case CMemory::MAP_SUPERFX_RAM:
+			WRITE_WORD(S9xGetSuperFXRAM(Address), Word);
+			addCyclesInMemoryAccess_x2(CPU, speed);
+			return;
+
 		case CMemory::MAP_NONE:
 		default:
 			addCyclesInMemoryAccess_x2(CPU, speed);
@@ -761,6 +782,7 @@ inline void S9xSetPCBase (uint32 Address)
 			CPU.PCBase = S9xGetBasePointerBSX(Address);
 			return;
 
+		case CMemory::MAP_SUPERFX_RAM: // no direct pointer so each fetch waits for the GSU
 		case CMemory::MAP_NONE:
 		default:
 			CPU.PCBase = NULL;
@@ -807,6 +829,7 @@ inline uint8 * S9xGetBasePointer (uint32 Address)
 		case CMemory::MAP_OBC_RAM:
 			return (S9xGetBasePointerOBC1(Address & 0xffff));
 
+		case CMemory::MAP_SUPERFX_RAM: // no direct pointer so each access waits for the GSU
 		case CMemory::MAP_NONE:
 		default:
 			return (NULL);
@@ -852,6 +875,7 @@ inline uint8 * S9xGetMemPointer (uint32 Address)
 		case CMemory::MAP_OBC_RAM:
 			return (S9xGetMemPointerOBC1(Address & 0xffff));
 
+		case CMemory::MAP_SUPERFX_RAM: // no direct pointer so each access waits for the GSU
 		case CMemory::MAP_NONE:
 		default:
 			return (NULL);
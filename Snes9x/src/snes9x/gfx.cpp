@@ -4,6 +4,7 @@
    For further information, consult the LICENSE file in the root directory.
 \*****************************************************************************/
 
+#include <imagine/thread/ThreadPool.hh>
 #include "snes9x.h"
 #include "ppu.h"
 #include "tile.h"
@@ -14,6 +15,8 @@
 #include "screenshot.h"
 #include "font.h"
 #include "display.h"
+#include <algorithm>
+#include <vector>
 
 extern struct SCheatData		Cheat;
 
@@ -23,19 +26,19 @@ static int	font_width = 8, font_height = 9;
 void (*S9xCustomDisplayString) (const char *, int, int, bool, int) = NULL;
 
 static void SetupOBJ (void);
-static void DrawOBJS (int);
+static void DrawOBJS (SGFX &, SBG &, int);
 static void DisplayTime (void);
 static void DisplayFrameRate (void);
 static void DisplayPressedKeys (void);
 static void DisplayWatchedAddresses (void);
 static void DisplayStringFromBottom (const char *, int, int, bool);
-static void DrawBackground (int, uint8, uint8);
-static void DrawBackgroundMosaic (int, uint8, uint8);
-static void DrawBackgroundOffset (int, uint8, uint8, int);
-static void DrawBackgroundOffsetMosaic (int, uint8, uint8, int);
-static inline void DrawBackgroundMode7 (int, void (*DrawMath) (uint32, uint32, int), void (*DrawNomath) (uint32, uint32, int), int);
-static inline void DrawBackdrop (void);
-static inline void RenderScreen (bool8);
+static void DrawBackground (SGFX &, SBG &, int, uint8, uint8);
+static void DrawBackgroundMosaic (SGFX &, SBG &, int, uint8, uint8);
+static void DrawBackgroundOffset (SGFX &, SBG &, int, uint8, uint8, int);
+static void DrawBackgroundOffsetMosaic (SGFX &, SBG &, int, uint8, uint8, int);
+static inline void DrawBackgroundMode7 (SGFX &, SBG &, int, void (*DrawMath) (SGFX &, uint32, uint32, int), void (*DrawNomath) (SGFX &, uint32, uint32, int), int);
+static inline void DrawBackdrop (SGFX &, SBG &);
+static inline void RenderScreen (SGFX &, SBG &, bool8);
 static uint16 get_crosshair_color (uint8);
 static void S9xDisplayStringType (const char *, int, int, bool, int);
 
@@ -201,6 +204,7 @@ void S9xEndScreenRefresh (void)
 	if (IPPU.RenderThisFrame)
 	{
 		FLUSH_REDRAW();
+		S9xRenderBands();
 
 		if (GFX.DoInterlace && GFX.InterlaceFrame == 0)
 		{
@@ -309,8 +313,11 @@ void RenderLine (uint8 C)
 	}
 }
 
-static inline void RenderScreen (bool8 sub)
+static inline void RenderScreen (SGFX &GFX, SBG &BG, bool8 sub)
 {
+	const SPPU	&PPU = GFX.Band->PPU;
+	const auto	&IPPU = GFX.Band->IPPU;
+
 	uint8	BGActive;
 	int		D;
 
@@ -321,7 +328,7 @@ static inline void RenderScreen (bool8 sub)
 			GFX.S += GFX.RealPPL;
 		GFX.DB = GFX.ZBuffer;
 		GFX.Clip = IPPU.Clip[0];
-		BGActive = Memory.FillRAM[0x212c] & ~Settings.BG_Forced;
+		BGActive = GFX.Band->Reg(0x212c) & ~Settings.BG_Forced;
 		D = 32;
 	}
 	else
@@ -329,32 +336,32 @@ static inline void RenderScreen (bool8 sub)
 		GFX.S = GFX.SubScreen;
 		GFX.DB = GFX.SubZBuffer;
 		GFX.Clip = IPPU.Clip[1];
-		BGActive = Memory.FillRAM[0x212d] & ~Settings.BG_Forced;
-		D = (Memory.FillRAM[0x2130] & 2) << 4; // 'do math' depth flag
+		BGActive = GFX.Band->Reg(0x212d) & ~Settings.BG_Forced;
+		D = (GFX.Band->Reg(0x2130) & 2) << 4; // 'do math' depth flag
 	}
 
 	if (BGActive & 0x10)
 	{
 		BG.TileAddress = PPU.OBJNameBase;
 		BG.NameSelect = PPU.OBJNameSelect;
-		BG.EnableMath = !sub && (Memory.FillRAM[0x2131] & 0x10);
+		BG.EnableMath = !sub && (GFX.Band->Reg(0x2131) & 0x10);
 		BG.StartPalette = 128;
-		S9xSelectTileConverter(4, FALSE, sub, FALSE);
-		S9xSelectTileRenderers(PPU.BGMode, sub, TRUE);
-		DrawOBJS(D + 4);
+		S9xSelectTileConverter(GFX, BG, 4, FALSE, sub, FALSE);
+		S9xSelectTileRenderers(GFX, PPU.BGMode, sub, TRUE);
+		DrawOBJS(GFX, BG, D + 4);
 	}
 
 	BG.NameSelect = 0;
-	S9xSelectTileRenderers(PPU.BGMode, sub, FALSE);
+	S9xSelectTileRenderers(GFX, PPU.BGMode, sub, FALSE);
 
 	#define DO_BG(n, pal, depth, hires, offset, Zh, Zl, voffoff) \
 		if (BGActive & (1 << n)) \
 		{ \
 			BG.StartPalette = pal; \
-			BG.EnableMath = !sub && (Memory.FillRAM[0x2131] & (1 << n)); \
+			BG.EnableMath = !sub && (GFX.Band->Reg(0x2131) & (1 << n)); \
 			BG.TileSizeH = (!hires && PPU.BG[n].BGSize) ? 16 : 8; \
 			BG.TileSizeV = (PPU.BG[n].BGSize) ? 16 : 8; \
-			S9xSelectTileConverter(depth, hires, sub, PPU.BGMosaic[n]); \
+			S9xSelectTileConverter(GFX, BG, depth, hires, sub, PPU.BGMosaic[n]); \
 			\
 			if (offset) \
 			{ \
@@ -362,16 +369,16 @@ static inline void RenderScreen (bool8 sub)
 				BG.OffsetSizeV = (PPU.BG[2].BGSize) ? 16 : 8; \
 				\
 				if (PPU.BGMosaic[n] && (hires || PPU.Mosaic > 1)) \
-					DrawBackgroundOffsetMosaic(n, D + Zh, D + Zl, voffoff); \
+					DrawBackgroundOffsetMosaic(GFX, BG, n, D + Zh, D + Zl, voffoff); \
 				else \
-					DrawBackgroundOffset(n, D + Zh, D + Zl, voffoff); \
+					DrawBackgroundOffset(GFX, BG, n, D + Zh, D + Zl, voffoff); \
 			} \
 			else \
 			{ \
 				if (PPU.BGMosaic[n] && (hires || PPU.Mosaic > 1)) \
-					DrawBackgroundMosaic(n, D + Zh, D + Zl); \
+					DrawBackgroundMosaic(GFX, BG, n, D + Zh, D + Zl); \
 				else \
-					DrawBackground(n, D + Zh, D + Zl); \
+					DrawBackground(GFX, BG, n, D + Zh, D + Zl); \
 			} \
 		}
 
@@ -417,14 +424,14 @@ static inline void RenderScreen (bool8 sub)
 		case 7:
 			if (BGActive & 0x01)
 			{
-				BG.EnableMath = !sub && (Memory.FillRAM[0x2131] & 1);
-				DrawBackgroundMode7(0, GFX.DrawMode7BG1Math, GFX.DrawMode7BG1Nomath, D);
+				BG.EnableMath = !sub && (GFX.Band->Reg(0x2131) & 1);
+				DrawBackgroundMode7(GFX, BG, 0, GFX.DrawMode7BG1Math, GFX.DrawMode7BG1Nomath, D);
 			}
 
-			if ((Memory.FillRAM[0x2133] & 0x40) && (BGActive & 0x02))
+			if ((GFX.Band->Reg(0x2133) & 0x40) && (BGActive & 0x02))
 			{
-				BG.EnableMath = !sub && (Memory.FillRAM[0x2131] & 2);
-				DrawBackgroundMode7(1, GFX.DrawMode7BG2Math, GFX.DrawMode7BG2Nomath, D);
+				BG.EnableMath = !sub && (GFX.Band->Reg(0x2131) & 2);
+				DrawBackgroundMode7(GFX, BG, 1, GFX.DrawMode7BG2Math, GFX.DrawMode7BG2Nomath, D);
 			}
 
 			break;
@@ -432,15 +439,145 @@ static inline void RenderScreen (bool8 sub)
 
 	#undef DO_BG
 
-	BG.EnableMath = !sub && (Memory.FillRAM[0x2131] & 0x20);
+	BG.EnableMath = !sub && (GFX.Band->Reg(0x2131) & 0x20);
+
+	DrawBackdrop(GFX, BG);
+}
+
+// Deferred, parallel rendering for S9xUpdateScreen. Each band of lines drawn
+// between PPU register writes is recorded with the PPU state the renderer
+// reads, and the bands are drawn together at the end of the frame, or earlier
+// when something they don't record is about to change (VRAM, the OBJ line
+// lists, the screen layout). The recorded lines are split into ranges drawn on
+// the shared thread pool, the first with the global GFX/BG and each other with
+// a private copy. Lines are drawn independently of each other, so the output
+// is the same as drawing each band when it's recorded.
+struct RenderLane
+{
+	SGFX	gfx;
+	SBG		bg;
+};
+
+static std::vector<RenderLane>	renderLanes;
+static std::vector<SRenderBand>	renderBands;
+// splitting fewer lines than this costs more in GFX copies than it saves
+static const uint32		MinRenderLaneLines = 16;
+
+static void RenderBand (SGFX &GFX, SBG &BG, const SRenderBand &band, uint32 startY, uint32 endY)
+{
+	GFX.Band = &band;
+	GFX.StartY = startY;
+	GFX.EndY = endY;
+	GFX.FixedColour = band.FixedColour;
+
+	if (band.Sub)
+		RenderScreen(GFX, BG, TRUE);
 
-	DrawBackdrop();
+	RenderScreen(GFX, BG, FALSE);
+}
+
+// mosaic blocks take their scroll values from the first line drawn in the
+// band, so a band starting mid-block would be drawn differently
+static bool8 SplittableBand (const SRenderBand &band)
+{
+	const SPPU	&PPU = band.PPU;
+
+	return !((PPU.Mosaic > 1 || PPU.BGMode == 5 || PPU.BGMode == 6) &&
+		(PPU.BGMosaic[0] || PPU.BGMosaic[1] || PPU.BGMosaic[2] || PPU.BGMosaic[3]));
+}
+
+// draws the recorded lines from startY to endY, a band that can't be split is
+// drawn whole by the range holding its first line
+static void RenderBandRange (SGFX &GFX, SBG &BG, uint32 startY, uint32 endY)
+{
+	for (const SRenderBand &band : renderBands)
+	{
+		if (band.EndY < startY || band.StartY > endY)
+			continue;
+
+		if (SplittableBand(band))
+			RenderBand(GFX, BG, band, std::max(band.StartY, startY), std::min(band.EndY, endY));
+		else if (band.StartY >= startY)
+			RenderBand(GFX, BG, band, band.StartY, band.EndY);
+	}
+}
+
+static void RecordBand (bool8 sub)
+{
+	SRenderBand	&band = renderBands.emplace_back();
+
+	band.PPU = PPU;
+	memcpy(band.IPPU.Clip, IPPU.Clip, sizeof(band.IPPU.Clip));
+	memcpy(band.IPPU.ScreenColors, IPPU.ScreenColors, sizeof(band.IPPU.ScreenColors));
+	band.IPPU.Interlace = IPPU.Interlace;
+	band.IPPU.PseudoHires = IPPU.PseudoHires;
+	band.IPPU.DoubleWidthPixels = IPPU.DoubleWidthPixels;
+	band.IPPU.MaxBrightness = IPPU.MaxBrightness;
+	memcpy(band.FillRAM, &Memory.FillRAM[0x2100], sizeof(band.FillRAM));
+	band.StartY = GFX.StartY;
+	band.EndY = GFX.EndY;
+	band.FixedColour = GFX.FixedColour;
+	band.Sub = sub;
+	GFX.PendingBands = renderBands.size();
+}
+
+void S9xRenderBands (void)
+{
+	if (renderBands.empty())
+		return;
+
+	uint32	startY = GFX.StartY, endY = GFX.EndY, fixedColour = GFX.FixedColour;
+	uint32	firstY = renderBands.front().StartY, lastY = renderBands.back().EndY;
+	uint32	lines = lastY - firstY + 1;
+	uint32	lanes = std::min((uint32) renderLanes.size() + 1, lines / MinRenderLaneLines);
+
+	if (lanes <= 1)
+		RenderBandRange(GFX, BG, firstY, lastY);
+	else
+	{
+		for (uint32 i = 1; i < lanes; i++)
+		{
+			renderLanes[i - 1].gfx = GFX;
+			renderLanes[i - 1].bg = BG;
+		}
+
+		IG::ThreadPool::shared().parallelFor(0, lanes,
+			[=](unsigned i)
+			{
+				uint32	laneStartY = firstY + lines * i / lanes;
+				uint32	laneEndY = firstY + lines * (i + 1) / lanes - 1;
+
+				if (i == 0)
+					RenderBandRange(GFX, BG, laneStartY, laneEndY);
+				else
+					RenderBandRange(renderLanes[i - 1].gfx, renderLanes[i - 1].bg, laneStartY, laneEndY);
+			});
+	}
+
+	renderBands.clear();
+	GFX.PendingBands = 0;
+	GFX.StartY = startY;
+	GFX.EndY = endY;
+	GFX.FixedColour = fixedColour;
+}
+
+void S9xSetRenderThreads (int threads)
+{
+	S9xRenderBands();
+	renderLanes.resize(std::max(threads, 1) - 1);
 }
 
 void S9xUpdateScreen (void)
 {
 	if (IPPU.OBJChanged || IPPU.InterlaceOBJ)
+	{
+		// the recorded bands use the current OBJ line lists, with only
+		// InterlaceOBJ set they're rebuilt the same
+		if (IPPU.OBJChanged)
+			S9xRenderBands();
+
 		SetupOBJ();
+	}
 
 	// XXX: Check ForceBlank? Or anything else?
 	PPU.RangeTimeOver |= GFX.OBJLines[GFX.EndY].RTOFlags;
@@ -464,6 +601,9 @@ void S9xUpdateScreen (void)
 		{
 			if (!IPPU.DoubleWidthPixels && (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires))
 			{
+				// the lines drawn so far get widened below
+				S9xRenderBands();
+
 				#ifdef USE_OPENGL
 				if (Settings.OpenGLEnable && GFX.RealPPL == 256)
 				{
@@ -501,6 +641,7 @@ void S9xUpdateScreen (void)
 
 			if (!IPPU.DoubleHeightPixels && IPPU.Interlace && (PPU.BGMode == 5 || PPU.BGMode == 6))
 			{
+				S9xRenderBands();
 				IPPU.DoubleHeightPixels = TRUE;
 				IPPU.RenderedScreenHeight = PPU.ScreenHeight << 1;
 				GFX.PPL = GFX.RealPPL << 1;
@@ -514,13 +655,17 @@ void S9xUpdateScreen (void)
 		if ((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2131] & 0x3f))
 			GFX.FixedColour = BUILD_PIXEL(IPPU.XB[PPU.FixedColourRed], IPPU.XB[PPU.FixedColourGreen], IPPU.XB[PPU.FixedColourBlue]);
 
-		if (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires ||
-			((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2130] & 2) && (Memory.FillRAM[0x2131] & 0x3f) && (Memory.FillRAM[0x212d] & 0x1f)))
-			// If hires (Mode 5/6 or pseudo-hires) or math is to be done
-			// involving the subscreen, then we need to render the subscreen...
-			RenderScreen(TRUE);
+		// If hires (Mode 5/6 or pseudo-hires) or math is to be done
+		// involving the subscreen, then we need to render the subscreen...
+		bool8	sub = PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires ||
+			((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2130] & 2) && (Memory.FillRAM[0x2131] & 0x3f) && (Memory.FillRAM[0x212d] & 0x1f));
 
-		RenderScreen(FALSE);
+		RecordBand(sub);
+
+		// without other threads to share the work there's nothing to gain
+		// from waiting for the rest of the frame
+		if (renderLanes.empty())
+			S9xRenderBands();
 	}
 	else
 	{
@@ -779,10 +924,13 @@ static void SetupOBJ (void)
 #pragma GCC push_options
 #pragma GCC optimize ("no-tree-vrp")
 #endif
-static void DrawOBJS (int D)
+static void DrawOBJS (SGFX &GFX, SBG &BG, int D)
 {
-	void (*DrawTile) (uint32, uint32, uint32, uint32) = NULL;
-	void (*DrawClippedTile) (uint32, uint32, uint32, uint32, uint32, uint32) = NULL;
+	const SPPU	&PPU = GFX.Band->PPU;
+	const auto	&IPPU = GFX.Band->IPPU;
+
+	void (*DrawTile) (SGFX &, SBG &, uint32, uint32, uint32, uint32) = NULL;
+	void (*DrawClippedTile) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32) = NULL;
 
 	int	PixWidth = IPPU.DoubleWidthPixels ? 2 : 1;
 	BG.InterlaceLine = GFX.InterlaceFrame ? 8 : 0;
@@ -857,14 +1005,14 @@ static void DrawOBJS (int D)
 					if (x == X && x + 8 < next_clip)
 					{
 						if (DrawMode)
-							DrawTile(BaseTile | TileX, O, TileLine, 1);
+							DrawTile(GFX, BG, BaseTile | TileX, O, TileLine, 1);
 						x += 8;
 					}
 					else
 					{
 						int	w = (next_clip <= X + 8) ? next_clip - x : X + 8 - x;
 						if (DrawMode)
-							DrawClippedTile(BaseTile | TileX, O, x - X, w, TileLine, 1);
+							DrawClippedTile(GFX, BG, BaseTile | TileX, O, x - X, w, TileLine, 1);
 						x += w;
 					}
 				}
@@ -876,8 +1024,11 @@ static void DrawOBJS (int D)
 #pragma GCC pop_options
 #endif
 
-static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
+static void DrawBackground (SGFX &GFX, SBG &BG, int bg, uint8 Zh, uint8 Zl)
 {
+	const SPPU	&PPU = GFX.Band->PPU;
+	const auto	&IPPU = GFX.Band->IPPU;
+
 	BG.TileAddress = PPU.BG[bg].NameBase << 1;
 
 	uint32	Tile;
@@ -901,8 +1052,8 @@ static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 	int		PixWidth = IPPU.DoubleWidthPixels ? 2 : 1;
 	bool8	HiresInterlace = IPPU.Interlace && IPPU.DoubleWidthPixels;
 
-	void (*DrawTile) (uint32, uint32, uint32, uint32);
-	void (*DrawClippedTile) (uint32, uint32, uint32, uint32, uint32, uint32);
+	void (*DrawTile) (SGFX &, SBG &, uint32, uint32, uint32, uint32);
+	void (*DrawClippedTile) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
 
 	for (int clip = 0; clip < GFX.Clip[bg].Count; clip++)
 	{
@@ -1008,7 +1159,7 @@ static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 
 				if (BG.TileSizeH == 8)
 				{
-					DrawClippedTile(Tile, Offset, l, w, VirtAlign, Lines);
+					DrawClippedTile(GFX, BG, Tile, Offset, l, w, VirtAlign, Lines);
 					t++;
 					if (HTile == 31)
 						t = b2;
@@ -1019,9 +1170,9 @@ static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 				else
 				{
 					if (!(Tile & H_FLIP))
-						DrawClippedTile(TILE_PLUS(Tile, (HTile & 1)), Offset, l, w, VirtAlign, Lines);
+						DrawClippedTile(GFX, BG, TILE_PLUS(Tile, (HTile & 1)), Offset, l, w, VirtAlign, Lines);
 					else
-						DrawClippedTile(TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, l, w, VirtAlign, Lines);
+						DrawClippedTile(GFX, BG, TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, l, w, VirtAlign, Lines);
 					t += HTile & 1;
 					if (HTile == 63)
 						t = b2;
@@ -1045,7 +1196,7 @@ static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 
 				if (BG.TileSizeH == 8)
 				{
-					DrawTile(Tile, Offset, VirtAlign, Lines);
+					DrawTile(GFX, BG, Tile, Offset, VirtAlign, Lines);
 					t++;
 					if (HTile == 31)
 						t = b2;
@@ -1056,9 +1207,9 @@ static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 				else
 				{
 					if (!(Tile & H_FLIP))
-						DrawTile(TILE_PLUS(Tile, (HTile & 1)), Offset, VirtAlign, Lines);
+						DrawTile(GFX, BG, TILE_PLUS(Tile, (HTile & 1)), Offset, VirtAlign, Lines);
 					else
-						DrawTile(TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, VirtAlign, Lines);
+						DrawTile(GFX, BG, TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, VirtAlign, Lines);
 					t += HTile & 1;
 					if (HTile == 63)
 						t = b2;
@@ -1081,21 +1232,24 @@ static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 					Tile = TILE_PLUS(Tile, ((Tile & V_FLIP) ? t2 : t1));
 
 				if (BG.TileSizeH == 8)
-					DrawClippedTile(Tile, Offset, 0, Width, VirtAlign, Lines);
+					DrawClippedTile(GFX, BG, Tile, Offset, 0, Width, VirtAlign, Lines);
 				else
 				{
 					if (!(Tile & H_FLIP))
-						DrawClippedTile(TILE_PLUS(Tile, (HTile & 1)), Offset, 0, Width, VirtAlign, Lines);
+						DrawClippedTile(GFX, BG, TILE_PLUS(Tile, (HTile & 1)), Offset, 0, Width, VirtAlign, Lines);
 					else
-						DrawClippedTile(TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, 0, Width, VirtAlign, Lines);
+						DrawClippedTile(GFX, BG, TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, 0, Width, VirtAlign, Lines);
 				}
 			}
 		}
 	}
 }
 
-static void DrawBackgroundMosaic (int bg, uint8 Zh, uint8 Zl)
+static void DrawBackgroundMosaic (SGFX &GFX, SBG &BG, int bg, uint8 Zh, uint8 Zl)
 {
+	const SPPU	&PPU = GFX.Band->PPU;
+	const auto	&IPPU = GFX.Band->IPPU;
+
 	BG.TileAddress = PPU.BG[bg].NameBase << 1;
 
 	uint32	Tile;
@@ -1119,7 +1273,7 @@ static void DrawBackgroundMosaic (int bg, uint8 Zh, uint8 Zl)
 	int	PixWidth = IPPU.DoubleWidthPixels ? 2 : 1;
 	bool8	HiresInterlace = IPPU.Interlace && IPPU.DoubleWidthPixels;
 
-	void (*DrawPix) (uint32, uint32, uint32, uint32, uint32, uint32);
+	void (*DrawPix) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
 
 	int	MosaicStart = ((uint32) GFX.StartY - PPU.MosaicStart) % PPU.Mosaic;
 
@@ -1214,13 +1368,13 @@ static void DrawBackgroundMosaic (int bg, uint8 Zh, uint8 Zl)
 					Tile = TILE_PLUS(Tile, ((Tile & V_FLIP) ? t2 : t1));
 
 				if (BG.TileSizeH == 8)
-					DrawPix(Tile, Offset, VirtAlign, HPos & 7, w, Lines);
+					DrawPix(GFX, BG, Tile, Offset, VirtAlign, HPos & 7, w, Lines);
 				else
 				{
 					if (!(Tile & H_FLIP))
-						DrawPix(TILE_PLUS(Tile, (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
+						DrawPix(GFX, BG, TILE_PLUS(Tile, (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
 					else
-						DrawPix(TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
+						DrawPix(GFX, BG, TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
 				}
 
 				HPos += PPU.Mosaic;
@@ -1261,8 +1415,11 @@ static void DrawBackgroundMosaic (int bg, uint8 Zh, uint8 Zl)
 	}
 }
 
-static void DrawBackgroundOffset (int bg, uint8 Zh, uint8 Zl, int VOffOff)
+static void DrawBackgroundOffset (SGFX &GFX, SBG &BG, int bg, uint8 Zh, uint8 Zl, int VOffOff)
 {
+	const SPPU	&PPU = GFX.Band->PPU;
+	const auto	&IPPU = GFX.Band->IPPU;
+
 	BG.TileAddress = PPU.BG[bg].NameBase << 1;
 
 	uint32	Tile;
@@ -1300,7 +1457,7 @@ static void DrawBackgroundOffset (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 	int	PixWidth = IPPU.DoubleWidthPixels ? 2 : 1;
 	bool8	HiresInterlace = IPPU.Interlace && IPPU.DoubleWidthPixels;
 
-	void (*DrawClippedTile) (uint32, uint32, uint32, uint32, uint32, uint32);
+	void (*DrawClippedTile) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
 
 	for (int clip = 0; clip < GFX.Clip[bg].Count; clip++)
 	{
@@ -1472,14 +1629,14 @@ static void DrawBackgroundOffset (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 
 				if (BG.TileSizeH == 8)
 				{
-					DrawClippedTile(Tile, Offset, l, w, VirtAlign, 1);
+					DrawClippedTile(GFX, BG, Tile, Offset, l, w, VirtAlign, 1);
 				}
 				else
 				{
 					if (!(Tile & H_FLIP))
-						DrawClippedTile(TILE_PLUS(Tile, (HTile & 1)), Offset, l, w, VirtAlign, 1);
+						DrawClippedTile(GFX, BG, TILE_PLUS(Tile, (HTile & 1)), Offset, l, w, VirtAlign, 1);
 					else
-						DrawClippedTile(TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, l, w, VirtAlign, 1);
+						DrawClippedTile(GFX, BG, TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, l, w, VirtAlign, 1);
 				}
 
 				Left += w;
@@ -1490,8 +1647,11 @@ static void DrawBackgroundOffset (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 	}
 }
 
-static void DrawBackgroundOffsetMosaic (int bg, uint8 Zh, uint8 Zl, int VOffOff)
+static void DrawBackgroundOffsetMosaic (SGFX &GFX, SBG &BG, int bg, uint8 Zh, uint8 Zl, int VOffOff)
 {
+	const SPPU	&PPU = GFX.Band->PPU;
+	const auto	&IPPU = GFX.Band->IPPU;
+
 	BG.TileAddress = PPU.BG[bg].NameBase << 1;
 
 	uint32	Tile;
@@ -1529,7 +1689,7 @@ static void DrawBackgroundOffsetMosaic (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 	int	PixWidth = IPPU.DoubleWidthPixels ? 2 : 1;
 	bool8	HiresInterlace = IPPU.Interlace && IPPU.DoubleWidthPixels;
 
-	void (*DrawPix) (uint32, uint32, uint32, uint32, uint32, uint32);
+	void (*DrawPix) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
 
 	int	MosaicStart = ((uint32) GFX.StartY - PPU.MosaicStart) % PPU.Mosaic;
 
@@ -1699,14 +1859,14 @@ static void DrawBackgroundOffsetMosaic (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 					Tile = TILE_PLUS(Tile, ((Tile & V_FLIP) ? t2 : t1));
 
 				if (BG.TileSizeH == 8)
-					DrawPix(Tile, Offset, VirtAlign, HPos & 7, w, Lines);
+					DrawPix(GFX, BG, Tile, Offset, VirtAlign, HPos & 7, w, Lines);
 				else
 				{
 					if (!(Tile & H_FLIP))
-						DrawPix(TILE_PLUS(Tile, (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
+						DrawPix(GFX, BG, TILE_PLUS(Tile, (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
 					else
 					if (!(Tile & V_FLIP))
-						DrawPix(TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
+						DrawPix(GFX, BG, TILE_PLUS(Tile, 1 - (HTile & 1)), Offset, VirtAlign, HPos & 7, w, Lines);
 				}
 
 				Left += w;
@@ -1719,20 +1879,20 @@ static void DrawBackgroundOffsetMosaic (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 	}
 }
 
-static inline void DrawBackgroundMode7 (int bg, void (*DrawMath) (uint32, uint32, int), void (*DrawNomath) (uint32, uint32, int), int D)
+static inline void DrawBackgroundMode7 (SGFX &GFX, SBG &BG, int bg, void (*DrawMath) (SGFX &, uint32, uint32, int), void (*DrawNomath) (SGFX &, uint32, uint32, int), int D)
 {
 	for (int clip = 0; clip < GFX.Clip[bg].Count; clip++)
 	{
 		GFX.ClipColors = !(GFX.Clip[bg].DrawMode[clip] & 1);
 
 		if (BG.EnableMath && (GFX.Clip[bg].DrawMode[clip] & 2))
-			DrawMath(GFX.Clip[bg].Left[clip], GFX.Clip[bg].Right[clip], D);
+			DrawMath(GFX, GFX.Clip[bg].Left[clip], GFX.Clip[bg].Right[clip], D);
 		else
-			DrawNomath(GFX.Clip[bg].Left[clip], GFX.Clip[bg].Right[clip], D);
+			DrawNomath(GFX, GFX.Clip[bg].Left[clip], GFX.Clip[bg].Right[clip], D);
 	}
 }
 
-static inline void DrawBackdrop (void)
+static inline void DrawBackdrop (SGFX &GFX, SBG &BG)
 {
 	uint32	Offset = GFX.StartY * GFX.PPL;
 
@@ -1741,9 +1901,9 @@ static inline void DrawBackdrop (void)
 		GFX.ClipColors = !(GFX.Clip[5].DrawMode[clip] & 1);
 
 		if (BG.EnableMath && (GFX.Clip[5].DrawMode[clip] & 2))
-			GFX.DrawBackdropMath(Offset, GFX.Clip[5].Left[clip], GFX.Clip[5].Right[clip]);
+			GFX.DrawBackdropMath(GFX, Offset, GFX.Clip[5].Left[clip], GFX.Clip[5].Right[clip]);
 		else
-			GFX.DrawBackdropNomath(Offset, GFX.Clip[5].Left[clip], GFX.Clip[5].Right[clip]);
+			GFX.DrawBackdropNomath(GFX, Offset, GFX.Clip[5].Left[clip], GFX.Clip[5].Right[clip]);
 	}
 }
 
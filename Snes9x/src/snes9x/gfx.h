@@ -9,6 +9,8 @@
 
 #include "port.h"
 
+struct SBG;
+
 struct SLineData
 {
 	struct
@@ -57,7 +59,9 @@ struct SGFX
 	uint8	OBJWidths[128];
 	uint8	OBJVisibleTiles[128];
 
-	struct ClipData	*Clip;
+	const struct ClipData	*Clip;
+	const struct SRenderBand	*Band;	// band being drawn
+	uint32	PendingBands;		// bands recorded but not drawn yet
 
 	struct
 	{
@@ -71,18 +75,18 @@ struct SGFX
 		}	OBJ[128];
 	}	OBJLines[SNES_HEIGHT_EXTENDED];
 
-	void	(*DrawBackdropMath) (uint32, uint32, uint32);
-	void	(*DrawBackdropNomath) (uint32, uint32, uint32);
-	void	(*DrawTileMath) (uint32, uint32, uint32, uint32);
-	void	(*DrawTileNomath) (uint32, uint32, uint32, uint32);
-	void	(*DrawClippedTileMath) (uint32, uint32, uint32, uint32, uint32, uint32);
-	void	(*DrawClippedTileNomath) (uint32, uint32, uint32, uint32, uint32, uint32);
-	void	(*DrawMosaicPixelMath) (uint32, uint32, uint32, uint32, uint32, uint32);
-	void	(*DrawMosaicPixelNomath) (uint32, uint32, uint32, uint32, uint32, uint32);
-	void	(*DrawMode7BG1Math) (uint32, uint32, int);
-	void	(*DrawMode7BG1Nomath) (uint32, uint32, int);
-	void	(*DrawMode7BG2Math) (uint32, uint32, int);
-	void	(*DrawMode7BG2Nomath) (uint32, uint32, int);
+	void	(*DrawBackdropMath) (SGFX &, uint32, uint32, uint32);
+	void	(*DrawBackdropNomath) (SGFX &, uint32, uint32, uint32);
+	void	(*DrawTileMath) (SGFX &, SBG &, uint32, uint32, uint32, uint32);
+	void	(*DrawTileNomath) (SGFX &, SBG &, uint32, uint32, uint32, uint32);
+	void	(*DrawClippedTileMath) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
+	void	(*DrawClippedTileNomath) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
+	void	(*DrawMosaicPixelMath) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
+	void	(*DrawMosaicPixelNomath) (SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
+	void	(*DrawMode7BG1Math) (SGFX &, uint32, uint32, int);
+	void	(*DrawMode7BG1Nomath) (SGFX &, uint32, uint32, int);
+	void	(*DrawMode7BG2Math) (SGFX &, uint32, uint32, int);
+	void	(*DrawMode7BG2Nomath) (SGFX &, uint32, uint32, int);
 
 	static const char	*InfoString;
 	static uint32	InfoStringTimeout;
@@ -128,6 +132,7 @@ extern struct SGFX	GFX;
 #define H_FLIP		0x4000
 #define V_FLIP		0x8000
 #define BLANK_TILE	2
+#define CONVERTING_TILE	3
 
 struct COLOR_ADD
 {
@@ -210,6 +215,9 @@ void S9xDisplayChar (uint16 *, uint8);
 void S9xGraphicsScreenResize (void);
 // called automatically unless Settings.AutoDisplayMessages is false
 void S9xDisplayMessages (uint16 *, int, int, int, int);
+// render each screen band on this many threads, 1 renders on the calling thread only
+void S9xSetRenderThreads (int);
+void S9xRenderBands (void);
 
 // external port interface which must be implemented or initialised for each port
 bool8 S9xGraphicsInit (void);
@@ -2901,6 +2901,23 @@ void CMemory::map_SetaDSP (void)
 	// map_index(0x68, 0x6f, 0x0000, 0x0fff, MAP_SETA_DSP, ?);
 }
 
+void CMemory::map_SuperFXRAM (bool8 sync)
+{
+	// with a GSU thread, CPU accesses go through getset.h to wait for a running burst
+	if (sync)
+	{
+		map_index(0x00, 0x3f, 0x6000, 0x7fff, MAP_SUPERFX_RAM, MAP_TYPE_RAM);
+		map_index(0x80, 0xbf, 0x6000, 0x7fff, MAP_SUPERFX_RAM, MAP_TYPE_RAM);
+		map_index(0x70, 0x71, 0x0000, 0xffff, MAP_SUPERFX_RAM, MAP_TYPE_RAM);
+		return;
+	}
+
+	map_space(0x00, 0x3f, 0x6000, 0x7fff, SRAM - 0x6000);
+	map_space(0x80, 0xbf, 0x6000, 0x7fff, SRAM - 0x6000);
+	map_space(0x70, 0x70, 0x0000, 0xffff, SRAM);
+	map_space(0x71, 0x71, 0x0000, 0xffff, SRAM + 0x10000);
+}
+
 void CMemory::map_WriteProtectROM (void)
 {
 	memmove((void *) WriteMap, (void *) Map, sizeof(Map));
@@ -3095,10 +3112,7 @@ void CMemory::Map_SuperFXLoROMMap (void)
 	map_hirom_offset(0x40, 0x7f, 0x0000, 0xffff, CalculatedSize, 0);
 	map_hirom_offset(0xc0, 0xff, 0x0000, 0xffff, CalculatedSize, 0);
 
-	map_space(0x00, 0x3f, 0x6000, 0x7fff, SRAM - 0x6000);
-	map_space(0x80, 0xbf, 0x6000, 0x7fff, SRAM - 0x6000);
-	map_space(0x70, 0x70, 0x0000, 0xffff, SRAM);
-	map_space(0x71, 0x71, 0x0000, 0xffff, SRAM + 0x10000);
+	map_SuperFXRAM(S9xSuperFXThreadActive());
 
 	map_WRAM();
 
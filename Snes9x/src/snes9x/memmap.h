@@ -46,6 +46,7 @@ struct CMemory
 		MAP_SETA_DSP,
 		MAP_SETA_RISC,
 		MAP_BSX,
+		MAP_SUPERFX_RAM,
 		MAP_NONE,
 		MAP_LAST
 	};
@@ -141,6 +142,7 @@ struct CMemory
 	void	map_OBC1 (void);
 	void	map_SetaRISC (void);
 	void	map_SetaDSP (void);
+	void	map_SuperFXRAM (bool8);
 	void	map_WriteProtectROM (void);
 	void	Map_Initialize (void);
 	void	Map_LoROMMap (void);
@@ -197,6 +197,31 @@ struct SPPU
 	uint16	VRAMReadBuffer;
 };
 
+// The PPU state the renderer reads, recorded by S9xUpdateScreen for each band
+// of lines so the bands can be drawn together once the frame is emulated
+struct SRenderBand
+{
+	struct SPPU	PPU;
+
+	struct
+	{
+		struct ClipData Clip[2][6];
+		uint16	ScreenColors[256];
+		bool8	Interlace;
+		bool8	PseudoHires;
+		bool8	DoubleWidthPixels;
+		uint8	MaxBrightness;
+	}	IPPU;
+
+	uint8	FillRAM[0x40];		// $2100-$213f
+	uint32	StartY;
+	uint32	EndY;
+	uint32	FixedColour;
+	bool8	Sub;
+
+	uint8 Reg (uint16 address) const { return FillRAM[address - 0x2100]; }
+};
+
 static constexpr uint16 SignExtend[2]
 {
 	0x0000,
@@ -241,6 +266,13 @@ static inline void FLUSH_REDRAW (void)
 		S9xUpdateScreen();
 }
 
+// the bands S9xUpdateScreen defers don't record VRAM, draw them before it changes
+static inline void FLUSH_BANDS (void)
+{
+	if (GFX.PendingBands)
+		S9xRenderBands();
+}
+
 static inline void S9xUpdateVRAMReadBuffer()
 {
 	if (PPU.VMA.FullGraphicCount)
@@ -368,6 +400,7 @@ static inline void REGISTER_2118 (uint8 Byte)
 {
 	if(CHECK_INBLANK1(PPU, CPU))
 		return;
+	FLUSH_BANDS();
 
 	uint32	address;
 
@@ -406,6 +439,7 @@ static inline void REGISTER_2118_tile (uint8 Byte)
 {
 	if(CHECK_INBLANK1(PPU, CPU))
 		return;
+	FLUSH_BANDS();
 
 	uint32 rem = PPU.VMA.Address & PPU.VMA.Mask1;
 	uint32 address = (((PPU.VMA.Address & ~PPU.VMA.Mask1) + (rem >> PPU.VMA.Shift) + ((rem & (PPU.VMA.FullGraphicCount - 1)) << 3)) << 1) & 0xffff;
@@ -432,6 +466,7 @@ static inline void REGISTER_2118_linear (uint8 Byte)
 {
 	if(CHECK_INBLANK1(PPU, CPU))
 		return;
+	FLUSH_BANDS();
 
 	uint32	address;
 
@@ -484,6 +519,7 @@ static inline void REGISTER_2119 (uint8 Byte)
 {
 	if(CHECK_INBLANK2(PPU, CPU))
 		return;
+	FLUSH_BANDS();
 	uint32	address;
 
 	if (PPU.VMA.FullGraphicCount)
@@ -521,6 +557,7 @@ static inline void REGISTER_2119_tile (uint8 Byte)
 {
 	if(CHECK_INBLANK2(PPU, CPU))
 		return;
+	FLUSH_BANDS();
 
 	uint32 rem = PPU.VMA.Address & PPU.VMA.Mask1;
 	uint32 address = ((((PPU.VMA.Address & ~PPU.VMA.Mask1) + (rem >> PPU.VMA.Shift) + ((rem & (PPU.VMA.FullGraphicCount - 1)) << 3)) << 1) + 1) & 0xffff;
@@ -547,6 +584,7 @@ static inline void REGISTER_2119_linear (uint8 Byte)
 {
 	if(CHECK_INBLANK2(PPU, CPU))
 		return;
+	FLUSH_BANDS();
 
 	uint32	address;
 
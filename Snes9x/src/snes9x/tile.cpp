@@ -330,14 +330,17 @@ extern template struct TileImpl::Renderers<DrawTile16, HiresInterlace>;
 extern template struct TileImpl::Renderers<DrawClippedTile16, HiresInterlace>;
 extern template struct TileImpl::Renderers<DrawMosaicPixel16, HiresInterlace>;
 
-void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
+void S9xSelectTileRenderers (SGFX &GFX, int BGMode, bool8 sub, bool8 obj)
 {
-	void	(**DT)		(uint32, uint32, uint32, uint32);
-	void	(**DCT)		(uint32, uint32, uint32, uint32, uint32, uint32);
-	void	(**DMP)		(uint32, uint32, uint32, uint32, uint32, uint32);
-	void	(**DB)		(uint32, uint32, uint32);
-	void	(**DM7BG1)	(uint32, uint32, int);
-	void	(**DM7BG2)	(uint32, uint32, int);
+	const SPPU	&PPU = GFX.Band->PPU;
+	const auto	&IPPU = GFX.Band->IPPU;
+
+	void	(**DT)		(SGFX &, SBG &, uint32, uint32, uint32, uint32);
+	void	(**DCT)		(SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
+	void	(**DMP)		(SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
+	void	(**DB)		(SGFX &, uint32, uint32, uint32);
+	void	(**DM7BG1)	(SGFX &, uint32, uint32, int);
+	void	(**DM7BG2)	(SGFX &, uint32, uint32, int);
 	bool8	M7M1, M7M2;
 
 	M7M1 = PPU.BGMosaic[0] && PPU.Mosaic > 1;
@@ -416,11 +419,11 @@ void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 		i = 0;
 	else
 	{
-		i = (Memory.FillRAM[0x2131] & 0x80) ? 4 : 1;
-		if (Memory.FillRAM[0x2131] & 0x40)
+		i = (GFX.Band->Reg(0x2131) & 0x80) ? 4 : 1;
+		if (GFX.Band->Reg(0x2131) & 0x40)
 		{
 			i++;
-			if (Memory.FillRAM[0x2130] & 2)
+			if (GFX.Band->Reg(0x2130) & 2)
 				i++;
 		}
 		if (IPPU.MaxBrightness != 0xf)
@@ -441,7 +444,7 @@ void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 	GFX.DrawMode7BG2Math    = DM7BG2[i];
 }
 
-void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
+void S9xSelectTileConverter (const SGFX &GFX, SBG &BG, int depth, bool8 hires, bool8 sub, bool8 mosaic)
 {
 	switch (depth)
 	{
@@ -452,7 +455,7 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 			BG.TileShift        = 6;
 			BG.PaletteShift     = 0;
 			BG.PaletteMask      = 0;
-			BG.DirectColourMode = Memory.FillRAM[0x2130] & 1;
+			BG.DirectColourMode = GFX.Band->Reg(0x2130) & 1;
 
 			break;
 
@@ -8,7 +8,7 @@
 #define _TILE_H_
 
 void S9xInitTileRenderer (void);
-void S9xSelectTileRenderers (int, bool8, bool8);
-void S9xSelectTileConverter (int, bool8, bool8, bool8);
+void S9xSelectTileRenderers (SGFX &, int, bool8, bool8);
+void S9xSelectTileConverter (const SGFX &, SBG &, int, bool8, bool8, bool8);
 
 #endif
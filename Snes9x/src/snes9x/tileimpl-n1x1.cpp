@@ -10,12 +10,12 @@
 namespace TileImpl {
 
 	template<class MATH, class BPSTART>
-	void Normal1x1Base<MATH, BPSTART>::Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2)
+	void Normal1x1Base<MATH, BPSTART>::Draw(SGFX &GFX, int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2)
 	{
 		(void) OffsetInLine;
 		if (Z1 > GFX.DB[Offset + N] && (M))
 		{
-			GFX.S[Offset + N] = MATH::Calc(GFX.ScreenColors[Pix], GFX.SubScreen[Offset + N], GFX.SubZBuffer[Offset + N]);
+			GFX.S[Offset + N] = MATH::Calc(GFX, GFX.ScreenColors[Pix], GFX.SubScreen[Offset + N], GFX.SubZBuffer[Offset + N]);
 			GFX.DB[Offset + N] = Z2;
 		}
 	}
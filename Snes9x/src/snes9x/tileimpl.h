@@ -10,6 +10,7 @@
 #include "snes9x.h"
 #include "ppu.h"
 #include "tile.h"
+#include <thread>
 
 
 
@@ -21,7 +22,7 @@ namespace TileImpl {
 	struct BPProgressive
 	{
 		enum { Pitch = 1 };
-		static alwaysinline uint32 Get(uint32 StartLine) { return StartLine; }
+		static alwaysinline uint32 Get(const SBG &BG, uint32 StartLine) { return StartLine; }
 	};
 
 	// Interlace: Only draw every other line, so we'll redefine bpstart_t and Pitch to do so.
@@ -29,7 +30,7 @@ namespace TileImpl {
 	struct BPInterlace
 	{
 		enum { Pitch = 2 };
-		static alwaysinline uint32 Get(uint32 StartLine) { return StartLine * 2 + BG.InterlaceLine; }
+		static alwaysinline uint32 Get(const SBG &BG, uint32 StartLine) { return StartLine * 2 + BG.InterlaceLine; }
 	};
 
 
@@ -40,7 +41,7 @@ namespace TileImpl {
 		enum { Pitch = BPSTART::Pitch };
 		typedef BPSTART bpstart_t;
 
-		static void Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
+		static void Draw(SGFX &GFX, int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
 	};
 
 	template<class MATH>
@@ -54,7 +55,7 @@ namespace TileImpl {
 		enum { Pitch = BPSTART::Pitch };
 		typedef BPSTART bpstart_t;
 
-		static void Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
+		static void Draw(SGFX &GFX, int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
 	};
 
 	template<class MATH>
@@ -77,7 +78,7 @@ namespace TileImpl {
 		enum { Pitch = BPSTART::Pitch };
 		typedef BPSTART bpstart_t;
 
-		static void Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
+		static void Draw(SGFX &GFX, int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
 	};
 
 	template<class MATH>
@@ -89,7 +90,7 @@ namespace TileImpl {
 	class CachedTile
 	{
 	public:
-		CachedTile(uint32 tile) : Tile(tile) {}
+		CachedTile(SGFX &gfx, SBG &bg, uint32 tile) : GFX(gfx), BG(bg), Tile(tile) {}
 
 		alwaysinline void GetCachedTile()
 		{
@@ -101,20 +102,40 @@ namespace TileImpl {
 			if (Tile & H_FLIP)
 			{
 				pCache = &BG.BufferFlip[TileNumber << 6];
-				if (!BG.BufferedFlip[TileNumber])
-					BG.BufferedFlip[TileNumber] = BG.ConvertTileFlip(pCache, TileAddr, Tile & 0x3ff);
+				if (!IsConverted(BG.BufferedFlip[TileNumber]))
+					Convert(BG.BufferedFlip[TileNumber], BG.ConvertTileFlip);
 			}
 			else
 			{
 				pCache = &BG.Buffer[TileNumber << 6];
-				if (!BG.Buffered[TileNumber])
-					BG.Buffered[TileNumber] = BG.ConvertTile(pCache, TileAddr, Tile & 0x3ff);
+				if (!IsConverted(BG.Buffered[TileNumber]))
+					Convert(BG.Buffered[TileNumber], BG.ConvertTile);
 			}
 		}
 
+		static alwaysinline bool IsConverted(uint8 &buffered)
+		{
+			uint8	state = __atomic_load_n(&buffered, __ATOMIC_ACQUIRE);
+			return state && state != CONVERTING_TILE;
+		}
+
+		// Other render threads may want the same tile, the first one to claim
+		// it converts while the rest wait for the result, yielding since the
+		// converting thread may have been preempted
+		void Convert(uint8 &buffered, uint8 (*convert) (uint8 *, uint32, uint32))
+		{
+			uint8	unconverted = 0;
+
+			if (__atomic_compare_exchange_n(&buffered, &unconverted, CONVERTING_TILE, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+				__atomic_store_n(&buffered, convert(pCache, TileAddr, Tile & 0x3ff), __ATOMIC_RELEASE);
+			else
+				while (__atomic_load_n(&buffered, __ATOMIC_ACQUIRE) == CONVERTING_TILE)
+					std::this_thread::yield();
+		}
+
 		alwaysinline bool IsBlankTile() const
 		{
-			return ((Tile & H_FLIP) ? BG.BufferedFlip[TileNumber] : BG.Buffered[TileNumber]) == BLANK_TILE;
+			return __atomic_load_n((Tile & H_FLIP) ? &BG.BufferedFlip[TileNumber] : &BG.Buffered[TileNumber], __ATOMIC_RELAXED) == BLANK_TILE;
 		}
 
 		alwaysinline void SelectPalette() const
@@ -124,7 +145,7 @@ namespace TileImpl {
 				GFX.RealScreenColors = DirectColourMaps[(Tile >> 10) & 7];
 			}
 			else
-				GFX.RealScreenColors = &IPPU.ScreenColors[((Tile >> BG.PaletteShift) & BG.PaletteMask) + BG.StartPalette];
+				GFX.RealScreenColors = &GFX.Band->IPPU.ScreenColors[((Tile >> BG.PaletteShift) & BG.PaletteMask) + BG.StartPalette];
 			GFX.ScreenColors = GFX.ClipColors ? BlackColourMap : GFX.RealScreenColors;
 		}
 
@@ -134,6 +155,8 @@ namespace TileImpl {
 		}
 
 	private:
+		SGFX   &GFX;
+		SBG    &BG;
 		uint8  *pCache;
 		uint32 Tile;
 		uint32 TileNumber;
@@ -143,7 +166,7 @@ namespace TileImpl {
 
 	struct NOMATH
 	{
-		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
+		static alwaysinline uint16 Calc(const SGFX &GFX, uint16 Main, uint16 Sub, uint8 SD)
 		{
 			return Main;
 		}
@@ -153,7 +176,7 @@ namespace TileImpl {
 	template<class Op>
 	struct REGMATH
 	{
-		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
+		static alwaysinline uint16 Calc(const SGFX &GFX, uint16 Main, uint16 Sub, uint8 SD)
 		{
 			return Op::fn(Main, (SD & 0x20) ? Sub : GFX.FixedColour);
 		}
@@ -165,7 +188,7 @@ namespace TileImpl {
 	template<class Op>
 	struct MATHF1_2
 	{
-		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
+		static alwaysinline uint16 Calc(const SGFX &GFX, uint16 Main, uint16 Sub, uint8 SD)
 		{
 			return GFX.ClipColors ? Op::fn(Main, GFX.FixedColour) : Op::fn1_2(Main, GFX.FixedColour);
 		}
@@ -176,9 +199,9 @@ namespace TileImpl {
 	template<class Op>
 	struct MATHS1_2
 	{
-		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
+		static alwaysinline uint16 Calc(const SGFX &GFX, uint16 Main, uint16 Sub, uint8 SD)
 		{
-			return GFX.ClipColors ? REGMATH<Op>::Calc(Main, Sub, SD) : (SD & 0x20) ? Op::fn1_2(Main, Sub) : Op::fn(Main, GFX.FixedColour);
+			return GFX.ClipColors ? REGMATH<Op>::Calc(GFX, Main, Sub, SD) : (SD & 0x20) ? Op::fn1_2(Main, Sub) : Op::fn(Main, GFX.FixedColour);
 		}
 	};
 	typedef MATHS1_2<COLOR_ADD> Blend_AddS1_2;
@@ -229,21 +252,21 @@ namespace TileImpl {
 
 	#define OFFSET_IN_LINE \
 		uint32 OffsetInLine = Offset % GFX.RealPPL;
-	#define DRAW_PIXEL(N, M) PIXEL::Draw(N, M, Offset, OffsetInLine, Pix, Z1, Z2)
+	#define DRAW_PIXEL(N, M) PIXEL::Draw(GFX, N, M, Offset, OffsetInLine, Pix, Z1, Z2)
 	#define Z1	GFX.Z1
 	#define Z2	GFX.Z2
 
 	template<class PIXEL>
 	struct DrawTile16
 	{
-		typedef void (*call_t)(uint32, uint32, uint32, uint32);
+		typedef void (*call_t)(SGFX &, SBG &, uint32, uint32, uint32, uint32);
 
 		enum { Pitch = PIXEL::Pitch };
 		typedef typename PIXEL::bpstart_t bpstart_t;
 
-		static void Draw(uint32 Tile, uint32 Offset, uint32 StartLine, uint32 LineCount)
+		static void Draw(SGFX &GFX, SBG &BG, uint32 Tile, uint32 Offset, uint32 StartLine, uint32 LineCount)
 		{
-			CachedTile cache(Tile);
+			CachedTile cache(GFX, BG, Tile);
 			int32	l;
 			uint8	*bp, Pix;
 
@@ -254,7 +277,7 @@ namespace TileImpl {
 
 			if (!(Tile & (V_FLIP | H_FLIP)))
 			{
-				bp = cache.Ptr() + bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp += 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -266,7 +289,7 @@ namespace TileImpl {
 			else
 			if (!(Tile & V_FLIP))
 			{
-				bp = cache.Ptr() + bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp += 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -278,7 +301,7 @@ namespace TileImpl {
 			else
 			if (!(Tile & H_FLIP))
 			{
-				bp = cache.Ptr() + 56 - bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + 56 - bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp -= 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -289,7 +312,7 @@ namespace TileImpl {
 			}
 			else
 			{
-				bp = cache.Ptr() + 56 - bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + 56 - bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp -= 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -312,14 +335,14 @@ namespace TileImpl {
 	template<class PIXEL>
 	struct DrawClippedTile16
 	{
-		typedef void (*call_t)(uint32, uint32, uint32, uint32, uint32, uint32);
+		typedef void (*call_t)(SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
 
 		enum { Pitch = PIXEL::Pitch };
 		typedef typename PIXEL::bpstart_t bpstart_t;
 
-		static void Draw(uint32 Tile, uint32 Offset, uint32 StartPixel, uint32 Width, uint32 StartLine, uint32 LineCount)
+		static void Draw(SGFX &GFX, SBG &BG, uint32 Tile, uint32 Offset, uint32 StartPixel, uint32 Width, uint32 StartLine, uint32 LineCount)
 		{
-			CachedTile cache(Tile);
+			CachedTile cache(GFX, BG, Tile);
 			int32	l;
 			uint8	*bp, Pix, w;
 
@@ -330,7 +353,7 @@ namespace TileImpl {
 
 			if (!(Tile & (V_FLIP | H_FLIP)))
 			{
-				bp = cache.Ptr() + bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp += 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -351,7 +374,7 @@ namespace TileImpl {
 			else
 			if (!(Tile & V_FLIP))
 			{
-				bp = cache.Ptr() + bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp += 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -372,7 +395,7 @@ namespace TileImpl {
 			else
 			if (!(Tile & H_FLIP))
 			{
-				bp = cache.Ptr() + 56 - bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + 56 - bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp -= 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -392,7 +415,7 @@ namespace TileImpl {
 			}
 			else
 			{
-				bp = cache.Ptr() + 56 - bpstart_t::Get(StartLine);
+				bp = cache.Ptr() + 56 - bpstart_t::Get(BG, StartLine);
 				OFFSET_IN_LINE;
 				for (l = LineCount; l > 0; l--, bp -= 8 * Pitch, Offset += GFX.PPL)
 				{
@@ -425,13 +448,13 @@ namespace TileImpl {
 	template<class PIXEL>
 	struct DrawMosaicPixel16
 	{
-		typedef void (*call_t)(uint32, uint32, uint32, uint32, uint32, uint32);
+		typedef void (*call_t)(SGFX &, SBG &, uint32, uint32, uint32, uint32, uint32, uint32);
 
 		typedef typename PIXEL::bpstart_t bpstart_t;
 
-		static void Draw(uint32 Tile, uint32 Offset, uint32 StartLine, uint32 StartPixel, uint32 Width, uint32 LineCount)
+		static void Draw(SGFX &GFX, SBG &BG, uint32 Tile, uint32 Offset, uint32 StartLine, uint32 StartPixel, uint32 Width, uint32 LineCount)
 		{
-			CachedTile cache(Tile);
+			CachedTile cache(GFX, BG, Tile);
 			int32	l, w;
 			uint8	Pix;
 
@@ -444,9 +467,9 @@ namespace TileImpl {
 				StartPixel = 7 - StartPixel;
 
 			if (Tile & V_FLIP)
-				Pix = cache.Ptr()[56 - bpstart_t::Get(StartLine) + StartPixel];
+				Pix = cache.Ptr()[56 - bpstart_t::Get(BG, StartLine) + StartPixel];
 			else
-				Pix = cache.Ptr()[bpstart_t::Get(StartLine) + StartPixel];
+				Pix = cache.Ptr()[bpstart_t::Get(BG, StartLine) + StartPixel];
 
 			if (Pix)
 			{
@@ -475,13 +498,13 @@ namespace TileImpl {
 	template<class PIXEL>
 	struct DrawBackdrop16
 	{
-		typedef void (*call_t)(uint32 Offset, uint32 Left, uint32 Right);
+		typedef void (*call_t)(SGFX &GFX, uint32 Offset, uint32 Left, uint32 Right);
 
-		static void Draw(uint32 Offset, uint32 Left, uint32 Right)
+		static void Draw(SGFX &GFX, uint32 Offset, uint32 Left, uint32 Right)
 		{
 			uint32	l, x;
 
-			GFX.RealScreenColors = IPPU.ScreenColors;
+			GFX.RealScreenColors = GFX.Band->IPPU.ScreenColors;
 			GFX.ScreenColors = GFX.ClipColors ? BlackColourMap : GFX.RealScreenColors;
 
 			OFFSET_IN_LINE;
@@ -508,7 +531,7 @@ namespace TileImpl {
 
 	#define CLIP_10_BIT_SIGNED(a)	(((a) & 0x2000) ? ((a) | ~0x3ff) : ((a) & 0x3ff))
 
-	#define DRAW_PIXEL(N, M) PIXEL::Draw(N, M, Offset, OffsetInLine, Pix, OP::Z1(D, b), OP::Z2(D, b))
+	#define DRAW_PIXEL(N, M) PIXEL::Draw(GFX, N, M, Offset, OffsetInLine, Pix, OP::Z1(D, b), OP::Z2(D, b))
 
 	struct DrawMode7BG1_OP
 	{
@@ -518,7 +541,7 @@ namespace TileImpl {
 		};
 		static uint8 Z1(int D, uint8 b) { return D + 7; }
 		static uint8 Z2(int D, uint8 b) { return D + 7; }
-		static uint8 DCMODE() { return Memory.FillRAM[0x2130] & 1; }
+		static uint8 DCMODE(const SGFX &GFX) { return GFX.Band->Reg(0x2130) & 1; }
 	};
 	struct DrawMode7BG2_OP
 	{
@@ -528,24 +551,25 @@ namespace TileImpl {
 		};
 		static uint8 Z1(int D, uint8 b) { return D + ((b & 0x80) ? 11 : 3); }
 		static uint8 Z2(int D, uint8 b) { return D + ((b & 0x80) ? 11 : 3); }
-		static uint8 DCMODE() { return 0; }
+		static uint8 DCMODE(const SGFX &) { return 0; }
 	};
 
 	template<class PIXEL, class OP>
 	struct DrawTileNormal
 	{
-		typedef void (*call_t)(uint32 Left, uint32 Right, int D);
+		typedef void (*call_t)(SGFX &GFX, uint32 Left, uint32 Right, int D);
 
-		static void Draw(uint32 Left, uint32 Right, int D)
+		static void Draw(SGFX &GFX, uint32 Left, uint32 Right, int D)
 		{
+			const SPPU	&PPU = GFX.Band->PPU;
 			uint8	*VRAM1 = Memory.VRAM + 1;
 
-			if (OP::DCMODE())
+			if (OP::DCMODE(GFX))
 			{
 				GFX.RealScreenColors = DirectColourMaps[0];
 			}
 			else
-				GFX.RealScreenColors = IPPU.ScreenColors;
+				GFX.RealScreenColors = GFX.Band->IPPU.ScreenColors;
 
 			GFX.ScreenColors = GFX.ClipColors ? BlackColourMap : GFX.RealScreenColors;
 
@@ -643,18 +667,19 @@ namespace TileImpl {
 	template<class PIXEL, class OP>
 	struct DrawTileMosaic
 	{
-		typedef void (*call_t)(uint32 Left, uint32 Right, int D);
+		typedef void (*call_t)(SGFX &GFX, uint32 Left, uint32 Right, int D);
 
-		static void Draw(uint32 Left, uint32 Right, int D)
+		static void Draw(SGFX &GFX, uint32 Left, uint32 Right, int D)
 		{
+			const SPPU	&PPU = GFX.Band->PPU;
 			uint8	*VRAM1 = Memory.VRAM + 1;
 
-			if (OP::DCMODE())
+			if (OP::DCMODE(GFX))
 			{
 				GFX.RealScreenColors = DirectColourMaps[0];
 			}
 			else
-				GFX.RealScreenColors = IPPU.ScreenColors;
+				GFX.RealScreenColors = GFX.Band->IPPU.ScreenColors;
 
 			GFX.ScreenColors = GFX.ClipColors ? BlackColourMap : GFX.RealScreenColors;
 
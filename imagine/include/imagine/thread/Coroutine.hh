@@ -0,0 +1,63 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <memory>
+#include <thread>
+
+namespace IG
+{
+
+// Stackful coroutine for running code that never returns (like an emulator's
+// main loop) on the calling thread. resume() switches to the coroutine's stack
+// and runs until it calls yield(), the next resume() continues after that yield().
+// Switching only saves callee-saved registers so it costs about as much as a
+// function call, unlike handing off to a thread. Suspended frames may hold
+// addresses of the thread's TLS (like errno's), so a coroutine must always be
+// resumed on the thread that first resumed it.
+
+class Coroutine
+{
+public:
+	using EntryDelegate = DelegateFunc<void()>;
+	static constexpr size_t DEFAULT_STACK_SIZE = 1024 * 1024;
+
+	Coroutine() {}
+	Coroutine(EntryDelegate entry, size_t stackSize = DEFAULT_STACK_SIZE);
+	// the stack holds a pointer to the object, so it can't be moved
+	Coroutine(const Coroutine &) = delete;
+	Coroutine &operator=(const Coroutine &) = delete;
+	void resume();
+	void yield();
+	bool isActive() const { return active; }
+	bool hasFinished() const { return finished; }
+	explicit operator bool() const { return (bool)stack; }
+
+protected:
+	std::unique_ptr<uint8_t[]> stack{};
+	void *stackPtr{};
+	void *callerStackPtr{};
+	EntryDelegate entry{};
+	std::thread::id resumeThread{};
+	bool active{};
+	bool finished{};
+
+	static void run(Coroutine *co);
+};
+
+}
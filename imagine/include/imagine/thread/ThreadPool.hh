@@ -0,0 +1,132 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/thread/Semaphore.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace IG
+{
+
+enum class TaskPriority : uint8_t
+{
+	REALTIME,   // work a frame is waiting on, like parallel renderer lanes
+	NORMAL,
+	BACKGROUND, // I/O, compression, indexing
+};
+
+// Bounded set of worker threads shared by code that would otherwise start its own.
+// Each worker has a deque per priority, a worker runs tasks from the back of its
+// own deques and steals from the front of the others' when out of work. Background
+// tasks run at a lower thread priority and never occupy every worker when there's
+// more than one, so real-time tasks always have a thread to run on.
+
+class ThreadPool
+{
+public:
+	static constexpr unsigned PRIORITIES = 3;
+	using TaskDelegate = DelegateFunc2<sizeof(uintptr_t)*4, void()>;
+
+	struct Config
+	{
+		// 0 uses one less than the number of performance cores,
+		// leaving one for the thread submitting the work
+		unsigned threads{};
+		int nice{};
+		int backgroundNice = 10;
+		// keep workers off the efficiency cores of big.LITTLE CPUs
+		bool usePerformanceCores = true;
+	};
+
+	ThreadPool(Config config);
+	ThreadPool(): ThreadPool(Config{}) {}
+	~ThreadPool();
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+	// task captures are copied like a DelegateFunc, so keep them small and trivially copyable
+	void run(TaskDelegate task, TaskPriority priority = TaskPriority::NORMAL);
+	// run one queued task of at least the given priority on the calling thread
+	bool runPendingTask(TaskPriority lowestPriority = TaskPriority::BACKGROUND);
+	unsigned threads() const { return workers.size(); }
+	static ThreadPool &shared();
+
+	// call func(i) for each i in [begin, end) on up to maxLanes threads (0 for
+	// no limit) including the calling one, returning once every call finished
+	template<class Func>
+	void parallelFor(unsigned begin, unsigned end, Func &&func, unsigned maxLanes = 0)
+	{
+		if(begin >= end)
+			return;
+		ParallelForJob job
+		{
+			[](void *ctx, unsigned i)
+			{
+				(*(std::remove_reference_t<Func>*)ctx)(i);
+			},
+			(void*)&func, begin, end
+		};
+		runParallelFor(job, maxLanes);
+	}
+
+protected:
+	struct Worker
+	{
+		std::mutex lock{};
+		std::array<std::deque<TaskDelegate>, PRIORITIES> queue{};
+		std::thread thread{};
+	};
+
+	struct ParallelForJob
+	{
+		void (*func)(void *ctx, unsigned i);
+		void *ctx;
+		std::atomic_uint next;
+		unsigned end;
+		std::atomic_uint activeRunners{};
+		Semaphore done{0};
+
+		ParallelForJob(void (*func)(void *, unsigned), void *ctx, unsigned begin, unsigned end):
+			func{func}, ctx{ctx}, next{begin}, end{end} {}
+		void runIndices();
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers{};
+	std::mutex sleepLock{};
+	std::condition_variable wake{};
+	std::array<std::atomic_uint, PRIORITIES> queued{};
+	std::atomic_uint runningBackground{};
+	std::atomic_uint nextQueue{};
+	unsigned backgroundLimit{};
+	int nice{}, backgroundNice{};
+	bool quit{};
+
+	void workerLoop(unsigned idx, std::vector<int> cpus);
+	bool hasRunnableTask() const;
+	bool takeTask(unsigned priority, TaskDelegate &task);
+	void runParallelFor(ParallelForJob &job, unsigned maxLanes);
+};
+
+}
@@ -8,6 +8,10 @@ endif
 
 CFLAGS_OPTIMIZE_DEBUG_DEFAULT ?= -O1
 
+ifdef PGO
+ $(error PGO builds are only set up for GCC)
+endif
+
 CFLAGS_WARN += -Wno-attributes -Wno-missing-braces
 
 ifndef RELEASE
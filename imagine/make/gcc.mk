@@ -31,6 +31,22 @@ else
  LDFLAGS_SYSTEM += -fno-lto
 endif
 
+# Profile-guided optimization: build with PGO := generate, run the binary on
+# a typical workload so it writes .gcda files next to its objects, then
+# rebuild the same objects with PGO := use (see pgoBuild.sh)
+ifeq ($(PGO),generate)
+ CFLAGS_CODEGEN += -fprofile-generate -fprofile-update=prefer-atomic
+ LDFLAGS_SYSTEM += -fprofile-generate
+else ifeq ($(PGO),use)
+ # code the workload never ran keeps its normal optimization and
+ # functions edited since the profile was made are built without it
+ CFLAGS_CODEGEN += -fprofile-use -fprofile-partial-training -fprofile-correction
+ CFLAGS_WARN += -Wno-missing-profile -Wno-coverage-mismatch
+ LDFLAGS_SYSTEM += -fprofile-use
+else ifdef PGO
+ $(error PGO must be generate or use)
+endif
+
 CFLAGS_WARN += $(if $(ccNoStrictAliasing),,-Werror=strict-aliasing) -fmax-errors=15
 
 ifdef RELEASE
@@ -0,0 +1,114 @@
+#!/bin/bash
+
+# Profile-guided builds of an EmuFramework app for linux-x86_64. Run from the
+# app's directory with IMAGINE_PATH set and imagine/EmuFramework already built.
+#
+# pgoBuild.sh train    build an instrumented binary, run the benchmark set and
+#                      store its profile in pgo/linux-x86_64
+# pgoBuild.sh build    build with the stored profile
+# pgoBuild.sh compare  run the benchmark set on the release and PGO builds and
+#                      write the speedups to pgo/linux-x86_64/report.txt
+#
+# pgo/benchmark.txt lists the workload, one "game [state] frames" entry per
+# line with paths relative to PGO_MEDIA_PATH. The app needs a display, set
+# PGO_RUN="xvfb-run -a" to run the benchmarks without one.
+#
+# Profiles are stored as .gcda files laid out like the object directory
+# (format 1), their VERSION file records the GCC that made them since GCC
+# ignores .gcda files from other versions.
+
+formatVersion=1
+pgoDir=pgo
+profileDir=$pgoDir/linux-x86_64
+objDir=build/linux-x86_64-release-pgo/obj
+pgoTargetDir=target/linux-pgo
+releaseTargetDir=target/linux
+MAKE=${MAKE:-make}
+gccVersion=$(${CC:-gcc} -dumpfullversion)
+
+die()
+{
+	echo "$@" >&2
+	exit 1
+}
+
+findExec()
+{
+	find "$1" -maxdepth 1 -type f -executable ! -name '*-debug' 2>/dev/null | head -n 1
+}
+
+# print each benchmark result line from the given binary
+runBenchmarks()
+{
+	local exe=$1
+	[ -x "$exe" ] || die "missing app binary in $(dirname "$exe")"
+	local entries=0
+	while read -r game state frames
+	do
+		case "$game" in
+			''|'#'*) continue;;
+		esac
+		if [ -z "$frames" ]
+		then
+			frames=$state
+			state=
+		fi
+		local args=(-benchmark=$frames)
+		[ -n "$state" ] && args+=("-benchmark-state=$PGO_MEDIA_PATH/$state")
+		$PGO_RUN "$exe" "${args[@]}" "$PGO_MEDIA_PATH/$game" < /dev/null | grep '^benchmark:' \
+			|| die "benchmark of $game failed"
+		entries=$((entries + 1))
+	done < $pgoDir/benchmark.txt
+	[ $entries -gt 0 ] || die "no entries in $pgoDir/benchmark.txt"
+}
+
+train()
+{
+	$MAKE -f linux-x86_64-release-pgo-generate.mk -B -j$(nproc) || exit 1
+	find $objDir -name '*.gcda' -delete
+	runBenchmarks "$(findExec $pgoTargetDir)"
+	rm -rf $profileDir
+	mkdir -p $profileDir
+	(cd $objDir && find . -name '*.gcda' | tar -cf - -T -) | (cd $profileDir && tar -xf -)
+	printf 'format %s\ngcc %s\n' $formatVersion "$gccVersion" > $profileDir/VERSION
+	echo "stored $(find $profileDir -name '*.gcda' | wc -l) profiles in $profileDir"
+}
+
+build()
+{
+	[ -f $profileDir/VERSION ] || die "no profile in $profileDir, run train first"
+	local storedFormat=$(sed -n 's/^format //p' $profileDir/VERSION)
+	local storedGCC=$(sed -n 's/^gcc //p' $profileDir/VERSION)
+	[ "$storedFormat" = $formatVersion ] || die "profile format $storedFormat isn't supported, run train again"
+	[ "$storedGCC" = "$gccVersion" ] \
+		|| echo "warning: profile is from GCC $storedGCC and will be ignored by GCC $gccVersion, run train again" >&2
+	mkdir -p $objDir
+	find $objDir -name '*.gcda' -delete
+	(cd $profileDir && find . -name '*.gcda' | tar -cf - -T -) | (cd $objDir && tar -xf -)
+	$MAKE -f linux-x86_64-release-pgo-use.mk -B -j$(nproc) || exit 1
+}
+
+compare()
+{
+	local baselineMakefile=linux-x86_64-release.mk
+	[ -f $baselineMakefile ] || baselineMakefile=linux-x86_64-release-static.mk
+	$MAKE -f $baselineMakefile -j$(nproc) || exit 1
+	local release pgo
+	release=$(runBenchmarks "$(findExec $releaseTargetDir)") || exit 1
+	pgo=$(runBenchmarks "$(findExec $pgoTargetDir)") || exit 1
+	local results='s/^benchmark: (.*): [0-9]+ frames in .*, ([0-9.]+) fps$/\1\t\2/'
+	{
+		echo "GCC $gccVersion, $(date -u +%Y-%m-%d)"
+		printf '%-40s %10s %10s %8s\n' game release pgo speedup
+		paste <(sed -E "$results" <<< "$release") <(sed -E "$results" <<< "$pgo") \
+			| awk -F'\t' '{ printf "%-40s %10.2f %10.2f %+7.1f%%\n", $1, $2, $4, ($4 / $2 - 1) * 100 }'
+	} | tee $profileDir/report.txt
+}
+
+[ -n "$IMAGINE_PATH" ] || die "IMAGINE_PATH isn't set"
+[ -f build.mk ] || die "run from an app's directory"
+
+case "$1" in
+	train|build|compare) $1;;
+	*) die "usage: $0 train|build|compare";;
+esac
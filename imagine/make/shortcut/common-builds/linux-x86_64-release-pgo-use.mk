@@ -0,0 +1,10 @@
+include $(IMAGINE_PATH)/make/config.mk
+O_RELEASE := 1
+LTO_MODE ?= lto
+PGO := use
+# both PGO steps share objects so profiles are found next to them
+buildName := linux-x86_64-release-pgo
+targetDir := target/linux-pgo
+-include $(projectPath)/config.mk
+include $(IMAGINE_PATH)/make/linux-x86_64-gcc.mk
+include $(projectPath)/build.mk
@@ -0,0 +1,394 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Coroutine"
+#include <imagine/thread/Coroutine.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/utility.h>
+#include <algorithm>
+#include <cstring>
+
+// IG_switchStack(void **saveStackPtr, void *loadStackPtr) pushes the callee-saved
+// registers, stores the stack pointer in *saveStackPtr, then loads loadStackPtr
+// and pops the registers saved there. A new stack is prepared so the first
+// switch "returns" into IG_coroutineEntry with the entry function and its
+// argument in callee-saved registers. On x86 the mxcsr and x87 control word
+// are callee-saved too, so each stack keeps its own rounding and denormal
+// modes. CFI notes let debuggers unwind through a switch and stop at
+// IG_coroutineEntry, the bottom of a coroutine's stack.
+
+#ifdef __APPLE__
+#define ASM_SYM(name) "_" #name
+#define ASM_FUNC_TYPE(name)
+#define ASM_PUSH_TEXT ".pushsection __TEXT,__text,regular,pure_instructions\n"
+#else
+#define ASM_SYM(name) #name
+#define ASM_FUNC_TYPE(name) ".type " #name ", %function\n"
+#define ASM_PUSH_TEXT ".pushsection .text\n"
+#endif
+#define ASM_POP_SECTION ".popsection\n"
+
+extern "C"
+{
+	void IG_switchStack(void **saveStackPtr, void *loadStackPtr);
+	void IG_coroutineEntry();
+}
+
+#if defined __x86_64__
+
+#define ASM_PUSH(reg) \
+	"	pushq %" #reg "\n" \
+	"	.cfi_adjust_cfa_offset 8\n" \
+	"	.cfi_rel_offset %" #reg ", 0\n"
+#define ASM_POP(reg) \
+	"	popq %" #reg "\n" \
+	"	.cfi_adjust_cfa_offset -8\n" \
+	"	.cfi_restore %" #reg "\n"
+
+asm(
+	ASM_PUSH_TEXT
+	".globl " ASM_SYM(IG_switchStack) "\n"
+	ASM_FUNC_TYPE(IG_switchStack)
+	".p2align 4\n"
+	ASM_SYM(IG_switchStack) ":\n"
+	"	.cfi_startproc\n"
+	ASM_PUSH(rbp)
+	ASM_PUSH(rbx)
+	ASM_PUSH(r12)
+	ASM_PUSH(r13)
+	ASM_PUSH(r14)
+	ASM_PUSH(r15)
+	"	subq $8, %rsp\n"
+	"	.cfi_adjust_cfa_offset 8\n"
+	"	stmxcsr (%rsp)\n"
+	"	fnstcw 4(%rsp)\n"
+	"	movq %rsp, (%rdi)\n"
+	"	movq %rsi, %rsp\n"
+	"	ldmxcsr (%rsp)\n"
+	"	fldcw 4(%rsp)\n"
+	"	addq $8, %rsp\n"
+	"	.cfi_adjust_cfa_offset -8\n"
+	ASM_POP(r15)
+	ASM_POP(r14)
+	ASM_POP(r13)
+	ASM_POP(r12)
+	ASM_POP(rbx)
+	ASM_POP(rbp)
+	"	ret\n"
+	"	.cfi_endproc\n"
+	".globl " ASM_SYM(IG_coroutineEntry) "\n"
+	ASM_FUNC_TYPE(IG_coroutineEntry)
+	".p2align 4\n"
+	ASM_SYM(IG_coroutineEntry) ":\n"
+	"	.cfi_startproc\n"
+	"	.cfi_undefined %rip\n"
+	"	movq %r12, %rdi\n"
+	"	callq *%r13\n"
+	"	ud2\n"
+	"	.cfi_endproc\n"
+	ASM_POP_SECTION
+);
+
+// mxcsr/fpu control word, r15, r14, r13, r12 (arg), rbx, rbp, return address
+static constexpr int STACK_FRAME_WORDS = 8;
+static constexpr int ARG_WORD = 4, FUNC_WORD = 3, RETURN_WORD = 7;
+
+static void initFPControlWords(uintptr_t *frame)
+{
+	uint32_t fpCtrl[2]{0x1F80, 0x037F}; // default mxcsr & x87 control word
+	memcpy(frame, fpCtrl, sizeof(fpCtrl));
+}
+
+#elif defined __i386__
+
+#define ASM_PUSH(reg) \
+	"	pushl %" #reg "\n" \
+	"	.cfi_adjust_cfa_offset 4\n" \
+	"	.cfi_rel_offset %" #reg ", 0\n"
+#define ASM_POP(reg) \
+	"	popl %" #reg "\n" \
+	"	.cfi_adjust_cfa_offset -4\n" \
+	"	.cfi_restore %" #reg "\n"
+
+// targets without SSE leave the mxcsr slot unused
+#if defined __SSE__
+#define ASM_MXCSR_SAVE "	stmxcsr (%esp)\n"
+#define ASM_MXCSR_LOAD "	ldmxcsr (%esp)\n"
+#else
+#define ASM_MXCSR_SAVE
+#define ASM_MXCSR_LOAD
+#endif
+
+asm(
+	ASM_PUSH_TEXT
+	".globl " ASM_SYM(IG_switchStack) "\n"
+	ASM_FUNC_TYPE(IG_switchStack)
+	".p2align 4\n"
+	ASM_SYM(IG_switchStack) ":\n"
+	"	.cfi_startproc\n"
+	"	movl 4(%esp), %eax\n"
+	"	movl 8(%esp), %edx\n"
+	ASM_PUSH(ebp)
+	ASM_PUSH(ebx)
+	ASM_PUSH(esi)
+	ASM_PUSH(edi)
+	"	subl $8, %esp\n"
+	"	.cfi_adjust_cfa_offset 8\n"
+	ASM_MXCSR_SAVE
+	"	fnstcw 4(%esp)\n"
+	"	movl %esp, (%eax)\n"
+	"	movl %edx, %esp\n"
+	ASM_MXCSR_LOAD
+	"	fldcw 4(%esp)\n"
+	"	addl $8, %esp\n"
+	"	.cfi_adjust_cfa_offset -8\n"
+	ASM_POP(edi)
+	ASM_POP(esi)
+	ASM_POP(ebx)
+	ASM_POP(ebp)
+	"	ret\n"
+	"	.cfi_endproc\n"
+	".globl " ASM_SYM(IG_coroutineEntry) "\n"
+	ASM_FUNC_TYPE(IG_coroutineEntry)
+	".p2align 4\n"
+	ASM_SYM(IG_coroutineEntry) ":\n"
+	"	.cfi_startproc\n"
+	"	.cfi_undefined %eip\n"
+	"	subl $12, %esp\n"
+	"	pushl %esi\n"
+	"	call *%edi\n"
+	"	ud2\n"
+	"	.cfi_endproc\n"
+	ASM_POP_SECTION
+);
+
+// mxcsr/fpu control word, edi (func), esi (arg), ebx, ebp, return address
+static constexpr int STACK_FRAME_WORDS = 7;
+static constexpr int ARG_WORD = 3, FUNC_WORD = 2, RETURN_WORD = 6;
+
+static void initFPControlWords(uintptr_t *frame)
+{
+	uint32_t fpCtrl[2]{0x1F80, 0x037F}; // default mxcsr & x87 control word
+	memcpy(frame, fpCtrl, sizeof(fpCtrl));
+}
+
+#elif defined __aarch64__
+
+asm(
+	ASM_PUSH_TEXT
+	".globl " ASM_SYM(IG_switchStack) "\n"
+	ASM_FUNC_TYPE(IG_switchStack)
+	".p2align 2\n"
+	ASM_SYM(IG_switchStack) ":\n"
+	"	.cfi_startproc\n"
+	"	sub sp, sp, #160\n"
+	"	.cfi_def_cfa_offset 160\n"
+	"	stp x19, x20, [sp, #0]\n"
+	"	stp x21, x22, [sp, #16]\n"
+	"	stp x23, x24, [sp, #32]\n"
+	"	stp x25, x26, [sp, #48]\n"
+	"	stp x27, x28, [sp, #64]\n"
+	"	stp x29, x30, [sp, #80]\n"
+	"	.cfi_offset x19, -160\n"
+	"	.cfi_offset x20, -152\n"
+	"	.cfi_offset x21, -144\n"
+	"	.cfi_offset x22, -136\n"
+	"	.cfi_offset x23, -128\n"
+	"	.cfi_offset x24, -120\n"
+	"	.cfi_offset x25, -112\n"
+	"	.cfi_offset x26, -104\n"
+	"	.cfi_offset x27, -96\n"
+	"	.cfi_offset x28, -88\n"
+	"	.cfi_offset x29, -80\n"
+	"	.cfi_offset x30, -72\n"
+	"	stp d8, d9, [sp, #96]\n"
+	"	stp d10, d11, [sp, #112]\n"
+	"	stp d12, d13, [sp, #128]\n"
+	"	stp d14, d15, [sp, #144]\n"
+	"	.cfi_offset d8, -64\n"
+	"	.cfi_offset d9, -56\n"
+	"	.cfi_offset d10, -48\n"
+	"	.cfi_offset d11, -40\n"
+	"	.cfi_offset d12, -32\n"
+	"	.cfi_offset d13, -24\n"
+	"	.cfi_offset d14, -16\n"
+	"	.cfi_offset d15, -8\n"
+	"	mov x9, sp\n"
+	"	str x9, [x0]\n"
+	"	mov sp, x1\n"
+	"	ldp x19, x20, [sp, #0]\n"
+	"	ldp x21, x22, [sp, #16]\n"
+	"	ldp x23, x24, [sp, #32]\n"
+	"	ldp x25, x26, [sp, #48]\n"
+	"	ldp x27, x28, [sp, #64]\n"
+	"	ldp x29, x30, [sp, #80]\n"
+	"	ldp d8, d9, [sp, #96]\n"
+	"	ldp d10, d11, [sp, #112]\n"
+	"	ldp d12, d13, [sp, #128]\n"
+	"	ldp d14, d15, [sp, #144]\n"
+	"	add sp, sp, #160\n"
+	"	.cfi_def_cfa_offset 0\n"
+	"	ret\n"
+	"	.cfi_endproc\n"
+	".globl " ASM_SYM(IG_coroutineEntry) "\n"
+	ASM_FUNC_TYPE(IG_coroutineEntry)
+	".p2align 2\n"
+	ASM_SYM(IG_coroutineEntry) ":\n"
+	"	.cfi_startproc\n"
+	"	.cfi_undefined x30\n"
+	"	mov x0, x19\n"
+	"	blr x20\n"
+	"	brk #0\n"
+	"	.cfi_endproc\n"
+	ASM_POP_SECTION
+);
+
+// x19 (arg), x20 (func), x21-x28, x29, x30 (return address), d8-d15
+static constexpr int STACK_FRAME_WORDS = 20;
+static constexpr int ARG_WORD = 0, FUNC_WORD = 1, RETURN_WORD = 11;
+
+static void initFPControlWords(uintptr_t *) {}
+
+#elif defined __arm__
+
+#if defined __ARM_FP || defined __VFP_FP__ && !defined __SOFTFP__
+#define ASM_VFP_PUSH \
+	"	vpush {d8-d15}\n" \
+	"	.cfi_adjust_cfa_offset 64\n" \
+	"	.cfi_rel_offset d8, 0\n" \
+	"	.cfi_rel_offset d9, 8\n" \
+	"	.cfi_rel_offset d10, 16\n" \
+	"	.cfi_rel_offset d11, 24\n" \
+	"	.cfi_rel_offset d12, 32\n" \
+	"	.cfi_rel_offset d13, 40\n" \
+	"	.cfi_rel_offset d14, 48\n" \
+	"	.cfi_rel_offset d15, 56\n"
+#define ASM_VFP_POP \
+	"	vpop {d8-d15}\n" \
+	"	.cfi_adjust_cfa_offset -64\n"
+static constexpr int VFP_WORDS = 16;
+#else
+#define ASM_VFP_PUSH
+#define ASM_VFP_POP
+static constexpr int VFP_WORDS = 0;
+#endif
+
+asm(
+	ASM_PUSH_TEXT
+	".syntax unified\n"
+	".arm\n"
+	".globl " ASM_SYM(IG_switchStack) "\n"
+	ASM_FUNC_TYPE(IG_switchStack)
+	".p2align 2\n"
+	ASM_SYM(IG_switchStack) ":\n"
+	"	.cfi_startproc\n"
+	"	push {r4-r11, lr}\n"
+	"	.cfi_adjust_cfa_offset 36\n"
+	"	.cfi_rel_offset r4, 0\n"
+	"	.cfi_rel_offset r5, 4\n"
+	"	.cfi_rel_offset r6, 8\n"
+	"	.cfi_rel_offset r7, 12\n"
+	"	.cfi_rel_offset r8, 16\n"
+	"	.cfi_rel_offset r9, 20\n"
+	"	.cfi_rel_offset r10, 24\n"
+	"	.cfi_rel_offset r11, 28\n"
+	"	.cfi_rel_offset lr, 32\n"
+	ASM_VFP_PUSH
+	"	sub sp, sp, #4\n" // keep 8-byte alignment
+	"	.cfi_adjust_cfa_offset 4\n"
+	"	str sp, [r0]\n"
+	"	mov sp, r1\n"
+	"	add sp, sp, #4\n"
+	"	.cfi_adjust_cfa_offset -4\n"
+	ASM_VFP_POP
+	"	pop {r4-r11, pc}\n"
+	"	.cfi_endproc\n"
+	".globl " ASM_SYM(IG_coroutineEntry) "\n"
+	ASM_FUNC_TYPE(IG_coroutineEntry)
+	".p2align 2\n"
+	ASM_SYM(IG_coroutineEntry) ":\n"
+	"	.cfi_startproc\n"
+	"	.cfi_undefined lr\n"
+	"	mov r0, r4\n"
+	"	blx r5\n"
+	"	bkpt #0\n"
+	"	.cfi_endproc\n"
+	ASM_POP_SECTION
+);
+
+// padding, d8-d15, r4 (arg), r5 (func), r6-r11, return address
+static constexpr int STACK_FRAME_WORDS = 1 + VFP_WORDS + 9;
+static constexpr int ARG_WORD = 1 + VFP_WORDS, FUNC_WORD = ARG_WORD + 1, RETURN_WORD = STACK_FRAME_WORDS - 1;
+
+static void initFPControlWords(uintptr_t *) {}
+
+#else
+#error "Coroutine stack switching not implemented for this architecture"
+#endif
+
+namespace IG
+{
+
+Coroutine::Coroutine(EntryDelegate entry, size_t stackSize):
+	stack{new uint8_t[stackSize]},
+	entry{entry}
+{
+	// build the initial register frame at the 16-byte aligned top of the stack
+	auto stackTop = (uintptr_t)(stack.get() + stackSize) & ~(uintptr_t)15;
+	auto frame = (uintptr_t*)stackTop - STACK_FRAME_WORDS;
+	std::fill_n(frame, STACK_FRAME_WORDS, 0);
+	initFPControlWords(frame);
+	frame[ARG_WORD] = (uintptr_t)this;
+	frame[FUNC_WORD] = (uintptr_t)&run;
+	frame[RETURN_WORD] = (uintptr_t)&IG_coroutineEntry;
+	stackPtr = frame;
+}
+
+void Coroutine::resume()
+{
+	assumeExpr(stack);
+	assumeExpr(!active);
+	auto thisThread = std::this_thread::get_id();
+	if(resumeThread == std::thread::id{})
+		resumeThread = thisThread;
+	assumeExpr(resumeThread == thisThread);
+	if(unlikely(finished))
+	{
+		logWarn("resuming finished coroutine");
+		return;
+	}
+	active = true;
+	IG_switchStack(&callerStackPtr, stackPtr);
+}
+
+void Coroutine::yield()
+{
+	assumeExpr(active);
+	active = false;
+	IG_switchStack(&stackPtr, callerStackPtr);
+}
+
+void Coroutine::run(Coroutine *co)
+{
+	co->entry();
+	logMsg("coroutine finished");
+	co->finished = true;
+	co->active = false;
+	void *unusedStackPtr;
+	IG_switchStack(&unusedStackPtr, co->callerStackPtr);
+	bug_unreachable("finished coroutine resumed");
+}
+
+}
@@ -0,0 +1,6 @@
+ifndef inc_thread_coroutine
+inc_thread_coroutine := 1
+
+SRC += thread/Coroutine.cc
+
+endif
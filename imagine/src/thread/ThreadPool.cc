@@ -0,0 +1,300 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "ThreadPool"
+#include <imagine/thread/ThreadPool.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace IG
+{
+
+// pool and deque index of the calling worker thread, if any
+static thread_local ThreadPool *thisPool{};
+static thread_local unsigned thisWorkerIdx{};
+
+static std::vector<int> performanceCPUs()
+{
+	std::vector<int> cpus{};
+	#ifdef __linux__
+	// efficiency cores report lower maximum frequencies than the others, keep every
+	// core above the slowest cluster so SoCs with a single prime core still get
+	// their big cores too
+	unsigned cpuCount = std::thread::hardware_concurrency();
+	std::vector<unsigned long> maxFreq(cpuCount);
+	unsigned long lowestFreq = ULONG_MAX;
+	iterateTimes(cpuCount, i)
+	{
+		char path[80];
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", i);
+		auto file = fopen(path, "r");
+		if(!file)
+			return {};
+		if(fscanf(file, "%lu", &maxFreq[i]) != 1)
+			maxFreq[i] = 0;
+		fclose(file);
+		lowestFreq = std::min(lowestFreq, maxFreq[i]);
+	}
+	if(std::all_of(maxFreq.begin(), maxFreq.end(), [&](auto freq){ return freq == lowestFreq; }))
+		return {}; // homogeneous cores
+	iterateTimes(cpuCount, i)
+	{
+		if(maxFreq[i] > lowestFreq)
+			cpus.emplace_back(i);
+	}
+	#endif
+	return cpus;
+}
+
+static void setThisThreadAffinity(const std::vector<int> &cpus)
+{
+	#ifdef __linux__
+	if(cpus.empty())
+		return;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(auto cpu : cpus)
+	{
+		CPU_SET(cpu, &set);
+	}
+	if(sched_setaffinity(0, sizeof(set), &set) == -1)
+	{
+		logWarn("error setting worker CPU affinity");
+	}
+	#endif
+}
+
+ThreadPool::ThreadPool(Config config):
+	nice{config.nice}, backgroundNice{config.backgroundNice}
+{
+	std::vector<int> cpus{};
+	if(config.usePerformanceCores)
+		cpus = performanceCPUs();
+	unsigned threads = config.threads;
+	if(!threads)
+	{
+		unsigned cores = cpus.size() ? cpus.size() : std::thread::hardware_concurrency();
+		threads = std::max(cores, 2u) - 1;
+	}
+	// a single worker still runs background tasks, parallelFor() callers run their
+	// own queued real-time lanes if it's busy with one
+	backgroundLimit = std::max(threads - 1, 1u);
+	logMsg("starting %u worker(s)%s", threads, cpus.size() ? " on performance cores" : "");
+	workers.reserve(threads);
+	iterateTimes(threads, i)
+	{
+		workers.emplace_back(std::make_unique<Worker>());
+	}
+	// start threads after all workers exist since any of them may steal from the others
+	iterateTimes(threads, i)
+	{
+		workers[i]->thread = std::thread{[this, i, cpus](){ workerLoop(i, cpus); }};
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lk{sleepLock};
+		quit = true;
+	}
+	wake.notify_all();
+	for(auto &w : workers)
+	{
+		w->thread.join();
+	}
+}
+
+ThreadPool &ThreadPool::shared()
+{
+	static ThreadPool pool{};
+	return pool;
+}
+
+void ThreadPool::run(TaskDelegate task, TaskPriority priority)
+{
+	assumeExpr(task);
+	auto p = (unsigned)priority;
+	// workers keep their own tasks local, other threads spread them out
+	unsigned idx = thisPool == this ? thisWorkerIdx :
+		nextQueue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+	{
+		auto &w = *workers[idx];
+		std::lock_guard lk{w.lock};
+		w.queue[p].emplace_back(task);
+	}
+	queued[p].fetch_add(1, std::memory_order_release);
+	{
+		// pairs with the predicate check in workerLoop() so the wake-up isn't missed
+		std::lock_guard lk{sleepLock};
+	}
+	wake.notify_one();
+}
+
+bool ThreadPool::hasRunnableTask() const
+{
+	return queued[(unsigned)TaskPriority::REALTIME].load(std::memory_order_acquire) ||
+		queued[(unsigned)TaskPriority::NORMAL].load(std::memory_order_acquire) ||
+		(queued[(unsigned)TaskPriority::BACKGROUND].load(std::memory_order_acquire) &&
+			runningBackground.load(std::memory_order_acquire) < backgroundLimit);
+}
+
+bool ThreadPool::takeTask(unsigned priority, TaskDelegate &task)
+{
+	if(!queued[priority].load(std::memory_order_acquire))
+		return false;
+	unsigned firstIdx = thisPool == this ? thisWorkerIdx : 0;
+	iterateTimes(workers.size(), i)
+	{
+		unsigned idx = (firstIdx + i) % workers.size();
+		auto &w = *workers[idx];
+		std::lock_guard lk{w.lock};
+		auto &queue = w.queue[priority];
+		if(queue.empty())
+			continue;
+		if(idx == firstIdx && thisPool == this)
+		{
+			// newest task from our own deque is the most likely to have its data in cache
+			task = queue.back();
+			queue.pop_back();
+		}
+		else
+		{
+			task = queue.front();
+			queue.pop_front();
+		}
+		queued[priority].fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
+
+bool ThreadPool::runPendingTask(TaskPriority lowestPriority)
+{
+	TaskDelegate task{};
+	for(unsigned p = 0; p <= (unsigned)lowestPriority; p++)
+	{
+		if(p != (unsigned)TaskPriority::BACKGROUND)
+		{
+			if(takeTask(p, task))
+			{
+				task();
+				return true;
+			}
+			continue;
+		}
+		// workers reserve a background slot before taking the task, other threads
+		// don't take a worker away from real-time tasks so they always can
+		bool isWorker = thisPool == this;
+		if(isWorker)
+		{
+			auto running = runningBackground.load(std::memory_order_relaxed);
+			do
+			{
+				if(running >= backgroundLimit)
+					return false;
+			} while(!runningBackground.compare_exchange_weak(running, running + 1, std::memory_order_acq_rel));
+		}
+		if(!takeTask(p, task))
+		{
+			if(isWorker)
+				runningBackground.fetch_sub(1, std::memory_order_release);
+			return false;
+		}
+		if(isWorker && backgroundNice != nice)
+			setThisThreadPriority(backgroundNice);
+		task();
+		if(isWorker)
+		{
+			if(backgroundNice != nice)
+				setThisThreadPriority(nice);
+			runningBackground.fetch_sub(1, std::memory_order_release);
+		}
+		if(queued[p].load(std::memory_order_acquire))
+		{
+			// a worker may be sleeping on a background task that was over the limit
+			{
+				std::lock_guard lk{sleepLock};
+			}
+			wake.notify_one();
+		}
+		return true;
+	}
+	return false;
+}
+
+void ThreadPool::workerLoop(unsigned idx, std::vector<int> cpus)
+{
+	thisPool = this;
+	thisWorkerIdx = idx;
+	if(nice)
+		setThisThreadPriority(nice);
+	setThisThreadAffinity(cpus);
+	while(true)
+	{
+		if(runPendingTask(TaskPriority::BACKGROUND))
+			continue;
+		std::unique_lock lk{sleepLock};
+		wake.wait(lk, [this](){ return quit || hasRunnableTask(); });
+		if(quit && !hasRunnableTask())
+			return;
+	}
+}
+
+void ThreadPool::ParallelForJob::runIndices()
+{
+	for(unsigned i = next.fetch_add(1, std::memory_order_relaxed); i < end;
+		i = next.fetch_add(1, std::memory_order_relaxed))
+	{
+		func(ctx, i);
+	}
+}
+
+void ThreadPool::runParallelFor(ParallelForJob &job, unsigned maxLanes)
+{
+	unsigned items = job.end - job.next.load(std::memory_order_relaxed);
+	unsigned lanes = std::min({items, threads() + 1, maxLanes ? maxLanes : UINT_MAX});
+	unsigned runners = lanes - 1;
+	if(!runners)
+	{
+		job.runIndices();
+		return;
+	}
+	job.activeRunners.store(runners, std::memory_order_relaxed);
+	iterateTimes(runners, i)
+	{
+		run(
+			[&job]()
+			{
+				job.runIndices();
+				if(job.activeRunners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					job.done.notify();
+			}, TaskPriority::REALTIME);
+	}
+	job.runIndices();
+	// while runners are still queued, run real-time tasks here instead of blocking,
+	// which also keeps a parallelFor() inside a task from waiting on its own worker
+	while(job.activeRunners.load(std::memory_order_acquire) && runPendingTask(TaskPriority::REALTIME)) {}
+	job.done.wait();
+}
+
+}
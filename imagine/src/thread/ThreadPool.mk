@@ -0,0 +1,6 @@
+ifndef inc_thread_pool
+inc_thread_pool := 1
+
+SRC += thread/ThreadPool.cc
+
+endif
@@ -1,7 +1,11 @@
 ifneq ($(filter linux android,$(ENV)),)
  include $(imagineSrcDir)/thread/PosixSemaphore.mk
+ include $(imagineSrcDir)/thread/Coroutine.mk
+ include $(imagineSrcDir)/thread/ThreadPool.mk
 else ifneq ($(filter ios macosx,$(ENV)),)
  include $(imagineSrcDir)/thread/MachSemaphore.mk
+ include $(imagineSrcDir)/thread/Coroutine.mk
+ include $(imagineSrcDir)/thread/ThreadPool.mk
 else ifeq ($(ENV), win32)
  include $(imagineSrcDir)/thread/Win32Thread.mk
 endif
@@ -0,0 +1,160 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+// Checks Coroutine stack switching: execution interleaves at each yield(),
+// callee-saved state survives switches, and each stack keeps its own FPU
+// rounding mode. Build and run with "make -C imagine/src/thread/tests check".
+
+#include <imagine/thread/Coroutine.hh>
+#include <imagine/logger/logger.h>
+#include <cfenv>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+CLINK void logger_printf(LoggerSeverity, const char *, ...) {}
+
+CLINK void bug_doExit(const char *msg, ...)
+{
+	fprintf(stderr, "%s\n", msg);
+	abort();
+}
+
+static bool check(bool ok, const char *desc)
+{
+	printf("%s: %s\n", desc, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+static bool interleavesAtYields()
+{
+	std::vector<int> order;
+	IG::Coroutine *coPtr{};
+	IG::Coroutine co
+	{
+		[&]()
+		{
+			for(int i = 0; i < 3; i++)
+			{
+				order.push_back(i * 2);
+				coPtr->yield();
+			}
+		}
+	};
+	coPtr = &co;
+	for(int i = 0; i < 4; i++)
+	{
+		co.resume();
+		order.push_back(i * 2 + 1);
+	}
+	return check(order == std::vector<int>{0, 1, 2, 3, 4, 5, 7} && co.hasFinished(),
+		"execution interleaves at yields");
+}
+
+[[gnu::noinline]] static double mix(double a, int n)
+{
+	for(int i = 0; i < n; i++)
+		a = a * 1.0000001 + i;
+	return a;
+}
+
+static bool calleeSavedSurvive()
+{
+	// the compiler keeps these live across resume() in callee-saved registers
+	IG::Coroutine *coPtr{};
+	IG::Coroutine co
+	{
+		[&]()
+		{
+			for(;;)
+			{
+				volatile double clobber = mix(3., 10);
+				(void)clobber;
+				coPtr->yield();
+			}
+		}
+	};
+	coPtr = &co;
+	double expected = 1.;
+	double val = 1.;
+	long sum = 0;
+	for(int i = 0; i < 100; i++)
+	{
+		val = mix(val, 3);
+		sum += i * 7;
+		co.resume();
+		expected = mix(expected, 3);
+	}
+	return check(val == expected && sum == 7 * 99 * 100 / 2, "locals survive switches");
+}
+
+static bool keepsRoundingModePerStack()
+{
+	bool coSawOwnMode = true;
+	IG::Coroutine *coPtr{};
+	IG::Coroutine co
+	{
+		[&]()
+		{
+			fesetround(FE_UPWARD);
+			for(;;)
+			{
+				coPtr->yield();
+				coSawOwnMode &= fegetround() == FE_UPWARD;
+			}
+		}
+	};
+	coPtr = &co;
+	fesetround(FE_TONEAREST);
+	bool callerKeptMode = true;
+	for(int i = 0; i < 3; i++)
+	{
+		co.resume();
+		callerKeptMode &= fegetround() == FE_TONEAREST;
+	}
+	return check(callerKeptMode && coSawOwnMode, "rounding mode is kept per stack");
+}
+
+static bool runsOnAnotherThread()
+{
+	// the first resume() picks the thread, not the constructor
+	int yields = 0;
+	IG::Coroutine *coPtr{};
+	IG::Coroutine co
+	{
+		[&]()
+		{
+			for(;;)
+			{
+				yields++;
+				coPtr->yield();
+			}
+		}
+	};
+	coPtr = &co;
+	std::thread t{[&](){ for(int i = 0; i < 5; i++) co.resume(); }};
+	t.join();
+	return check(yields == 5, "runs on a thread other than its creator");
+}
+
+int main()
+{
+	bool ok = interleavesAtYields();
+	ok &= calleeSavedSurvive();
+	ok &= keepsRoundingModePerStack();
+	ok &= runsOnAnotherThread();
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+// Checks ThreadPool scheduling on small pools: background tasks must run with a
+// single worker, and must leave a worker free for other work when there are more.
+// Build and run with "make -C imagine/src/thread/tests check".
+
+#include <imagine/thread/ThreadPool.hh>
+#include <imagine/logger/logger.h>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+CLINK void logger_printf(LoggerSeverity, const char *msg, ...)
+{
+	if(!getenv("THREAD_POOL_TEST_VERBOSE"))
+		return;
+	va_list args;
+	va_start(args, msg);
+	vfprintf(stderr, msg, args);
+	va_end(args);
+}
+
+namespace IG
+{
+void setThisThreadPriority(int) {}
+}
+
+static constexpr auto timeout = 5s;
+
+static bool check(bool ok, const char *desc)
+{
+	printf("%s: %s\n", desc, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+static bool singleWorkerRunsBackground()
+{
+	IG::ThreadPool pool{{.threads = 1, .usePerformanceCores = false}};
+	std::promise<void> ran;
+	pool.run([&](){ ran.set_value(); }, IG::TaskPriority::BACKGROUND);
+	return check(ran.get_future().wait_for(timeout) == std::future_status::ready,
+		"single worker runs a background task");
+}
+
+static bool singleWorkerParallelForWhileBusy()
+{
+	IG::ThreadPool pool{{.threads = 1, .usePerformanceCores = false}};
+	std::promise<void> started, release;
+	auto releaseFuture = release.get_future();
+	pool.run([&](){ started.set_value(); releaseFuture.wait(); }, IG::TaskPriority::BACKGROUND);
+	if(started.get_future().wait_for(timeout) != std::future_status::ready)
+	{
+		release.set_value();
+		return check(false, "parallelFor finishes while the single worker runs a background task");
+	}
+	// the only worker is blocked, the caller has to run every lane itself
+	auto done = std::async(std::launch::async, [&]()
+		{
+			std::atomic_uint sum{};
+			pool.parallelFor(0, 64, [&](unsigned i){ sum += i; });
+			return sum.load();
+		});
+	bool ok = done.wait_for(timeout) == std::future_status::ready && done.get() == 64 * 63 / 2;
+	release.set_value();
+	return check(ok, "parallelFor finishes while the single worker runs a background task");
+}
+
+static bool backgroundLeavesWorkerFree()
+{
+	constexpr unsigned workers = 3;
+	IG::ThreadPool pool{{.threads = workers, .usePerformanceCores = false}};
+	std::atomic_uint running{};
+	std::promise<void> release;
+	std::shared_future<void> releaseFuture = release.get_future();
+	for(unsigned i = 0; i < workers; i++)
+	{
+		pool.run([&](){ running++; releaseFuture.wait(); }, IG::TaskPriority::BACKGROUND);
+	}
+	std::promise<void> ran;
+	pool.run([&](){ ran.set_value(); }, IG::TaskPriority::NORMAL);
+	bool ok = ran.get_future().wait_for(timeout) == std::future_status::ready;
+	// give the workers time to pick up every background task they're allowed to
+	for(auto waited = 0ms; running.load() < workers - 1 && waited < timeout; waited += 10ms)
+		std::this_thread::sleep_for(10ms);
+	std::this_thread::sleep_for(50ms);
+	ok = ok && running.load() == workers - 1;
+	release.set_value();
+	return check(ok, "background tasks leave a worker for normal tasks");
+}
+
+int main()
+{
+	bool ok = singleWorkerRunsBackground();
+	ok &= singleWorkerParallelForWhileBusy();
+	ok &= backgroundLeavesWorkerFree();
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}